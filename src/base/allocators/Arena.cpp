@@ -0,0 +1,63 @@
+#include "Arena.hpp"
+
+#include <algorithm>
+
+void base::Arena::rewind(const Marker& marker) {
+    _current = marker.block;
+    _used    = marker.used;
+}
+
+auto base::Arena::usedBytes() const -> SizeT {
+    auto used = _used;
+
+    for (SizeT i = 0; i < _current && i < _blocks.size(); ++i)
+        used += _blocks[i].size;
+
+    return used;
+}
+
+auto base::Arena::bump(SizeT bytes, SizeT alignment) -> void* {
+    if (_current >= _blocks.size())
+        return nullptr;
+
+    auto& block  = _blocks[_current];
+    auto  start  = reinterpret_cast<uintptr_t>(block.data.get());
+    auto  offset = ((start + _used + alignment - 1) & ~(alignment - 1)) - start;
+
+    if (offset + bytes > block.size)
+        return nullptr;
+
+    _used = offset + bytes;
+    return block.data.get() + offset;
+}
+
+void* base::Arena::do_allocate(SizeT bytes, SizeT alignment) {
+    ++_allocations;
+
+    if (auto ptr = bump(bytes, alignment))
+        return ptr;
+
+    // Kept blocks are reused before new one is allocated
+    while (_current + 1 < _blocks.size()) {
+        ++_current;
+        _used = 0;
+
+        if (auto ptr = bump(bytes, alignment))
+            return ptr;
+    }
+
+    // Blocks grow geometrically: few of them are needed for big temporaries
+    auto size = std::max({_blockSize, _reserved, bytes + alignment});
+
+    _blocks.push_back(Block{std::unique_ptr<Byte[]>(new Byte[size]), size});
+    _reserved += size;
+    _current   = _blocks.size() - 1;
+    _used      = 0;
+
+    return bump(bytes, alignment);
+}
+
+auto base::thread_arena() -> Arena& {
+    thread_local auto arena = Arena();
+    return arena;
+}
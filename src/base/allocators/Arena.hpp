@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include "../baseTypes.hpp"
+
+namespace base {
+    /**
+     * Bump allocator for short-lived temporaries. Deallocation is no-op, memory is released by rewind
+     * to marker or reset. Blocks are kept for next allocations and grow with arena, so arena
+     * stops allocating after warm-up. Not thread-safe: use thread_arena()
+     */
+    class Arena : public std::pmr::memory_resource {
+    public:
+        static constexpr SizeT DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+        struct Marker {
+            SizeT block = 0;
+            SizeT used  = 0;
+        };
+
+        explicit Arena(SizeT blockSize = DEFAULT_BLOCK_SIZE): _blockSize(blockSize) {}
+
+        Arena(const Arena&)            = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        auto mark() const -> Marker { return {_current, _used}; }
+
+        // Memory allocated after marker is released, blocks are kept
+        void rewind(const Marker& marker);
+        void reset() { rewind({}); }
+
+        auto usedBytes()     const -> SizeT;
+        auto reservedBytes() const { return _reserved; }
+        auto allocations()   const { return _allocations; } // Count of allocations since creation
+        auto blocksCount()   const { return _blocks.size(); }
+
+    protected:
+        void* do_allocate  (SizeT bytes, SizeT alignment) override;
+        void  do_deallocate(void*, SizeT, SizeT) override {}
+        bool  do_is_equal  (const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+
+    private:
+        auto bump(SizeT bytes, SizeT alignment) -> void*;
+
+        struct Block {
+            std::unique_ptr<Byte[]> data;
+            SizeT                   size;
+        };
+
+        std::vector<Block> _blocks;
+        SizeT              _current     = 0; // Block being filled
+        SizeT              _used        = 0; // Bytes used in current block
+        SizeT              _reserved    = 0;
+        SizeT              _allocations = 0;
+        SizeT              _blockSize;
+    };
+
+    // Arena for temporaries of current thread
+    auto thread_arena() -> Arena&;
+
+    /**
+     * Rewinds arena on destruction: everything allocated in scope must be destroyed before,
+     * containers from outer scopes must not grow in it
+     */
+    class ArenaScope {
+    public:
+        explicit ArenaScope(Arena& arena = thread_arena()): _arena(arena), _marker(arena.mark()) {}
+        ~ArenaScope() { _arena.rewind(_marker); }
+
+        ArenaScope(const ArenaScope&)            = delete;
+        ArenaScope& operator=(const ArenaScope&) = delete;
+
+        auto arena() -> Arena& { return _arena; }
+
+    private:
+        Arena&        _arena;
+        Arena::Marker _marker;
+    };
+}
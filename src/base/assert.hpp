@@ -37,7 +37,7 @@ namespace details {
         if (!expr) {
             auto msg = fmt::format("\nFATAL ERROR:\nfile: {}:{}\nfunc: {}\nline: {}\nexpr: {}",
                     file, line, func, line, strexp);
-            base::Log("{}", msg);
+            base::LogAt(base::LogLevel::Fatal, base::LogCategory::General, "{}", msg);
             std::cerr << msg << std::endl;
             std::abort();
         }
@@ -51,12 +51,12 @@ namespace details {
             int line,
             const char* strexp,
             FmtT format,
-            ArgT... args
+            const ArgT&... args
     ) {
         if (!expr) {
             auto msg = fmt::format("\nFATAL ERROR:\nfile: {}:{}\nfunc: {}\nline: {}\nexpr: {}\nwhat: {}",
                     file, line, func, line, strexp, fmt::format(format, args...));
-            base::Log("{}", msg);
+            base::LogAt(base::LogLevel::Fatal, base::LogCategory::General, "{}", msg);
             std::cerr << msg << std::endl;
             std::abort();
         }
@@ -0,0 +1,372 @@
+#include "async_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if __has_include(<linux/io_uring.h>)
+    #include <linux/io_uring.h>
+    #define DE_HAS_IO_URING
+#endif
+
+namespace base::aio_dtls {
+    struct Request {
+        enum class Op { Read, Write };
+
+        Op                 op;
+        int                fd;
+        iovec              iov;
+        U64                offset;
+        AsyncIo::Callback  callback;
+    };
+
+#ifdef DE_HAS_IO_URING
+    /**
+     * Raw io_uring without liburing. Submission queue is used under AsyncIo mutex,
+     * completion queue is used only by completion thread
+     */
+    struct Ring {
+        int fd = -1;
+
+        U32*          sq_head  = nullptr;
+        U32*          sq_tail  = nullptr;
+        U32*          sq_mask  = nullptr;
+        U32*          sq_array = nullptr;
+        U32           sq_entries = 0;
+        io_uring_sqe* sqes     = nullptr;
+
+        U32*          cq_head = nullptr;
+        U32*          cq_tail = nullptr;
+        U32*          cq_mask = nullptr;
+        io_uring_cqe* cqes    = nullptr;
+
+        void*  sq_ptr     = MAP_FAILED;
+        void*  cq_ptr     = MAP_FAILED;
+        SizeT  sq_size    = 0;
+        SizeT  cq_size    = 0;
+        SizeT  sqes_size  = 0;
+
+        ~Ring() {
+            if (sqes)
+                munmap(sqes, sqes_size);
+            if (cq_ptr != MAP_FAILED && cq_ptr != sq_ptr)
+                munmap(cq_ptr, cq_size);
+            if (sq_ptr != MAP_FAILED)
+                munmap(sq_ptr, sq_size);
+            if (fd != -1)
+                close(fd);
+        }
+
+        bool init(U32 entries) {
+            auto params = io_uring_params();
+            std::memset(&params, 0, sizeof(params));
+
+            fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+            if (fd < 0) {
+                fd = -1;
+                return false;
+            }
+
+            sq_size = params.sq_off.array + params.sq_entries * sizeof(U32);
+            cq_size = params.cq_off.cqes  + params.cq_entries * sizeof(io_uring_cqe);
+
+            auto single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single_mmap)
+                sq_size = cq_size = std::max(sq_size, cq_size);
+
+            sq_ptr = mmap(nullptr, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+            if (sq_ptr == MAP_FAILED)
+                return false;
+
+            cq_ptr = single_mmap ? sq_ptr :
+                     mmap(nullptr, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+            if (cq_ptr == MAP_FAILED)
+                return false;
+
+            sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+            auto sqes_ptr = mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+            if (sqes_ptr == MAP_FAILED)
+                return false;
+
+            auto sq = static_cast<char*>(sq_ptr);
+            auto cq = static_cast<char*>(cq_ptr);
+
+            sqes       = static_cast<io_uring_sqe*>(sqes_ptr);
+            sq_entries = params.sq_entries;
+            sq_head    = reinterpret_cast<U32*>(sq + params.sq_off.head);
+            sq_tail    = reinterpret_cast<U32*>(sq + params.sq_off.tail);
+            sq_mask    = reinterpret_cast<U32*>(sq + params.sq_off.ring_mask);
+            sq_array   = reinterpret_cast<U32*>(sq + params.sq_off.array);
+            cq_head    = reinterpret_cast<U32*>(cq + params.cq_off.head);
+            cq_tail    = reinterpret_cast<U32*>(cq + params.cq_off.tail);
+            cq_mask    = reinterpret_cast<U32*>(cq + params.cq_off.ring_mask);
+            cqes       = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+            return true;
+        }
+
+        // Returns false if submission queue is full
+        bool push(U8 opcode, int file, const void* addr, U32 len, U64 offset, U64 user_data) {
+            auto tail = *sq_tail;
+            if (tail - __atomic_load_n(sq_head, __ATOMIC_ACQUIRE) == sq_entries)
+                return false;
+
+            auto index = tail & *sq_mask;
+            auto sqe   = &sqes[index];
+
+            std::memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode    = opcode;
+            sqe->fd        = file;
+            sqe->addr      = reinterpret_cast<U64>(addr);
+            sqe->len       = len;
+            sqe->off       = offset;
+            sqe->user_data = user_data;
+
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+            return true;
+        }
+
+        int enter(U32 to_submit, U32 min_complete, U32 flags) {
+            int rc;
+            do {
+                rc = static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+            } while (rc < 0 && errno == EINTR);
+
+            return rc;
+        }
+    };
+#else
+    struct Ring {
+        bool init(U32) { return false; }
+    };
+#endif
+}
+
+using base::aio_dtls::Request;
+
+
+base::AsyncIo::AsyncIo(Backend backend, U32 queue_depth): _backend(backend), _queue_depth(queue_depth) {
+    if (_backend != Backend::ThreadPool) {
+        _ring = std::make_unique<aio_dtls::Ring>();
+
+        if (_ring->init(queue_depth))
+            _backend = Backend::IoUring;
+        else {
+            _ring.reset();
+            _backend = Backend::ThreadPool;
+        }
+    }
+
+    if (_backend == Backend::IoUring)
+        _threads.emplace_back(&AsyncIo::completionLoop, this);
+    else {
+        auto count = std::clamp<U32>(std::thread::hardware_concurrency(), 2, 4);
+
+        for (U32 i = 0; i < count; ++i)
+            _threads.emplace_back(&AsyncIo::workerLoop, this);
+    }
+}
+
+base::AsyncIo::~AsyncIo() {
+    wait_idle();
+
+    {
+        auto lock = std::lock_guard(_mutex);
+        _stop = true;
+
+#ifdef DE_HAS_IO_URING
+        // Wake up completion thread with request without callback
+        if (_ring) {
+            _ring->push(IORING_OP_NOP, -1, nullptr, 0, 0, 0);
+            _ring->enter(1, 0, 0);
+        }
+#endif
+    }
+    _ready_cv.notify_all();
+
+    for (auto& thread : _threads)
+        thread.join();
+}
+
+void base::AsyncIo::read(int fd, Byte* buffer, SizeT size, U64 offset, Callback callback) {
+    enqueue(new Request{Request::Op::Read, fd, iovec{buffer, size}, offset, std::move(callback)});
+}
+
+void base::AsyncIo::write(int fd, const Byte* buffer, SizeT size, U64 offset, Callback callback) {
+    enqueue(new Request{Request::Op::Write, fd, iovec{const_cast<Byte*>(buffer), size}, offset, std::move(callback)});
+}
+
+auto base::AsyncIo::read(int fd, Byte* buffer, SizeT size, U64 offset) -> std::future<S64> {
+    auto promise = std::make_shared<std::promise<S64>>();
+    auto future  = promise->get_future();
+
+    read(fd, buffer, size, offset, [promise](S64 result) { promise->set_value(result); });
+    return future;
+}
+
+auto base::AsyncIo::write(int fd, const Byte* buffer, SizeT size, U64 offset) -> std::future<S64> {
+    auto promise = std::make_shared<std::promise<S64>>();
+    auto future  = promise->get_future();
+
+    write(fd, buffer, size, offset, [promise](S64 result) { promise->set_value(result); });
+    return future;
+}
+
+void base::AsyncIo::read_file(const ftl::String& path, std::function<void(ftl::Vector<Byte>)> callback) {
+    auto fd = open(path.c_str(), O_RDONLY);
+
+    struct stat st = {};
+    if (fd == -1 || fstat(fd, &st) != 0) {
+        if (fd != -1)
+            close(fd);
+        callback({});
+        return;
+    }
+
+    auto buffer = std::make_shared<ftl::Vector<Byte>>(static_cast<SizeT>(st.st_size));
+    auto data   = buffer->data();
+    auto size   = buffer->size();
+
+    read(fd, data, size, 0, [fd, buffer, callback = std::move(callback)](S64 result) {
+        close(fd);
+        callback(result == static_cast<S64>(buffer->size()) ? std::move(*buffer) : ftl::Vector<Byte>());
+    });
+}
+
+void base::AsyncIo::enqueue(Request* request) {
+    auto lock = std::unique_lock(_mutex);
+    _queued.push_back(request);
+    ++_pending;
+
+    if (_queued.size() >= BATCH_SIZE) {
+        lock.unlock();
+        flush();
+    }
+}
+
+void base::AsyncIo::flush() {
+    {
+        auto lock = std::lock_guard(_mutex);
+        if (_queued.empty())
+            return;
+
+        _ready.insert(_ready.end(), _queued.begin(), _queued.end());
+        _queued.clear();
+
+        if (_ring)
+            submitReady();
+    }
+
+    if (!_ring)
+        _ready_cv.notify_all();
+}
+
+void base::AsyncIo::wait_idle() {
+    flush();
+
+    auto lock = std::unique_lock(_mutex);
+    _idle_cv.wait(lock, [this] { return _pending == 0; });
+}
+
+void base::AsyncIo::submitReady() {
+#ifdef DE_HAS_IO_URING
+    U32 count = 0;
+
+    while (!_ready.empty() && _in_flight < _queue_depth) {
+        auto request = _ready.front();
+        auto opcode  = request->op == Request::Op::Read ? IORING_OP_READV : IORING_OP_WRITEV;
+
+        if (!_ring->push(opcode, request->fd, &request->iov, 1, request->offset, reinterpret_cast<U64>(request)))
+            break;
+
+        _ready.pop_front();
+        ++_in_flight;
+        ++count;
+    }
+
+    if (count)
+        _ring->enter(count, 0, 0);
+#endif
+}
+
+void base::AsyncIo::complete(Request* request, S64 result) {
+    if (request->callback)
+        request->callback(result);
+    delete request;
+
+    auto lock = std::lock_guard(_mutex);
+    if (--_pending == 0)
+        _idle_cv.notify_all();
+}
+
+void base::AsyncIo::completionLoop() {
+#ifdef DE_HAS_IO_URING
+    auto completed = std::vector<std::pair<Request*, S64>>();
+
+    while (true) {
+        _ring->enter(0, 1, IORING_ENTER_GETEVENTS);
+
+        auto head = *_ring->cq_head;
+        auto tail = __atomic_load_n(_ring->cq_tail, __ATOMIC_ACQUIRE);
+        auto wake = false;
+
+        for (; head != tail; ++head) {
+            auto& cqe = _ring->cqes[head & *_ring->cq_mask];
+
+            if (cqe.user_data)
+                completed.emplace_back(reinterpret_cast<Request*>(cqe.user_data), cqe.res);
+            else
+                wake = true;
+        }
+        __atomic_store_n(_ring->cq_head, head, __ATOMIC_RELEASE);
+
+        {
+            auto lock = std::lock_guard(_mutex);
+            _in_flight -= static_cast<U32>(completed.size());
+            submitReady();
+        }
+
+        for (auto& [request, result] : completed)
+            complete(request, result);
+        completed.clear();
+
+        if (wake) {
+            auto lock = std::lock_guard(_mutex);
+            if (_stop)
+                break;
+        }
+    }
+#endif
+}
+
+void base::AsyncIo::workerLoop() {
+    while (true) {
+        Request* request;
+        {
+            auto lock = std::unique_lock(_mutex);
+            _ready_cv.wait(lock, [this] { return _stop || !_ready.empty(); });
+
+            if (_ready.empty())
+                break;
+
+            request = _ready.front();
+            _ready.pop_front();
+        }
+
+        auto offset = static_cast<off_t>(request->offset);
+        auto result = request->op == Request::Op::Read ?
+                      pread (request->fd, request->iov.iov_base, request->iov.iov_len, offset) :
+                      pwrite(request->fd, request->iov.iov_base, request->iov.iov_len, offset);
+
+        complete(request, result < 0 ? -errno : static_cast<S64>(result));
+    }
+}
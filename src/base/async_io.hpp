@@ -0,0 +1,98 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "ftl/string.hpp"
+#include "ftl/vector.hpp"
+
+namespace base {
+    namespace aio_dtls {
+        struct Request;
+        struct Ring;
+    }
+
+    /**
+     * Asynchronous file I/O
+     *
+     * Requests are queued and submitted in batches: on flush() or when batch is full.
+     * On Linux requests go to io_uring and completions are reaped by one thread, if io_uring
+     * is not available they are executed by pool of threads with pread/pwrite.
+     * Callbacks are called from completion threads with count of transferred bytes or -errno.
+     * Buffers must stay alive until completion
+     */
+    class AsyncIo {
+    public:
+        enum class Backend {
+            Auto = 0, IoUring, ThreadPool
+        };
+
+        using Callback = std::function<void(S64)>;
+
+        static constexpr SizeT BATCH_SIZE = 32;
+
+        /**
+         * @param backend - Auto uses io_uring if kernel supports it
+         * @param queue_depth - max count of requests in flight
+         */
+        explicit AsyncIo(Backend backend = Backend::Auto, U32 queue_depth = 128);
+        ~AsyncIo();
+
+        AsyncIo(const AsyncIo&) = delete;
+        AsyncIo& operator=(const AsyncIo&) = delete;
+
+        void read (int fd, Byte* buffer, SizeT size, U64 offset, Callback callback);
+        void write(int fd, const Byte* buffer, SizeT size, U64 offset, Callback callback);
+
+        auto read (int fd, Byte* buffer, SizeT size, U64 offset) -> std::future<S64>;
+        auto write(int fd, const Byte* buffer, SizeT size, U64 offset) -> std::future<S64>;
+
+        /**
+         * Read whole file. Callback gets empty vector if file can't be read
+         */
+        void read_file(const ftl::String& path, std::function<void(ftl::Vector<Byte>)> callback);
+
+        void flush    (); // Submit queued requests
+        void wait_idle(); // Flush and wait for all requests including ones submitted from callbacks
+
+        auto backend    () const { return _backend; }
+        auto queue_depth() const { return _queue_depth; }
+
+    private:
+        void enqueue       (aio_dtls::Request* request);
+        void submitReady   (); // io_uring only, _mutex must be locked
+        void complete      (aio_dtls::Request* request, S64 result);
+        void completionLoop();
+        void workerLoop    ();
+
+    private:
+        Backend                         _backend;
+        U32                             _queue_depth;
+        std::unique_ptr<aio_dtls::Ring> _ring;
+
+        std::mutex                      _mutex;
+        std::condition_variable         _ready_cv;
+        std::condition_variable         _idle_cv;
+        std::deque<aio_dtls::Request*>  _queued;  // Waiting for flush
+        std::deque<aio_dtls::Request*>  _ready;   // Flushed, waiting for worker or free ring slot
+        U32                             _in_flight = 0;
+        SizeT                           _pending   = 0;
+        bool                            _stop      = false;
+
+        std::vector<std::thread>        _threads;
+    };
+
+
+    inline AsyncIo& async_io() {
+        static AsyncIo inst;
+        return inst;
+    }
+
+} // namespace base
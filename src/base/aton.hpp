@@ -1,6 +1,8 @@
 #ifndef UIBUILDER_ATOUI_HPP
 #define UIBUILDER_ATOUI_HPP
 
+#include <cstring>
+#include <string_view>
 #include <type_traits>
 #include "assert.hpp"
 
@@ -9,125 +11,144 @@
 
 namespace base {
 
-    template<typename T>
-    auto aton(const char *p) -> std::enable_if_t<std::is_floating_point_v<T>, T> {
-
-        while (white_space(*p)) { ++p; }
-
-        auto r = static_cast<T>(0);
-
-        //get sign
-        bool neg = false;
-        if (*p == '-') {
-            neg = true;
-            ++p;
-        }
-        else if (*p == '+') {
-            neg = false;
-            ++p;
+    namespace aton_dtls {
+        inline U64 read_eight(const char* p) {
+            U64 val;
+            std::memcpy(&val, p, sizeof(U64));
+            return val;
         }
 
-        //get the digits before decimal point
-        while (valid_digit(*p)) {
-            r = (r * 10) + (*p - '0');
-            ++p;
+        // SWAR: check and parse 8 digits at once (little endian)
+        inline bool is_eight_digits(U64 val) {
+            return ((val & 0xF0F0F0F0F0F0F0F0) | (((val + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+                   0x3333333333333333;
         }
 
-        //get the digits after decimal point
-        if (*p == '.') {
-            T f = 0.0;
-            std::size_t scale = 1;
-            ++p;
-            while (valid_digit(*p)) {
-                f = (f * 10) + (*p - '0');
-                ++p;
-                scale *= 10;
-            }
-            r += f / static_cast<T>(scale);
-        }
+        inline U32 parse_eight_digits(U64 val) {
+            constexpr U64 mask = 0x000000FF000000FF;
+            constexpr U64 mul1 = 0x000F424000000064; // 100 + (1000000 << 32)
+            constexpr U64 mul2 = 0x0000271000000001; // 1 + (10000 << 32)
 
-        //R_ASSERTF(!read_check, "string '%s' not a number", p);
+            val -= 0x3030303030303030;
+            val  = (val * 10) + (val >> 8);
+            val  = (((val & mask) * mul1) + (((val >> 16) & mask) * mul2)) >> 32;
 
-        // Get the digits after the "e"/"E" (exponenet)
-        if (*p == 'e' || *p == 'E') {
-            std::ptrdiff_t e = 0;
-
-            bool negE = false;
-            ++p;
-            if (*p == '-') { negE = true; ++p; }
-            else if (*p == '+') { negE = false; ++p; }
+            return static_cast<U32>(val);
+        }
 
-            while (valid_digit(*p)) { e = (e * 10) + (*p - '0'); ++p; }
-            //R_ASSERTF(!read_check, "string '%s' not a number", p);
+        // Digits are accumulated with wrapping as by scalar loop
+        inline U64 parse_digits(const char*& p, const char* end) {
+            auto r = U64(0);
 
-            if (!neg && e > std::numeric_limits<T>::max_exponent10) {
-                e = std::numeric_limits<T>::max_exponent10;
+            while (end - p >= 8 && is_eight_digits(read_eight(p))) {
+                r  = r * 100000000 + parse_eight_digits(read_eight(p));
+                p += 8;
             }
-            else if (e < std::numeric_limits<T>::min_exponent10) {
-                e = -std::numeric_limits<T>::min_exponent10;
+
+            while (p != end && valid_digit(*p)) {
+                r = r * 10 + static_cast<U64>(*p - '0');
+                ++p;
             }
 
-            auto scaleE = static_cast<T>(1.0);
-            while (e >= 50) { scaleE *= static_cast<T>(1E50); e -= 50; }
-            while (e > 0) { scaleE *= 10; --e; }
+            return r;
+        }
 
-            if (negE) {
-                r /= scaleE;
+        /**
+         * Correctly rounded (round to nearest even) decimal parsing, Eisel-Lemire algorithm.
+         * Numbers with more than 19 significant digits that can't be rounded by truncated
+         * mantissa fall back to strtod. Leading spaces must be skipped
+         * @param p - moved after parsed number, unchanged if there are no digits
+         */
+        auto parse_float64(const char*& p, const char* end) -> Float64;
+        auto parse_float32(const char*& p, const char* end) -> Float32;
+
+        template <typename T>
+        auto parse_integer(const char*& p, const char* end) -> T {
+            auto start = p;
+            auto neg   = false;
+            if (p != end && *p == '-' && std::is_signed_v<T>) {
+                neg = true;
+                ++p;
             }
-            else {
-                r *= scaleE;
+            else if (p != end && *p == '+') {
+                ++p;
             }
-        }
 
-        if (neg) { r = -r; }
-        return r;
-    }
+            auto digits = p;
+            auto r      = static_cast<T>(parse_digits(p, end));
 
-    template<typename T>
-    auto aton(const char *p) -> std::enable_if_t<std::is_signed_v<T> && std::is_integral_v<T>, T> {
-        while (white_space(*p)) { ++p; }
-
-        auto r = static_cast<T>(0);
+            if (p == digits) {
+                p = start;
+                return 0;
+            }
 
-        bool neg = false;
-        if (*p == '-') {
-            neg = true;
-            ++p;
-        }
-        else if (*p == '+') {
-            neg = false;
-            ++p;
+            return neg ? static_cast<T>(-r) : r;
         }
 
-        while (valid_digit(*p)) {
-            r = (r * 10) + (*p - '0');
-            ++p;
+        template <typename T>
+        auto parse(const char*& p, const char* end) -> T {
+            if constexpr (std::is_same_v<T, Float32>)
+                return parse_float32(p, end);
+            else if constexpr (std::is_floating_point_v<T>)
+                return static_cast<T>(parse_float64(p, end));
+            else
+                return parse_integer<T>(p, end);
         }
-
-        if (neg) { r = -r; }
-        return r;
     }
 
-    template<typename T>
-    auto aton(const char *p) -> std::enable_if_t<std::is_unsigned_v<T>, T> {
-        while (white_space(*p)) { ++p; }
-
-        auto r = static_cast<T>(0);
+    /**
+     * Parse number at the start of string, leading spaces are skipped.
+     * Floats are correctly rounded
+     */
+    template <typename T>
+    auto aton(std::string_view str) -> std::enable_if_t<std::is_arithmetic_v<T>, T> {
+        auto p   = str.data();
+        auto end = str.data() + str.size();
 
-        if (*p == '+') { ++p; }
+        while (p != end && white_space(*p)) { ++p; }
 
-        while (valid_digit(*p)) {
-            r = (r * 10) + (*p - '0');
-            ++p;
-        }
+        return aton_dtls::parse<T>(p, end);
+    }
 
-        return r;
+    template<typename T>
+    auto aton(const char *p) -> std::enable_if_t<std::is_arithmetic_v<T>, T> {
+        return aton<T>(std::string_view(p));
     }
 
     template <typename T>
     inline auto aton(const char* p, T& value) {
         value = aton<T>(p);
     }
+
+    /**
+     * Parse numbers separated by spaces, tabs and line breaks
+     * @return count of parsed numbers. Parsing stops at first invalid number or when output is full
+     */
+    template <typename T>
+    auto aton_array(std::string_view str, T* out, SizeT capacity) -> SizeT {
+        auto p     = str.data();
+        auto end   = str.data() + str.size();
+        auto count = SizeT(0);
+
+        auto is_separator = [](char c) { return white_space(c) || c == '\n' || c == '\r'; };
+
+        while (count < capacity) {
+            while (p != end && is_separator(*p)) { ++p; }
+
+            if (p == end)
+                break;
+
+            auto start = p;
+            auto value = aton_dtls::parse<T>(p, end);
+
+            if (p == start || (p != end && !is_separator(*p)))
+                break;
+
+            out[count++] = value;
+        }
+
+        return count;
+    }
 }
 
 #undef white_space
@@ -1,6 +1,7 @@
 #ifndef TILEENGINE_BASETYPES_HPP
 #define TILEENGINE_BASETYPES_HPP
 
+#include <cstddef>
 #include <cstdint>
 
 #if __GNUC__ == 8 && (__GNUC_MINOR__ < 3) && __GNUC__ != 9 || defined(__clang__)
@@ -0,0 +1,293 @@
+#include "binary_log.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+#include <fmt/format.h>
+
+#include "files.hpp"
+
+namespace {
+    struct Registry {
+        std::mutex                     mutex;
+        std::deque<base::blog::Format> formats; // Index is id - 1
+    };
+
+    // Never destroyed: logger thread formats messages left in queue at exit
+    Registry& registry() {
+        static auto inst = new Registry();
+        return *inst;
+    }
+
+    template <typename T>
+    void append(std::string& out, T value) {
+        Byte buf[sizeof(T)];
+        srlz::_serialize_tmpl(buf, value);
+        out.append(reinterpret_cast<const char*>(buf), sizeof(T));
+    }
+
+    void append(std::string& out, std::string_view str) {
+        out.append(str.data(), str.size());
+    }
+
+    class Reader {
+    public:
+        Reader(const Byte* data, SizeT size): _ptr(data), _end(data + size) {}
+
+        template <typename T>
+        bool read(T& value) {
+            if (static_cast<SizeT>(_end - _ptr) < sizeof(T))
+                return false;
+
+            srlz::_deserialize_tmpl(value, _ptr);
+            _ptr += sizeof(T);
+            return true;
+        }
+
+        bool read(std::string_view& str, SizeT size) {
+            if (static_cast<SizeT>(_end - _ptr) < size)
+                return false;
+
+            str = std::string_view(reinterpret_cast<const char*>(_ptr), size);
+            _ptr += size;
+            return true;
+        }
+
+        bool empty() const { return _ptr == _end; }
+
+    private:
+        const Byte* _ptr;
+        const Byte* _end;
+    };
+
+    using FormatArg = fmt::basic_format_arg<fmt::format_context>;
+
+    // Packs one value into type-erased argument, available in every fmt version since 5
+    template <typename T>
+    FormatArg to_format_arg(const T& value) {
+        return fmt::basic_format_args<fmt::format_context>(fmt::make_format_args(value)).get(0);
+    }
+
+    template <typename T>
+    bool pushArg(Reader& reader, std::vector<FormatArg>& args) {
+        auto value = T();
+        if (!reader.read(value))
+            return false;
+
+        args.push_back(to_format_arg(value));
+        return true;
+    }
+}
+
+
+auto base::blog::register_format(const char* format, const char* file, U32 line, std::vector<ArgType> types) -> U32 {
+    auto& reg  = registry();
+    auto  lock = std::lock_guard(reg.mutex);
+
+    reg.formats.push_back(Format{ftl::String(std::string_view(format)), ftl::String(std::string_view(file)),
+                                 line, std::move(types)});
+    return static_cast<U32>(reg.formats.size());
+}
+
+auto base::blog::format_info(U32 id) -> const Format& {
+    auto& reg  = registry();
+    auto  lock = std::lock_guard(reg.mutex);
+
+    return reg.formats[id - 1];
+}
+
+auto base::blog::format_message(const Format& format, const Byte* args, SizeT size) -> std::optional<std::string> {
+    auto reader = Reader(args, size);
+    auto store  = std::vector<FormatArg>();
+    auto valid  = true;
+
+    for (auto type : format.types) {
+        switch (type) {
+            case ArgType::Bool: {
+                auto value = U8();
+                valid = reader.read(value);
+                store.push_back(to_format_arg(value != 0));
+            } break;
+            case ArgType::Char:    valid = pushArg<char>   (reader, store); break;
+            case ArgType::Int8:    valid = pushArg<S8>     (reader, store); break;
+            case ArgType::Int16:   valid = pushArg<S16>    (reader, store); break;
+            case ArgType::Int32:   valid = pushArg<S32>    (reader, store); break;
+            case ArgType::Int64:   valid = pushArg<S64>    (reader, store); break;
+            case ArgType::UInt8:   valid = pushArg<U8>     (reader, store); break;
+            case ArgType::UInt16:  valid = pushArg<U16>    (reader, store); break;
+            case ArgType::UInt32:  valid = pushArg<U32>    (reader, store); break;
+            case ArgType::UInt64:  valid = pushArg<U64>    (reader, store); break;
+            case ArgType::Float32: valid = pushArg<Float32>(reader, store); break;
+            case ArgType::Float64: valid = pushArg<Float64>(reader, store); break;
+            case ArgType::String: {
+                auto length = U32();
+                auto str    = std::string_view();
+                valid = reader.read(length) && reader.read(str, length);
+                store.push_back(to_format_arg(fmt::string_view(str.data(), str.size())));
+            } break;
+            default:
+                valid = false;
+        }
+
+        if (!valid)
+            return std::nullopt;
+    }
+
+    if (!reader.empty())
+        return std::nullopt;
+
+    try {
+        // Arguments are unpacked, string arguments point into args
+        auto store_args = fmt::basic_format_args<fmt::format_context>(store.data(), static_cast<int>(store.size()));
+        return fmt::vformat(fmt::string_view(format.format.data(), format.format.size()), store_args);
+    }
+    catch (const fmt::format_error&) {
+        return std::nullopt;
+    }
+}
+
+
+////////////////////////////////// Binary log file
+
+void base::blog::write_header(std::string& out) {
+    append(out, FILE_MAGIC);
+    append(out, FILE_VERSION);
+}
+
+void base::blog::write_format_chunk(std::string& out, U32 id, const Format& format) {
+    append(out, static_cast<U8>(Chunk::Format));
+    append(out, id);
+    append(out, format.line);
+    append(out, static_cast<U16>(format.file.size()));
+    append(out, std::string_view(format.file.data(), format.file.size()));
+    append(out, static_cast<U16>(format.format.size()));
+    append(out, std::string_view(format.format.data(), format.format.size()));
+    append(out, static_cast<U8>(format.types.size()));
+
+    for (auto type : format.types)
+        append(out, static_cast<U8>(type));
+}
+
+void base::blog::write_message_chunk(std::string& out, S64 time, LogLevel level, LogCategory category,
+                                     U32 id, const Byte* args, SizeT size) {
+    append(out, static_cast<U8>(Chunk::Message));
+    append(out, time);
+    append(out, static_cast<U8>(level));
+    append(out, static_cast<U8>(category));
+    append(out, id);
+    append(out, static_cast<U32>(size));
+    append(out, std::string_view(reinterpret_cast<const char*>(args), size));
+}
+
+void base::blog::write_text_chunk(std::string& out, S64 time, LogLevel level, LogCategory category,
+                                  std::string_view text) {
+    append(out, static_cast<U8>(Chunk::Text));
+    append(out, time);
+    append(out, static_cast<U8>(level));
+    append(out, static_cast<U8>(category));
+    append(out, static_cast<U32>(text.size()));
+    append(out, text);
+}
+
+bool base::blog::read_log(const std::string_view& path, const ReadCallback& callback) {
+    auto file = MappedFile::openOpt(path, MappedFile::Access::Sequential);
+    if (!file)
+        return false;
+
+    auto reader  = Reader(file->data(), file->size());
+    auto magic   = U32();
+    auto version = U32();
+
+    if (!reader.read(magic) || !reader.read(version) || magic != FILE_MAGIC || version != FILE_VERSION)
+        return false;
+
+    auto formats = std::unordered_map<U32, Format>();
+
+    auto to_time = [](S64 time) {
+        return std::chrono::system_clock::time_point(
+                std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(time)));
+    };
+
+    auto read_tags = [&reader](LogLevel& level, LogCategory& category) {
+        auto lvl = U8();
+        auto cat = U8();
+        if (!reader.read(lvl) || !reader.read(cat) ||
+            lvl > static_cast<U8>(LogLevel::Off) || cat >= static_cast<U8>(LogCategory::Count))
+            return false;
+
+        level    = static_cast<LogLevel>(lvl);
+        category = static_cast<LogCategory>(cat);
+        return true;
+    };
+
+    while (!reader.empty()) {
+        auto kind = U8();
+        reader.read(kind);
+
+        if (kind == static_cast<U8>(Chunk::Format)) {
+            auto id        = U32();
+            auto format    = Format();
+            auto file_size = U16();
+            auto fmt_size  = U16();
+            auto argc      = U8();
+            auto file_name = std::string_view();
+            auto fmt_str   = std::string_view();
+
+            if (!reader.read(id) || !reader.read(format.line) ||
+                !reader.read(file_size) || !reader.read(file_name, file_size) ||
+                !reader.read(fmt_size) || !reader.read(fmt_str, fmt_size) || !reader.read(argc))
+                return false;
+
+            format.file   = ftl::String(file_name);
+            format.format = ftl::String(fmt_str);
+
+            for (U8 i = 0; i < argc; ++i) {
+                auto type = U8();
+                if (!reader.read(type))
+                    return false;
+                format.types.push_back(static_cast<ArgType>(type));
+            }
+
+            formats[id] = std::move(format);
+        }
+        else if (kind == static_cast<U8>(Chunk::Message)) {
+            auto time     = S64();
+            auto level    = LogLevel();
+            auto category = LogCategory();
+            auto id       = U32();
+            auto size     = U32();
+            auto args     = std::string_view();
+
+            if (!reader.read(time) || !read_tags(level, category) ||
+                !reader.read(id) || !reader.read(size) || !reader.read(args, size))
+                return false;
+
+            auto format = formats.find(id);
+            if (format == formats.end())
+                return false;
+
+            auto text = format_message(format->second, reinterpret_cast<const Byte*>(args.data()), args.size());
+            if (!text)
+                return false;
+
+            callback(to_time(time), level, category, *text);
+        }
+        else if (kind == static_cast<U8>(Chunk::Text)) {
+            auto time     = S64();
+            auto level    = LogLevel();
+            auto category = LogCategory();
+            auto size     = U32();
+            auto text     = std::string_view();
+
+            if (!reader.read(time) || !read_tags(level, category) || !reader.read(size) || !reader.read(text, size))
+                return false;
+
+            callback(to_time(time), level, category, text);
+        }
+        else
+            return false;
+    }
+
+    return true;
+}
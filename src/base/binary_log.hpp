@@ -0,0 +1,149 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "log_levels.hpp"
+#include "serialization.hpp"
+#include "ftl/string.hpp"
+
+/**
+ * Deferred log formatting
+ *
+ * Call site registers its format string and argument types once and gets format id.
+ * Log call stores only the id and raw arguments, formatting is done by logger thread
+ * or by LogDecoder tool for binary log files.
+ *
+ * Binary log file: header (magic, version), then chunks:
+ *   Format  - U8 kind, U32 id, U32 line, U16 file size, file, U16 format size, format, U8 argc, argc types
+ *   Message - U8 kind, S64 time (ns since epoch), U8 level, U8 category, U32 format id, U32 args size, args
+ *   Text    - U8 kind, S64 time, U8 level, U8 category, U32 text size, text
+ * Integers and floats are stored by srlz, strings are U32 size + bytes
+ */
+namespace base::blog {
+
+    constexpr U32 FILE_MAGIC   = 0x474c4244; // "DBLG"
+    constexpr U32 FILE_VERSION = 2;
+
+    enum class Chunk : U8 {
+        Format = 1, Message, Text
+    };
+
+    enum class ArgType : U8 {
+        Bool = 1, Char,
+        Int8, Int16, Int32, Int64,
+        UInt8, UInt16, UInt32, UInt64,
+        Float32, Float64,
+        String
+    };
+
+    struct Format {
+        ftl::String          format;
+        ftl::String          file;
+        U32                  line = 0;
+        std::vector<ArgType> types;
+    };
+
+    template <typename T>
+    constexpr bool is_string_arg =
+            std::is_same_v<T, const char*> || std::is_same_v<T, char*> || std::is_same_v<T, std::string> ||
+            std::is_same_v<T, std::string_view> || std::is_same_v<T, ftl::String>;
+
+    template <typename T>
+    constexpr ArgType arg_type() {
+        using Tp = std::decay_t<T>;
+
+        if constexpr (std::is_same_v<Tp, bool>)
+            return ArgType::Bool;
+        else if constexpr (std::is_same_v<Tp, char>)
+            return ArgType::Char;
+        else if constexpr (std::is_integral_v<Tp> && std::is_signed_v<Tp>)
+            return sizeof(Tp) == 1 ? ArgType::Int8 : sizeof(Tp) == 2 ? ArgType::Int16 :
+                   sizeof(Tp) == 4 ? ArgType::Int32 : ArgType::Int64;
+        else if constexpr (std::is_integral_v<Tp>)
+            return sizeof(Tp) == 1 ? ArgType::UInt8 : sizeof(Tp) == 2 ? ArgType::UInt16 :
+                   sizeof(Tp) == 4 ? ArgType::UInt32 : ArgType::UInt64;
+        else if constexpr (std::is_same_v<Tp, float>)
+            return ArgType::Float32;
+        else if constexpr (std::is_same_v<Tp, double>)
+            return ArgType::Float64;
+        else {
+            static_assert(is_string_arg<Tp>, "Unsupported deferred log argument type");
+            return ArgType::String;
+        }
+    }
+
+    inline auto string_arg(const char* str)          { return std::string_view(str); }
+    inline auto string_arg(const std::string& str)   { return std::string_view(str); }
+    inline auto string_arg(std::string_view str)     { return str; }
+    inline auto string_arg(const ftl::String& str)   { return std::string_view(str.data(), str.size()); }
+
+    template <typename T>
+    SizeT arg_size(const T& value) {
+        using Tp = std::decay_t<T>;
+
+        if constexpr (is_string_arg<Tp>)
+            return sizeof(U32) + string_arg(value).size();
+        else
+            return sizeof(Tp);
+    }
+
+    template <typename T>
+    Byte* encode_arg(Byte* out, const T& value) {
+        using Tp = std::decay_t<T>;
+
+        if constexpr (is_string_arg<Tp>) {
+            auto str = string_arg(value);
+            srlz::_serialize_tmpl(out, static_cast<U32>(str.size()));
+            std::memcpy(out + sizeof(U32), str.data(), str.size());
+            return out + sizeof(U32) + str.size();
+        }
+        else if constexpr (std::is_same_v<Tp, bool>) {
+            *out = Byte(value ? 1 : 0);
+            return out + 1;
+        }
+        else {
+            srlz::_serialize_tmpl(out, value);
+            return out + sizeof(Tp);
+        }
+    }
+
+    /**
+     * Register call site format. Thread safe
+     * @return format id, never 0
+     */
+    auto register_format(const char* format, const char* file, U32 line, std::vector<ArgType> types) -> U32;
+
+    /**
+     * Registered format, format id must be valid. Returned reference is stable
+     */
+    auto format_info(U32 id) -> const Format&;
+
+    /**
+     * Decode arguments and format message
+     * @return nullopt if arguments don't match format types
+     */
+    auto format_message(const Format& format, const Byte* args, SizeT size) -> std::optional<std::string>;
+
+    void write_header        (std::string& out);
+    void write_format_chunk  (std::string& out, U32 id, const Format& format);
+    void write_message_chunk (std::string& out, S64 time, LogLevel level, LogCategory category,
+                              U32 id, const Byte* args, SizeT size);
+    void write_text_chunk    (std::string& out, S64 time, LogLevel level, LogCategory category, std::string_view text);
+
+    using ReadCallback = std::function<void(std::chrono::system_clock::time_point, LogLevel, LogCategory, std::string_view)>;
+
+    /**
+     * Read binary log file, callback is called for each message in order
+     * @return false if file can't be read or is corrupted. Messages before corrupted chunk are passed
+     */
+    bool read_log(const std::string_view& path, const ReadCallback& callback);
+
+} // namespace base::blog
@@ -0,0 +1,164 @@
+#include "compression.hpp"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+namespace {
+    constexpr SizeT MIN_MATCH     = 4;
+    constexpr SizeT LAST_LITERALS = 5;  // Last bytes of block are always literals
+    constexpr SizeT MF_LIMIT      = 12; // Last match must start before this distance from the end
+    constexpr SizeT MAX_OFFSET    = 65535;
+    constexpr U32   HASH_LOG      = 12;
+    constexpr U32   NO_POS        = std::numeric_limits<U32>::max();
+
+    inline U32 read32(const U8* p) {
+        U32 v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline U32 hash32(U32 v) {
+        return (v * 2654435761U) >> (32 - HASH_LOG);
+    }
+
+    inline U8* writeLength(U8* p, SizeT length) {
+        for (; length >= 255; length -= 255)
+            *p++ = 255;
+        *p++ = static_cast<U8>(length);
+        return p;
+    }
+
+    inline U8* writeLiterals(U8* p, U8* token, const U8* literals, SizeT count) {
+        if (count >= 15) {
+            *token = 15 << 4;
+            p = writeLength(p, count - 15);
+        } else
+            *token = static_cast<U8>(count << 4);
+
+        if (count)
+            std::memcpy(p, literals, count);
+        return p + count;
+    }
+
+    inline bool readLength(const U8*& ip, const U8* iend, SizeT& length) {
+        U8 b;
+        do {
+            if (ip == iend)
+                return false;
+            b = *ip++;
+            length += b;
+        } while (b == 255);
+
+        return true;
+    }
+}
+
+auto base::lz4::compress(const Byte* src, SizeT size) -> ftl::Vector<Byte> {
+    auto result = ftl::Vector<Byte>(compress_bound(size));
+    auto table  = std::array<U32, 1U << HASH_LOG>();
+    table.fill(NO_POS);
+
+    auto in     = reinterpret_cast<const U8*>(src);
+    auto op     = reinterpret_cast<U8*>(result.data());
+    auto anchor = SizeT(0);
+
+    if (size > MF_LIMIT) {
+        auto match_limit = size - LAST_LITERALS;
+
+        for (SizeT ip = 0; ip < size - MF_LIMIT;) {
+            auto seq = read32(in + ip);
+            auto h   = hash32(seq);
+            auto ref = table[h];
+            table[h] = static_cast<U32>(ip);
+
+            if (ref == NO_POS || ip - ref > MAX_OFFSET || read32(in + ref) != seq) {
+                ++ip;
+                continue;
+            }
+
+            auto length = MIN_MATCH;
+            while (ip + length < match_limit && in[ref + length] == in[ip + length])
+                ++length;
+
+            auto token = op++;
+            op = writeLiterals(op, token, in + anchor, ip - anchor);
+
+            auto offset = static_cast<U16>(ip - ref);
+            *op++ = static_cast<U8>(offset);
+            *op++ = static_cast<U8>(offset >> 8);
+
+            if (length - MIN_MATCH >= 15) {
+                *token |= 15;
+                op = writeLength(op, length - MIN_MATCH - 15);
+            } else
+                *token |= static_cast<U8>(length - MIN_MATCH);
+
+            ip    += length;
+            anchor = ip;
+        }
+    }
+
+    auto token = op++;
+    op = writeLiterals(op, token, in + anchor, size - anchor);
+
+    result.resize(static_cast<SizeT>(op - reinterpret_cast<U8*>(result.data())));
+    return result;
+}
+
+bool base::lz4::decompress(const Byte* src, SizeT src_size, Byte* dst, SizeT dst_size) {
+    auto ip     = reinterpret_cast<const U8*>(src);
+    auto iend   = ip + src_size;
+    auto op     = reinterpret_cast<U8*>(dst);
+    auto ostart = op;
+    auto oend   = op + dst_size;
+
+    while (ip != iend) {
+        auto token    = *ip++;
+        auto literals = SizeT(token >> 4);
+
+        if (literals == 15 && !readLength(ip, iend, literals))
+            return false;
+
+        if (literals > SizeT(iend - ip) || literals > SizeT(oend - op))
+            return false;
+
+        if (literals)
+            std::memcpy(op, ip, literals);
+        ip += literals;
+        op += literals;
+
+        // Last sequence has no match
+        if (ip == iend)
+            break;
+
+        if (iend - ip < 2)
+            return false;
+
+        auto offset = SizeT(ip[0]) | SizeT(ip[1]) << 8;
+        ip += 2;
+
+        if (offset == 0 || offset > SizeT(op - ostart))
+            return false;
+
+        auto length = SizeT(token & 15);
+        if (length == 15 && !readLength(ip, iend, length))
+            return false;
+        length += MIN_MATCH;
+
+        if (length > SizeT(oend - op))
+            return false;
+
+        // Match may overlap with output
+        auto match = op - offset;
+        if (offset >= length)
+            std::memcpy(op, match, length);
+        else
+            for (SizeT i = 0; i < length; ++i)
+                op[i] = match[i];
+
+        op += length;
+    }
+
+    return op == oend;
+}
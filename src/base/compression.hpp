@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+
+#include "baseTypes.hpp"
+#include "ftl/vector.hpp"
+
+/**
+ * LZ4 block format codec
+ *
+ * Greedy single-pass compressor with 4K hash table. Output is compatible with LZ4_decompress_safe,
+ * so archives may be produced by any LZ4 block compressor
+ */
+namespace base::lz4 {
+
+    constexpr SizeT compress_bound(SizeT size) {
+        return size + size / 255 + 16;
+    }
+
+    auto compress(const Byte* src, SizeT size) -> ftl::Vector<Byte>;
+
+    /**
+     * Decompress block with bounds checking
+     * @param dst_size - exact size of decompressed data
+     * @return false if block is corrupted or does not decompress to dst_size bytes
+     */
+    bool decompress(const Byte* src, SizeT src_size, Byte* dst, SizeT dst_size);
+
+} // namespace base::lz4
@@ -0,0 +1,237 @@
+#include "config_cache.hpp"
+
+#include <cstdio>
+#include <string>
+#include <sys/stat.h>
+
+#include <xxhash.h>
+
+#include "files.hpp"
+#include "vfs.hpp"
+
+namespace {
+    using namespace base::cfg_detls;
+
+    struct FileStat {
+        S64 mtime = 0;
+        U64 size  = 0;
+    };
+
+    auto file_stat(StringCref path) -> std::optional<FileStat> {
+        struct stat st = {};
+        if (stat(path.c_str(), &st) != 0)
+            return std::nullopt;
+
+        return FileStat{S64(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec, static_cast<U64>(st.st_size)};
+    }
+
+    bool is_source_changed(const CfgCacheSource& source, StringCref path) {
+        auto st = file_stat(path);
+        if (!st || st->size != source.size)
+            return true;
+
+        if (st->mtime == source.mtime)
+            return false;
+
+        // Touched, but it may be not changed
+        auto file = base::vfs().open(std::string_view(path.data(), path.size()));
+        return !file || file->size() != source.size || XXH64(file->data(), file->size(), 0) != source.hash;
+    }
+
+    template <typename T>
+    void append(std::string& out, const T* data, SizeT count) {
+        out.append(reinterpret_cast<const char*>(data), sizeof(T) * count);
+    }
+
+    template <typename T>
+    void append(std::string& out, const std::vector<T>& table) {
+        append(out, table.data(), table.size());
+    }
+
+    class Block {
+    public:
+        auto add(StrViewCref str) {
+            auto offset = static_cast<U32>(_data.size());
+            _data.append(str);
+            return offset;
+        }
+
+        auto& data() const { return _data; }
+
+    private:
+        std::string _data;
+    };
+}
+
+
+auto base::cfg_detls::CfgCache::read(StringCref path, const StrVector& entries, StrVector& sources)
+        -> std::shared_ptr<CfgData>
+{
+    auto file = vfs().open(std::string_view(path.data(), path.size()));
+    if (!file || file->size() < sizeof(CfgCacheHeader))
+        return nullptr;
+
+    auto data   = reinterpret_cast<const char*>(file->data());
+    auto header = reinterpret_cast<const CfgCacheHeader*>(data);
+
+    if (header->magic != CfgCacheHeader::MAGIC || header->version != CfgCacheHeader::VERSION ||
+        header->entries_count != entries.size())
+        return nullptr;
+
+    auto tablesSize = sizeof(CfgCacheHeader) +
+                      sizeof(CfgCacheSource)  * SizeT(header->sources_count) +
+                      sizeof(CfgCacheString)  * (SizeT(header->entries_count) + header->strings_count) +
+                      sizeof(CfgCacheSection) * SizeT(header->sections_count) +
+                      sizeof(U32)             * SizeT(header->parents_count) +
+                      sizeof(CfgCacheValue)   * SizeT(header->values_count);
+
+    if (tablesSize + header->block_size != file->size())
+        return nullptr;
+
+    auto srcs     = reinterpret_cast<const CfgCacheSource*>(data + sizeof(CfgCacheHeader));
+    auto ents     = reinterpret_cast<const CfgCacheString*>(srcs + header->sources_count);
+    auto strings  = ents + header->entries_count;
+    auto sections = reinterpret_cast<const CfgCacheSection*>(strings + header->strings_count);
+    auto parents  = reinterpret_cast<const U32*>(sections + header->sections_count);
+    auto values   = reinterpret_cast<const CfgCacheValue*>(parents + header->parents_count);
+    auto block    = data + tablesSize;
+
+    auto blockView = [&](U32 offset, U32 size) -> std::optional<StrView> {
+        if (U64(offset) + size > header->block_size)
+            return std::nullopt;
+        return StrView(block + offset, size);
+    };
+
+    for (U32 i = 0; i < header->entries_count; ++i) {
+        auto entry = blockView(ents[i].offset, ents[i].size);
+        if (!entry || *entry != StrView(entries[i].data(), entries[i].size()))
+            return nullptr;
+    }
+
+    auto paths = StrVector();
+    for (U32 i = 0; i < header->sources_count; ++i) {
+        auto source = blockView(srcs[i].offset, srcs[i].length);
+        if (!source)
+            return nullptr;
+
+        paths.emplace_back(*source);
+        if (is_source_changed(srcs[i], paths.back()))
+            return nullptr;
+    }
+
+    // Tables are rebuilt from views to cache with stored hashes, nothing is parsed
+    auto result = std::make_shared<CfgData>();
+    result->_pool.reserve(header->strings_count);
+    result->_sections.reserve(header->sections_count);
+    result->_sectionIndex.reserve(header->sections_count);
+    result->_values.reserve(header->values_count);
+
+    for (U32 i = 0; i < header->strings_count; ++i) {
+        auto str = blockView(strings[i].offset, strings[i].size);
+        if (!str || result->_pool.intern(*str, strings[i].hash) != i + 1)
+            return nullptr;
+    }
+
+    auto validId = [&](U32 id) { return id != 0 && id <= header->strings_count; };
+
+    for (U32 i = 0; i < header->sections_count; ++i) {
+        auto& sect = sections[i];
+        if (!validId(sect.name) || U64(sect.parents_offset) + sect.parents_count > header->parents_count)
+            return nullptr;
+
+        auto& added = result->_sections.emplace_back(Section{sect.name, i, {}});
+        for (U32 j = 0; j < sect.parents_count; ++j) {
+            auto parent = parents[sect.parents_offset + j];
+            if (!validId(parent))
+                return nullptr;
+            added.parents.push_back(parent);
+        }
+
+        if (!result->_sectionIndex.insert(sect.name, result->_pool.hash(sect.name), i).second)
+            return nullptr;
+    }
+
+    for (U32 i = 0; i < header->values_count; ++i) {
+        auto& value = values[i];
+        auto  str   = blockView(value.offset, value.size);
+        if (!str || value.section >= header->sections_count || !validId(value.key) ||
+            !result->addValue(value.section, value.key, *str))
+            return nullptr;
+    }
+
+    for (auto& sect : result->_sections)
+        for (auto parent : sect.parents)
+            if (!result->_sectionIndex.find(parent, result->_pool.hash(parent)))
+                return nullptr;
+
+    result->_cache = std::move(*file);
+    sources = std::move(paths);
+
+    return result;
+}
+
+void base::cfg_detls::CfgCache::write(StringCref path, const CfgData& data, const StrVector& entries,
+                                      const FileCache& files) {
+    auto header   = CfgCacheHeader();
+    auto block    = Block();
+    auto srcs     = std::vector<CfgCacheSource>();
+    auto ents     = std::vector<CfgCacheString>();
+    auto strings  = std::vector<CfgCacheString>();
+    auto sections = std::vector<CfgCacheSection>();
+    auto parents  = std::vector<U32>();
+    auto values   = std::vector<CfgCacheValue>();
+
+    for (auto& [source, file] : files) {
+        auto st = file_stat(source);
+        if (!st || st->size != file->file.size())
+            return;
+
+        auto str = StrView(source.data(), source.size());
+        srcs.push_back(CfgCacheSource{st->mtime, st->size, XXH64(file->file.data(), file->file.size(), 0),
+                                      block.add(str), static_cast<U32>(str.size())});
+    }
+
+    for (auto& entry : entries) {
+        auto str = StrView(entry.data(), entry.size());
+        ents.push_back(CfgCacheString{0, block.add(str), static_cast<U32>(str.size())});
+    }
+
+    for (U32 id = 1; id < data._pool.size(); ++id) {
+        auto str = data._pool.str(id);
+        strings.push_back(CfgCacheString{data._pool.hash(id), block.add(str), static_cast<U32>(str.size())});
+    }
+
+    for (auto& sect : data._sections) {
+        sections.push_back(CfgCacheSection{sect.name, static_cast<U32>(parents.size()),
+                                           static_cast<U32>(sect.parents.size()), 0});
+        parents.insert(parents.end(), sect.parents.begin(), sect.parents.end());
+    }
+
+    data._values.forEach([&](U64 key, StrView value) {
+        values.push_back(CfgCacheValue{static_cast<U32>(key >> 32), static_cast<U32>(key),
+                                       block.add(value), static_cast<U32>(value.size())});
+    });
+
+    header.sources_count  = static_cast<U32>(srcs.size());
+    header.entries_count  = static_cast<U32>(ents.size());
+    header.strings_count  = static_cast<U32>(strings.size());
+    header.sections_count = static_cast<U32>(sections.size());
+    header.parents_count  = static_cast<U32>(parents.size());
+    header.values_count   = static_cast<U32>(values.size());
+    header.block_size     = block.data().size();
+
+    auto out = std::string();
+    append(out, &header, 1);
+    append(out, srcs);
+    append(out, ents);
+    append(out, strings);
+    append(out, sections);
+    append(out, parents);
+    append(out, values);
+    out.append(block.data());
+
+    // Current snapshot may be mapped from old cache, so it's replaced, not rewritten
+    auto tmp = path + ".tmp";
+    writeBytesToFile(tmp, reinterpret_cast<const Byte*>(out.data()), out.size());
+    std::rename(tmp.c_str(), path.c_str());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "configs.hpp"
+
+namespace base::cfg_detls {
+
+    /**
+     * Compiled configs cache (.dcfg)
+     *
+     * CfgCacheHeader, then tables: sources, entries, strings, sections, parents, values and strings block.
+     * Strings are interned names with their hashes, id of string is its index + 1. Values are final:
+     * unquoted and dereferenced, parents are resolved on lookup as in parsed snapshot.
+     * Everything is stored in native byte order, snapshot loaded from cache keeps views to mapped file.
+     *
+     * Cache is valid for the same entries if no source file is changed: size and mtime are compared
+     * first, if only mtime is different xxhash64 of file content is compared
+     */
+    struct CfgCacheHeader {
+        static constexpr U32 MAGIC   = 0x47464344; // "DCFG"
+        static constexpr U32 VERSION = 1;
+
+        U32 magic          = MAGIC;
+        U32 version        = VERSION;
+        U32 sources_count  = 0;
+        U32 entries_count  = 0;
+        U32 strings_count  = 0;
+        U32 sections_count = 0;
+        U32 parents_count  = 0;
+        U32 values_count   = 0;
+        U64 block_size     = 0;
+    };
+
+    struct CfgCacheString {
+        U64 hash   = 0;
+        U32 offset = 0; // From the start of strings block
+        U32 size   = 0;
+    };
+
+    struct CfgCacheSource {
+        S64 mtime  = 0; // Nanoseconds
+        U64 size   = 0;
+        U64 hash   = 0; // xxhash64 of content
+        U32 offset = 0; // Path
+        U32 length = 0;
+    };
+
+    struct CfgCacheSection {
+        U32 name           = 0; // String id
+        U32 parents_offset = 0; // From the start of parents table
+        U32 parents_count  = 0;
+        U32 reserved       = 0;
+    };
+
+    struct CfgCacheValue {
+        U32 section = 0; // Section index
+        U32 key     = 0; // String id
+        U32 offset  = 0; // From the start of strings block
+        U32 size    = 0;
+    };
+
+    class CfgCache {
+    public:
+        /**
+         * Load snapshot from cache
+         * @param sources - filled by all source files of snapshot
+         * @return nullptr if cache not exists, corrupted or outdated
+         */
+        static auto read(StringCref path, const StrVector& entries, StrVector& sources) -> std::shared_ptr<CfgData>;
+
+        /**
+         * Write snapshot parsed from files. Cache isn't written if any file can't be found on disk
+         * (packed to archive) or it is changed since parsing
+         */
+        static void write(StringCref path, const CfgData& data, const StrVector& entries, const FileCache& files);
+    };
+
+} // namespace base::cfg_detls
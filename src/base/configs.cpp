@@ -1,213 +1,346 @@
 #include "configs.hpp"
+
+#include <array>
+#include <stdexcept>
+#include <utility>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <xxhash.h>
+
 #include "assert.hpp"
+#include "allocators/Arena.hpp"
+#include "config_cache.hpp"
+#include "vfs.hpp"
+#include "ftl/string_scan.hpp"
+
+namespace {
+    inline U64 str_hash(std::string_view str) {
+        return XXH64(str.data(), str.size(), 0);
+    }
+
+    inline U64 value_hash(U64 section_hash, U64 key_hash) {
+        return key_hash ^ (section_hash + 0x9e3779b97f4a7c15ULL + (key_hash << 6) + (key_hash >> 2));
+    }
+
+    inline U64 value_key(U32 section, U32 key) {
+        return (U64(section) << 32) | key;
+    }
+
+    // Set while configs are reloaded: parse errors are thrown and previous configs are kept
+    thread_local bool t_recoverable_errors = false;
+
+    struct CfgParseError : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    class RecoverableErrorsScope {
+    public:
+        explicit RecoverableErrorsScope(bool enable): _previous(std::exchange(t_recoverable_errors, enable)) {}
+        ~RecoverableErrorsScope() { t_recoverable_errors = _previous; }
+
+    private:
+        bool _previous;
+    };
+}
+
+// Parse error: fatal on startup, CfgParseError on reload
+#define CFG_ASSERTF(EXPR, FMT, ...)                                                                    \
+    do {                                                                                               \
+        auto cfg_ok_ = static_cast<bool>(EXPR);                                                        \
+        if (!cfg_ok_ && t_recoverable_errors)                                                          \
+            throw CfgParseError(fmt::format(FMT, __VA_ARGS__));                                        \
+        ::details::assert_impl(cfg_ok_, __FILE__, __FUNCTION__, __LINE__, #EXPR, FMT, __VA_ARGS__);    \
+    } while (false)
 
 namespace base::cfg_detls {
-    auto Section::getValue(StringCref key) const -> StringCref {
-        auto val = _pairs.find(key);
-        RASSERTF(val != _pairs.end(), "Can't find key '{}' in section [{}]", key, _name);
-        return val->second;
-    }
-    auto Section::getValue(StringCref key) -> StringRef {
-        auto val = _pairs.find(key);
-        RASSERTF(val != _pairs.end(), "Can't find key '{}' in section [{}]", key, _name);
-        return val->second;
-    }
-    auto Section::value(StringCref key) -> StringRef {
-        return _pairs[key];
-    }
-    auto Section::valueOpt(StringCref key) const -> std::optional<String> {
-        auto val = _pairs.find(key);
-        if (val == _pairs.end())
+    ////////////////////////////////// StringArena
+
+    auto StringArena::store(StrViewCref str) -> StrView {
+        if (str.empty())
             return {};
-        else
-            return val->second;
+
+        // Big strings get their own block, current block stays last
+        if (str.size() > BLOCK_SIZE / 4) {
+            auto block = std::make_unique<char[]>(str.size());
+            auto ptr   = block.get();
+            std::memcpy(ptr, str.data(), str.size());
+
+            _blocks.push_back(std::move(block));
+            if (_blocks.size() > 1)
+                std::swap(_blocks.back(), _blocks[_blocks.size() - 2]);
+
+            _size += str.size();
+            return StrView(ptr, str.size());
+        }
+
+        if (_blockUsed + str.size() > BLOCK_SIZE) {
+            _blocks.push_back(std::make_unique<char[]>(BLOCK_SIZE));
+            _blockUsed = 0;
+            _size     += BLOCK_SIZE;
+        }
+
+        auto ptr = _blocks.back().get() + _blockUsed;
+        std::memcpy(ptr, str.data(), str.size());
+        _blockUsed += str.size();
+
+        return StrView(ptr, str.size());
+    }
+
+
+    ////////////////////////////////// StringPool
+
+    auto StringPool::intern(StrViewCref str) -> U32 {
+        return intern(str, str_hash(str));
     }
-    void Section::add(StringCref key, StringCref value) {
-        _pairs.emplace(key, value);
+
+    auto StringPool::intern(StrViewCref str, U64 hash) -> U32 {
+        auto id = static_cast<U32>(_strings.size());
+
+        auto [value, inserted] = _index.insert(str, hash, id);
+        if (inserted)
+            _strings.push_back(Entry{str, hash});
+
+        return *value;
     }
-    void Section::add(StringCref key, StringRval value) {
-        _pairs.emplace(key, value);
+
+    auto StringPool::find(StrViewCref str) const -> U32 {
+        return find(str, str_hash(str));
     }
-    void Section::addParent(StringCref parent) {
-        _parents.push_back(parent);
+
+    auto StringPool::find(StrViewCref str, U64 hash) const -> U32 {
+        auto id = _index.find(str, hash);
+        return id ? *id : 0;
     }
-    bool Section::isExists(StringCref key) const {
-        return _pairs.find(key) != _pairs.end();
+
+
+    ////////////////////////////////// CfgData
+
+    auto CfgData::sectionOpt(StrViewCref name) const -> const Section* {
+        auto id = _pool.find(name);
+        if (!id)
+            return nullptr;
+
+        auto index = _sectionIndex.find(id, _pool.hash(id));
+        return index ? &_sections[*index] : nullptr;
     }
-    void Section::reload() {
-        for (const auto& sectStr : _parents) {
-            auto& sect = cfgData().getSection(sectStr);
 
-            if (!sect._alreadyReloaded && !sect.getParents().empty())
-                sect.reload();
+    auto CfgData::getSection(StrViewCref name) const -> const Section& {
+        auto sect = sectionOpt(name);
+        CFG_ASSERTF(sect != nullptr, "Can't find section [{}]", name);
+        return *sect;
+    }
 
-            auto pairs = sect.getMap();
+    bool CfgData::isSectionExists(StrViewCref name) const {
+        return sectionOpt(name) != nullptr;
+    }
 
-            for (const auto& pair : pairs) {
-                if (!isExists(pair.first))
-                    add(pair.first, pair.second);
-            }
+    auto CfgData::findValue(U32 section, U32 key, U64 keyHash) const -> const StrView* {
+        auto& sect  = _sections[section];
+        auto  value = _values.find(value_key(section, key), value_hash(_pool.hash(sect.name), keyHash));
+        if (value)
+            return value;
+
+        // Parents are validated after loading
+        for (auto parent : sect.parents) {
+            value = findValue(*_sectionIndex.find(parent, _pool.hash(parent)), key, keyHash);
+            if (value)
+                return value;
         }
 
-        _alreadyReloaded = true;
+        return nullptr;
     }
 
+    auto CfgData::valueOpt(const Section& section, StrViewCref key) const -> std::optional<StrView> {
+        auto id = _pool.find(key);
+        if (!id)
+            return std::nullopt;
 
-    auto CfgData::getSection(StringCref key) const -> const Section& {
-        auto sect = _sections.find(key);
-        RASSERTF(sect != _sections.end(), "Can't find section [{}]", key);
-        return sect->second;
-    }
-    auto CfgData::getSection(StringCref key) -> Section& {
-        auto sect = _sections.find(key);
-        RASSERTF(sect != _sections.end(), "Can't find section [{}]", key);
-        return sect->second;
+        auto value = findValue(section.index, id, _pool.hash(id));
+        if (!value)
+            return std::nullopt;
+
+        return *value;
     }
-    auto CfgData::section(StringCref key) -> Section& {
-        auto& sect = _sections[key];
 
-        if (sect.name().empty())
-            sect.name() = key;
+    auto CfgData::valueOpt(StrViewCref section, StrViewCref key) const -> std::optional<StrView> {
+        auto sect = sectionOpt(section);
+        if (!sect)
+            return std::nullopt;
 
-        return sect;
+        return valueOpt(*sect, key);
     }
-    auto CfgData::sectionOpt(StringCref key) const -> std::optional<Section> {
-        auto sect = _sections.find(key);
-        if (sect == _sections.end())
-            return {};
-        else
-            return sect->second;
+
+    auto CfgData::getValue(StrViewCref section, StrViewCref key) const -> StrView {
+        auto value = valueOpt(getSection(section), key);
+        CFG_ASSERTF(value.has_value(), "Can't find key '{}' in section [{}]", key, section);
+        return *value;
     }
-    bool CfgData::isSectionExists(StringCref key) const {
-        return _sections.find(key) != _sections.end();
+
+    bool CfgData::isValueExists(StrViewCref section, StrViewCref key) const {
+        return valueOpt(section, key).has_value();
     }
-    auto CfgData::addSection(StringCref path, SizeT lineNum, StringCref key) -> Section& {
-        RASSERTF(!isSectionExists(key) ||
-                 !key.compare(GLOBAL_NAMESPACE), "Duplicate section [{}] in {}:{}", key, path, lineNum + 1);
 
-        auto& sect = _sections[key];
-        sect.name() = key;
+    auto CfgData::addSection(StringCref path, SizeT lineNum, StrViewCref name) -> U32 {
+        CFG_ASSERTF(!isSectionExists(name) ||
+                 name == GLOBAL_NAMESPACE, "Duplicate section [{}] in {}:{}", name, path, lineNum + 1);
 
-        return sect;
+        return section(name);
     }
 
-    auto CfgData::getValue(StringCref sect, StringCref key) const -> StringCref {
-        return getSection(sect).getValue(key);
-    }
-    auto CfgData::getValue(StringCref sect, StringCref key) -> StringRef {
-        return getSection(sect).getValue(key);
+    auto CfgData::section(StrViewCref name) -> U32 {
+        auto id    = _pool.intern(name);
+        auto index = static_cast<U32>(_sections.size());
+
+        auto [value, inserted] = _sectionIndex.insert(id, _pool.hash(id), index);
+        if (inserted)
+            _sections.push_back(Section{id, index, {}});
+
+        return *value;
     }
-    auto CfgData::value(StringCref sect, StringCref key) -> StringRef {
-        return section(sect).value(key);
+
+    void CfgData::addParent(U32 section, StrViewCref parent) {
+        _sections[section].parents.push_back(_pool.intern(parent));
     }
-    auto CfgData::valueOpt(StringCref sect, StringCref key) const -> std::optional<String> {
-        auto res1 = sectionOpt(sect);
-        if (res1)
-            return res1->valueOpt(key);
-        return {};
+
+    bool CfgData::addValue(U32 section, StrViewCref key, StrViewCref value) {
+        return addValue(section, _pool.intern(key), value);
     }
-    bool CfgData::isValueExists(StringCref sect, StringCref key) const {
-        auto res1 = isSectionExists(sect);
-        if (res1)
-            return getSection(sect).isExists(key);
-        return false;
+
+    bool CfgData::addValue(U32 section, U32 key, StrViewCref value) {
+        return _values.insert(value_key(section, key),
+                              value_hash(_pool.hash(_sections[section].name), _pool.hash(key)), value).second;
     }
-    void CfgData::addValue(StringCref sect, StringCref key, StringCref value) {
-        section(sect).add(key, value);
+
+    auto CfgData::ownValueOpt(StrViewCref section, StrViewCref key) const -> std::optional<StrView> {
+        auto sect = sectionOpt(section);
+        auto id   = _pool.find(key);
+        if (!sect || !id)
+            return std::nullopt;
+
+        auto value = _values.find(value_key(sect->index, id), value_hash(_pool.hash(sect->name), _pool.hash(id)));
+        if (!value)
+            return std::nullopt;
+
+        return *value;
     }
-    void CfgData::addValue(StringCref sect, StringCref key, StringRval value) {
-        section(sect).add(key, value);
+
+    void CfgData::validateParents() const {
+        // 0 - not visited, 1 - on stack, 2 - done
+        auto state = std::vector<U8>(_sections.size(), 0);
+
+        auto visit = [&](auto& self, U32 index) -> void {
+            auto& sect = _sections[index];
+            state[index] = 1;
+
+            for (auto parent : sect.parents) {
+                auto parentIndex = _sectionIndex.find(parent, _pool.hash(parent));
+                CFG_ASSERTF(parentIndex != nullptr, "Can't find parent section [{}] of section [{}]",
+                         _pool.str(parent), _pool.str(sect.name));
+                CFG_ASSERTF(state[*parentIndex] != 1, "Cyclic inheritance of section [{}] from [{}]",
+                         _pool.str(sect.name), _pool.str(parent));
+
+                if (state[*parentIndex] == 0)
+                    self(self, *parentIndex);
+            }
+
+            state[index] = 2;
+        };
+
+        for (U32 i = 0; i < _sections.size(); ++i)
+            if (state[i] == 0)
+                visit(visit, i);
     }
 
-    void CfgData::reloadParents() {
-        for (auto& s : _sections)
-            s.second.reload();
+    auto CfgData::memoryUsage() const -> SizeT {
+        auto size = _pool.bytes() + _sectionIndex.bytes() + _values.bytes() + _sections.capacity() * sizeof(Section);
+        for (auto& sect : _sections)
+            size += sect.parents.capacity() * sizeof(U32);
+        for (auto& file : _files)
+            size += file->arena.bytes() + file->ops.capacity() * sizeof(FileData::Op);
+        return size;
     }
 
     void CfgData::_print_info() const {
         std::cout << "Count: " << _sections.size() << std::endl;
-        for (auto& p : _sections) {
-            std::cout << "Section [" << p.first << "]";
-
-            if (!p.second.getParents().empty()) {
-                auto& parents = p.second.getParents();
+        for (auto& sect : _sections) {
+            std::cout << "Section [" << _pool.str(sect.name) << "]";
 
+            if (!sect.parents.empty()) {
                 std::cout << ": ";
-                for (SizeT i = 0; i < parents.size(); ++i) {
-                    std::cout << parents[i];
-                    if (i != parents.size() - 1)
+                for (SizeT i = 0; i < sect.parents.size(); ++i) {
+                    std::cout << _pool.str(sect.parents[i]);
+                    if (i != sect.parents.size() - 1)
                         std::cout << ", ";
                 }
             }
 
             std::cout << std::endl;
-            auto& map = p.second.getMap();
-            for (auto& p2 : map) {
-                std::cout << "\t" << p2.first << " = " << p2.second << std::endl;
-            }
+            _values.forEach([&](U64 key, StrView value) {
+                if (key >> 32 == sect.index)
+                    std::cout << "\t" << _pool.str(static_cast<U32>(key)) << " = " << value << std::endl;
+            });
             std::cout << std::endl;
         }
     }
 }
 
 
-inline bool is_plain_text(Char8 c) {
+constexpr bool is_plain_text(Char8 c) {
     return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
 }
 
-inline bool is_digit(Char8 c) {
+constexpr bool is_digit(Char8 c) {
     return c >= '0' && c <= '9';
 }
 
-inline bool is_space(Char8 c) {
+constexpr bool is_space(Char8 c) {
     return c == ' ' || c == '\t';
 }
 
-inline bool is_bracket(Char8 c) {
+constexpr bool is_bracket(Char8 c) {
     return c == '\'' || c == '\"';
 }
 
-inline bool is_legal_name_symbol(Char8 c) {
+constexpr bool is_legal_name_symbol(Char8 c) {
     return c == '@' || c == '.' || c =='/' || c == '\\' || c == '-';
 }
 
-inline bool is_symbol(Char8 c) {
+constexpr bool is_symbol(Char8 c) {
     return c == ',' || c == ';' || c == '#' || c == '[' || c == ']' ||
            c == '+' || c == '=' || c == '$' || c == '{' || c == '}' ||
            c == ':' || is_legal_name_symbol(c) || is_bracket(c);
 }
 
-inline bool validate_name_symbol(Char8 c) {
+constexpr bool validate_name_symbol(Char8 c) {
     return is_plain_text(c) || is_digit(c) || is_legal_name_symbol(c);
 }
 
-inline bool validate_keyval(Char8 c) {
+constexpr bool validate_keyval(Char8 c) {
     return validate_name_symbol(c) || is_space(c) || c == '-' || c == '+';
 }
 
-inline bool validate_symbol(Char8 c) {
+constexpr bool validate_symbol(Char8 c) {
     return is_space(c) || is_digit(c) || is_plain_text(c) || is_symbol(c);
 }
 
+constexpr auto VALID_SYMBOLS = [] {
+    auto table = std::array<bool, 256>();
+    for (SizeT c = 0; c < table.size(); ++c)
+        table[c] = validate_symbol(static_cast<Char8>(c));
+    return table;
+}();
+
 
 // Skip spaces, return true if end passed
 template <typename IterT>
 inline bool skip_spaces_if_no_endl(IterT& ptr, IterT end) {
-    while(is_space(*ptr) && ptr != end)
+    while(ptr != end && is_space(*ptr))
         ++ptr;
 
     return ptr == end;
 }
 
-// Skip spaces, return true if beg passed
-template <typename IterT>
-inline bool rskip_spaces_if_no_beg(IterT& ptr, IterT beg) {
-    while(is_space(*ptr) && ptr != beg)
-        --ptr;
-
-    return ptr == beg;
-}
-
 #define IS_WHITE_SPACE(CH)                 ((CH) == ' ' || (CH) == '\t')
 #define SKIP_WHITE_SPACE(ITR, ENDL)        while(IS_WHITE_SPACE(*(ITR)) && (ITR) != (ENDL)) ++(ITR)
 #define SKIP_BEFORE_WHITE_SPACE(ITR, ENDL) while(!IS_WHITE_SPACE(*(ITR)) && (ITR) != (ENDL)) ++(ITR)
@@ -219,21 +352,14 @@ using StrView     = std::string_view;
 using StrViewCref = const std::string_view&;
 using StrViewPair = std::pair<StrView, StrView>;
 using String      = ftl::String;
-using StrRef      = String&;
+using ArenaStrRef = ftl::pmr::String&;
 using StrCref     = const String&;
+using StrVector   = ftl::Vector<String>;
 namespace cfg_detls = base::cfg_detls;
 
 
 auto base::ConfigManager::remove_space_bounds_if_exists(StrViewCref str) -> StrView {
-    auto start = str.cbegin();
-    auto last  = str.cend() - 1;
-
-    if (!skip_spaces_if_no_endl(start, last)) {
-        if (!rskip_spaces_if_no_beg(last, start))
-            return str.substr(start - str.cbegin(), last - start + 1);
-    }
-
-    return str;
+    return ftl::str_scan::trim(str);
 }
 
 auto base::ConfigManager::remove_brackets_if_exists(StrViewCref str) -> StrView {
@@ -243,22 +369,64 @@ auto base::ConfigManager::remove_brackets_if_exists(StrViewCref str) -> StrView
 }
 
 
-void deleteComments  (StrCref path, StrvVector& lines); // Delete comments and check all symbols
-void processFileTask (StrCref path);
-void processFileTask ();
-void parseLinesTask  (StrCref path, StrvVector& lines);
-void preprocessorTask(StrCref path, SizeT lineNum, StrViewCref line);
+constexpr U32 NO_SECTION = std::numeric_limits<U32>::max();
+
+using FileOp     = cfg_detls::FileData::Op;
+using FileOpType = cfg_detls::FileData::OpType;
+
+// Records of file being parsed are collected in thread arena and copied to file data when it's parsed
+struct ParsingFile {
+    ParsingFile(cfg_detls::FileData& file, std::pmr::memory_resource* arena): data(file), ops(arena), derefs(arena) {}
+
+    cfg_detls::FileData&                          data;
+    std::pmr::vector<FileOp>                      ops;
+    std::pmr::vector<std::pair<StrView, StrView>> derefs;
+};
+
+struct ParseState {
+    cfg_detls::CfgData&          data;
+    const cfg_detls::CfgData*    previous;  // Nullptr if all files must be parsed
+    const cfg_detls::FileCache&  cache;     // Files of previous loading
+    cfg_detls::FileCache&        used;      // Files of this loading
+    const StrVector&             changed;
+    ParsingFile*                 file = nullptr; // File being parsed, nullptr on replay
+};
+
+auto deleteComments  (StrCref path, SizeT lineNum, StrViewCref line) -> StrView; // Delete comment and check all symbols
+void processFileTask (ParseState& st, StrCref path);
+void applyOp         (ParseState& st, StrCref path, const FileOp& op, U32& currentSection);
+void parseLineTask   (ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, U32& currentSection, ArenaStrRef buffer);
+void preprocessorTask(ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, U32& currentSection);
 auto pairFromLine    (StrCref path, SizeT lineNum, StrViewCref line) -> StrViewPair;
-auto unpackVariable  (StrCref path, SizeT lineNum, StrViewCref line) -> String;
+auto unpackValue     (ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, ArenaStrRef buffer) -> StrView;
+void unpackVariable  (ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, ArenaStrRef result);
+
+
+// Values without quotes, spaces and dereferences are views to config file, others are built in buffer
+// and stored in file arena
+auto unpackValue(ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, ArenaStrRef buffer) -> StrView {
+    auto front = line.front();
+
+    if (is_bracket(front)) {
+        if (line.size() > 1 && line.back() == front && line.find(front, 1) == line.size() - 1)
+            return line.substr(1, line.size() - 2);
+    }
+    else if (ftl::str_scan::find_any(line.data(), line.data() + line.size(), "\'\"$ \t") ==
+             line.data() + line.size())
+        return line;
 
+    unpackVariable(st, path, lineNum, line, buffer);
+    return st.file->data.arena.store(StrView(buffer.data(), buffer.size()));
+}
 
-auto unpackVariable (StrCref path, SizeT lineNum, StrViewCref line) -> String {
+// Dereferenced keys are recorded, file is parsed again on reload if their values are changed
+void unpackVariable(ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, ArenaStrRef result) {
     auto ptr = line.begin();
 
     bool onSingleQuotes = false;
     bool onDoubleQuotes = false;
 
-    auto result = String();
+    result.clear();
     result.reserve(line.length());
 
     for (; ptr != line.cend();) {
@@ -277,18 +445,18 @@ auto unpackVariable (StrCref path, SizeT lineNum, StrViewCref line) -> String {
 
                 ////////// Read key
 
-                RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+                CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
                          "Empty key after '$' in {}:{}",
                          path, lineNum + 1);
 
-                RASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
+                CFG_ASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
                          "Starting key with symbol '{}' in {}:{}",
                          *ptr, path, lineNum + 1);
 
                 auto start = ptr;
 
-                while(!is_space(*ptr) && *ptr != ':' && ptr != line.cend() && *ptr != '}' && *ptr != ',') {
-                    RASSERTF(validate_name_symbol(*ptr),
+                while(ptr != line.cend() && !is_space(*ptr) && *ptr != ':' && *ptr != '}' && *ptr != ',') {
+                    CFG_ASSERTF(validate_name_symbol(*ptr),
                              "Invalid character '{}' in key after '$' in {}:{}",
                              *ptr, path, lineNum + 1);
                     ++ptr;
@@ -300,24 +468,26 @@ auto unpackVariable (StrCref path, SizeT lineNum, StrViewCref line) -> String {
                 skip_spaces_if_no_endl(ptr, line.cend());
 
                 ////////// Dereference key
-                if (ptr == line.cend() || *ptr != ':')
+                if (ptr == line.cend() || *ptr != ':') {
                     //////// Read value from global namespaces
-                    val = cfg_detls::cfgData().getValue(cfg_detls::GLOBAL_NAMESPACE, first);
+                    val = st.data.getValue(cfg_detls::GLOBAL_NAMESPACE, first);
+                    st.file->derefs.emplace_back(cfg_detls::GLOBAL_NAMESPACE, first);
+                }
                 else if (*ptr == ':'){
                     //////// Read value from section (only no-parents section supported)
                     ++ptr; // skip ':'
 
-                    RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+                    CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
                             "Empty key after ':' in {}:{}", path, lineNum + 1);
 
-                    RASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
+                    CFG_ASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
                              "Starting key name with symbol '{}' in {}:{}",
                              *ptr, path, lineNum + 1);
 
                     auto start2 = ptr;
 
-                    while(!is_space(*ptr) && *ptr != ':' && ptr != line.cend()) {
-                        RASSERTF(validate_name_symbol(*ptr),
+                    while(ptr != line.cend() && !is_space(*ptr) && *ptr != ':') {
+                        CFG_ASSERTF(validate_name_symbol(*ptr),
                                  "Invalid character '{}' in key after '$' in {}:{}",
                                  *ptr, path, lineNum + 1);
                         ++ptr;
@@ -325,14 +495,16 @@ auto unpackVariable (StrCref path, SizeT lineNum, StrViewCref line) -> String {
 
                     auto second = line.substr(start2 - line.cbegin(), ptr - start2);
 
-                    RASSERTF(cfg_detls::cfgData().getSection(first).getParents().empty(),
+                    CFG_ASSERTF(st.data.getSection(first).parents.empty(),
                             "Attempt to dereference key '{}' from section [{}] with parent "
                             "in {}:{}", second, first, path, lineNum + 1);
 
-                    val = cfg_detls::cfgData().getValue(first, second);
+                    val = st.data.getValue(first, second);
+                    st.file->derefs.emplace_back(first, second);
                 }
 
-                result += base::ConfigManager::remove_brackets_if_exists(val);
+                auto unpacked = base::ConfigManager::remove_brackets_if_exists(val);
+                result.insert(result.end(), unpacked.begin(), unpacked.end());
                 continue;
             }
             else if (!is_space(*ptr)) {
@@ -342,8 +514,6 @@ auto unpackVariable (StrCref path, SizeT lineNum, StrViewCref line) -> String {
 
         ++ptr;
     }
-
-    return std::move(result);
 }
 
 auto pairFromLine(StrCref path, SizeT lineNum, StrViewCref line) -> StrViewPair {
@@ -356,12 +526,12 @@ auto pairFromLine(StrCref path, SizeT lineNum, StrViewCref line) -> StrViewPair
 
     auto start = ptr;
 
-    RASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
+    CFG_ASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
              "Starting key with symbol '{}' in {}:{}",
              *ptr, path, lineNum + 1);
 
-    while(!is_space(*ptr) && *ptr != '=' && ptr != line.cend()) {
-        RASSERTF(validate_name_symbol(*ptr),
+    while(ptr != line.cend() && !is_space(*ptr) && *ptr != '=') {
+        CFG_ASSERTF(validate_name_symbol(*ptr),
                  "Invalid character '{}' in key definition in {}:{}.",
                  *ptr, path, lineNum + 1);
         ++ptr;
@@ -372,67 +542,68 @@ auto pairFromLine(StrCref path, SizeT lineNum, StrViewCref line) -> StrViewPair
 
     //////////// Read values (no space deleting inside values)
 
-    RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+    CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
             "Missing value at key '{}' in {}:{}", key, path, lineNum + 1);
 
-    RASSERTF(*ptr == '=',
+    CFG_ASSERTF(*ptr == '=',
             "Missing delimiter '=' at key '{}' in {}:{}", key, path, lineNum + 1);
         ++ptr;
 
     auto value = base::ConfigManager::
             remove_space_bounds_if_exists(line.substr(ptr - line.cbegin(), line.end() - ptr));
 
-    RASSERTF(!value.empty(),
+    CFG_ASSERTF(!value.empty(),
              "Missing value at key '{}' in {}:{}", key, path, lineNum + 1);
 
     return StrViewPair(key, value);
 }
 
 
-void deleteComments(StrCref path, StrvVector& lines) {
-    for (SizeT n = 0; n < lines.size(); ++n) {
-        bool onSingleQuotes = false;
-        bool onDoubleQuotes = false;
+// Quotes and comments are found by vectorized scan, chars between them are validated by table
+auto deleteComments(StrCref path, SizeT lineNum, StrViewCref line) -> StrView {
+    auto p   = line.data();
+    auto end = line.data() + line.size();
 
-        auto& line = lines[n];
-        auto  i    = line.begin();
+    while (true) {
+        auto special = ftl::str_scan::find_any(p, end, "\'\";/");
 
-        for (; i != line.end(); ++i) {
-            if (*i == '\'' && !onDoubleQuotes)
-                onSingleQuotes = !onSingleQuotes;
+        for (; p != special; ++p)
+            CFG_ASSERTF(VALID_SYMBOLS[static_cast<U8>(*p)],
+                    "Undefined char symbol '{}' [{}] in {}:{}",
+                    *p, U32(U8(*p)), path, lineNum + 1);
 
-            else if (*i == '\"' && !onSingleQuotes)
-                onDoubleQuotes = !onDoubleQuotes;
+        if (special == end)
+            return line;
 
-            else if (!onSingleQuotes && !onDoubleQuotes) {
-                RASSERTF(validate_symbol(*i),
-                        "Undefined char symbol '{}' [{}] in {}:{}",
-                        *i, U32(U8(*i)), path, n + 1);
+        if (is_bracket(*special)) {
+            auto closing = ftl::str_scan::find_char(special + 1, end, *special);
 
-                if (*i == ';' || (*i == '/' && *(i + 1) == '/')) {
-                    line = line.substr(0, i - line.begin());
-                    break;
-                }
-            }
-        }
+            CFG_ASSERTF(closing != end || *special != '\'', "Missing second \' quote in {}:{}", path, lineNum + 1);
+            CFG_ASSERTF(closing != end, "Missing second \" quote in {}:{}", path, lineNum + 1);
 
-        RASSERTF(!onSingleQuotes, "Missing second \' quote in {}:{}", path, n + 1);
-        RASSERTF(!onDoubleQuotes, "Missing second \" quote in {}:{}", path, n + 1);
+            p = closing + 1;
+        }
+        else if (*special == ';' || (special + 1 != end && *(special + 1) == '/')) {
+            return line.substr(0, special - line.data());
+        }
+        else {
+            p = special + 1;
+        }
     }
 }
 
-void preprocessorTask(StrCref path, SizeT lineNum, StrViewCref line) {
+void preprocessorTask(ParseState& st, StrCref path, SizeT lineNum, StrViewCref line, U32& currentSection) {
     auto ptr = line.cbegin();
 
     ++ptr; // skip '#'
 
-    RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+    CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
             "Empty preprocessor directive in {}:{}", path, lineNum + 1);
 
     auto start = ptr;
 
     while (!is_space(*ptr) && ptr != line.cend()) {
-        RASSERTF(is_plain_text(*ptr),
+        CFG_ASSERTF(is_plain_text(*ptr),
                 "Invalid character in preprocessor directive in {}:{}",
                  path, lineNum + 1);
         ++ptr;
@@ -446,137 +617,232 @@ void preprocessorTask(StrCref path, SizeT lineNum, StrViewCref line) {
                 base::ConfigManager::remove_brackets_if_exists(
                         base::ConfigManager::remove_space_bounds_if_exists(backline));
 
-        RASSERTF(!appendPath.empty(),
+        CFG_ASSERTF(!appendPath.empty(),
                 "Empty path in include directive in {}:{}", path, lineNum + 1);
 
-        processFileTask(path.parent_path() / appendPath);
+        // Included path is relative to directory of current file. No inner arena scope:
+        // ops of current file grow in arena while include is applied
+        auto includePath = ftl::pmr::String(&base::thread_arena());
+        auto dirSize     = path.rfind('/') + 1; // Zero if path has no directory
+
+        includePath.reserve(dirSize + appendPath.size());
+        includePath.insert(includePath.end(), path.begin(), path.begin() + static_cast<PtrDiff>(dirSize));
+        includePath.insert(includePath.end(), appendPath.begin() + (dirSize && appendPath.front() == '/'),
+                           appendPath.end());
+
+        auto op = FileOp{FileOpType::Include, static_cast<U32>(lineNum),
+                         st.file->data.arena.store(StrView(includePath.data(), includePath.size())), {}};
+
+        applyOp(st, path, op, currentSection);
     } else {
 
-        RASSERTF(0, "Unknown preprocessor directive '#{}' in {}:{}", first, path, lineNum + 1);
+        CFG_ASSERTF(0, "Unknown preprocessor directive '#{}' in {}:{}", first, path, lineNum + 1);
     }
 }
 
 
-void parseLinesTask(StrCref path, StrvVector& lines) {
-    using cfg_detls::Section;
-    using cfg_detls::cfgData;
+void parseLineTask(ParseState& st, StrCref path, SizeT n, StrViewCref line, U32& currentSection, ArenaStrRef buffer) {
+    auto ptr = line.cbegin();
 
-    Section* currentSection = nullptr;
+    if (skip_spaces_if_no_endl(ptr, line.cend()))
+        return;
+    ////////////////////////////////////// Section /////////////////////////////////////////
+    if (*ptr == '[') {
+        auto start = ++ptr;
+
+        ////////////// Read section
+
+        CFG_ASSERTF(ptr != line.cend(), "Missing close section bracket in '{}' at line {}.", path, n + 1);
+        CFG_ASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
+                 "Starting section with symbol '{}' in {}:{}",
+                 *ptr, path, n + 1);
+
+        while(ptr != line.cend() && *ptr != ']') {
+            CFG_ASSERTF(validate_name_symbol(*ptr),
+                    "Invalid character '{}' in section definition in {}:{}",
+                    *ptr, path, n + 1);
+            ++ptr;
+        }
+
+        CFG_ASSERTF(ptr != line.cend() && *ptr == ']',
+                "Missing close section bracket in '{}' at line {}.", path, n + 1);
+
+        auto name = line.substr(start - line.cbegin(), ptr - start);
+        applyOp(st, path, FileOp{FileOpType::Section, static_cast<U32>(n), name, {}}, currentSection);
 
-    for (SizeT n = 0; n < lines.size(); ++n) {
-        auto& line = lines[n];
-        auto  ptr  = line.cbegin();
+        ++ptr; // skip ']'
 
         if (skip_spaces_if_no_endl(ptr, line.cend()))
-            continue;
-        ////////////////////////////////////// Section /////////////////////////////////////////
-        if (*ptr == '[') {
-            auto start = ++ptr;
+            return;
+
+
+        /////////////// Read parents
+
+        CFG_ASSERTF(*ptr == ':',
+                 "Unexpected symbol '{}' after section [{}] definition in '{}' at line {}.",
+                 *ptr, name, path, n + 1);
 
-            ////////////// Read section
+        ++ptr; // skip ':'
 
-            RASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
-                     "Starting section with symbol '{}' in {}:{}",
+        CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+                "Missing parents sections after ':' in '{}' at line {}.",
+                path, n + 1);
+
+
+
+        while(ptr != line.end()) {
+            auto start2 = ptr;
+
+            CFG_ASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
+                     "Starting parent definition with symbol '{}' in {}:{}",
                      *ptr, path, n + 1);
 
-            while(*ptr != ']' && ptr != line.cend()) {
-                RASSERTF(validate_name_symbol(*ptr),
-                        "Invalid character '{}' in section definition in {}:{}",
-                        *ptr, path, n + 1);
+            while(ptr != line.cend() && !is_space(*ptr) && *ptr != ',') {
+                CFG_ASSERTF(validate_name_symbol(*ptr),
+                         "Invalid character '{}' in parent definition in {}:{}",
+                         *ptr, path, n + 1);
                 ++ptr;
             }
 
-            RASSERTF(*ptr == ']',
-                    "Missing close section bracket in '{}' at line {}.", path, n + 1);
+            auto parent = line.substr(start2 - line.cbegin(), ptr - start2);
+            applyOp(st, path, FileOp{FileOpType::Parent, static_cast<U32>(n), parent, {}}, currentSection);
 
-            currentSection =
-                    &cfgData().addSection(path, n, line.substr(start - line.cbegin(), ptr - start));
+            if (skip_spaces_if_no_endl(ptr, line.cend()))
+                break;
 
-            ++ptr; // skip ']'
+            CFG_ASSERTF(*ptr == ',',
+                     "Missing ',' after parent definition in '{}' at line {}.", path, n + 1);
 
-            if (skip_spaces_if_no_endl(ptr, line.cend()))
-                continue;
+            ++ptr;
 
+            CFG_ASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
+                     "Missing parent parent definition after ',' in '{}' at line {}.",
+                     path, n + 1);
+        }
+    }
 
-            /////////////// Read parents
+    //////////////////////////// Preprocessor task //////////////////////////////////////
+    else if (*ptr == '#') {
+        preprocessorTask(st, path, n, line.substr(ptr - line.begin()), currentSection);
+    }
 
-            RASSERTF(*ptr == ':',
-                     "Unexpected symbol '{}' after section [{}] definition in '{}' at line {}.",
-                     *ptr, currentSection->name(), path, n+ 1);
+    //////////////////////////////// Read variables /////////////////////////////////////
+    else {
+        auto pair = pairFromLine(path, n, line);
 
-            ++ptr; // skip ':'
+        auto var  = unpackValue(st, path, n, pair.second, buffer);
+        auto type = currentSection != NO_SECTION ? FileOpType::Value : FileOpType::GlobalValue;
 
-            RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
-                    "Missing parents sections after ':' in '{}' at line {}.",
-                    path, n + 1);
+        applyOp(st, path, FileOp{type, static_cast<U32>(n), pair.first, var}, currentSection);
+    }
+}
 
+// Parser doesn't change config data directly, operations are recorded for replay on reload
+void applyOp(ParseState& st, StrCref path, const FileOp& op, U32& currentSection) {
+    // Record before applying: included file changes st.file while it's parsed
+    if (st.file)
+        st.file->ops.push_back(op);
 
+    switch (op.type) {
+        case FileOpType::Section:
+            currentSection = st.data.addSection(path, op.line, op.first);
+            break;
 
-            while(ptr != line.end()) {
-                auto start2 = ptr;
+        case FileOpType::Parent:
+            st.data.addParent(currentSection, op.first);
+            break;
 
-                RASSERTF(!is_digit(*ptr) && !is_legal_name_symbol(*ptr),
-                         "Starting parent definition with symbol '{}' in {}:{}",
-                         *ptr, path, n + 1);
+        case FileOpType::Value:
+            st.data.addValue(currentSection, op.first, op.second);
+            break;
 
-                while(!is_space(*ptr) && ptr != line.cend() && *ptr != ',') {
-                    RASSERTF(validate_name_symbol(*ptr),
-                             "Invalid character '{}' in parent definition in {}:{}",
-                             *ptr, path, n + 1);
-                    ++ptr;
-                }
+        case FileOpType::GlobalValue: {
+            auto added = st.data.addValue(st.data.section(cfg_detls::GLOBAL_NAMESPACE), op.first, op.second);
 
-                currentSection->addParent(line.substr(start2 - line.cbegin(), ptr - start2));
+            CFG_ASSERTF(added, "Duplicate variable '{}' in global namespace in {}:{}",
+                     op.first, path, op.line + 1);
+        } break;
 
-                if (skip_spaces_if_no_endl(ptr, line.cend()))
-                    break;
+        case FileOpType::Include:
+            processFileTask(st, String(op.first));
+            break;
+    }
+}
 
-                RASSERTF(*ptr == ',',
-                         "Missing ',' after parent definition in '{}' at line {}.", path, n + 1);
+// File can be replayed if it isn't changed and all values dereferenced by it are the same
+bool isReusable(const ParseState& st, StrCref path, const cfg_detls::FileData& file) {
+    if (!st.previous || std::find(st.changed.begin(), st.changed.end(), path) != st.changed.end())
+        return false;
 
-                ++ptr;
+    for (auto& [section, key] : file.derefs) {
+        auto sect = st.data.sectionOpt(section);
+        if (!sect || !sect->parents.empty() ||
+            st.data.ownValueOpt(section, key) != st.previous->ownValueOpt(section, key))
+            return false;
+    }
 
-                RASSERTF(!skip_spaces_if_no_endl(ptr, line.cend()),
-                         "Missing parent parent definition after ',' in '{}' at line {}.",
-                         path, n + 1);
-            }
-        }
+    return true;
+}
 
-        //////////////////////////// Preprocessor task //////////////////////////////////////
-        else if (*ptr == '#') {
-            preprocessorTask(path, n, line.substr(ptr - line.begin()));
-        }
+void processFileTask(ParseState& st, StrCref path) {
+    auto cached = st.cache.find(path);
 
-        //////////////////////////////// Read variables /////////////////////////////////////
-        else {
-            auto pair = pairFromLine(path, n, line);
+    if (cached != st.cache.end() && isReusable(st, path, *cached->second)) {
+        auto file           = cached->second;
+        auto parent         = std::exchange(st.file, nullptr);
+        auto currentSection = NO_SECTION;
 
-            auto var  = unpackVariable(path, n, pair.second);
+        st.data.addFile(file);
+        st.used[path] = file;
 
-            if (currentSection)
-                currentSection->add(pair.first, var);
-            else {
-                RASSERTF(!cfgData().section(cfg_detls::GLOBAL_NAMESPACE).isExists(pair.first),
-                         "Duplicate variable '{}' in global namespace in {}:{}",
-                         pair.first, path, n + 1);
+        for (auto& op : file->ops)
+            applyOp(st, path, op, currentSection);
 
-                cfgData().addValue(cfg_detls::GLOBAL_NAMESPACE, pair.first, var);
-            }
-        }
+        st.file = parent;
+        return;
     }
-}
 
-void processFileTask(StrCref path) {
-    auto file  = base::readFileToString(path);       // no log mode
-    auto lines = file.splitView({'\n', '\r', '\0'}, true); // do not delete empty strings
+    auto vfsFile = base::vfs().open(std::string_view(path.data(), path.size()));
+    CFG_ASSERTF(vfsFile.has_value(), "Can't open config file: \'{}\'", path); // no log mode
 
-    deleteComments(path, lines);
-    parseLinesTask(path, lines);
-}
+    // Names and most of values are views to the file, so it is kept by config data.
+    // File is copied: it may be rewritten in place while old snapshot is used
+    auto file = std::make_shared<cfg_detls::FileData>();
+    file->file = base::VfsFile(ftl::Vector<Byte>(vfsFile->data(), vfsFile->data() + vfsFile->size()));
+
+    st.data.addFile(file);
+    st.used[path] = file;
+
+    auto scope          = base::ArenaScope();
+    auto parsing        = ParsingFile(*file, &scope.arena());
+    auto parent         = std::exchange(st.file, &parsing);
+    auto data           = file->file.view();
+    auto currentSection = NO_SECTION;
+    auto buffer         = ftl::pmr::String(&scope.arena());
+    auto start          = SizeT(0);
+    auto lineNum        = SizeT(0);
 
-void processFileTask() {
-    for (auto& path : cfg_detls::cfg_state().getEntries())
-        processFileTask(path);
+    auto parse = [&](SizeT end) {
+        auto line = deleteComments(path, lineNum, data.substr(start, end - start));
+        parseLineTask(st, path, lineNum, line, currentSection, buffer);
+        start = end + 1;
+        ++lineNum;
+    };
+
+    // Empty lines are kept for right line numbers
+    constexpr auto lineEnds = StrView("\n\r\0", 3);
+
+    for (auto p = data.data(), end = data.data() + data.size();
+         (p = ftl::str_scan::find_any(p, end, lineEnds)) != end; ++p)
+        parse(static_cast<SizeT>(p - data.data()));
+
+    if (start < data.size())
+        parse(data.size());
+
+    file->ops.assign(parsing.ops.begin(), parsing.ops.end());
+    file->derefs.assign(parsing.derefs.begin(), parsing.derefs.end());
+
+    st.file = parent;
 }
 
 namespace base {
@@ -683,8 +949,214 @@ namespace base {
     }
 
 
+
+    ////////////////////////////////// CfgStorage
+
+    void cfg_detls::CfgStorage::load(const StrVector& entries, StringCref cachePath) {
+        {
+            auto lock  = std::lock_guard(_buildMutex);
+            _entries   = entries;
+            _cachePath = cachePath;
+
+            auto sources = StrVector();
+            auto cached  = cachePath.empty() ? nullptr : CfgCache::read(cachePath, entries, sources);
+
+            if (cached) {
+                auto previous = snapshot();
+
+                _files.clear();
+                _sources = std::move(sources);
+                std::atomic_store(&_current, CfgDataPtr(cached));
+                cfg_generation.fetch_add(1, std::memory_order_release);
+
+                notify(*previous, *cached);
+                return;
+            }
+        }
+
+        build({}, true);
+    }
+
+    void cfg_detls::CfgStorage::reload(const StrVector& changed) {
+        try {
+            build(changed, false);
+        }
+        catch (const CfgParseError& error) {
+            DE_LOG(Error, Cfg, "Config files are not reloaded, previous values are kept: {}", error.what());
+        }
+    }
+
+    void cfg_detls::CfgStorage::build(const StrVector& changed, bool full) {
+        auto lock     = std::lock_guard(_buildMutex);
+        auto errors   = RecoverableErrorsScope(!full);
+        auto previous = snapshot();
+        auto data     = std::make_shared<CfgData>();
+        auto used     = FileCache();
+        auto st       = ParseState{*data, full ? nullptr : previous.get(), _files, used, changed};
+
+        for (auto& path : _entries)
+            processFileTask(st, path);
+
+        data->validateParents();
+
+        _files = std::move(used);
+        _sources.clear();
+        for (auto& [path, file] : _files)
+            _sources.push_back(path);
+
+        std::atomic_store(&_current, CfgDataPtr(data));
+        cfg_generation.fetch_add(1, std::memory_order_release);
+
+        notify(*previous, *data);
+
+        if (!_cachePath.empty())
+            CfgCache::write(_cachePath, *data, _entries, _files);
+    }
+
+    void cfg_detls::CfgStorage::notify(const CfgData& previous, const CfgData& current) {
+        auto lock = std::lock_guard(_subsMutex);
+
+        for (auto& [id, sub] : _subs) {
+            auto section = StrView(sub.section.data(), sub.section.size());
+            auto name    = StrView(sub.name.data(), sub.name.size());
+
+            if (previous.valueOpt(section, name) != current.valueOpt(section, name) &&
+                std::find(_changed.begin(), _changed.end(), id) == _changed.end())
+                _changed.push_back(id);
+        }
+    }
+
+    auto cfg_detls::CfgStorage::subscribe(StrViewCref name, StrViewCref section, ChangeCallback callback) -> U64 {
+        auto lock = std::lock_guard(_subsMutex);
+        auto id   = ++_lastSubId;
+
+        _subs.emplace(id, Subscription{String(name), String(section), std::move(callback)});
+        return id;
+    }
+
+    void cfg_detls::CfgStorage::unsubscribe(U64 id) {
+        auto lock = std::lock_guard(_subsMutex);
+        _subs.erase(id);
+    }
+
+    void cfg_detls::CfgStorage::dispatchChanges() {
+        auto calls = std::vector<Subscription>();
+
+        {
+            auto lock = std::lock_guard(_subsMutex);
+            for (auto id : _changed) {
+                auto sub = _subs.find(id);
+                if (sub != _subs.end())
+                    calls.push_back(sub->second);
+            }
+            _changed.clear();
+        }
+
+        // Callbacks are called without lock, they can subscribe or read configs
+        for (auto& sub : calls)
+            sub.callback(StrView(sub.name.data(), sub.name.size()), StrView(sub.section.data(), sub.section.size()));
+    }
+
+    void cfg_detls::CfgStorage::startWatching() {
+        if (_watching)
+            return;
+
+        _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (_inotify < 0) {
+            DE_LOG(Error, Cfg, "Can't start config files watching: inotify_init1 failed with errno {}", errno);
+            return;
+        }
+
+        _watching = true;
+        _stop     = false;
+
+        updateWatches();
+
+        _watcher = std::thread([this] { watchLoop(); });
+    }
+
+    void cfg_detls::CfgStorage::stopWatching() {
+        if (!_watching)
+            return;
+
+        _stop = true;
+        if (_watcher.joinable())
+            _watcher.join();
+
+        close(_inotify);
+        _inotify  = -1;
+        _watches.clear();
+        _watching = false;
+    }
+
+    // Directories are watched instead of files: editors often replace file by renaming new one
+    void cfg_detls::CfgStorage::updateWatches() {
+        auto lock = std::lock_guard(_buildMutex);
+
+        for (auto& path : _sources) {
+            auto dir  = path.parent_path();
+            auto name = dir.empty() ? path : path.substr(dir.size());
+
+            auto wd = inotify_add_watch(_inotify, dir.empty() ? "." : dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+            if (wd < 0) {
+                DE_LOG(Warning, Cfg, "Can't watch config file '{}'", path);
+                continue;
+            }
+
+            auto& files = _watches[wd];
+            if (std::find_if(files.begin(), files.end(), [&](auto& f) { return f.second == path; }) == files.end())
+                files.emplace_back(name, path);
+        }
+    }
+
+    void cfg_detls::CfgStorage::watchLoop() {
+        using namespace std::chrono_literals;
+
+        alignas(inotify_event) char buffer[4096];
+
+        auto changed   = StrVector();
+        auto lastEvent = std::chrono::steady_clock::now();
+
+        while (!_stop) {
+            auto pfd = pollfd{_inotify, POLLIN, 0};
+
+            if (poll(&pfd, 1, 100) > 0) {
+                for (auto size = read(_inotify, buffer, sizeof(buffer)); size > 0;
+                          size = read(_inotify, buffer, sizeof(buffer))) {
+                    for (auto ptr = buffer; ptr < buffer + size;) {
+                        auto event = reinterpret_cast<const inotify_event*>(ptr);
+                        ptr += sizeof(inotify_event) + event->len;
+
+                        auto files = _watches.find(event->wd);
+                        if (event->len == 0 || files == _watches.end())
+                            continue;
+
+                        for (auto& [name, path] : files->second)
+                            if (StrView(name.data(), name.size()) == StrView(event->name) &&
+                                std::find(changed.begin(), changed.end(), path) == changed.end())
+                                changed.push_back(path);
+
+                        lastEvent = std::chrono::steady_clock::now();
+                    }
+                }
+            }
+
+            // Wait for the end of writing: editors save files in several steps
+            if (!changed.empty() && std::chrono::steady_clock::now() - lastEvent >= 50ms) {
+                DE_LOG(Info, Cfg, "Reload {} changed config files", changed.size());
+
+                reload(changed);
+                updateWatches();
+                changed.clear();
+            }
+        }
+    }
+
     void ConfigManager::load() {
-        processFileTask();
-        cfg_detls::cfgData().reloadParents();
+        auto& storage = cfg_detls::cfgStorage();
+        storage.load(cfg_detls::cfg_state().getEntries(), cfg_detls::cfg_state().cachePath());
+
+        if (force_read_ie<bool>("cfg_hot_reload", false))
+            storage.startWatching();
     }
-}
\ No newline at end of file
+}
@@ -1,8 +1,17 @@
 #pragma once
 
 #include <flat_hash_map.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
 #include "filesystem.hpp"
 #include "defines.hpp"
+#include "vfs.hpp"
 #include "ftl/string.hpp"
 #include "ftl/vector.hpp"
 #include "aton.hpp"
@@ -19,10 +28,18 @@ namespace base {
     namespace cfg_detls {
         static constexpr inline std::string_view GLOBAL_NAMESPACE = "__global";
 
+        // Incremented on each config loading, invalidates cfg::Key caches
+        inline std::atomic<U32> cfg_generation = 0;
+
         static inline auto DEFAULT_CFG_PATH() {
             return fs::current_path().parent_path() / "fs.cfg";
         }
 
+        // Configs are not loaded yet, so it can't be placed by appdata_dir
+        static inline auto DEFAULT_CFG_CACHE_PATH() {
+            return fs::current_path().parent_path() / "app_data" / "configs.dcfg";
+        }
+
         class CfgCreationState {
             friend ConfigManager;
         public:
@@ -34,6 +51,10 @@ namespace base {
                 _cfgEntries.push_back(path);
             }
 
+            void setCachePath(const ftl::String& path) {
+                _cachePath = path;
+            }
+
             bool onCreate () const { return _onCreate; }
             bool isCreated() const { return _isCreated; }
 
@@ -41,11 +62,16 @@ namespace base {
                 return _cfgEntries;
             }
 
+            const auto& cachePath() const {
+                return _cachePath;
+            }
+
         private:
             bool _onCreate  = false;
             bool _isCreated = false;
 
             ftl::Vector<ftl::String> _cfgEntries;
+            ftl::String              _cachePath = DEFAULT_CFG_CACHE_PATH();
 
             // Singleton impl
         public:
@@ -73,80 +99,319 @@ namespace base {
 
         using String        = ftl::String;
         using StringCref    = const String&;
-        using StringRef     = String&;
-        using StringRval    = String&&;
-        using StrStrMap     = ska::flat_hash_map<String, String>;
-        using StrSectionMap = ska::flat_hash_map<String, class Section>;
+        using StrView       = std::string_view;
+        using StrViewCref   = const std::string_view&;
         using StrVector     = ftl::Vector<String>;
 
-        class Section {
+        /**
+         * Open addressing hash table with linear probing, hash is computed by caller.
+         * Entries are stored densely in insertion order, slots keep entry index and low half of hash.
+         * Entries are never erased, only whole table is cleared
+         */
+        template <typename KeyT, typename ValueT>
+        class FlatTable {
         public:
-            auto getValue  (StringCref key) const -> StringCref;      // Get value (assert if not exists)
-            auto getValue  (StringCref key) -> StringRef;             // Get value (assert if not exists)
-            auto value     (StringCref key) -> StringRef;             // Get or create value
-            auto valueOpt  (StringCref key) const -> std::optional<String>; // Get value or nullopt
-            bool isExists  (StringCref key) const;
-            void add       (StringCref key, StringCref value);
-            void add       (StringCref key, StringRval value);
-            void addParent (StringCref parent);
-            auto getMap    () -> StrStrMap&             { return _pairs; }
-            auto getMap    () const -> const StrStrMap& { return _pairs; }
-            auto getParents() -> StrVector&             { return _parents; }
-            auto getParents() const -> const StrVector& { return _parents; }
-
-            auto& name()       { return _name; }
-            auto& name() const { return _name; }
-
-            void reload();
+            auto find(const KeyT& key, U64 hash) const -> const ValueT* {
+                if (_slots.empty())
+                    return nullptr;
+
+                auto hash32 = static_cast<U32>(hash);
+
+                for (auto i = hash32 & _mask;; i = (i + 1) & _mask) {
+                    auto& slot = _slots[i];
+                    if (slot.index == 0)
+                        return nullptr;
+                    if (slot.hash == hash32 && _entries[slot.index - 1].key == key)
+                        return &_entries[slot.index - 1].value;
+                }
+            }
+
+            // Returns existing value and false if key already exists
+            auto insert(const KeyT& key, U64 hash, const ValueT& value) -> std::pair<ValueT*, bool> {
+                if ((_entries.size() + 1) * 4 > _slots.size() * 3)
+                    rehash(_slots.empty() ? 16 : static_cast<U32>(_slots.size() * 2));
+
+                auto hash32 = static_cast<U32>(hash);
+
+                for (auto i = hash32 & _mask;; i = (i + 1) & _mask) {
+                    auto& slot = _slots[i];
+                    if (slot.index == 0) {
+                        _entries.push_back(Entry{key, value});
+                        slot = Slot{static_cast<U32>(_entries.size()), hash32};
+                        return {&_entries.back().value, true};
+                    }
+                    if (slot.hash == hash32 && _entries[slot.index - 1].key == key)
+                        return {&_entries[slot.index - 1].value, false};
+                }
+            }
+
+            template <typename F>
+            void forEach(F&& callback) const {
+                for (auto& entry : _entries)
+                    callback(entry.key, entry.value);
+            }
+
+            void reserve(SizeT count) {
+                auto capacity = U32(16);
+                while (capacity * 3 < count * 4)
+                    capacity *= 2;
+
+                if (capacity > _slots.size())
+                    rehash(capacity);
+                _entries.reserve(count);
+            }
+
+            void clear() {
+                _slots   = {};
+                _entries = {};
+                _mask    = 0;
+            }
+
+            auto size () const { return _entries.size(); }
+            auto bytes() const { return _slots.capacity() * sizeof(Slot) + _entries.capacity() * sizeof(Entry); }
 
         private:
-            StrStrMap _pairs;
-            StrVector _parents;
-            String    _name;
-            String    _file;
-            bool      _alreadyReloaded = false;
+            struct Slot {
+                U32 index = 0; // Entry index + 1, 0 is empty slot
+                U32 hash  = 0;
+            };
+
+            struct Entry {
+                KeyT   key;
+                ValueT value;
+            };
+
+            void rehash(U32 capacity) {
+                auto old = std::move(_slots);
+                _slots = std::vector<Slot>(capacity);
+                _mask  = capacity - 1;
+
+                for (auto& slot : old) {
+                    if (slot.index == 0)
+                        continue;
+
+                    auto i = slot.hash & _mask;
+                    while (_slots[i].index != 0)
+                        i = (i + 1) & _mask;
+                    _slots[i] = slot;
+                }
+            }
+
+            std::vector<Slot>  _slots;
+            std::vector<Entry> _entries;
+            U32                _mask = 0;
         };
 
+        /**
+         * Arena for strings built by parser
+         */
+        class StringArena {
+        public:
+            auto store(StrViewCref str) -> StrView;
+            auto bytes() const { return _size; }
+
+        private:
+            static constexpr SizeT BLOCK_SIZE = 64 * 1024;
+
+            std::vector<std::unique_ptr<char[]>> _blocks;
+            SizeT                                _blockUsed = BLOCK_SIZE;
+            SizeT                                _size      = 0;
+        };
+
+        /**
+         * Interned config names with precomputed hashes. Id 0 is reserved for 'not interned'.
+         * Interned strings are not copied, they must outlive the pool (names are views to config files)
+         */
+        class StringPool {
+        public:
+            StringPool() { _strings.push_back(Entry{}); }
+
+            auto intern(StrViewCref str) -> U32;
+            auto intern(StrViewCref str, U64 hash) -> U32;
+            auto find  (StrViewCref str) const -> U32;
+            auto find  (StrViewCref str, U64 hash) const -> U32;
+
+            auto str  (U32 id) const { return _strings[id].str; }
+            auto hash (U32 id) const { return _strings[id].hash; }
+            auto size () const { return static_cast<U32>(_strings.size()); } // With reserved id
+            auto bytes() const { return _strings.capacity() * sizeof(Entry) + _index.bytes(); }
+
+            void reserve(SizeT count) {
+                _strings.reserve(count + 1);
+                _index.reserve(count);
+            }
+
+        private:
+            struct Entry {
+                StrView str;
+                U64     hash = 0;
+            };
+
+            std::vector<Entry>      _strings;
+            FlatTable<StrView, U32> _index;
+        };
+
+        struct Section {
+            U32              name  = 0; // Interned name
+            U32              index = 0; // Index in CfgData
+            ftl::Vector<U32> parents;   // Interned names, resolved on lookup
+        };
+
+        /**
+         * Parsed config file. Parser records operations applied to config data,
+         * so unchanged file is replayed on reload without parsing
+         */
+        struct FileData {
+            enum class OpType : U8 {
+                Section, Parent, Value, GlobalValue, Include
+            };
+
+            struct Op {
+                OpType  type;
+                U32     line;
+                StrView first;  // Section, parent, key or included file path
+                StrView second; // Value
+            };
+
+            VfsFile                                  file;
+            StringArena                              arena;  // Transformed values and include paths
+            std::vector<Op>                          ops;
+            std::vector<std::pair<StrView, StrView>> derefs; // Sections and keys of dereferenced values
+        };
+
+        /**
+         * Config values snapshot
+         *
+         * Sections are stored in flat table by interned name, values are stored in one flat table
+         * by section index and interned key. Values are views to config files or to strings
+         * stored in file arena if value was transformed by parser (quotes, spaces, dereferences).
+         * Values inherited from parents are not copied, lookup walks parents depth-first in
+         * declaration order, so first parent that has key wins.
+         * Snapshot is not changed after loading, reload builds new one
+         */
         class CfgData {
+            friend class CfgCache;
         public:
-            auto getSection      (StringCref key) const  -> const Section&;
-            auto getSection      (StringCref key) -> Section&;
-            auto section         (StringCref key) -> Section&;
-            auto sectionOpt      (StringCref key) const -> std::optional<Section>;
-            bool isSectionExists (StringCref key) const;
-            auto addSection      (StringCref path, SizeT lineNum, StringCref key) -> Section&;
-
-            auto getValue      (StringCref section, StringCref key) const -> StringCref;
-            auto getValue      (StringCref section, StringCref key) -> StringRef;
-            auto value         (StringCref section, StringCref key) -> StringRef;
-            auto valueOpt      (StringCref section, StringCref key) const -> std::optional<String>;
-            bool isValueExists (StringCref section, StringCref key) const;
-            void addValue      (StringCref section, StringCref key, StringCref value);
-            void addValue      (StringCref section, StringCref key, StringRval value);
-
-            void reloadParents ();
+            auto sectionOpt      (StrViewCref name) const -> const Section*;
+            auto getSection      (StrViewCref name) const -> const Section&;
+            bool isSectionExists (StrViewCref name) const;
+
+            auto valueOpt      (const Section& section, StrViewCref key) const -> std::optional<StrView>;
+            auto valueOpt      (StrViewCref section, StrViewCref key) const -> std::optional<StrView>;
+            auto ownValueOpt   (StrViewCref section, StrViewCref key) const -> std::optional<StrView>; // Without parents
+            auto getValue      (StrViewCref section, StrViewCref key) const -> StrView;
+            bool isValueExists (StrViewCref section, StrViewCref key) const;
+
+            // Loader interface
+            void addFile   (std::shared_ptr<const FileData> file) { _files.push_back(std::move(file)); }
+            auto addSection(StringCref path, SizeT lineNum, StrViewCref name) -> U32;
+            auto section   (StrViewCref name) -> U32; // Get or create
+            void addParent (U32 section, StrViewCref parent);
+            bool addValue  (U32 section, StrViewCref key, StrViewCref value); // False if key already exists
+            bool addValue  (U32 section, U32 key, StrViewCref value);         // Key is interned name
+            void validateParents() const;
+
+            auto& files      () const { return _files; }
+            auto  valuesCount() const { return _values.size(); }
+            auto  memoryUsage() const -> SizeT;
 
             void _print_info() const;
 
         private:
-            StrSectionMap _sections;
+            auto findValue(U32 section, U32 key, U64 keyHash) const -> const StrView*;
+
+            StringPool              _pool;
+            std::vector<Section>    _sections;
+            FlatTable<U32, U32>     _sectionIndex; // Interned name -> section index
+            FlatTable<U64, StrView> _values;       // Section index << 32 | interned key -> value
+
+            std::vector<std::shared_ptr<const FileData>> _files;
+            VfsFile                                      _cache; // Names and values are views to cache if loaded from it
+        };
+
+        using CfgDataPtr = std::shared_ptr<const CfgData>;
+        using FileCache  = ska::flat_hash_map<String, std::shared_ptr<const FileData>>; // Path -> parsed file
+
+        /**
+         * Current configs and hot reload
+         *
+         * Readers take snapshot by atomic shared_ptr load, loading builds new snapshot and swaps it,
+         * so readers never see partially loaded configs and old snapshot lives while it is used.
+         * On reload only changed files and files that dereference changed values are parsed, other
+         * files are replayed from cached parse results. Parents are resolved on lookup, so they need
+         * no rebuilding. Errors on startup are fatal, reload with errors is logged and skipped: previous
+         * snapshot and parsed files are kept.
+         *
+         * Watcher thread waits for inotify events from config directories and reloads changed files.
+         * Change callbacks are called by dispatchChanges() on the caller thread.
+         *
+         * If cache path is set, snapshot is written to compiled cache after parsing and next loading
+         * of the same entries takes it from cache while source files are unchanged (see CfgCache)
+         */
+        class CfgStorage {
+        public:
+            using ChangeCallback = std::function<void(StrViewCref name, StrViewCref section)>;
+
+            auto snapshot() const -> CfgDataPtr { return std::atomic_load(&_current); }
+
+            void load  (const StrVector& entries, StringCref cachePath = {}); // Parse all files or read cache
+            void reload(const StrVector& changed); // Parse changed files, paths as in entries and includes
+
+            void startWatching();
+            void stopWatching ();
+            bool isWatching   () const { return _watching; }
+
+            auto subscribe      (StrViewCref name, StrViewCref section, ChangeCallback callback) -> U64;
+            void unsubscribe    (U64 id);
+            void dispatchChanges();
+
+        private:
+            struct Subscription {
+                String         name;
+                String         section;
+                ChangeCallback callback;
+            };
+
+            void build(const StrVector& changed, bool full);
+            void notify(const CfgData& previous, const CfgData& current);
+            void updateWatches();
+            void watchLoop();
+
+            CfgDataPtr _current = std::make_shared<const CfgData>();
+            std::mutex _buildMutex;
+            StrVector  _entries;
+            String     _cachePath;
+            FileCache  _files;   // Empty if loaded from cache
+            StrVector  _sources; // All files of current snapshot
+
+            std::mutex                            _subsMutex;
+            ska::flat_hash_map<U64, Subscription> _subs;
+            std::vector<U64>                      _changed;
+            U64                                   _lastSubId = 0;
+
+            std::thread                                                     _watcher;
+            std::atomic<bool>                                               _watching = false;
+            std::atomic<bool>                                               _stop     = false;
+            int                                                             _inotify  = -1;
+            ska::flat_hash_map<int, std::vector<std::pair<String, String>>> _watches; // wd -> file names and paths, watcher thread only
 
             // Singleton impl
         public:
-            CfgData(const CfgData&) = delete;
-            CfgData& operator= (const CfgData&) = delete;
+            CfgStorage(const CfgStorage&) = delete;
+            CfgStorage& operator= (const CfgStorage&) = delete;
 
-            static CfgData& instance() {
-                static CfgData inst;
+            static CfgStorage& instance() {
+                static CfgStorage inst;
                 return inst;
             }
 
         private:
-            CfgData()  = default;
-            ~CfgData() = default;
+            CfgStorage() = default;
+            ~CfgStorage() { stopWatching(); }
         };
 
-        inline CfgData& cfgData() { return CfgData::instance(); }
+        inline CfgStorage& cfgStorage()  { return CfgStorage::instance(); }
+        inline CfgDataPtr  cfgSnapshot() { return cfgStorage().snapshot(); }
     } // namespace cfg_detls
 
 
@@ -214,7 +479,8 @@ namespace base {
         }
         template <typename T>
         static T force_read_ie(StrViewCref name, StrViewCref section, const T& def_val) {
-            auto str = cfg_detls::cfgData().valueOpt(section, name);
+            auto data = cfg_detls::cfgSnapshot();
+            auto str  = data->valueOpt(section, name);
             if (str)
                 return superCast<T>(*str, name, section);
             else
@@ -222,9 +488,10 @@ namespace base {
         }
         template <typename T1, typename T2, typename... Ts>
         static auto force_read_ie(StrViewCref name, StrViewCref section, const std::tuple<T1, T2, Ts...>& def_vals) {
-            auto str = cfg_detls::cfgData().valueOpt(section, name);
+            auto data = cfg_detls::cfgSnapshot();
+            auto str  = data->valueOpt(section, name);
             if (str)
-                return superCast<T1, T2, Ts...>(*str, name, section);
+                return readTuple<T1, T2, Ts...>(*str, name, section);
             else
                 return def_vals;
         }
@@ -240,8 +507,8 @@ namespace base {
         }
         template <typename T>
         static T force_read_ive(StrViewCref name, StrViewCref section, const T& def_val) {
-            auto sect = cfg_detls::cfgData().getSection(section);
-            auto str  = sect.valueOpt(name);
+            auto data = cfg_detls::cfgSnapshot();
+            auto str  = data->valueOpt(data->getSection(section), name);
             if (str)
                 return superCast<T>(*str, name, section);
             else
@@ -249,10 +516,10 @@ namespace base {
         }
         template <typename T1, typename T2, typename... Ts>
         static auto force_read_ive(StrViewCref name, StrViewCref section, const std::tuple<T1, T2, Ts...>& def_vals) {
-            auto sect = cfg_detls::cfgData().getSection(section);
-            auto str  = sect.valueOpt(name);
+            auto data = cfg_detls::cfgSnapshot();
+            auto str  = data->valueOpt(data->getSection(section), name);
             if (str)
-                return superCast<T1, T2, Ts...>(*str, name, section);
+                return readTuple<T1, T2, Ts...>(*str, name, section);
             else
                 return def_vals;
         }
@@ -261,16 +528,14 @@ namespace base {
 
         template <typename T>
         static T force_read(StrViewCref name, StrViewCref section = cfg_detls::GLOBAL_NAMESPACE) {
-            return superCast<T>(readString(name, section), name, section);
+            auto data = cfg_detls::cfgSnapshot();
+            return superCast<T>(data->getValue(section, name), name, section);
         }
 
         template <typename T1, typename T2, typename... Ts>
         static auto force_read(StrViewCref name, StrViewCref section = cfg_detls::GLOBAL_NAMESPACE) {
-            auto str = readString(name, section);
-            auto vec = readerUnpackMulti(name, section, str, sizeof...(Ts) + 2);
-            auto is  = std::make_index_sequence<sizeof...(Ts) + 2>();
-
-            return readTupleImpl<T1, T2, Ts...>(vec, name, section, is);
+            auto data = cfg_detls::cfgSnapshot();
+            return readTuple<T1, T2, Ts...>(data->getValue(section, name), name, section);
         }
 
 
@@ -280,9 +545,12 @@ namespace base {
     private:
 
 
-        // Basic read method
-        SIA readString(StrViewCref name, StrViewCref section) -> ftl::String& {
-            return cfg_detls::cfgData().getValue(section, name);
+        template <typename T1, typename T2, typename... Ts>
+        SIA readTuple(StrViewCref str, StrViewCref name, StrViewCref section) {
+            auto vec = readerUnpackMulti(name, section, str, sizeof...(Ts) + 2);
+            auto is  = std::make_index_sequence<sizeof...(Ts) + 2>();
+
+            return readTupleImpl<T1, T2, Ts...>(vec, name, section, is);
         }
 
         //
@@ -314,8 +582,7 @@ namespace base {
         template <typename T>
         SIA superCast(StrViewCref str, StrViewCref, StrViewCref)
         -> std::enable_if_t<concepts::numbers<T>, T> {
-            auto nullTerminatedStr = ftl::String(str);
-            return aton<T>(nullTerminatedStr.c_str());
+            return aton<T>(str);
         }
 
         // String :)
@@ -431,6 +698,44 @@ namespace base {
             cfg_detls::cfg_state().clearCfgEntries();
         }
 
+        /**
+         * Set path to compiled configs cache
+         * @param path - path to cache file, empty path disables cache
+         */
+        inline void setCachePath(const ftl::String& path) {
+            cfg_detls::cfg_state().setCachePath(path);
+        }
+
+        /**
+         * Parse changed config files again, unchanged files are reused.
+         * Values read as string_view are valid until the next reload
+         * @param changed - paths of changed files as in entries and include directives
+         */
+        inline void reload(const ftl::Vector<ftl::String>& changed) {
+            cfg_detls::cfgStorage().reload(changed);
+        }
+
+        /**
+         * Subscribe to value changes. Callback is called by dispatchChanges() after reload that changed the value
+         * @param name - value name
+         * @param section - section name
+         * @return subscription id
+         */
+        inline auto subscribe(StrViewCref name, StrViewCref section, cfg_detls::CfgStorage::ChangeCallback callback) {
+            return cfg_detls::cfgStorage().subscribe(name, section, std::move(callback));
+        }
+
+        inline void unsubscribe(U64 id) {
+            cfg_detls::cfgStorage().unsubscribe(id);
+        }
+
+        /**
+         * Call callbacks of changed values on the current thread
+         */
+        inline void dispatchChanges() {
+            cfg_detls::cfgStorage().dispatchChanges();
+        }
+
         /**
          * Get instance of ConfigManager
          * @return reference to ConfigManager
@@ -696,6 +1001,66 @@ namespace base {
             else
                 return read<Ts...>(name, section);
         }
+
+        /**
+         * Cached config value
+         *
+         * Value is read and parsed on first access and cached until configs are reloaded,
+         * so access costs one generation check. Not thread safe, use separate keys for threads
+         * @tparam Ts - type (types) of value, tuple is cached if more one types passed
+         */
+        template <typename... Ts>
+        class Key {
+        public:
+            using ValueT = decltype(ConfigManager::force_read<Ts...>(
+                    std::declval<std::string_view>(), std::declval<std::string_view>()));
+
+            /**
+             * @param name - value name
+             * @param section - section name. If unused - perform read from global namespace
+             */
+            Key(StrViewCref name, StrViewCref section = cfg_detls::GLOBAL_NAMESPACE):
+                _name(name), _section(section) {}
+
+            /**
+             * Key with default value, used if value or section doesn't exist
+             */
+            Key(StrViewCref name, StrViewCref section, const ValueT& def_val):
+                _name(name), _section(section), _default(def_val) {}
+
+            const ValueT& get() const {
+                // Loaded before read: value of reload finished during read is refreshed on next access
+                auto generation = cfg_detls::cfg_generation.load(std::memory_order_acquire);
+
+                if (_generation != generation || !_value) {
+                    auto name    = std::string_view(_name.data(), _name.size());
+                    auto section = std::string_view(_section.data(), _section.size());
+
+                    if (_default)
+                        _value.emplace(read_ie<Ts...>(name, section, *_default));
+                    else
+                        _value.emplace(read<Ts...>(name, section));
+
+                    // Configs could be loaded by this read
+                    _generation = generation ? generation : cfg_detls::cfg_generation.load(std::memory_order_acquire);
+                }
+
+                return *_value;
+            }
+
+            const ValueT& operator* () const { return get(); }
+            const ValueT* operator->() const { return &get(); }
+
+            auto& name   () const { return _name; }
+            auto& section() const { return _section; }
+
+        private:
+            ftl::String                   _name;
+            ftl::String                   _section;
+            std::optional<ValueT>         _default;
+            mutable std::optional<ValueT> _value;
+            mutable U32                   _generation = 0;
+        };
     }
 
 } // namespace base
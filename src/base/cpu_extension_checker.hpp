@@ -4,12 +4,19 @@
 
 #ifdef _WIN32
     #define cpuid(info, x)    __cpuidex(info, x, 0)
+    #define xgetbv(index)     _xgetbv(index)
 #else
     #include <cpuid.h>
 
-    void cpuid(int info[4], int InfoType){
+    inline void cpuid(int info[4], int InfoType){
         __cpuid_count(InfoType, 0, info[0], info[1], info[2], info[3]);
     }
+
+    inline unsigned long long xgetbv(unsigned index) {
+        unsigned eax, edx;
+        __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(index));
+        return (static_cast<unsigned long long>(edx) << 32) | eax;
+    }
 #endif
 
 #include "defines.hpp"
@@ -56,6 +63,10 @@ namespace base {
         bool HW_AVX512IFMA = false; //  AVX512 Integer 52-bit Fused Multiply-Add
         bool HW_AVX512VBMI = false; //  AVX512 Vector Byte Manipulation Instructions
 
+        //  OS support (registers are saved on context switch)
+        bool OS_AVX    = false;
+        bool OS_AVX512 = false;
+
 
     DE_MARK_AS_SINGLETON(CpuExtensionsChecker);
     };
@@ -88,6 +99,13 @@ namespace base {
             HW_FMA3   = (info[2] & ((int)1 << 12)) != 0;
 
             HW_RDRAND = (info[2] & ((int)1 << 30)) != 0;
+
+            bool osxsave = (info[2] & ((int)1 << 27)) != 0;
+            if (osxsave) {
+                auto xcr0 = xgetbv(0);
+                OS_AVX    = (xcr0 & 0x06) == 0x06; // XMM, YMM
+                OS_AVX512 = (xcr0 & 0xE6) == 0xE6; // XMM, YMM, opmask, ZMM
+            }
         }
         if (nIds >= 0x00000007){
             cpuid(info,0x00000007);
@@ -119,7 +137,7 @@ namespace base {
         }
     }
 
-    const auto& cpu_extensions_checker() {
+    inline const auto& cpu_extensions_checker() {
         return CpuExtensionsChecker::instance();
     }
 }
\ No newline at end of file
@@ -1,4 +1,10 @@
 #include "files.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
 #include "assert.hpp"
 #include "filesystem.hpp"
 
@@ -46,6 +52,96 @@ auto base::FileReader::readAllToString() -> ftl::String {
     return std::move(str);
 }
 
+namespace {
+    int madviseAccess(base::MappedFile::Access access) {
+        switch (access) {
+            case base::MappedFile::Access::Sequential: return MADV_SEQUENTIAL;
+            case base::MappedFile::Access::Random:     return MADV_RANDOM;
+            case base::MappedFile::Access::WillNeed:   return MADV_WILLNEED;
+            default:                                   return MADV_NORMAL;
+        }
+    }
+}
+
+base::MappedFile::MappedFile(const std::string_view& name, Access access) {
+    if (!map(name, access))
+        RABORTF("Can't map file: \'{}\'", name);
+}
+
+base::MappedFile::~MappedFile() {
+    unmap();
+}
+
+base::MappedFile::MappedFile(MappedFile&& mf) noexcept: _data(mf._data), _size(mf._size) {
+    mf._data = nullptr;
+    mf._size = 0;
+}
+
+auto base::MappedFile::operator=(MappedFile&& mf) noexcept -> MappedFile& {
+    if (this != &mf) {
+        unmap();
+        _data = mf._data;
+        _size = mf._size;
+        mf._data = nullptr;
+        mf._size = 0;
+    }
+    return *this;
+}
+
+auto base::MappedFile::openOpt(const std::string_view& name, Access access) -> std::optional<MappedFile> {
+    auto file = MappedFile();
+
+    if (!file.map(name, access))
+        return std::nullopt;
+
+    return std::move(file);
+}
+
+bool base::MappedFile::map(const std::string_view& name, Access access) {
+    auto fd = open(std::string(name).c_str(), O_RDONLY);
+    if (fd == -1)
+        return false;
+
+    struct stat st = {};
+    auto rc = fstat(fd, &st) == 0;
+
+    if (rc && st.st_size > 0) {
+        auto addr = mmap(nullptr, static_cast<SizeT>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (addr != MAP_FAILED) {
+            _data = static_cast<const Byte*>(addr);
+            _size = static_cast<SizeT>(st.st_size);
+            advise(access);
+        } else
+            rc = false;
+    }
+
+    // Mapping stays valid after close
+    close(fd);
+    return rc;
+}
+
+void base::MappedFile::unmap() {
+    if (_data)
+        munmap(const_cast<Byte*>(_data), _size);
+
+    _data = nullptr;
+    _size = 0;
+}
+
+void base::MappedFile::advise(Access access, SizeT offset, SizeT size) {
+    if (!_data || offset >= _size)
+        return;
+
+    // Range start must be page aligned
+    auto page  = static_cast<SizeT>(sysconf(_SC_PAGESIZE));
+    auto start = offset & ~(page - 1);
+    auto end   = size > _size - offset ? _size : offset + size;
+
+    madvise(const_cast<Byte*>(_data) + start, end - start, madviseAccess(access));
+}
+
+
 void base::writeBytesToFile(const ftl::String& path, const ftl::Vector<Byte>& bytes) {
     auto fw = FileWriter(path);
     fw.write(bytes);
@@ -2,9 +2,12 @@
 #define DECAYENGINE_FILES_HPP
 
 #include <iostream>
+#include <algorithm>
+#include <limits>
 #include <fstream>
 #include <mutex>
 #include <string_view>
+#include <optional>
 
 #include "concepts.hpp"
 #include "serialization.hpp"
@@ -84,6 +87,90 @@ namespace base {
     };
 
 
+    /**
+     * Non-owning view to contiguous bytes
+     */
+    class BytesView {
+    public:
+        static constexpr SizeT npos = std::numeric_limits<SizeT>::max();
+
+        BytesView() = default;
+        BytesView(const Byte* data, SizeT size): _data(data), _size(size) {}
+
+        auto data () const { return _data; }
+        auto size () const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        auto begin() const { return _data; }
+        auto end  () const { return _data + _size; }
+
+        auto& operator[](SizeT i) const { return _data[i]; }
+
+        auto subview(SizeT offset, SizeT count = npos) const -> BytesView {
+            offset = std::min(offset, _size);
+            return BytesView(_data + offset, std::min(count, _size - offset));
+        }
+
+    private:
+        const Byte* _data = nullptr;
+        SizeT       _size = 0;
+    };
+
+
+    /**
+     * Read-only memory mapped file
+     *
+     * Views are valid while MappedFile is alive. Empty file has empty views
+     */
+    class MappedFile {
+    public:
+        enum class Access {
+            Normal = 0, Sequential, Random, WillNeed
+        };
+
+        MappedFile() = default;
+        MappedFile(const std::string_view& name, Access access = Access::Normal); // Abort if can't map
+        ~MappedFile();
+
+        MappedFile(MappedFile&& mf) noexcept;
+        MappedFile& operator=(MappedFile&& mf) noexcept;
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        /**
+         * Map file if it exists
+         * @return nullopt if file can't be opened or mapped
+         */
+        static auto openOpt(const std::string_view& name, Access access = Access::Normal) -> std::optional<MappedFile>;
+
+        /**
+         * Hint kernel how the range will be accessed
+         */
+        void advise(Access access, SizeT offset = 0, SizeT size = BytesView::npos);
+
+        auto bytes(SizeT offset = 0, SizeT size = BytesView::npos) const -> BytesView {
+            return BytesView(_data, _size).subview(offset, size);
+        }
+
+        auto view(SizeT offset = 0, SizeT size = BytesView::npos) const -> std::string_view {
+            auto b = bytes(offset, size);
+            return std::string_view(reinterpret_cast<const char*>(b.data()), b.size());
+        }
+
+        auto data () const { return _data; }
+        auto size () const { return _size; }
+        bool empty() const { return _size == 0; }
+
+    protected:
+        bool map(const std::string_view& name, Access access);
+        void unmap();
+
+        const Byte* _data = nullptr;
+        SizeT       _size = 0;
+    };
+
+
     template <SizeT _Size>
     inline void writeBytesToFile(const ftl::String& path, const ftl::Array<Byte, _Size>& bytes) {
         auto fw = FileWriter(path);
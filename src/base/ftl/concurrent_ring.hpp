@@ -0,0 +1,504 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "../baseTypes.hpp"
+#include "../assert.hpp"
+
+namespace ftl {
+
+
+    namespace concurrent_ring_impl {
+        constexpr SizeT CACHE_LINE = 64;
+
+        inline void check_capacity(SizeT capacity) {
+            RASSERTF(capacity && (capacity & (capacity - 1)) == 0,
+                     "Capacity of concurrent ring must be power of two ({})", capacity);
+        }
+
+        // Spin a bit on full / empty ring, then give time slice away
+        class Backoff {
+        public:
+            void operator()() {
+                if (_spins < 64)
+                    ++_spins;
+                else
+                    std::this_thread::yield();
+            }
+
+        private:
+            U32 _spins = 0;
+        };
+
+        template <typename T>
+        struct alignas(T) Slot {
+            T*       ptr()       { return std::launder(reinterpret_cast<T*>(data)); }
+            const T* ptr() const { return std::launder(reinterpret_cast<const T*>(data)); }
+
+            Byte data[sizeof(T)];
+        };
+
+        // Iterator over published values of SpscRing, positions are free-running as ring indices
+        template <typename T>
+        class SpscIter {
+            using RCT   = std::remove_const_t<T>;
+            using SlotT = Slot<RCT>;
+
+        public:
+            using iterator_category = std::random_access_iterator_tag;
+            using value_type        = RCT;
+            using difference_type   = PtrDiff;
+            using pointer           = T*;
+            using reference         = T&;
+
+            SpscIter(SlotT* slots, SizeT mask, SizeT pos): _slots(slots), _mask(mask), _pos(pos) {}
+
+            T& operator* () const { return *_slots[_pos & _mask].ptr(); }
+            T* operator->() const { return _slots[_pos & _mask].ptr(); }
+            T& operator[](PtrDiff n) const { return *_slots[(_pos + n) & _mask].ptr(); }
+
+            bool operator== (const SpscIter& it) const { return _pos == it._pos; }
+            bool operator!= (const SpscIter& it) const { return _pos != it._pos; }
+            bool operator<  (const SpscIter& it) const { return static_cast<PtrDiff>(_pos - it._pos) < 0; }
+
+            SpscIter& operator++()    { ++_pos; return *this; }
+            SpscIter& operator--()    { --_pos; return *this; }
+            SpscIter  operator++(int) { auto tmp = *this; ++_pos; return tmp; }
+            SpscIter  operator--(int) { auto tmp = *this; --_pos; return tmp; }
+
+            SpscIter& operator+=(PtrDiff val)       { _pos += val; return *this; }
+            SpscIter& operator-=(PtrDiff val)       { _pos -= val; return *this; }
+            SpscIter  operator+ (PtrDiff val) const { return SpscIter(_slots, _mask, _pos + val); }
+            SpscIter  operator- (PtrDiff val) const { return SpscIter(_slots, _mask, _pos - val); }
+
+            PtrDiff operator-(const SpscIter& it) const { return static_cast<PtrDiff>(_pos - it._pos); }
+
+        private:
+            SlotT* _slots;
+            SizeT  _mask;
+            SizeT  _pos;
+        };
+    }
+
+
+    /**
+     * Bounded wait-free single-producer single-consumer ring
+     *
+     * Indices are free-running and masked on access. Each side keeps cached copy of other side's index
+     * and reloads it only when ring looks full (or empty), so shared cache lines are touched once per
+     * capacity elements in the best case. Batch operations publish whole range with one store.
+     *
+     * Consumer may iterate values published so far with begin() / end() as ftl::Ring and release
+     * them with pop_front(count): producer doesn't touch slots until they are popped
+     */
+    template <typename Type>
+    class SpscRing {
+        using SlotT  = concurrent_ring_impl::Slot<Type>;
+        using IterT  = concurrent_ring_impl::SpscIter<Type>;
+        using CIterT = concurrent_ring_impl::SpscIter<const Type>;
+        static constexpr auto CACHE_LINE = concurrent_ring_impl::CACHE_LINE;
+
+    public:
+        using value_type = Type;
+
+        // Capacity must be a power of two
+        explicit SpscRing(SizeT capacity): _slots(new SlotT[capacity]), _mask(capacity - 1) {
+            concurrent_ring_impl::check_capacity(capacity);
+        }
+
+        ~SpscRing() {
+            auto head = _head.load(std::memory_order_relaxed);
+            for (auto i = _tail.load(std::memory_order_relaxed); i != head; ++i)
+                _slots[i & _mask].ptr()->~Type();
+        }
+
+        SpscRing(const SpscRing&)            = delete;
+        SpscRing& operator=(const SpscRing&) = delete;
+
+
+        ////////////////////////////// Producer
+
+        /**
+         * Construct value in place
+         * @return false if ring is full
+         */
+        template <typename... Args>
+        bool try_emplace_back(Args&&... args) {
+            auto head = _head.load(std::memory_order_relaxed);
+
+            if (head - _cached_tail > _mask) {
+                _cached_tail = _tail.load(std::memory_order_acquire);
+                if (head - _cached_tail > _mask)
+                    return false;
+            }
+
+            new (_slots[head & _mask].data) Type(std::forward<Args>(args)...);
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_push_back(const Type& value) { return try_emplace_back(value); }
+        bool try_push_back(Type&& value)      { return try_emplace_back(std::move(value)); }
+
+        /**
+         * Push as many values from [first, last) as fit
+         * @return count of pushed values
+         */
+        template <typename IterT>
+        SizeT try_push_back(IterT first, IterT last) {
+            auto head  = _head.load(std::memory_order_relaxed);
+            auto count = static_cast<SizeT>(std::distance(first, last));
+
+            if (capacity() - (head - _cached_tail) < count)
+                _cached_tail = _tail.load(std::memory_order_acquire);
+
+            count = std::min(count, capacity() - (head - _cached_tail));
+
+            for (SizeT i = 0; i < count; ++i, ++first)
+                new (_slots[(head + i) & _mask].data) Type(*first);
+
+            if (count)
+                _head.store(head + count, std::memory_order_release);
+
+            return count;
+        }
+
+        // Wait until there is free space
+        template <typename... Args>
+        SpscRing& emplace_back(Args&&... args) {
+            auto backoff = concurrent_ring_impl::Backoff();
+            while (!try_emplace_back(std::forward<Args>(args)...))
+                backoff();
+            return *this;
+        }
+
+        SpscRing& push_back(const Type& value) { return emplace_back(value); }
+        SpscRing& push_back(Type&& value)      { return emplace_back(std::move(value)); }
+
+
+        ////////////////////////////// Consumer
+
+        // Oldest value or nullptr if ring is empty. Stays valid until pop_front
+        Type* front() {
+            auto tail = _tail.load(std::memory_order_relaxed);
+
+            if (tail == _cached_head) {
+                _cached_head = _head.load(std::memory_order_acquire);
+                if (tail == _cached_head)
+                    return nullptr;
+            }
+
+            return _slots[tail & _mask].ptr();
+        }
+
+        // Ring must not be empty: call after front() returned value
+        void pop_front() {
+            auto tail = _tail.load(std::memory_order_relaxed);
+            ASSERT(tail != _cached_head);
+
+            _slots[tail & _mask].ptr()->~Type();
+            _tail.store(tail + 1, std::memory_order_release);
+        }
+
+        // Release count oldest values, e.g. after iteration from begin()
+        void pop_front(SizeT count) {
+            auto tail = _tail.load(std::memory_order_relaxed);
+
+            if (_cached_head - tail < count)
+                _cached_head = _head.load(std::memory_order_acquire);
+            ASSERT(count <= _cached_head - tail);
+
+            for (SizeT i = 0; i < count; ++i)
+                _slots[(tail + i) & _mask].ptr()->~Type();
+
+            _tail.store(tail + count, std::memory_order_release);
+        }
+
+        // Values published so far, from oldest. Consumer only, end() is taken once per iteration
+        auto begin ()       -> IterT  { return  IterT(_slots.get(), _mask, _tail.load(std::memory_order_relaxed)); }
+        auto end   ()       -> IterT  { return  IterT(_slots.get(), _mask, _head.load(std::memory_order_acquire)); }
+        auto begin () const -> CIterT { return CIterT(_slots.get(), _mask, _tail.load(std::memory_order_relaxed)); }
+        auto end   () const -> CIterT { return CIterT(_slots.get(), _mask, _head.load(std::memory_order_acquire)); }
+        auto cbegin() const -> CIterT { return begin(); }
+        auto cend  () const -> CIterT { return end(); }
+
+        /**
+         * Move oldest value to out
+         * @return false if ring is empty
+         */
+        bool try_pop_front(Type& out) {
+            auto value = front();
+            if (!value)
+                return false;
+
+            out = std::move(*value);
+            pop_front();
+            return true;
+        }
+
+        /**
+         * Move up to max oldest values to output iterator
+         * @return count of popped values
+         */
+        template <typename OutIterT>
+        SizeT try_pop_front(OutIterT out, SizeT max) {
+            auto tail = _tail.load(std::memory_order_relaxed);
+
+            if (_cached_head - tail < max)
+                _cached_head = _head.load(std::memory_order_acquire);
+
+            auto count = std::min(max, _cached_head - tail);
+
+            for (SizeT i = 0; i < count; ++i, ++out) {
+                auto value = _slots[(tail + i) & _mask].ptr();
+                *out = std::move(*value);
+                value->~Type();
+            }
+
+            if (count)
+                _tail.store(tail + count, std::memory_order_release);
+
+            return count;
+        }
+
+
+        ////////////////////////////// Any thread, approximate while ring is used
+
+        SizeT size() const {
+            auto tail = _tail.load(std::memory_order_acquire);
+            return _head.load(std::memory_order_acquire) - tail;
+        }
+
+        bool  empty()    const { return size() == 0; }
+        SizeT capacity() const { return _mask + 1; }
+
+    private:
+        std::unique_ptr<SlotT[]> _slots;
+        SizeT                    _mask;
+
+        alignas(CACHE_LINE) std::atomic<SizeT> _head        = 0; // Written by producer
+        SizeT                                  _cached_tail = 0;
+
+        alignas(CACHE_LINE) std::atomic<SizeT> _tail        = 0; // Written by consumer
+        SizeT                                  _cached_head = 0;
+    };
+
+
+    /**
+     * Bounded lock-free multi-producer multi-consumer ring (D. Vyukov's algorithm)
+     *
+     * Every slot has sequence number telling which lap it is free or filled for, so producers and
+     * consumers only contend on their own position counter. Slots are padded to cache line to keep
+     * neighbouring producers from sharing it. Batch operations claim a range of ready slots with one CAS.
+     *
+     * There are no iterators: any consumer may take and destroy value while other one reads it,
+     * values are only moved out by try_pop_front
+     */
+    template <typename Type>
+    class MpmcRing {
+        static constexpr auto CACHE_LINE = concurrent_ring_impl::CACHE_LINE;
+
+        struct alignas(CACHE_LINE) Cell {
+            std::atomic<SizeT>               sequence;
+            concurrent_ring_impl::Slot<Type> slot;
+        };
+
+    public:
+        using value_type = Type;
+
+        // Capacity must be a power of two
+        explicit MpmcRing(SizeT capacity): _cells(new Cell[capacity]), _mask(capacity - 1) {
+            concurrent_ring_impl::check_capacity(capacity);
+
+            for (SizeT i = 0; i < capacity; ++i)
+                _cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~MpmcRing() {
+            auto end = _enqueue_pos.load(std::memory_order_relaxed);
+            for (auto i = _dequeue_pos.load(std::memory_order_relaxed); i != end; ++i)
+                _cells[i & _mask].slot.ptr()->~Type();
+        }
+
+        MpmcRing(const MpmcRing&)            = delete;
+        MpmcRing& operator=(const MpmcRing&) = delete;
+
+
+        ////////////////////////////// Producers
+
+        /**
+         * Construct value in place
+         * @return false if ring is full
+         */
+        template <typename... Args>
+        bool try_emplace_back(Args&&... args) {
+            auto pos  = _enqueue_pos.load(std::memory_order_relaxed);
+            auto cell = claim<0>(_enqueue_pos, pos);
+
+            if (!cell)
+                return false;
+
+            new (cell->slot.data) Type(std::forward<Args>(args)...);
+            cell->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool try_push_back(const Type& value) { return try_emplace_back(value); }
+        bool try_push_back(Type&& value)      { return try_emplace_back(std::move(value)); }
+
+        /**
+         * Push as many values from [first, last) as there are free slots in a row
+         * @return count of pushed values
+         */
+        template <typename IterT>
+        SizeT try_push_back(IterT first, IterT last) {
+            auto max = static_cast<SizeT>(std::distance(first, last));
+            auto pos = SizeT(0);
+            auto count = claim_range<0>(_enqueue_pos, pos, max);
+
+            for (SizeT i = 0; i < count; ++i, ++first) {
+                auto& cell = _cells[(pos + i) & _mask];
+                new (cell.slot.data) Type(*first);
+                cell.sequence.store(pos + i + 1, std::memory_order_release);
+            }
+
+            return count;
+        }
+
+        // Wait until there is free slot
+        template <typename... Args>
+        MpmcRing& emplace_back(Args&&... args) {
+            auto backoff = concurrent_ring_impl::Backoff();
+            while (!try_emplace_back(std::forward<Args>(args)...))
+                backoff();
+            return *this;
+        }
+
+        MpmcRing& push_back(const Type& value) { return emplace_back(value); }
+        MpmcRing& push_back(Type&& value)      { return emplace_back(std::move(value)); }
+
+
+        ////////////////////////////// Consumers
+
+        /**
+         * Move oldest value to out
+         * @return false if ring is empty or oldest value is still being written
+         */
+        bool try_pop_front(Type& out) {
+            auto pos  = _dequeue_pos.load(std::memory_order_relaxed);
+            auto cell = claim<1>(_dequeue_pos, pos);
+
+            if (!cell)
+                return false;
+
+            release(*cell, pos, out);
+            return true;
+        }
+
+        /**
+         * Move up to max oldest values to output iterator
+         * @return count of popped values
+         */
+        template <typename OutIterT>
+        SizeT try_pop_front(OutIterT out, SizeT max) {
+            auto pos   = SizeT(0);
+            auto count = claim_range<1>(_dequeue_pos, pos, max);
+
+            for (SizeT i = 0; i < count; ++i, ++out)
+                release(_cells[(pos + i) & _mask], pos + i, *out);
+
+            return count;
+        }
+
+
+        ////////////////////////////// Any thread, approximate while ring is used
+
+        SizeT size() const {
+            auto dequeue = _dequeue_pos.load(std::memory_order_acquire);
+            auto enqueue = _enqueue_pos.load(std::memory_order_acquire);
+            return enqueue > dequeue ? enqueue - dequeue : 0;
+        }
+
+        bool  empty()    const { return size() == 0; }
+        SizeT capacity() const { return _mask + 1; }
+
+    private:
+        /**
+         * Slot at pos is ready for producers when its sequence is pos (Lag = 0),
+         * for consumers when it is pos + 1 (Lag = 1)
+         */
+        template <SizeT Lag>
+        Cell* claim(std::atomic<SizeT>& counter, SizeT& pos) {
+            while (true) {
+                auto cell = &_cells[pos & _mask];
+                auto seq  = cell->sequence.load(std::memory_order_acquire);
+                auto diff = static_cast<PtrDiff>(seq - (pos + Lag));
+
+                if (diff == 0) {
+                    if (counter.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                        return cell;
+                }
+                else if (diff < 0)
+                    return nullptr;
+                else
+                    pos = counter.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Count of ready slots in a row starting from pos
+        template <SizeT Lag>
+        SizeT ready_count(SizeT pos, SizeT max) const {
+            auto count = SizeT(0);
+            while (count < max &&
+                   _cells[(pos + count) & _mask].sequence.load(std::memory_order_acquire) == pos + count + Lag)
+                ++count;
+            return count;
+        }
+
+        // Nobody else can take slots past pos while CAS from pos is possible, so ready run is stable
+        template <SizeT Lag>
+        SizeT claim_range(std::atomic<SizeT>& counter, SizeT& pos, SizeT max) {
+            pos = counter.load(std::memory_order_relaxed);
+
+            while (max) {
+                if (auto count = ready_count<Lag>(pos, max)) {
+                    if (counter.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed))
+                        return count;
+                    continue;
+                }
+
+                // Ring is full (empty) or first slot was taken by someone else and pos is stale
+                auto seq = _cells[pos & _mask].sequence.load(std::memory_order_acquire);
+                if (static_cast<PtrDiff>(seq - (pos + Lag)) < 0)
+                    return 0;
+
+                pos = counter.load(std::memory_order_relaxed);
+            }
+
+            return 0;
+        }
+
+        template <typename OutT>
+        void release(Cell& cell, SizeT pos, OutT&& out) {
+            auto value = cell.slot.ptr();
+            out = std::move(*value);
+            value->~Type();
+            cell.sequence.store(pos + _mask + 1, std::memory_order_release);
+        }
+
+    private:
+        std::unique_ptr<Cell[]> _cells;
+        SizeT                   _mask;
+
+        alignas(CACHE_LINE) std::atomic<SizeT> _enqueue_pos = 0;
+        alignas(CACHE_LINE) std::atomic<SizeT> _dequeue_pos = 0;
+    };
+
+} // namespace ftl
@@ -1,168 +1,197 @@
+#include <algorithm>
+
 #include "string.hpp"
+#include "string_scan.hpp"
 #include "vector.hpp"
 
-#define SPLIT_VIEW_IMPL(CHAR_T)                                        \
-template <>                                                            \
-auto StringBase<CHAR_T>::splitView(CHAR_T c) const -> Vector<StrView> {\
-    Vector<StrView> vec;                                               \
-    StrView data = _str_v;                                             \
-    SizeType start = 0;                                                \
-                                                                       \
-    for (SizeType i = 0; i < data.size(); ++i) {                       \
-        if (data[i] == c) {                                            \
-            if (start != i) {                                          \
-                vec.emplace_back(data.substr(start, i - start));       \
-            }                                                          \
-            start = i + 1;                                             \
-        }                                                              \
-    }                                                                  \
-    if (start != data.size())                                          \
-        vec.emplace_back(data.substr(start, data.size()));             \
-    return std::move(vec);                                             \
+namespace {
+    // Char8 strings are scanned by vectorized kernels
+    template <typename CharT>
+    auto find_char(const CharT* p, const CharT* end, CharT c) -> const CharT* {
+        if constexpr (std::is_same_v<CharT, Char8>)
+            return ftl::str_scan::find_char(p, end, c);
+        else
+            return std::find(p, end, c);
+    }
+
+    template <typename CharT>
+    auto find_any(const CharT* p, const CharT* end, std::initializer_list<CharT> l) -> const CharT* {
+        if constexpr (std::is_same_v<CharT, Char8>)
+            return ftl::str_scan::find_any(p, end, std::string_view(l.begin(), l.size()));
+        else
+            return std::find_first_of(p, end, l.begin(), l.end());
+    }
+
+    template <typename CharT>
+    auto find_str(const CharT* p, const CharT* end, std::basic_string_view<CharT> str) -> const CharT* {
+        if (str.empty())
+            return end;
+
+        if constexpr (std::is_same_v<CharT, Char8>)
+            return ftl::str_scan::find_str(p, end, str);
+        else
+            return std::search(p, end, str.begin(), str.end());
+    }
+
+    /**
+     * Call emit(first, last) for each part between delimiters, emit returns false to stop.
+     * Part after last delimiter is never empty
+     */
+    template <typename CharT, typename FindT, typename EmitT>
+    void split_parts(std::basic_string_view<CharT> data, SizeT delimSize, bool createNullStrs,
+                     FindT find, EmitT emit) {
+        auto p   = data.data();
+        auto end = data.data() + data.size();
+
+        while (p != end) {
+            auto delim = find(p, end);
+            if (delim == end)
+                break;
+
+            if ((createNullStrs || delim != p) && !emit(p, delim))
+                return;
+
+            p = delim + delimSize;
+        }
+
+        if (p != end)
+            emit(p, end);
+    }
+
+    // Vector and strings in it use string allocator
+    template <typename VectorT, typename CharT, typename AllocT, typename FindT>
+    auto split_to_vector(std::basic_string_view<CharT> data, SizeT delimSize, bool createNullStrs,
+                         const AllocT& alloc, FindT find) {
+        auto vec = VectorT(alloc);
+
+        split_parts(data, delimSize, createNullStrs, find, [&](const CharT* first, const CharT* last) {
+            vec.emplace_back(std::basic_string_view<CharT>(first, static_cast<SizeT>(last - first)));
+            return true;
+        });
+
+        return vec;
+    }
+
+    // Last view keeps the rest of string if buffer is full
+    template <typename CharT, typename FindT>
+    auto split_to_buffer(std::basic_string_view<CharT> data, SizeT delimSize, bool createNullStrs, FindT find,
+                         std::basic_string_view<CharT>* out, SizeT capacity) {
+        auto count = SizeT(0);
+        auto end   = data.data() + data.size();
+
+        if (capacity == 0)
+            return count;
+
+        split_parts(data, delimSize, createNullStrs, find, [&](const CharT* first, const CharT* last) {
+            if (count + 1 == capacity)
+                last = end;
+
+            out[count++] = std::basic_string_view<CharT>(first, static_cast<SizeT>(last - first));
+            return count != capacity;
+        });
+
+        return count;
+    }
+
+    template <typename CharT>
+    auto char_finder(CharT c) {
+        return [c](const CharT* p, const CharT* end) { return find_char(p, end, c); };
+    }
+
+    template <typename CharT>
+    auto set_finder(std::initializer_list<CharT> l) {
+        return [l](const CharT* p, const CharT* end) { return find_any(p, end, l); };
+    }
+
+    template <typename CharT>
+    auto str_finder(std::basic_string_view<CharT> str) {
+        return [str](const CharT* p, const CharT* end) { return find_str(p, end, str); };
+    }
+}
+
+#define SPLIT_VIEW_IMPL(STRING_T)                                                                   \
+template <>                                                                                         \
+auto STRING_T::splitView(CharType c) const -> ViewVector {                                          \
+    return split_to_vector<ViewVector>(StrView(_str_v), 1, false, get_allocator(), char_finder(c)); \
+}                                                                                                   \
+template <>                                                                                         \
+auto STRING_T::splitView(CharType c, StrView* out, SizeType capacity) const -> SizeType {           \
+    return split_to_buffer(StrView(_str_v), 1, false, char_finder(c), out, capacity);               \
 }
 
-#define SPLIT_VIEW_STR_IMPL(CHAR_T)                                               \
-template<>                                                                        \
-auto StringBase<CHAR_T>::splitView(const StrView& str) const -> Vector<StrView> { \
-    Vector<SizeType> idxs;                                                        \
-    idxs.reserve(128);                                                            \
-                                                                                  \
-    Vector<StrView> strs;                                                         \
-    StrView data = _str_v;                                                        \
-                                                                                  \
-    { PtrDiff pos = -str.length();                                                \
-        while ((pos = data.find(str, pos + str.length())) != StrView::npos)       \
-            idxs.push_back(static_cast<SizeType>(pos)); }                         \
-                                                                                  \
-    strs.reserve(idxs.size() + 1);                                                \
-                                                                                  \
-    SizeType pos = 0;                                                             \
-    for (auto idx : idxs) {                                                       \
-        if (pos != idx)                                                           \
-            strs.emplace_back(data.substr(pos, idx - pos));                       \
-        pos = idx + str.length();                                                 \
-    }                                                                             \
-    if (pos != data.length())                                                     \
-        strs.emplace_back(data.substr(pos, data.length()));                       \
-    return std::move(strs);                                                       \
+#define SPLIT_VIEW_STR_IMPL(STRING_T)                                                               \
+template <>                                                                                         \
+auto STRING_T::splitView(const StrView& str) const -> ViewVector {                                  \
+    return split_to_vector<ViewVector>(StrView(_str_v), str.length(), false, get_allocator(),       \
+                                       str_finder(str));                                            \
+}                                                                                                   \
+template <>                                                                                         \
+auto STRING_T::splitView(const StrView& str, StrView* out, SizeType capacity) const -> SizeType {   \
+    return split_to_buffer(StrView(_str_v), str.length(), false, str_finder(str), out, capacity);   \
 }
 
-#define SPLIT_VIEW_IL_IMPL(CHAR_T)                                     \
-template <>                                                            \
-auto StringBase<CHAR_T>::splitView                                     \
-(std::initializer_list<CHAR_T> l, bool createNullStrs)                 \
-const -> Vector<StrView> {                                             \
-    Vector<StrView> vec;                                               \
-    StrView data = _str_v;                                             \
-    SizeType start = 0;                                                \
-                                                                       \
-    for (SizeType i = 0; i < data.size(); ++i) {                       \
-        bool cmp = false;                                              \
-        for (auto c : l) { if (data[i] == c) { cmp = true; break; } }  \
-        if (cmp) {                                                     \
-            if (createNullStrs || start != i) {                        \
-                vec.emplace_back(data.substr(start, i - start));       \
-            }                                                          \
-            start = i + 1;                                             \
-        }                                                              \
-    }                                                                  \
-    if (start != data.size())                                          \
-        vec.emplace_back(data.substr(start, data.size()));             \
-    return std::move(vec);                                             \
+#define SPLIT_VIEW_IL_IMPL(STRING_T)                                                                \
+template <>                                                                                         \
+auto STRING_T::splitView(std::initializer_list<CharType> l, bool createNullStrs) const              \
+-> ViewVector {                                                                                     \
+    return split_to_vector<ViewVector>(StrView(_str_v), 1, createNullStrs, get_allocator(),         \
+                                       set_finder(l));                                              \
+}                                                                                                   \
+template <>                                                                                         \
+auto STRING_T::splitView                                                                            \
+(std::initializer_list<CharType> l, StrView* out, SizeType capacity, bool createNullStrs) const     \
+-> SizeType {                                                                                       \
+    return split_to_buffer(StrView(_str_v), 1, createNullStrs, set_finder(l), out, capacity);       \
 }
 
-#define SPLIT_IMPL(CHAR_T)                                                         \
-template <>                                                                        \
-auto StringBase<CHAR_T>::split(CHAR_T c) const -> Vector<StringBase<CHAR_T>> {     \
-    Vector<StringBase<CHAR_T>> vec;                                                \
-    StrView data = _str_v;                                                         \
-    SizeType start = 0;                                                            \
-                                                                                   \
-    for (SizeType i = 0; i < data.size(); ++i) {                                   \
-        if (data[i] == c) {                                                        \
-            if (start != i) {                                                      \
-                vec.emplace_back(data.substr(start, i - start));                   \
-            }                                                                      \
-            start = i + 1;                                                         \
-        }                                                                          \
-    }                                                                              \
-    if (start != data.size())                                                      \
-        vec.emplace_back(data.substr(start, data.size()));                         \
-    return std::move(vec);                                                         \
+#define SPLIT_IMPL(STRING_T)                                                                        \
+template <>                                                                                         \
+auto STRING_T::split(CharType c) const -> StrVector {                                               \
+    return split_to_vector<StrVector>(StrView(_str_v), 1, false, get_allocator(), char_finder(c));  \
 }
 
-#define SPLIT_STR_IMPL(CHAR_T)                                                           \
-template<>                                                                                    \
-auto StringBase<CHAR_T>::split(const StrView& str) const -> Vector<StringBase<CHAR_T>> {      \
-    Vector<SizeType> idxs;                                                                    \
-    idxs.reserve(128);                                                                        \
-                                                                                              \
-    Vector<StringBase<CHAR_T>> strs;                                                          \
-    StrView data = _str_v;                                                                    \
-                                                                                              \
-    { PtrDiff pos = -str.length();                                                            \
-        while ((pos = data.find(str, pos + str.length())) != StrView::npos)                   \
-            idxs.push_back(static_cast<SizeType>(pos)); }                                     \
-                                                                                              \
-    strs.reserve(idxs.size() + 1);                                                            \
-                                                                                              \
-    SizeType pos = 0;                                                                         \
-    for (auto idx : idxs) {                                                                   \
-        if (pos != idx)                                                                       \
-            strs.emplace_back(data.substr(pos, idx - pos));                                   \
-        pos = idx + str.length();                                                             \
-    }                                                                                         \
-    if (pos != data.length())                                                                 \
-        strs.emplace_back(data.substr(pos, data.length()));                                   \
-    return std::move(strs);                                                                   \
+#define SPLIT_STR_IMPL(STRING_T)                                                                    \
+template <>                                                                                         \
+auto STRING_T::split(const StrView& str) const -> StrVector {                                       \
+    return split_to_vector<StrVector>(StrView(_str_v), str.length(), false, get_allocator(),        \
+                                      str_finder(str));                                             \
 }
 
-#define SPLIT_IL_IMPL(CHAR_T)                                          \
-template <>                                                            \
-auto StringBase<CHAR_T>::split                                         \
-(std::initializer_list<CHAR_T> l, bool createNullStrs)                 \
-const -> Vector<StringBase<CHAR_T>> {                                  \
-    Vector<StringBase<CHAR_T>> vec;                                    \
-    StrView data = _str_v;                                             \
-    SizeType start = 0;                                                \
-                                                                       \
-    for (SizeType i = 0; i < data.size(); ++i) {                       \
-        bool cmp = false;                                              \
-        for (auto c : l) { if (data[i] == c) { cmp = true; break; } }  \
-        if (cmp) {                                                     \
-            if (createNullStrs || start != i) {                        \
-                vec.emplace_back(data.substr(start, i - start));       \
-            }                                                          \
-            start = i + 1;                                             \
-        }                                                              \
-    }                                                                  \
-    if (start != data.size())                                          \
-        vec.emplace_back(data.substr(start, data.size()));             \
-    return std::move(vec);                                             \
+#define SPLIT_IL_IMPL(STRING_T)                                                                     \
+template <>                                                                                         \
+auto STRING_T::split(std::initializer_list<CharType> l, bool createNullStrs) const -> StrVector {   \
+    return split_to_vector<StrVector>(StrView(_str_v), 1, createNullStrs, get_allocator(),          \
+                                      set_finder(l));                                               \
 }
 
 namespace ftl {
-    SPLIT_IMPL(Char8)
-    SPLIT_IMPL(Char16)
-    SPLIT_IMPL(Char32)
-
-    SPLIT_STR_IMPL(Char8)
-    SPLIT_STR_IMPL(Char16)
-    SPLIT_STR_IMPL(Char32)
-
-    SPLIT_IL_IMPL(Char8)
-    SPLIT_IL_IMPL(Char16)
-    SPLIT_IL_IMPL(Char32)
-
-    SPLIT_VIEW_IMPL(Char8)
-    SPLIT_VIEW_IMPL(Char16)
-    SPLIT_VIEW_IMPL(Char32)
-
-    SPLIT_VIEW_STR_IMPL(Char8)
-    SPLIT_VIEW_STR_IMPL(Char16)
-    SPLIT_VIEW_STR_IMPL(Char32)
-
-    SPLIT_VIEW_IL_IMPL(Char8)
-    SPLIT_VIEW_IL_IMPL(Char16)
-    SPLIT_VIEW_IL_IMPL(Char32)
-}
\ No newline at end of file
+    SPLIT_IMPL(String)
+    SPLIT_IMPL(String16)
+    SPLIT_IMPL(String32)
+    SPLIT_IMPL(pmr::String)
+
+    SPLIT_STR_IMPL(String)
+    SPLIT_STR_IMPL(String16)
+    SPLIT_STR_IMPL(String32)
+    SPLIT_STR_IMPL(pmr::String)
+
+    SPLIT_IL_IMPL(String)
+    SPLIT_IL_IMPL(String16)
+    SPLIT_IL_IMPL(String32)
+    SPLIT_IL_IMPL(pmr::String)
+
+    SPLIT_VIEW_IMPL(String)
+    SPLIT_VIEW_IMPL(String16)
+    SPLIT_VIEW_IMPL(String32)
+    SPLIT_VIEW_IMPL(pmr::String)
+
+    SPLIT_VIEW_STR_IMPL(String)
+    SPLIT_VIEW_STR_IMPL(String16)
+    SPLIT_VIEW_STR_IMPL(String32)
+    SPLIT_VIEW_STR_IMPL(pmr::String)
+
+    SPLIT_VIEW_IL_IMPL(String)
+    SPLIT_VIEW_IL_IMPL(String16)
+    SPLIT_VIEW_IL_IMPL(String32)
+    SPLIT_VIEW_IL_IMPL(pmr::String)
+}
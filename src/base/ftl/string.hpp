@@ -1,34 +1,76 @@
 #ifndef DECAYENGINE_STRING_HPP
 #define DECAYENGINE_STRING_HPP
 
+#include <array>
 #include <iomanip>
+#include <memory>
+#include <memory_resource>
 #include "containers_base.hpp"
 #include "cp_string.hpp"
 #include "../baseTypes.hpp"
 #include "../concepts.hpp"
 
 namespace ftl {
-    template<typename T>
+    template <typename T, typename AllocT = std::allocator<T>>
     class Vector;
 
-    template <typename CharT>
+    template <typename CharT, typename AllocT = std::allocator<CharT>>
+    class StringBase;
+
+    /**
+     * Inline storage for allocation-free splitView
+     */
+    template <typename CharT, SizeT _Capacity>
+    class SplitViews {
+    public:
+        using StrView = std::basic_string_view<CharT>;
+
+        auto begin() const { return _views.begin(); }
+        auto end()   const { return _views.begin() + _size; }
+        auto size()  const { return _size; }
+        auto empty() const { return _size == 0; }
+
+        auto& operator[](SizeT i) const { return _views[i]; }
+
+        static constexpr auto capacity() { return _Capacity; }
+
+    private:
+        template <typename, typename>
+        friend class StringBase;
+
+        std::array<StrView, _Capacity> _views;
+        SizeT                          _size = 0;
+    };
+
+    /**
+     * Allocator is used by string and by vectors returned from split,
+     * use ftl::pmr::String for strings in memory resource (e.g. base::Arena)
+     */
+    template <typename CharT, typename AllocT>
     class StringBase {
         static_assert(
                 concepts::any_of<CharT, Char8, Char16, Char32>,
                 "String must contains char symbols only"
         );
 
+        template <typename T>
+        using RebindAllocT = typename std::allocator_traits<AllocT>::template rebind_alloc<T>;
+
     public:
-        using CharType = CharT;
-        using SizeType = typename std::basic_string<CharT>::size_type;
-        using IterT    = typename std::basic_string<CharT>::iterator;
-        using C_IterT  = typename std::basic_string<CharT>::const_iterator;
-        using R_IterT  = typename std::basic_string<CharT>::const_iterator;
-        using CR_IterT = typename std::basic_string<CharT>::const_reverse_iterator;
-        using StrView  = std::basic_string_view<CharT>;
+        using StdString      = std::basic_string<CharT, std::char_traits<CharT>, AllocT>;
+        using CharType       = CharT;
+        using SizeType       = typename StdString::size_type;
+        using IterT          = typename StdString::iterator;
+        using C_IterT        = typename StdString::const_iterator;
+        using R_IterT        = typename StdString::const_iterator;
+        using CR_IterT       = typename StdString::const_reverse_iterator;
+        using StrView        = std::basic_string_view<CharT>;
+        using allocator_type = AllocT;
+        using ViewVector     = Vector<StrView, RebindAllocT<StrView>>;
+        using StrVector      = Vector<StringBase, RebindAllocT<StringBase>>;
 
     public:
-        static constexpr auto npos = std::basic_string<CharT>::npos;
+        static constexpr auto npos = StdString::npos;
 
 
         // Constructors
@@ -38,9 +80,9 @@ namespace ftl {
         StringBase(const StringBase& str, SizeType pos)             : _str_v(str._str_v, pos) {}
         StringBase(const StringBase& str, SizeType pos, SizeType n) : _str_v(str._str_v, pos, n) {}
 
-        StringBase(const std::basic_string<CharT>& str)      : _str_v(str) {}
+        StringBase(const StdString& str)                     : _str_v(str) {}
         StringBase(const std::basic_string_view<CharT>& str) : _str_v(str) {}
-        StringBase(std::basic_string<CharT>&& str)           : _str_v(std::move(str)) {}
+        StringBase(StdString&& str)                          : _str_v(std::move(str)) {}
         StringBase(std::basic_string_view<CharT>&& str)      : _str_v(std::move(str)) {}
 
         StringBase(SizeType n, CharT c)            : _str_v(c, n) {}
@@ -58,6 +100,15 @@ namespace ftl {
         template <CharT... _Str>
         StringBase(ConstexprString<CharT, _Str...> str) : StringBase(str.str_view()) {}
 
+        // Allocator-extended, also used by uses-allocator construction in pmr containers
+        explicit StringBase(const AllocT& alloc)                    : _str_v(alloc) {}
+        StringBase(const StrView& str, const AllocT& alloc)         : _str_v(str, alloc) {}
+        StringBase(const StringBase& str, const AllocT& alloc)      : _str_v(str._str_v, alloc) {}
+        StringBase(StringBase&& str, const AllocT& alloc)           : _str_v(std::move(str._str_v), alloc) {}
+
+        template <std::size_t _Size>
+        StringBase(const CharT(&str)[_Size], const AllocT& alloc) : _str_v(str, _Size ? _Size-1 : 0, alloc) {}
+
 
         // Basic methods
 
@@ -71,6 +122,8 @@ namespace ftl {
         inline auto data    ()       { return _str_v.data(); }
         inline auto clear   ()       { _str_v.clear(); return *this; }
 
+        inline auto get_allocator() const { return _str_v.get_allocator(); }
+
         inline auto resize  (SizeType size)          -> StringBase& { _str_v.resize(size); return *this; }
         inline auto resize  (SizeType size, CharT c) -> StringBase& { _str_v.resize(size, c); return *this; }
         inline auto reserve (SizeType size)          -> StringBase& { _str_v.reserve(size); return *this; }
@@ -271,7 +324,7 @@ namespace ftl {
         FIND_METHODS_GENERATOR(find_last_not_of, npos);
 
         inline auto substr(SizeType pos, SizeType n = npos) const {
-            return StringBase(_str_v.substr(pos, n));
+            return StringBase(StrView(_str_v).substr(pos, n), _str_v.get_allocator());
         }
 
         inline auto compare(const StringBase& str) const {
@@ -450,8 +503,8 @@ namespace ftl {
             return os;
         }
 
-        using StdStrCrefT = const std::basic_string<CharT>&;
-        using StdStrRefT  = std::basic_string<CharT>&;
+        using StdStrCrefT = const StdString&;
+        using StdStrRefT  = StdString&;
         using StdStrView  = std::basic_string_view<CharT>;
 
         operator StdStrCrefT () const noexcept { return _str_v; }
@@ -462,22 +515,56 @@ namespace ftl {
             std::swap(a._str_v, b._str_v);
         }
 
+        // Formatted in place: no temporary std::string, capacity and allocator are kept
         template <typename FmtT, typename... ArgsT>
         auto& sprintf(FmtT format, ArgsT... args) {
-            _str_v = fmt::format(format, args...);
+            _str_v.clear();
+            fmt::format_to(std::back_inserter(_str_v), format, args...);
             return *this;
         }
 
         U64 hash() const { return XXH64(_str_v.c_str(), _str_v.length() * sizeof(CharT), 0); }
 
-        auto splitView(CharT c) const            -> Vector<StrView>;
-        auto splitView(const StrView& str) const -> Vector<StrView>;
-        auto split    (CharT c) const            -> Vector<StringBase<CharT>>;
-        auto split    (const StrView& str) const -> Vector<StringBase<CharT>>;
+        auto splitView(CharT c) const            -> ViewVector;
+        auto splitView(const StrView& str) const -> ViewVector;
+        auto split    (CharT c) const            -> StrVector;
+        auto split    (const StrView& str) const -> StrVector;
+
 
+        auto splitView(std::initializer_list<CharT> l, bool createNullStrs = false) const -> ViewVector;
+        auto split    (std::initializer_list<CharT> l, bool createNullStrs = false) const -> StrVector;
 
-        auto splitView(std::initializer_list<CharT> l, bool createNullStrs = false) const -> Vector<StrView>;
-        auto split    (std::initializer_list<CharT> l, bool createNullStrs = false) const -> Vector<StringBase<CharT>>;
+        /**
+         * Allocation-free splitView to caller buffer. If string has more parts than capacity,
+         * last view contains the rest of string unsplit
+         * @return count of written views
+         */
+        auto splitView(CharT c, StrView* out, SizeType capacity) const            -> SizeType;
+        auto splitView(const StrView& str, StrView* out, SizeType capacity) const -> SizeType;
+        auto splitView(std::initializer_list<CharT> l, StrView* out, SizeType capacity,
+                       bool createNullStrs = false) const -> SizeType;
+
+        template <SizeT _Capacity>
+        auto splitView(CharT c) const -> SplitViews<CharT, _Capacity> {
+            SplitViews<CharT, _Capacity> views;
+            views._size = splitView(c, views._views.data(), _Capacity);
+            return views;
+        }
+
+        template <SizeT _Capacity>
+        auto splitView(const StrView& str) const -> SplitViews<CharT, _Capacity> {
+            SplitViews<CharT, _Capacity> views;
+            views._size = splitView(str, views._views.data(), _Capacity);
+            return views;
+        }
+
+        template <SizeT _Capacity>
+        auto splitView(std::initializer_list<CharT> l, bool createNullStrs = false) const
+        -> SplitViews<CharT, _Capacity> {
+            SplitViews<CharT, _Capacity> views;
+            views._size = splitView(l, views._views.data(), _Capacity, createNullStrs);
+            return views;
+        }
 
         
         inline auto parent_path() const -> StringBase {
@@ -500,13 +587,17 @@ namespace ftl {
         }
 
     protected:
-        std::basic_string<CharT> _str_v;
+        StdString _str_v;
     };
 
     using String   = StringBase<Char8>;
     using String16 = StringBase<Char16>;
     using String32 = StringBase<Char32>;
 
+    namespace pmr {
+        using String = StringBase<Char8, std::pmr::polymorphic_allocator<Char8>>;
+    }
+
 } // namespace ftl
 
 //
@@ -518,21 +609,21 @@ namespace std {
 }
 
 // fmt format
-template <>
-struct fmt::formatter<ftl::String> {
+template <typename AllocT>
+struct fmt::formatter<ftl::StringBase<Char8, AllocT>> {
     template <typename ParseContext>
     constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
 
     template <typename FormatContext>
-    auto format(const ftl::String& str, FormatContext& ctx) {
+    auto format(const ftl::StringBase<Char8, AllocT>& str, FormatContext& ctx) {
         return format_to(ctx.out(), "{}", str.c_str());
     }
 };
 
 // std chash
-template <typename CharT>
-struct std::hash<ftl::StringBase<CharT>> {
-    U64 operator()(const ftl::StringBase<CharT>& str) const {
+template <typename CharT, typename AllocT>
+struct std::hash<ftl::StringBase<CharT, AllocT>> {
+    U64 operator()(const ftl::StringBase<CharT, AllocT>& str) const {
         return str.hash();
     }
 };
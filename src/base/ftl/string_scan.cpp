@@ -0,0 +1,307 @@
+#include "string_scan.hpp"
+
+#include <cstring>
+#include <immintrin.h>
+
+#include "../cpu_extension_checker.hpp"
+
+namespace {
+    using namespace ftl::str_scan;
+
+    inline bool in_set(Char8 c, std::string_view set) {
+        for (auto s : set)
+            if (c == s)
+                return true;
+        return false;
+    }
+
+
+    // SSE2: 16 chars per block
+    __attribute__((target("sse2")))
+    inline auto sse2_load(const Char8* p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    }
+
+    __attribute__((target("sse2")))
+    inline U32 sse2_set_mask(const Char8* p, const __m128i* chars, SizeT count) {
+        auto block = sse2_load(p);
+        auto eq    = _mm_cmpeq_epi8(block, chars[0]);
+
+        for (SizeT i = 1; i < count; ++i)
+            eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, chars[i]));
+
+        return static_cast<U32>(_mm_movemask_epi8(eq));
+    }
+
+    template <bool Negate>
+    __attribute__((target("sse2")))
+    inline U32 sse2_block_mask(const Char8* p, const __m128i* chars, SizeT count) {
+        auto mask = sse2_set_mask(p, chars, count);
+        return Negate ? ~mask & 0xFFFF : mask;
+    }
+
+    // Last block overlaps already scanned chars, they are shifted out of mask
+    __attribute__((target("sse2")))
+    auto sse2_find_char(const Char8* p, const Char8* end, Char8 c) -> const Char8* {
+        auto chars = _mm_set1_epi8(c);
+        auto last  = end - 16;
+
+        for (; p < last; p += 16)
+            if (auto mask = sse2_set_mask(p, &chars, 1))
+                return p + __builtin_ctz(mask);
+
+        auto mask = sse2_set_mask(last, &chars, 1) >> (p - last);
+        return mask ? p + __builtin_ctz(mask) : end;
+    }
+
+    template <bool Negate>
+    __attribute__((target("sse2")))
+    auto sse2_find_set(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+        __m128i chars[MAX_SET_SIZE] = {};
+        for (SizeT i = 0; i < set.size(); ++i)
+            chars[i] = _mm_set1_epi8(set[i]);
+
+        auto last = end - 16;
+
+        for (; p < last; p += 16)
+            if (auto mask = sse2_block_mask<Negate>(p, chars, set.size()))
+                return p + __builtin_ctz(mask);
+
+        auto mask = sse2_block_mask<Negate>(last, chars, set.size()) >> (p - last);
+        return mask ? p + __builtin_ctz(mask) : end;
+    }
+
+    // Blocks are scanned from the end, first block overlaps already scanned chars
+    __attribute__((target("sse2")))
+    auto sse2_rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+        __m128i chars[MAX_SET_SIZE] = {};
+        for (SizeT i = 0; i < set.size(); ++i)
+            chars[i] = _mm_set1_epi8(set[i]);
+
+        auto block = end - 16;
+
+        for (; block > p; block -= 16)
+            if (auto mask = sse2_block_mask<true>(block, chars, set.size()))
+                return block + (32 - __builtin_clz(mask));
+
+        auto unscanned = static_cast<U32>(block + 16 - p);
+        auto mask      = sse2_block_mask<true>(p, chars, set.size()) & ((1U << unscanned) - 1);
+        return mask ? p + (32 - __builtin_clz(mask)) : p;
+    }
+
+    __attribute__((target("sse2")))
+    auto sse2_find_str(const Char8* p, const Char8* end, std::string_view str) -> const Char8* {
+        auto size  = str.size();
+        auto first = _mm_set1_epi8(str.front());
+        auto back  = _mm_set1_epi8(str.back());
+        auto limit = end - size - 15;
+
+        for (; p <= limit; p += 16) {
+            auto eq   = _mm_and_si128(_mm_cmpeq_epi8(sse2_load(p), first),
+                                      _mm_cmpeq_epi8(sse2_load(p + size - 1), back));
+            auto mask = static_cast<U32>(_mm_movemask_epi8(eq));
+
+            for (; mask; mask &= mask - 1) {
+                auto candidate = p + __builtin_ctz(mask);
+                if (std::memcmp(candidate + 1, str.data() + 1, size - 2) == 0)
+                    return candidate;
+            }
+        }
+
+        return scalar::find_str(p, end, str);
+    }
+
+
+    // AVX2: 32 chars per block
+    __attribute__((target("avx2")))
+    inline auto avx2_load(const Char8* p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    }
+
+    __attribute__((target("avx2")))
+    inline U32 avx2_set_mask(const Char8* p, const __m256i* chars, SizeT count) {
+        auto block = avx2_load(p);
+        auto eq    = _mm256_cmpeq_epi8(block, chars[0]);
+
+        for (SizeT i = 1; i < count; ++i)
+            eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(block, chars[i]));
+
+        return static_cast<U32>(_mm256_movemask_epi8(eq));
+    }
+
+    template <bool Negate>
+    __attribute__((target("avx2")))
+    inline U32 avx2_block_mask(const Char8* p, const __m256i* chars, SizeT count) {
+        auto mask = avx2_set_mask(p, chars, count);
+        return Negate ? ~mask : mask;
+    }
+
+    __attribute__((target("avx2")))
+    auto avx2_find_char(const Char8* p, const Char8* end, Char8 c) -> const Char8* {
+        if (end - p < 32)
+            return sse2_find_char(p, end, c);
+
+        auto chars = _mm256_set1_epi8(c);
+        auto last  = end - 32;
+
+        for (; p < last; p += 32)
+            if (auto mask = avx2_set_mask(p, &chars, 1))
+                return p + __builtin_ctz(mask);
+
+        auto mask = avx2_set_mask(last, &chars, 1) >> (p - last);
+        return mask ? p + __builtin_ctz(mask) : end;
+    }
+
+    template <bool Negate>
+    __attribute__((target("avx2")))
+    auto avx2_find_set(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+        if (end - p < 32)
+            return sse2_find_set<Negate>(p, end, set);
+
+        __m256i chars[MAX_SET_SIZE] = {};
+        for (SizeT i = 0; i < set.size(); ++i)
+            chars[i] = _mm256_set1_epi8(set[i]);
+
+        auto last = end - 32;
+
+        for (; p < last; p += 32)
+            if (auto mask = avx2_block_mask<Negate>(p, chars, set.size()))
+                return p + __builtin_ctz(mask);
+
+        auto mask = avx2_block_mask<Negate>(last, chars, set.size()) >> (p - last);
+        return mask ? p + __builtin_ctz(mask) : end;
+    }
+
+    __attribute__((target("avx2")))
+    auto avx2_rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+        if (end - p < 32)
+            return sse2_rfind_not_any(p, end, set);
+
+        __m256i chars[MAX_SET_SIZE] = {};
+        for (SizeT i = 0; i < set.size(); ++i)
+            chars[i] = _mm256_set1_epi8(set[i]);
+
+        auto block = end - 32;
+
+        for (; block > p; block -= 32)
+            if (auto mask = avx2_block_mask<true>(block, chars, set.size()))
+                return block + (32 - __builtin_clz(mask));
+
+        auto unscanned = static_cast<U32>(block + 32 - p);
+        auto mask      = avx2_block_mask<true>(p, chars, set.size()) & static_cast<U32>((U64(1) << unscanned) - 1);
+        return mask ? p + (32 - __builtin_clz(mask)) : p;
+    }
+
+    __attribute__((target("avx2")))
+    auto avx2_find_str(const Char8* p, const Char8* end, std::string_view str) -> const Char8* {
+        auto size = str.size();
+        if (end - p < static_cast<PtrDiff>(size + 31))
+            return sse2_find_str(p, end, str);
+
+        auto first = _mm256_set1_epi8(str.front());
+        auto back  = _mm256_set1_epi8(str.back());
+        auto limit = end - size - 31;
+
+        for (; p <= limit; p += 32) {
+            auto eq   = _mm256_and_si256(_mm256_cmpeq_epi8(avx2_load(p), first),
+                                         _mm256_cmpeq_epi8(avx2_load(p + size - 1), back));
+            auto mask = static_cast<U32>(_mm256_movemask_epi8(eq));
+
+            for (; mask; mask &= mask - 1) {
+                auto candidate = p + __builtin_ctz(mask);
+                if (std::memcmp(candidate + 1, str.data() + 1, size - 2) == 0)
+                    return candidate;
+            }
+        }
+
+        return scalar::find_str(p, end, str);
+    }
+
+
+    struct Kernels {
+        decltype(&scalar::find_char)     find_char;
+        decltype(&scalar::find_any)      find_any;
+        decltype(&scalar::find_not_any)  find_not_any;
+        decltype(&scalar::rfind_not_any) rfind_not_any;
+        decltype(&scalar::find_str)      find_str;
+    };
+
+    auto select_kernels() -> Kernels {
+        auto& cpu = base::cpu_extensions_checker();
+
+        if (cpu.HW_AVX2 && cpu.OS_AVX)
+            return {avx2_find_char, avx2_find_set<false>, avx2_find_set<true>, avx2_rfind_not_any, avx2_find_str};
+        else if (cpu.HW_SSE2)
+            return {sse2_find_char, sse2_find_set<false>, sse2_find_set<true>, sse2_rfind_not_any, sse2_find_str};
+        else
+            return {scalar::find_char, scalar::find_any, scalar::find_not_any, scalar::rfind_not_any,
+                    scalar::find_str};
+    }
+
+    const auto& kernels() {
+        static const auto instance = select_kernels();
+        return instance;
+    }
+
+    // Kernels require at least one full SSE2 block
+    constexpr PtrDiff MIN_KERNEL_SIZE = 16;
+
+    inline bool use_kernel(const Char8* p, const Char8* end, std::string_view set) {
+        return end - p >= MIN_KERNEL_SIZE && !set.empty() && set.size() <= MAX_SET_SIZE;
+    }
+}
+
+
+auto ftl::str_scan::find_char(const Char8* p, const Char8* end, Char8 c) -> const Char8* {
+    return end - p >= MIN_KERNEL_SIZE ? kernels().find_char(p, end, c) : scalar::find_char(p, end, c);
+}
+
+auto ftl::str_scan::find_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    return use_kernel(p, end, set) ? kernels().find_any(p, end, set) : scalar::find_any(p, end, set);
+}
+
+auto ftl::str_scan::find_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    return use_kernel(p, end, set) ? kernels().find_not_any(p, end, set) : scalar::find_not_any(p, end, set);
+}
+
+auto ftl::str_scan::rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    return use_kernel(p, end, set) ? kernels().rfind_not_any(p, end, set) : scalar::rfind_not_any(p, end, set);
+}
+
+auto ftl::str_scan::find_str(const Char8* p, const Char8* end, std::string_view str) -> const Char8* {
+    if (str.size() < 2)
+        return str.empty() ? p : find_char(p, end, str.front());
+
+    return end - p >= static_cast<PtrDiff>(str.size()) + MIN_KERNEL_SIZE - 1 ?
+           kernels().find_str(p, end, str) : scalar::find_str(p, end, str);
+}
+
+
+auto ftl::str_scan::scalar::find_char(const Char8* p, const Char8* end, Char8 c) -> const Char8* {
+    while (p != end && *p != c)
+        ++p;
+    return p;
+}
+
+auto ftl::str_scan::scalar::find_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    while (p != end && !in_set(*p, set))
+        ++p;
+    return p;
+}
+
+auto ftl::str_scan::scalar::find_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    while (p != end && in_set(*p, set))
+        ++p;
+    return p;
+}
+
+auto ftl::str_scan::scalar::rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8* {
+    while (end != p && in_set(*(end - 1), set))
+        --end;
+    return end;
+}
+
+auto ftl::str_scan::scalar::find_str(const Char8* p, const Char8* end, std::string_view str) -> const Char8* {
+    auto pos = std::string_view(p, static_cast<SizeT>(end - p)).find(str);
+    return pos == std::string_view::npos ? end : p + pos;
+}
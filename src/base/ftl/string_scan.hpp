@@ -0,0 +1,55 @@
+#pragma once
+
+#include <string_view>
+#include "../baseTypes.hpp"
+
+/**
+ * Vectorized scanning of char ranges. SSE2 or AVX2 kernels are selected at first call by cpu extensions,
+ * ranges shorter than one vector are scanned by scalar loops
+ */
+namespace ftl::str_scan {
+
+    // Sets of chars with more symbols are scanned by scalar loop
+    constexpr SizeT MAX_SET_SIZE = 8;
+
+    /**
+     * Find first char equal to c in [p, end)
+     * @return pointer to found char or end
+     */
+    auto find_char(const Char8* p, const Char8* end, Char8 c) -> const Char8*;
+
+    /**
+     * Find first char that is (find_any) or is not (find_not_any) in set
+     * @return pointer to found char or end
+     */
+    auto find_any    (const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+    auto find_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+
+    /**
+     * Find last char that is not in set
+     * @return pointer after found char or p if all chars are in set
+     */
+    auto rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+
+    /**
+     * Find first occurrence of str, candidates are filtered by first and last chars
+     * @return pointer to found substring or end
+     */
+    auto find_str(const Char8* p, const Char8* end, std::string_view str) -> const Char8*;
+
+    inline auto trim(std::string_view str, std::string_view set = " \t") -> std::string_view {
+        auto first = find_not_any(str.data(), str.data() + str.size(), set);
+        auto last  = rfind_not_any(first, str.data() + str.size(), set);
+        return {first, static_cast<SizeT>(last - first)};
+    }
+
+    // Reference implementations
+    namespace scalar {
+        auto find_char    (const Char8* p, const Char8* end, Char8 c) -> const Char8*;
+        auto find_any     (const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+        auto find_not_any (const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+        auto rfind_not_any(const Char8* p, const Char8* end, std::string_view set) -> const Char8*;
+        auto find_str     (const Char8* p, const Char8* end, std::string_view str) -> const Char8*;
+    }
+
+} // namespace ftl::str_scan
@@ -2,6 +2,7 @@
 #define DECAYENGINE_VECTOR_HPP
 
 #include <vector>
+#include <memory_resource>
 #include <iostream>
 #include <sstream>
 #include <functional>
@@ -10,18 +11,20 @@
 #include "string.hpp"
 
 namespace ftl {
-    template<typename Type>
+    // Default AllocT is declared in string.hpp
+    template<typename Type, typename AllocT>
     class Vector {
-        using iterator         = typename std::vector<Type>::iterator;
-        using const_iterator   = typename std::vector<Type>::const_iterator;
-        using r_iterator       = typename std::vector<Type>::reverse_iterator;
-        using const_r_iterator = typename std::vector<Type>::const_reverse_iterator;
-        using allocator_type   = typename std::vector<Type>::allocator_type;
-        using RefType          = typename std::vector<Type>::reference;
-        using C_RefType        = typename std::vector<Type>::const_reference;
+        using StdVector        = std::vector<Type, AllocT>;
+        using iterator         = typename StdVector::iterator;
+        using const_iterator   = typename StdVector::const_iterator;
+        using r_iterator       = typename StdVector::reverse_iterator;
+        using const_r_iterator = typename StdVector::const_reverse_iterator;
+        using RefType          = typename StdVector::reference;
+        using C_RefType        = typename StdVector::const_reference;
 
     public:
-        using ValType = Type;
+        using ValType        = Type;
+        using allocator_type = AllocT;
 
         ~Vector () noexcept = default;
 
@@ -227,7 +230,7 @@ namespace ftl {
                     "Callback has wrong number of arguments"
             );
 
-            auto filtered = Vector();
+            auto filtered = Vector(get_allocator());
 
             if constexpr (ttr::args_count<Function> == 1) {
                 for (auto& item : _stl_vector)
@@ -330,26 +333,31 @@ namespace ftl {
         friend std::ostream& operator<< (std::ostream& os, const Vector& vector) { vector.print(os); return os; }
 
     protected:
-        std::vector<Type> _stl_vector;
+        StdVector _stl_vector;
     };
+
+    namespace pmr {
+        template <typename Type>
+        using Vector = ftl::Vector<Type, std::pmr::polymorphic_allocator<Type>>;
+    }
 }
 
 // fmt format
-template <typename Type>
-struct fmt::formatter<ftl::Vector<Type>> {
+template <typename Type, typename AllocT>
+struct fmt::formatter<ftl::Vector<Type, AllocT>> {
     template <typename ParseContext>
     constexpr auto parse(ParseContext &ctx) { return ctx.begin(); }
 
     template <typename FormatContext>
-    auto format(const ftl::Vector<Type>& vec, FormatContext& ctx) {
+    auto format(const ftl::Vector<Type, AllocT>& vec, FormatContext& ctx) {
         return format_to(ctx.out(), "{}", vec.to_string());
     }
 };
 
 // std hash
-template <typename Type>
-struct std::hash<ftl::Vector<Type>> {
-    U64 operator()(const ftl::Vector<Type>& vec) const {
+template <typename Type, typename AllocT>
+struct std::hash<ftl::Vector<Type, AllocT>> {
+    U64 operator()(const ftl::Vector<Type, AllocT>& vec) const {
         return vec.hash();
     }
 };
@@ -0,0 +1,94 @@
+#include "handles.hpp"
+
+#include "assert.hpp"
+
+base::HandlePool::~HandlePool() {
+    for (auto& segment : _segments)
+        delete [] segment.load(std::memory_order_relaxed);
+}
+
+auto base::HandlePool::slot(U32 index) const -> Slot& {
+    auto segment = 31 - static_cast<U32>(__builtin_clz((index >> FIRST_SEGMENT_BITS) + 1));
+    auto offset  = index - (((1U << segment) - 1) << FIRST_SEGMENT_BITS);
+
+    return _segments[segment].load(std::memory_order_acquire)[offset];
+}
+
+auto base::HandlePool::makeSegment(U32 segment) -> Slot* {
+    auto slots = _segments[segment].load(std::memory_order_acquire);
+    if (slots)
+        return slots;
+
+    // Threads may race for the new segment, losers free their copy
+    auto fresh = new Slot[FIRST_SEGMENT_SIZE << segment];
+
+    if (_segments[segment].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel))
+        return fresh;
+
+    delete [] fresh;
+    return slots;
+}
+
+auto base::HandlePool::allocate() -> Handle {
+    auto head = _head.load(std::memory_order_acquire);
+
+    while (static_cast<U32>(head) != Handle::INVALID_INDEX) {
+        auto index = static_cast<U32>(head);
+        auto next  = slot(index).next.load(std::memory_order_relaxed);
+
+        // Tag is changed on each pop, so head which was popped and pushed back does not match
+        if (_head.compare_exchange_weak(head, packHead(next, static_cast<U32>(head >> 32) + 1),
+                                        std::memory_order_acq_rel, std::memory_order_acquire))
+            return Handle{index, slot(index).generation.load(std::memory_order_acquire)};
+    }
+
+    auto index = _slots_count.fetch_add(1, std::memory_order_acq_rel);
+    RASSERTF(index < ((1U << SEGMENTS_COUNT) - 1) << FIRST_SEGMENT_BITS, "Handle pool overflow ({})", index);
+
+    auto segment = 31 - static_cast<U32>(__builtin_clz((index >> FIRST_SEGMENT_BITS) + 1));
+    makeSegment(segment);
+
+    return Handle{index, slot(index).generation.load(std::memory_order_acquire)};
+}
+
+bool base::HandlePool::retire(Handle handle) {
+    if (handle.index >= slots_count())
+        return false;
+
+    auto generation = handle.generation;
+    return slot(handle.index).generation.compare_exchange_strong(
+            generation, generation + 1, std::memory_order_acq_rel, std::memory_order_relaxed);
+}
+
+void base::HandlePool::recycle(U32 index) {
+    auto& s    = slot(index);
+    auto  head = _head.load(std::memory_order_relaxed);
+
+    do {
+        s.next.store(static_cast<U32>(head), std::memory_order_relaxed);
+    } while (!_head.compare_exchange_weak(head, packHead(index, static_cast<U32>(head >> 32)),
+                                          std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool base::HandlePool::release(Handle handle) {
+    if (!retire(handle))
+        return false;
+
+    recycle(handle.index);
+    return true;
+}
+
+bool base::HandlePool::valid(Handle handle) const {
+    return handle.index < slots_count() &&
+           slot(handle.index).generation.load(std::memory_order_acquire) == handle.generation;
+}
+
+void base::HandlePool::reset() {
+    // Slots are reused from index 0 with new generations
+    auto count = slots_count();
+    for (U32 i = 0; i < count; ++i)
+        slot(i).generation.fetch_add(1, std::memory_order_relaxed);
+
+    _head.store(packHead(Handle::INVALID_INDEX, 0), std::memory_order_relaxed);
+    _slots_count.store(0, std::memory_order_release);
+}
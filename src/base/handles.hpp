@@ -0,0 +1,92 @@
+#pragma once
+
+#include <atomic>
+
+#include "baseTypes.hpp"
+
+namespace base {
+    /**
+     * Generational handle: index of slot and generation of slot at the moment of allocation
+     *
+     * Generation of slot is incremented on release, so handle becomes stale
+     * even if its slot is reused. Packs to 64 bits: generation in high half, index in low half
+     */
+    struct Handle {
+        static constexpr U32 INVALID_INDEX = 0xFFFFFFFF;
+
+        U32 index      = INVALID_INDEX;
+        U32 generation = 0;
+
+        constexpr U64 pack() const {
+            return (static_cast<U64>(generation) << 32) | index;
+        }
+
+        static constexpr Handle unpack(U64 packed) {
+            return Handle{static_cast<U32>(packed), static_cast<U32>(packed >> 32)};
+        }
+
+        constexpr bool operator==(const Handle& h) const { return index == h.index && generation == h.generation; }
+        constexpr bool operator!=(const Handle& h) const { return !(*this == h); }
+    };
+
+
+    /**
+     * Lock-free pool of generational handles
+     *
+     * Free slots form Treiber stack, head holds index of the top slot and ABA tag in one 64-bit word.
+     * Slots are stored in segments of growing size which are never moved or freed while pool is alive,
+     * so any thread may read slot of any index it got from pool.
+     * allocate(), release(), retire(), recycle() and valid() may be called from any thread
+     */
+    class HandlePool {
+    public:
+        HandlePool() = default;
+        ~HandlePool();
+
+        HandlePool(const HandlePool&) = delete;
+        HandlePool& operator=(const HandlePool&) = delete;
+
+        Handle allocate();
+
+        // retire() + recycle(). Returns false if handle is stale
+        bool release(Handle handle);
+
+        /**
+         * Makes handle stale, but does not return slot to free list yet
+         * Slot must be recycled after retire() returned true
+         * @return false if handle is already stale
+         */
+        bool retire (Handle handle);
+        void recycle(U32 index);
+
+        bool valid(Handle handle) const;
+
+        // Count of slots ever allocated, all indices are less than it
+        U32 slots_count() const { return _slots_count.load(std::memory_order_acquire); }
+
+        // Not thread-safe. Makes all handles stale and frees all slots
+        void reset();
+
+    private:
+        struct Slot {
+            std::atomic<U32> generation = 0;
+            std::atomic<U32> next       = Handle::INVALID_INDEX; // Next free slot
+        };
+
+        // Segment k holds FIRST_SEGMENT_SIZE << k slots
+        static constexpr U32 FIRST_SEGMENT_BITS = 10;
+        static constexpr U32 FIRST_SEGMENT_SIZE = 1U << FIRST_SEGMENT_BITS;
+        static constexpr U32 SEGMENTS_COUNT     = 32 - FIRST_SEGMENT_BITS;
+
+        auto slot       (U32 index) const -> Slot&;
+        auto makeSegment(U32 segment) -> Slot*;
+
+        static constexpr U64 packHead(U32 index, U32 tag) { return (static_cast<U64>(tag) << 32) | index; }
+
+    private:
+        std::atomic<Slot*> _segments[SEGMENTS_COUNT] = {};
+        std::atomic<U64>   _head        = packHead(Handle::INVALID_INDEX, 0);
+        std::atomic<U32>   _slots_count = 0;
+    };
+
+} // namespace base
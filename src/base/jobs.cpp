@@ -0,0 +1,195 @@
+#include "jobs.hpp"
+
+#include "assert.hpp"
+
+namespace {
+    // Index of worker for current thread, -1 for non-worker threads
+    thread_local S64 t_worker_index = -1;
+}
+
+
+////////////////////////////// Work-stealing deque
+
+base::jobs_dtls::WorkStealingDeque::WorkStealingDeque(SizeT capacity): _jobs(capacity) {
+    RASSERTF(capacity && (capacity & (capacity - 1)) == 0,
+             "Capacity of work-stealing deque must be power of two ({})", capacity);
+    _mask = static_cast<S64>(capacity) - 1;
+}
+
+bool base::jobs_dtls::WorkStealingDeque::push(Job* job) {
+    auto b = _bottom.load(std::memory_order_relaxed);
+    auto t = _top.load(std::memory_order_acquire);
+
+    if (b - t > _mask)
+        return false;
+
+    _jobs[b & _mask].store(job, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _bottom.store(b + 1, std::memory_order_relaxed);
+
+    return true;
+}
+
+auto base::jobs_dtls::WorkStealingDeque::pop() -> Job* {
+    auto b = _bottom.load(std::memory_order_relaxed) - 1;
+    _bottom.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto t = _top.load(std::memory_order_relaxed);
+
+    if (t > b) {
+        // Empty
+        _bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    auto job = _jobs[b & _mask].load(std::memory_order_relaxed);
+
+    if (t == b) {
+        // Last item, race with thieves
+        if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            job = nullptr;
+        _bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    return job;
+}
+
+auto base::jobs_dtls::WorkStealingDeque::steal() -> Job* {
+    auto t = _top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    auto b = _bottom.load(std::memory_order_acquire);
+
+    if (t >= b)
+        return nullptr;
+
+    auto job = _jobs[t & _mask].load(std::memory_order_relaxed);
+
+    if (!_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+
+    return job;
+}
+
+
+////////////////////////////// Job system
+
+base::JobSystem::JobSystem() {
+    auto hw = std::thread::hardware_concurrency();
+    auto workers_count = hw > 1 ? hw - 1 : 1;
+
+    _deques.reserve(workers_count);
+    for (SizeT i = 0; i < workers_count; ++i)
+        _deques.emplace_back(std::make_unique<jobs_dtls::WorkStealingDeque>());
+
+    _workers.reserve(workers_count);
+    for (SizeT i = 0; i < workers_count; ++i)
+        _workers.emplace_back(&JobSystem::workerLoop, this, i);
+}
+
+base::JobSystem::~JobSystem() {
+    {
+        auto lock = std::lock_guard(_sleep_mutex);
+        _stop.store(true);
+    }
+    _sleep_cv.notify_all();
+
+    for (auto& w : _workers)
+        w.join();
+
+    // Jobs that were never taken
+    auto injected = static_cast<jobs_dtls::Job*>(nullptr);
+    while (_injected.try_pop_front(injected))
+        delete injected;
+    for (auto& d : _deques)
+        while (auto job = d->pop())
+            delete job;
+}
+
+void base::JobSystem::submit(JobFuncT func, JobCounter* counter) {
+    if (counter)
+        counter->_pending.fetch_add(1, std::memory_order_relaxed);
+
+    auto job = new jobs_dtls::Job{std::move(func), counter};
+
+    auto pushed = t_worker_index >= 0 ? _deques[t_worker_index]->push(job) : _injected.try_push_back(job);
+
+    if (!pushed) {
+        // Queue is full, do it yourself
+        execute(job);
+        return;
+    }
+
+    _queued.fetch_add(1);
+    wakeUp();
+}
+
+void base::JobSystem::wait(const JobCounter& counter) {
+    while (!counter.done()) {
+        if (auto job = findJob(t_worker_index))
+            execute(job);
+        else
+            std::this_thread::yield();
+    }
+}
+
+void base::JobSystem::wakeUp() {
+    if (_sleepers.load() > 0) {
+        { auto lock = std::lock_guard(_sleep_mutex); }
+        _sleep_cv.notify_one();
+    }
+}
+
+auto base::JobSystem::findJob(S64 index) -> jobs_dtls::Job* {
+    jobs_dtls::Job* job = nullptr;
+
+    // Own jobs
+    if (index >= 0)
+        job = _deques[index]->pop();
+
+    // Jobs from non-worker threads
+    if (!job)
+        _injected.try_pop_front(job);
+
+    // Steal from others
+    if (!job) {
+        auto count = static_cast<S64>(_deques.size());
+        auto start = index >= 0 ? index + 1 : 0;
+
+        for (S64 i = 0; i < count && !job; ++i) {
+            auto victim = (start + i) % count;
+            if (victim != index)
+                job = _deques[victim]->steal();
+        }
+    }
+
+    if (job)
+        _queued.fetch_sub(1);
+
+    return job;
+}
+
+void base::JobSystem::execute(jobs_dtls::Job* job) {
+    job->func();
+
+    if (job->counter)
+        job->counter->_pending.fetch_sub(1, std::memory_order_release);
+
+    delete job;
+}
+
+void base::JobSystem::workerLoop(SizeT index) {
+    t_worker_index = static_cast<S64>(index);
+
+    while (!_stop.load(std::memory_order_relaxed)) {
+        if (auto job = findJob(t_worker_index)) {
+            execute(job);
+            continue;
+        }
+
+        // Park
+        auto lock = std::unique_lock(_sleep_mutex);
+        _sleepers.fetch_add(1);
+        _sleep_cv.wait(lock, [this] { return _stop.load() || _queued.load() > 0; });
+        _sleepers.fetch_sub(1);
+    }
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <atomic>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "defines.hpp"
+#include "ftl/concurrent_ring.hpp"
+
+namespace base {
+    class JobCounter;
+
+    namespace jobs_dtls {
+        struct Job {
+            std::function<void()> func;
+            JobCounter*           counter;
+        };
+
+        /**
+         * Bounded Chase-Lev work-stealing deque
+         *
+         * Owner thread pushes and pops from the bottom, any other thread steals from the top
+         */
+        class WorkStealingDeque {
+        public:
+            explicit WorkStealingDeque(SizeT capacity = 4096);
+
+            bool push (Job* job); // Owner only. Returns false if deque is full
+            auto pop  () -> Job*; // Owner only
+            auto steal() -> Job*; // Any thread
+
+            bool empty() const {
+                return _bottom.load(std::memory_order_relaxed) <= _top.load(std::memory_order_relaxed);
+            }
+
+        private:
+            alignas(64) std::atomic<S64> _top    = 0;
+            alignas(64) std::atomic<S64> _bottom = 0;
+
+            std::vector<std::atomic<Job*>> _jobs;
+            S64                            _mask;
+        };
+    } // namespace jobs_dtls
+
+
+    /**
+     * Fork/join handle. Counts jobs submitted with it and not finished yet
+     */
+    class JobCounter {
+        friend class JobSystem;
+    public:
+        JobCounter() = default;
+        JobCounter(const JobCounter&) = delete;
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        bool done() const { return _pending.load(std::memory_order_acquire) == 0; }
+
+    private:
+        std::atomic<SizeT> _pending = 0;
+    };
+
+
+    /**
+     * Long-lived job system
+     *
+     * Workers are parked on condition variable while there is no work. Each worker owns
+     * work-stealing deque, jobs from non-worker threads are injected through shared lock-free ring.
+     * Thread waiting on JobCounter executes pending jobs instead of blocking.
+     */
+    class JobSystem {
+    public:
+        using JobFuncT = std::function<void()>;
+
+        void submit(JobFuncT func, JobCounter* counter = nullptr);
+        void wait  (const JobCounter& counter);
+
+        /**
+         * Split [0, count) into chunks and process them in parallel, caller thread takes part in work
+         * @param count - count of items
+         * @param grain - minimal count of items in one chunk
+         * @param func - function like void f(SizeT start, SizeT end)
+         */
+        template <typename Function>
+        void parallel_for(SizeT count, SizeT grain, Function&& func) {
+            if (count == 0)
+                return;
+
+            grain = grain ? grain : 1;
+
+            auto chunks = std::min((count + grain - 1) / grain, concurrency() * 4);
+            if (chunks <= 1) {
+                func(SizeT(0), count);
+                return;
+            }
+
+            auto chunk = (count + chunks - 1) / chunks;
+            auto counter = JobCounter();
+
+            for (SizeT start = chunk; start < count; start += chunk) {
+                auto end = std::min(start + chunk, count);
+                submit([&func, start, end] { func(start, end); }, &counter);
+            }
+
+            func(SizeT(0), chunk);
+            wait(counter);
+        }
+
+        SizeT workers_count() const { return _workers.size(); }
+        SizeT concurrency  () const { return _workers.size() + 1; } // Workers + caller thread
+
+    private:
+        void workerLoop(SizeT index);
+        auto findJob   (S64 index) -> jobs_dtls::Job*;
+        void execute   (jobs_dtls::Job* job);
+        void wakeUp    ();
+
+    private:
+        std::vector<std::thread>                                   _workers;
+        std::vector<std::unique_ptr<jobs_dtls::WorkStealingDeque>> _deques;
+
+        ftl::MpmcRing<jobs_dtls::Job*> _injected = ftl::MpmcRing<jobs_dtls::Job*>(4096);
+
+        std::mutex              _sleep_mutex;
+        std::condition_variable _sleep_cv;
+        std::atomic<S64>        _queued   = 0;
+        std::atomic<S64>        _sleepers = 0;
+        std::atomic<bool>       _stop     = false;
+
+    DE_MARK_AS_SINGLETON(JobSystem);
+    };
+
+
+    inline JobSystem& job_system() {
+        return JobSystem::instance();
+    }
+
+} // namespace base
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "baseTypes.hpp"
+#include "defines.hpp"
+
+// Log calls below this level are removed at compile time. Levels: 0 - trace ... 5 - fatal
+#ifndef DE_LOG_MIN_LEVEL
+    #ifdef DE_DEBUG
+        #define DE_LOG_MIN_LEVEL 0
+    #else
+        #define DE_LOG_MIN_LEVEL 2
+    #endif
+#endif
+
+namespace base {
+
+    enum class LogLevel : U8 {
+        Trace = 0, Debug, Info, Warning, Error, Fatal, Off
+    };
+
+    enum class LogCategory : U8 {
+        General = 0, Graphics, Io, Cfg, Lua, Count
+    };
+
+    constexpr auto LOG_MIN_LEVEL = static_cast<LogLevel>(DE_LOG_MIN_LEVEL);
+
+    namespace logs_dtls {
+        // Runtime thresholds, relaxed load is a plain read
+        inline std::atomic<U8> log_thresholds[static_cast<SizeT>(LogCategory::Count)] = {};
+    }
+
+    inline bool logEnabled(LogLevel level, LogCategory category) {
+        return static_cast<U8>(level) >=
+               logs_dtls::log_thresholds[static_cast<SizeT>(category)].load(std::memory_order_relaxed);
+    }
+
+    inline void setLogThreshold(LogCategory category, LogLevel level) {
+        logs_dtls::log_thresholds[static_cast<SizeT>(category)].store(static_cast<U8>(level), std::memory_order_relaxed);
+    }
+
+    inline auto logThreshold(LogCategory category) {
+        return static_cast<LogLevel>(logs_dtls::log_thresholds[static_cast<SizeT>(category)].load(std::memory_order_relaxed));
+    }
+
+    constexpr auto logLevelName(LogLevel level) -> std::string_view {
+        constexpr std::string_view names[] = {"trace", "debug", "info", "warning", "error", "fatal", "off"};
+        return names[static_cast<SizeT>(level)];
+    }
+
+    constexpr auto logCategoryName(LogCategory category) -> std::string_view {
+        constexpr std::string_view names[] = {"general", "graphics", "io", "cfg", "lua"};
+        return names[static_cast<SizeT>(category)];
+    }
+
+    inline auto logLevelFromName(std::string_view name) -> std::optional<LogLevel> {
+        for (U8 i = 0; i <= static_cast<U8>(LogLevel::Off); ++i)
+            if (logLevelName(static_cast<LogLevel>(i)) == name)
+                return static_cast<LogLevel>(i);
+
+        return std::nullopt;
+    }
+
+    /**
+     * Append "WARNING [graphics] " like prefix. Info messages of general category have no prefix
+     */
+    inline void appendLogPrefix(std::string& out, LogLevel level, LogCategory category) {
+        if (level != LogLevel::Info) {
+            for (auto c : logLevelName(level))
+                out += static_cast<char>(c - 'a' + 'A');
+            out += ' ';
+        }
+
+        if (category != LogCategory::General) {
+            out += '[';
+            out.append(logCategoryName(category));
+            out += "] ";
+        }
+    }
+
+} // namespace base
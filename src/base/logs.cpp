@@ -1,29 +1,318 @@
 #include "logs.hpp"
 
+#include <algorithm>
+#include <ctime>
+#include <iostream>
+
+#include "assert.hpp"
 #include "filesystem.hpp"
 
 #include "configs.hpp"
 
+namespace base::logs_dtls {
+    // Circular buffer of max size, the oldest entry is overwritten by the new one
+    struct Journal {
+        std::vector<JournalEntry> slots;
+        SizeT                     first = 0;
+        SizeT                     count = 0;
+
+        auto at(SizeT i) -> JournalEntry& { return slots[(first + i) % slots.size()]; }
+    };
+}
+
+namespace {
+    // Writer thread wakes up at least this often to drain the queue
+    constexpr auto WRITE_INTERVAL = std::chrono::milliseconds(5);
+
+    S64 nanoseconds(std::chrono::system_clock::time_point time) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+    }
+}
+
 base::Logger::Logger()  {
     logs_dtls::log_state().onCreate = true;
 
     // Todo: read log path from cfg
     auto path = ftl::String(base::fs::current_path().parent_path()) /
             cfg::force_read_ie<ftl::String>("logs_dir", "force_log");
+    _isBinary = cfg::force_read_ie<bool>("log_binary", false);
+    loadThresholds();
+
     auto name = ftl::String("log_");
-    name += timer().getSystemDateTime().to_string("DD_MM_YYYY__hh_mm_ss.log");
+    name += timer().getSystemDateTime().to_string("DD_MM_YYYY__hh_mm_ss");
+    name += _isBinary ? ftl::String(".blog") : ftl::String(".log");
     _fw.emplace(FileWriter(path / name));
 
-    _fw->write("!!! LOG START   ")
-        .write(timer().getSystemDateTime().to_string("DD.MM.YYYY hh:mm:ss:xxx.\n\n"))
-        .flush();
+    auto start = ftl::String("!!! LOG START   ") + timer().getSystemDateTime().to_string("DD.MM.YYYY hh:mm:ss:xxx.");
+
+    if (_isBinary) {
+        blog::write_header(_fileBatch);
+        blog::write_text_chunk(_fileBatch, nanoseconds(std::chrono::system_clock::now()),
+                               LogLevel::Info, LogCategory::General, start.c_str());
+        _fw->write(reinterpret_cast<const Byte*>(_fileBatch.data()), _fileBatch.size()).flush();
+        _fileBatch.clear();
+    }
+    else
+        _fw->write(start).write("\n\n").flush();
+
+    _journal = std::make_unique<logs_dtls::Journal>();
+    _journal->slots.resize(_journalMaxSize);
+    _writer = std::thread(&Logger::writerLoop, this);
 
     logs_dtls::log_state().onCreate = false;
     logs_dtls::log_state().isCreated = true;
 }
 
 base::Logger::~Logger() {
-    _fw->write("\n!!! LOG DESTROY ")
-        .write(timer().getSystemDateTime().to_string("DD.MM.YYYY hh:mm:ss:xxx.\n"))
-        .flush();
-}
\ No newline at end of file
+    {
+        auto lock = std::lock_guard(_writerMutex);
+        _stop = true;
+    }
+    _writerCv.notify_one();
+    _writer.join();
+
+    auto destroy = ftl::String("!!! LOG DESTROY ") + timer().getSystemDateTime().to_string("DD.MM.YYYY hh:mm:ss:xxx.");
+
+    if (_isBinary) {
+        blog::write_text_chunk(_fileBatch, nanoseconds(std::chrono::system_clock::now()),
+                               LogLevel::Info, LogCategory::General, destroy.c_str());
+        _fw->write(reinterpret_cast<const Byte*>(_fileBatch.data()), _fileBatch.size()).flush();
+    }
+    else
+        _fw->write("\n").write(destroy).write("\n").flush();
+}
+
+void base::Logger::flush() {
+    // Writer thread can't wait for itself (assert inside writer)
+    if (!_fw || std::this_thread::get_id() == _writer.get_id())
+        return;
+
+    auto ticket = ++_flushTicket;
+    auto fill   = [ticket](logs_dtls::Record& record) {
+        record.flush_ticket = ticket;
+        record.size         = 0;
+    };
+
+    while (!_queue.try_push(fill))
+        waitForSpace();
+    _writerCv.notify_one();
+
+    auto lock = std::unique_lock(_writerMutex);
+    _flushedCv.wait(lock, [this, ticket] { return _flushedTicket >= ticket || _stop; });
+}
+
+auto base::Logger::getJournal() const -> ftl::Vector<JournalEntry> {
+    auto lock   = std::lock_guard(_journalMutex);
+    auto result = ftl::Vector<JournalEntry>();
+
+    result.reserve(_journal->count);
+    for (SizeT i = 0; i < _journal->count; ++i)
+        result.push_back(_journal->at(i));
+
+    return result;
+}
+
+auto base::Logger::setJournalMaxSize(SizeT size) -> Logger& {
+    auto lock  = std::lock_guard(_journalMutex);
+    auto slots = std::vector<JournalEntry>(size);
+    auto count = std::min(size, _journal->count);
+
+    // The newest entries are kept
+    for (SizeT i = 0; i < count; ++i)
+        slots[i] = std::move(_journal->at(_journal->count - count + i));
+
+    _journal->slots = std::move(slots);
+    _journal->first = 0;
+    _journal->count = count;
+    _journalMaxSize = size;
+    return *this;
+}
+
+void base::Logger::loadThresholds() {
+    auto read_level = [](const ftl::String& key, LogLevel default_level) {
+        auto name  = cfg::force_read_ie<ftl::String>(key.c_str(), ftl::String(logLevelName(default_level)));
+        auto level = logLevelFromName(std::string_view(name.data(), name.size()));
+        RASSERTF(level.has_value(), "Invalid {} '{}' in fs.cfg", key, name);
+        return *level;
+    };
+
+    auto common = read_level("log_level", LogLevel::Trace);
+
+    for (U8 i = 0; i < static_cast<U8>(LogCategory::Count); ++i) {
+        auto category = static_cast<LogCategory>(i);
+        auto key      = ftl::String("log_level_") + ftl::String(logCategoryName(category));
+        setLogThreshold(category, read_level(key, common));
+    }
+}
+
+void base::Logger::onError(LogLevel level) {
+    if (level == LogLevel::Fatal)
+        flush();
+    else
+        _writerCv.notify_one();
+}
+
+void base::Logger::waitForSpace() {
+    _writerCv.notify_one();
+    std::this_thread::yield();
+}
+
+void base::Logger::writerLoop() {
+    auto lastFlush = std::chrono::steady_clock::now();
+    auto dirty     = false;
+    auto stopping  = false;
+    auto errors    = false;
+
+    while (true) {
+        auto ticket = U64(0);
+
+        while (_queue.try_pop([this, &ticket, &errors](logs_dtls::Record& record) {
+            if (record.flush_ticket)
+                ticket = std::max(ticket, record.flush_ticket);
+            else {
+                errors = errors || record.level >= LogLevel::Error;
+                write(record);
+            }
+        }));
+
+        if (!_fileBatch.empty()) {
+            _fw->write(reinterpret_cast<const Byte*>(_fileBatch.data()), _fileBatch.size());
+            _fileBatch.clear();
+            dirty = true;
+        }
+
+        if (!_consoleBatch.empty()) {
+            std::cout.write(_consoleBatch.data(), static_cast<std::streamsize>(_consoleBatch.size())).flush();
+            _consoleBatch.clear();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (dirty && (ticket || stopping || errors || now - lastFlush >= FLUSH_INTERVAL)) {
+            _fw->flush();
+            lastFlush = now;
+            dirty     = false;
+            errors    = false;
+        }
+
+        auto lock = std::unique_lock(_writerMutex);
+        if (ticket) {
+            // Concurrent flush() calls may push tickets out of order
+            _flushedTicket = std::max(_flushedTicket, ticket);
+            _flushedCv.notify_all();
+        }
+
+        // One more pass after stop request to write messages pushed before it
+        if (stopping)
+            break;
+
+        stopping = _stop;
+        if (!stopping)
+            _writerCv.wait_for(lock, WRITE_INTERVAL);
+    }
+
+    _flushedCv.notify_all();
+}
+
+void base::Logger::write(const logs_dtls::Record& record) {
+    auto formatted = std::optional<std::string>();
+    auto text      = record.text();
+
+    if (record.format_id) {
+        auto& format = formatInfo(record.format_id);
+        auto  args   = reinterpret_cast<const Byte*>(record.inline_text);
+
+        if (_isBinary) {
+            if (!_formatWritten[record.format_id]) {
+                blog::write_format_chunk(_fileBatch, record.format_id, format);
+                _formatWritten[record.format_id] = true;
+            }
+            blog::write_message_chunk(_fileBatch, nanoseconds(record.time), record.level, record.category,
+                                      record.format_id, args, record.size);
+
+            // Don't format at all if nobody reads text
+            if (!_isConsoleOutput && !_isAttachedToJournal)
+                return;
+        }
+
+        formatted = blog::format_message(format, args, record.size);
+        text      = formatted ? std::string_view(*formatted) : std::string_view(format.format.data(), format.format.size());
+    }
+    else if (_isBinary)
+        blog::write_text_chunk(_fileBatch, nanoseconds(record.time), record.level, record.category, text);
+
+    auto seconds = std::chrono::system_clock::to_time_t(record.time);
+    auto ms      = std::chrono::duration_cast<std::chrono::milliseconds>(record.time.time_since_epoch()).count() % 1000;
+
+    // localtime is slow, so it is called once per second
+    if (seconds != _lastSecond) {
+        auto tm = std::tm();
+        localtime_r(&seconds, &tm);
+
+        auto size = fmt::format_to_n(_secondPrefix, sizeof(_secondPrefix) - 1, "[{:02}:{:02}:{:02}:",
+                                     tm.tm_hour, tm.tm_min, tm.tm_sec).size;
+        _secondPrefix[size] = '\0';
+        _lastSecond = seconds;
+    }
+
+    char time[16];
+    auto time_size = fmt::format_to_n(time, sizeof(time), "{}{:03}]: ", _secondPrefix, ms).size;
+    auto time_text = std::string_view(time, std::min(time_size, sizeof(time)));
+
+    if (record.level != LogLevel::Info || record.category != LogCategory::General) {
+        _line.clear();
+        appendLogPrefix(_line, record.level, record.category);
+        _line.append(text);
+        text = _line;
+    }
+
+    if (!_isBinary) {
+        _fileBatch.append(time_text);
+        _fileBatch.append(text);
+        _fileBatch += '\n';
+    }
+
+    if (_isConsoleOutput) {
+        _consoleBatch.append(text);
+        _consoleBatch += '\n';
+    }
+
+    if (_isAttachedToJournal)
+        addToJournal(time_text, text);
+}
+
+auto base::Logger::formatInfo(U32 format_id) -> const blog::Format& {
+    if (format_id >= _formats.size()) {
+        _formats.resize(format_id + 1, nullptr);
+        _formatWritten.resize(format_id + 1, false);
+    }
+
+    if (!_formats[format_id])
+        _formats[format_id] = &blog::format_info(format_id);
+
+    return *_formats[format_id];
+}
+
+void base::Logger::addToJournal(std::string_view time, std::string_view str) {
+    auto lock = std::lock_guard(_journalMutex);
+    auto& j   = *_journal;
+
+    if (j.slots.empty())
+        return;
+
+    if (j.count == j.slots.size())
+        j.first = (j.first + 1) % j.slots.size();
+    else
+        ++j.count;
+
+    auto& entry = j.at(j.count - 1);
+
+    entry.time_size = static_cast<U8>(std::min(time.size(), sizeof(entry.time_text)));
+    entry.size      = str.size();
+    std::memcpy(entry.time_text, time.data(), entry.time_size);
+
+    // Buffer of long text is kept for the next long message in this slot
+    if (str.size() > JournalEntry::INLINE_SIZE)
+        entry.long_text.assign(str.data(), str.size());
+    else
+        std::memcpy(entry.message, str.data(), str.size());
+}
@@ -1,11 +1,23 @@
 #ifndef DECAYENGINE_LOGS_HPP
 #define DECAYENGINE_LOGS_HPP
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #include "defines.hpp"
 #include "time.hpp"
 #include "files.hpp"
 #include "ftl/string.hpp"
-#include <deque>
+#include "ftl/vector.hpp"
+#include "binary_log.hpp"
+#include "log_levels.hpp"
 
 namespace base {
     namespace logs_dtls {
@@ -33,42 +45,259 @@ namespace base {
         inline LoggerCreationState& log_state() {
             return LoggerCreationState::instance();
         }
+
+        struct Journal;
+
+
+        /**
+         * Log message in queue. Short messages are formatted right into the record,
+         * long ones go to the heap. Deferred messages keep raw arguments in inline_text
+         */
+        struct Record {
+            static constexpr SizeT INLINE_SIZE = 232;
+
+            auto text() const -> std::string_view {
+                return size > INLINE_SIZE ? std::string_view(long_text) : std::string_view(inline_text, size);
+            }
+
+            std::chrono::system_clock::time_point time;
+            U64         flush_ticket = 0; // Not zero for flush requests
+            U32         format_id    = 0; // Not zero for deferred messages
+            LogLevel    level        = LogLevel::Info;
+            LogCategory category     = LogCategory::General;
+            SizeT       size         = 0;
+            char        inline_text[INLINE_SIZE];
+            std::string long_text;
+        };
+
+        /**
+         * Bounded lock-free multi-producer single-consumer queue (D. Vyukov's algorithm).
+         * Values are constructed once and filled in place, so pushing doesn't allocate
+         */
+        template <typename T>
+        class MpscRing {
+            struct Cell {
+                std::atomic<SizeT> sequence;
+                T                  value;
+            };
+
+        public:
+            // Capacity must be a power of two
+            explicit MpscRing(SizeT capacity): _cells(new Cell[capacity]), _mask(capacity - 1) {
+                for (SizeT i = 0; i < capacity; ++i)
+                    _cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /**
+             * Fill free cell with filler(T&)
+             * @return false if queue is full
+             */
+            template <typename F>
+            bool try_push(F&& filler) {
+                auto pos = _enqueue_pos.load(std::memory_order_relaxed);
+                Cell* cell;
+
+                while (true) {
+                    cell = &_cells[pos & _mask];
+                    auto seq  = cell->sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+
+                    if (diff == 0) {
+                        if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = _enqueue_pos.load(std::memory_order_relaxed);
+                }
+
+                filler(cell->value);
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Pass oldest value to consumer(T&). Must be called from one thread only
+             * @return false if queue is empty or oldest value is still being filled
+             */
+            template <typename F>
+            bool try_pop(F&& consumer) {
+                auto cell = &_cells[_dequeue_pos & _mask];
+
+                if (cell->sequence.load(std::memory_order_acquire) != _dequeue_pos + 1)
+                    return false;
+
+                consumer(cell->value);
+                cell->sequence.store(_dequeue_pos + _mask + 1, std::memory_order_release);
+                ++_dequeue_pos;
+                return true;
+            }
+
+            auto capacity() const { return _mask + 1; }
+
+        private:
+            std::unique_ptr<Cell[]> _cells;
+            SizeT                   _mask;
+
+            alignas(64) std::atomic<SizeT> _enqueue_pos = 0;
+            alignas(64) SizeT              _dequeue_pos = 0;
+        };
     }
 
+    /**
+     * Line of log journal. Short messages are kept in inline buffer, so journal slots are reused
+     * without allocations, longer ones are stored whole in long_text
+     */
+    struct JournalEntry {
+        static constexpr SizeT INLINE_SIZE = 224;
+
+        auto time() const -> std::string_view { return std::string_view(time_text, time_size); }
+        auto text() const -> std::string_view {
+            return size > INLINE_SIZE ? std::string_view(long_text) : std::string_view(message, size);
+        }
+
+        char        time_text[16];
+        U8          time_size = 0;
+        SizeT       size      = 0;
+        char        message[INLINE_SIZE];
+        std::string long_text;
+    };
+
+    /**
+     * Asynchronous logger
+     *
+     * Producers format messages into records of lock-free ring and never wait on file or console.
+     * Background thread writes records in batches and flushes them every FLUSH_INTERVAL or on flush().
+     * Errors are flushed as soon as writer gets them, fatal messages are flushed before return.
+     * If ring is full producer waits for free record, so messages are never lost
+     */
     class Logger {
     public:
+        static constexpr SizeT QUEUE_SIZE     = 8192;
+        static constexpr auto  FLUSH_INTERVAL = std::chrono::milliseconds(100);
+
         template <typename FmtT, typename... ArgsT>
         void operator()(FmtT format, ArgsT... args) {
-            if (!_fw) return;
+            log(LogLevel::Info, LogCategory::General, format, args...);
+        }
+
+        template <typename FmtT, typename... ArgsT>
+        void log(LogLevel level, LogCategory category, FmtT format, ArgsT... args) {
+            // Thresholds may be changed by logger creation
+            if (!_fw || !logEnabled(level, category)) return;
 
-            auto msg  = ftl::String().sprintf(format, args...);
-            auto time = timer().getSystemDateTime().to_string("[hh:mm:ss:xxx]: ");
+            auto time = std::chrono::system_clock::now();
 
-            std::cout << msg << std::endl;
+            auto fill = [&](logs_dtls::Record& record) {
+                record.time         = time;
+                record.flush_ticket = 0;
+                record.format_id    = 0;
+                record.level        = level;
+                record.category     = category;
+                record.size = fmt::format_to_n(record.inline_text, logs_dtls::Record::INLINE_SIZE, format, args...).size;
 
-            _fw->write(time).write(msg).write("\n").flush();
+                if (record.size > logs_dtls::Record::INLINE_SIZE)
+                    record.long_text = fmt::format(format, args...);
+            };
 
-            if (_isAttachedToJournal)
-                addToJournal(time, msg);
+            while (!_queue.try_push(fill))
+                waitForSpace();
+
+            if (level >= LogLevel::Error)
+                onError(level);
         }
 
-        auto& journalMaxSize      () const   { return _journalMaxSize; }
-        auto& journalMaxSize      ()         { return _journalMaxSize; }
-        auto& getJournal          ()         { return _journal; }
+        /**
+         * Log with deferred formatting. Only arguments are copied, message is formatted
+         * by writer thread or by LogDecoder if log is binary. Used by DE_BLOG
+         */
+        template <typename... ArgsT>
+        void deferred(LogLevel level, LogCategory category, U32 format_id, const char* format, const ArgsT&... args) {
+            if (!_fw || !logEnabled(level, category)) return;
+
+            auto size = (blog::arg_size(args) + ... + SizeT(0));
+            if (size > logs_dtls::Record::INLINE_SIZE) {
+                log(level, category, format, args...);
+                return;
+            }
+
+            auto time = std::chrono::system_clock::now();
+
+            auto fill = [&](logs_dtls::Record& record) {
+                record.time         = time;
+                record.flush_ticket = 0;
+                record.format_id    = format_id;
+                record.level        = level;
+                record.category     = category;
+                record.size         = size;
+
+                [[maybe_unused]] auto out = reinterpret_cast<Byte*>(record.inline_text);
+                ((out = blog::encode_arg(out, args)), ...);
+            };
+
+            while (!_queue.try_push(fill))
+                waitForSpace();
+
+            if (level >= LogLevel::Error)
+                onError(level);
+        }
+
+        /**
+         * Write and flush all messages logged before the call. Called before abort
+         */
+        void flush();
+
+        auto  journalMaxSize      () const   { return _journalMaxSize.load(); }
+        auto  getJournal          () const   -> ftl::Vector<JournalEntry>;
+        auto  setJournalMaxSize   (SizeT size) -> Logger&;
         auto& setAttachedToJournal(bool val) { _isAttachedToJournal = val; return *this; }
+        auto& setConsoleOutput    (bool val) { _isConsoleOutput     = val; return *this; }
+        bool  isBinary            () const   { return _isBinary; }
+
+
+        /**
+         * Set thresholds from fs.cfg: log_level for all categories, log_level_<category> overrides it
+         */
+        void loadThresholds();
 
 
     protected:
-        void addToJournal(const ftl::String& time, const ftl::String& str) {
-            _journal.emplace_back(time, str);
-            if (_journal.size() > _journalMaxSize)
-                _journal.erase(_journal.begin());
-        }
+        void onError     (LogLevel level); // Wake up writer, wait for flush if fatal
+        void waitForSpace();
+        void writerLoop  ();
+        void write       (const logs_dtls::Record& record);
+        void addToJournal(std::string_view time, std::string_view str);
+        auto formatInfo  (U32 format_id) -> const blog::Format&;
+
+        std::atomic<SizeT>                  _journalMaxSize      = 100;
+        std::atomic<bool>                   _isAttachedToJournal = false;
+        std::atomic<bool>                   _isConsoleOutput     = true;
+        mutable std::mutex                  _journalMutex;
+        std::unique_ptr<logs_dtls::Journal> _journal;
+
+        logs_dtls::MpscRing<logs_dtls::Record> _queue = logs_dtls::MpscRing<logs_dtls::Record>(QUEUE_SIZE);
+
+        // Set in constructor before writer thread starts and read by producers, only writer thread writes to _fw
+        std::optional<FileWriter>        _fw = {};
+        bool                             _isBinary = false;
 
-        SizeT _journalMaxSize     = 100;
-        bool _isAttachedToJournal = false;
-        std::deque<std::pair<ftl::String, ftl::String>> _journal;
-        std::optional<FileWriter> _fw = {};
+        // Used by writer thread only
+        std::vector<const blog::Format*> _formats;       // Cache of registered formats by id
+        std::vector<bool>                _formatWritten; // Format chunk is written to binary log
+        std::string                      _fileBatch;
+        std::string                      _consoleBatch;
+        std::string                      _line;          // Message with level and category prefix
+        std::time_t                      _lastSecond = -1;
+        char                             _secondPrefix[16];
+
+        std::mutex                       _writerMutex;
+        std::condition_variable          _writerCv;
+        std::condition_variable          _flushedCv;
+        std::atomic<U64>                 _flushTicket = 0;
+        U64                              _flushedTicket = 0;
+        bool                             _stop = false;
+        std::thread                      _writer;
 
     // Singleton impl
     public:
@@ -88,10 +317,37 @@ namespace base {
 
     template <typename FmtT, typename... ArgsT>
     inline void Log(FmtT format, ArgsT... args) {
-        if (!logs_dtls::log_state().onCreate)
+        if (logEnabled(LogLevel::Info, LogCategory::General) && !logs_dtls::log_state().onCreate)
             Logger::instance()(format, args...);
     }
 
+    /**
+     * Leveled log call, use DE_LOG to skip arguments evaluation for disabled levels
+     */
+    template <typename FmtT, typename... ArgsT>
+    inline void LogAt(LogLevel level, LogCategory category, FmtT format, ArgsT... args) {
+        if (!logs_dtls::log_state().onCreate)
+            Logger::instance().log(level, category, format, args...);
+    }
+
+    /**
+     * Deferred log call, use DE_BLOG. Format is registered once per call site,
+     * SiteT is unique type of call site (lambda from DE_BLOG)
+     */
+    template <typename SiteT, SizeT N, typename... ArgsT>
+    inline void BLog(LogLevel level, LogCategory category, SiteT, const char* file, U32 line,
+                     const char (&format)[N], const ArgsT&... args) {
+        static const auto id = blog::register_format(format, file, line, {blog::arg_type<ArgsT>()...});
+
+        if (!logs_dtls::log_state().onCreate)
+            Logger::instance().deferred(level, category, id, format, args...);
+    }
+
+    inline void LogFlush() {
+        if (logs_dtls::log_state().isCreated)
+            Logger::instance().flush();
+    }
+
     inline void logger() {
         Logger::instance();
     }
@@ -99,8 +355,8 @@ namespace base {
 #ifdef DE_DEBUG
     template <typename FmtT, typename... ArgsT>
     inline void DLog(FmtT format, ArgsT... args) {
-        if (!logs_dtls::log_state().onCreate)
-            Logger::instance()(format, args...);
+        if (logEnabled(LogLevel::Debug, LogCategory::General) && !logs_dtls::log_state().onCreate)
+            Logger::instance().log(LogLevel::Debug, LogCategory::General, format, args...);
     }
 #else
     template <typename FmtT, typename... ArgsT>
@@ -110,4 +366,25 @@ namespace base {
 
 
 
+/**
+ * Leveled logging: DE_LOG(Warning, Graphics, "Can't load '{}'", path)
+ * Calls below DE_LOG_MIN_LEVEL are removed at compile time, calls below runtime threshold
+ * of category cost one branch and don't evaluate arguments
+ */
+#define DE_LOG(LEVEL, CATEGORY, ...) \
+    do { \
+        if constexpr (::base::LogLevel::LEVEL >= ::base::LOG_MIN_LEVEL) \
+            if (::base::logEnabled(::base::LogLevel::LEVEL, ::base::LogCategory::CATEGORY)) \
+                ::base::LogAt(::base::LogLevel::LEVEL, ::base::LogCategory::CATEGORY, __VA_ARGS__); \
+    } while (false)
+
+// Same with deferred formatting. Format must be string literal, arguments are numbers, chars and strings
+#define DE_BLOG(LEVEL, CATEGORY, ...) \
+    do { \
+        if constexpr (::base::LogLevel::LEVEL >= ::base::LOG_MIN_LEVEL) \
+            if (::base::logEnabled(::base::LogLevel::LEVEL, ::base::LogCategory::CATEGORY)) \
+                ::base::BLog(::base::LogLevel::LEVEL, ::base::LogCategory::CATEGORY, [] {}, \
+                             __FILE__, __LINE__, __VA_ARGS__); \
+    } while (false)
+
 #endif //DECAYENGINE_LOGS_HPP
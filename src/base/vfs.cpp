@@ -0,0 +1,346 @@
+#include "vfs.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#include <xxhash.h>
+
+#include "assert.hpp"
+#include "allocators/Arena.hpp"
+#include "compression.hpp"
+#include "filesystem.hpp"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace {
+    constexpr SizeT DATA_ALIGNMENT = 16;
+
+    auto openLoose(const std::string& path) -> std::optional<base::VfsFile> {
+        auto file = base::MappedFile::openOpt(path, base::MappedFile::Access::Sequential);
+        if (!file)
+            return std::nullopt;
+
+        auto mapping = std::make_shared<const base::MappedFile>(std::move(*file));
+        auto bytes   = mapping->bytes();
+
+        return base::VfsFile(std::move(mapping), bytes);
+    }
+
+    bool isRegularFile(const std::string& path) {
+        struct stat st = {};
+        return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+    }
+
+    auto joinPath(const ftl::String& dir, const ftl::String& path) -> std::string {
+        return (dir / path).c_str();
+    }
+}
+
+
+////////////////////////////////// VfsFile
+
+base::VfsFile::VfsFile(std::shared_ptr<const MappedFile> mapping, BytesView bytes):
+    _mapping(std::move(mapping)), _bytes(bytes) {}
+
+base::VfsFile::VfsFile(ftl::Vector<Byte> buffer): _buffer(std::move(buffer)) {
+    _bytes = BytesView(_buffer.data(), _buffer.size());
+}
+
+
+////////////////////////////////// Paths
+
+auto base::normalizePath(const std::string_view& path) -> ftl::String {
+    auto scope    = ArenaScope();
+    auto parts    = std::pmr::vector<std::string_view>(&scope.arena());
+    auto absolute = !path.empty() && path.front() == '/';
+
+    for (SizeT start = 0; start < path.size();) {
+        auto end = std::min(path.find('/', start), path.size());
+        auto part = path.substr(start, end - start);
+
+        if (part == "..") {
+            if (!parts.empty() && parts.back() != "..")
+                parts.pop_back();
+            else if (!absolute)
+                parts.push_back(part);
+        }
+        else if (!part.empty() && part != ".")
+            parts.push_back(part);
+
+        start = end + 1;
+    }
+
+    auto result = ftl::String();
+    result.reserve(path.size() + 1);
+
+    if (absolute)
+        result += '/';
+
+    for (auto& part : parts) {
+        if (result.size() > 1 || (!absolute && !result.empty()))
+            result += '/';
+        result.insert(result.end(), part.begin(), part.end());
+    }
+
+    return result;
+}
+
+auto base::packPathHash(const std::string_view& normalized_path) -> U64 {
+    return XXH64(normalized_path.data(), normalized_path.size(), 0);
+}
+
+
+////////////////////////////////// PackArchive
+
+auto base::PackArchive::openOpt(const std::string_view& path) -> std::optional<PackArchive> {
+    auto file = MappedFile::openOpt(path, MappedFile::Access::Random);
+    if (!file || file->size() < sizeof(PackHeader))
+        return std::nullopt;
+
+    auto header = PackHeader();
+    auto size   = file->size() - sizeof(PackHeader);
+    std::memcpy(&header, file->data() + size, sizeof(PackHeader));
+
+    auto valid = header.magic == PackHeader::MAGIC && header.version == PackHeader::VERSION &&
+                 header.entries_offset % alignof(PackEntry) == 0 &&
+                 header.entries_offset <= size &&
+                 header.entries_count <= (size - header.entries_offset) / sizeof(PackEntry) &&
+                 header.names_offset <= size && header.names_size <= size - header.names_offset;
+
+    if (!valid)
+        return std::nullopt;
+
+    auto archive = PackArchive();
+    archive._entries = reinterpret_cast<const PackEntry*>(file->data() + header.entries_offset);
+    archive._count   = static_cast<SizeT>(header.entries_count);
+    archive._names   = reinterpret_cast<const char*>(file->data() + header.names_offset);
+
+    for (auto& entry : archive) {
+        valid = entry.offset <= header.entries_offset && entry.size <= header.entries_offset - entry.offset &&
+                U64(entry.name_offset) + entry.name_size <= header.names_size &&
+                (entry.compression == static_cast<U32>(PackCompression::LZ4) ||
+                 (entry.compression == static_cast<U32>(PackCompression::Store) && entry.size == entry.original_size));
+
+        if (!valid)
+            return std::nullopt;
+    }
+
+    archive._file = std::make_shared<const MappedFile>(std::move(*file));
+    return std::move(archive);
+}
+
+auto base::PackArchive::find(const std::string_view& path) const -> const PackEntry* {
+    auto hash  = packPathHash(path);
+    auto entry = std::lower_bound(begin(), end(), hash, [](const PackEntry& e, U64 h) { return e.path_hash < h; });
+
+    // Compare names in case of hash collision
+    for (; entry != end() && entry->path_hash == hash; ++entry)
+        if (name(*entry) == path)
+            return entry;
+
+    return nullptr;
+}
+
+auto base::PackArchive::read(const PackEntry& entry) const -> std::optional<VfsFile> {
+    if (entry.compression == static_cast<U32>(PackCompression::Store))
+        return VfsFile(_file, _file->bytes(entry.offset, entry.size));
+
+    auto buffer = ftl::Vector<Byte>(static_cast<SizeT>(entry.original_size));
+
+    if (!lz4::decompress(_file->data() + entry.offset, entry.size, buffer.data(), buffer.size()))
+        return std::nullopt;
+
+    return VfsFile(std::move(buffer));
+}
+
+
+////////////////////////////////// Archive writer
+
+auto base::writePackArchive(const ftl::String& output, const ftl::Vector<PackSource>& sources,
+                            PackCompression compression) -> PackStats {
+    struct Item {
+        ftl::String       name;
+        U64               hash;
+        const PackSource* source;
+    };
+
+    auto items = std::vector<Item>();
+    items.reserve(sources.size());
+
+    for (auto& source : sources) {
+        auto name = normalizePath(std::string_view(source.path.data(), source.path.size()));
+        auto hash = packPathHash(std::string_view(name.data(), name.size()));
+        items.push_back(Item{std::move(name), hash, &source});
+    }
+
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        return a.hash < b.hash || (a.hash == b.hash && std::string_view(a.name.c_str()) < b.name.c_str());
+    });
+
+    for (SizeT i = 1; i < items.size(); ++i)
+        RASSERTF(items[i].name != items[i - 1].name, "Duplicate path '{}' in archive '{}'", items[i].name, output);
+
+    auto stats   = PackStats();
+    auto entries = std::vector<PackEntry>(items.size());
+    auto names   = ftl::String();
+    auto offset  = U64(0);
+    auto fw      = FileWriter(output);
+    auto padding = std::array<Byte, DATA_ALIGNMENT>();
+
+    auto pad = [&](SizeT alignment) {
+        auto count = (alignment - offset % alignment) % alignment;
+        fw.write(padding.data(), count);
+        offset += count;
+    };
+
+    for (SizeT i = 0; i < items.size(); ++i) {
+        auto& entry = entries[i];
+        auto  file  = MappedFile(items[i].source->real_path, MappedFile::Access::Sequential);
+
+        entry.path_hash     = items[i].hash;
+        entry.offset        = offset;
+        entry.original_size = file.size();
+        entry.name_offset   = static_cast<U32>(names.size());
+        entry.name_size     = static_cast<U32>(items[i].name.size());
+        names += items[i].name;
+
+        auto packed = ftl::Vector<Byte>();
+        if (compression == PackCompression::LZ4 && !file.empty())
+            packed = lz4::compress(file.data(), file.size());
+
+        if (!packed.empty() && packed.size() + file.size() / 16 < file.size()) {
+            entry.compression = static_cast<U32>(PackCompression::LZ4);
+            entry.size        = packed.size();
+            fw.write(packed.data(), packed.size());
+        } else {
+            entry.compression = static_cast<U32>(PackCompression::Store);
+            entry.size        = file.size();
+            fw.write(file.data(), file.size());
+        }
+
+        offset += entry.size;
+        pad(DATA_ALIGNMENT);
+
+        stats.original_size += entry.original_size;
+        ++stats.files_count;
+    }
+
+    auto header = PackHeader();
+    header.entries_count  = entries.size();
+    header.entries_offset = offset;
+    header.names_offset   = offset + sizeof(PackEntry) * entries.size();
+    header.names_size     = names.size();
+
+    fw.write(reinterpret_cast<const Byte*>(entries.data()), sizeof(PackEntry) * entries.size());
+    fw.write(names);
+    offset = header.names_offset + header.names_size;
+    pad(alignof(PackHeader));
+
+    fw.write(reinterpret_cast<const Byte*>(&header), sizeof(header));
+    fw.flush();
+
+    stats.packed_size = offset + sizeof(header);
+    return stats;
+}
+
+
+////////////////////////////////// Vfs
+
+base::Vfs::Vfs(): _data_root(normalizePath(fs::current_path().parent_path().c_str())) {
+    auto archives = std::vector<std::string>();
+
+    if (auto dir = opendir(_data_root.c_str())) {
+        while (auto ent = readdir(dir)) {
+            auto name = std::string_view(ent->d_name);
+            if (name.size() > 4 && name.substr(name.size() - 4) == ".dpk")
+                archives.emplace_back(name);
+        }
+        closedir(dir);
+    }
+
+    // Later archives override earlier, so patches may be named after base archive
+    std::sort(archives.begin(), archives.end());
+
+    for (auto& name : archives)
+        mount_archive(_data_root / ftl::String(name));
+
+    mount_dir(_data_root);
+}
+
+base::Vfs::~Vfs() = default;
+
+void base::Vfs::mount_dir(const ftl::String& root) {
+    auto lock = std::unique_lock(_mutex);
+    _mounts.push_back(Mount{normalizePath(root.c_str()), std::nullopt});
+}
+
+bool base::Vfs::mount_archive(const ftl::String& path) {
+    auto archive = PackArchive::openOpt(path.c_str());
+    if (!archive)
+        return false;
+
+    auto lock = std::unique_lock(_mutex);
+    _mounts.push_back(Mount{path, std::move(archive)});
+    return true;
+}
+
+auto base::Vfs::virtual_path(const std::string_view& path) const -> std::optional<ftl::String> {
+    auto normalized = normalizePath(path);
+
+    if (normalized.empty() || normalized.front() != '/')
+        return normalized;
+
+    auto view = std::string_view(normalized.data(), normalized.size());
+    auto root = std::string_view(_data_root.data(), _data_root.size());
+
+    if (view.substr(0, root.size()) != root)
+        return std::nullopt;
+
+    if (view.size() == root.size())
+        return ftl::String();
+
+    if (view[root.size()] != '/' && root != "/")
+        return std::nullopt;
+
+    return ftl::String(view.substr(root == "/" ? 1 : root.size() + 1));
+}
+
+auto base::Vfs::open(const std::string_view& path) const -> std::optional<VfsFile> {
+    auto vpath = virtual_path(path);
+    if (!vpath)
+        return openLoose(std::string(path));
+
+    auto name = std::string_view(vpath->data(), vpath->size());
+    auto lock = std::shared_lock(_mutex);
+
+    for (auto mount = _mounts.rbegin(); mount != _mounts.rend(); ++mount) {
+        if (mount->archive) {
+            if (auto entry = mount->archive->find(name))
+                return mount->archive->read(*entry);
+        }
+        else if (auto file = openLoose(joinPath(mount->dir, *vpath)))
+            return file;
+    }
+
+    return std::nullopt;
+}
+
+bool base::Vfs::exists(const std::string_view& path) const {
+    auto vpath = virtual_path(path);
+    if (!vpath)
+        return isRegularFile(std::string(path));
+
+    auto name = std::string_view(vpath->data(), vpath->size());
+    auto lock = std::shared_lock(_mutex);
+
+    for (auto mount = _mounts.rbegin(); mount != _mounts.rend(); ++mount) {
+        if (mount->archive ? mount->archive->find(name) != nullptr : isRegularFile(joinPath(mount->dir, *vpath)))
+            return true;
+    }
+
+    return false;
+}
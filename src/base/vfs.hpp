@@ -0,0 +1,193 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "defines.hpp"
+#include "files.hpp"
+#include "ftl/string.hpp"
+#include "ftl/vector.hpp"
+
+namespace base {
+
+    /**
+     * Packed gamedata archive (.dpk)
+     *
+     * Entries data aligned to 16 bytes, PackEntry directory sorted by path hash, names block
+     * and PackHeader at the end of file, so archive is written in one pass.
+     * Paths are relative to data directory: "gamedata/textures/dummy.tga"
+     */
+    struct PackHeader {
+        static constexpr U32 MAGIC   = 0x4B415044; // "DPAK"
+        static constexpr U32 VERSION = 1;
+
+        U32 magic          = MAGIC;
+        U32 version        = VERSION;
+        U64 entries_count  = 0;
+        U64 entries_offset = 0;
+        U64 names_offset   = 0;
+        U64 names_size     = 0;
+    };
+
+    enum class PackCompression : U32 {
+        Store = 0, LZ4
+    };
+
+    struct PackEntry {
+        U64 path_hash     = 0; // xxhash64 of normalized path
+        U64 offset        = 0; // From the start of archive
+        U64 size          = 0; // Stored size
+        U64 original_size = 0;
+        U32 compression   = 0;
+        U32 name_offset   = 0; // From the start of names block
+        U32 name_size     = 0;
+        U32 reserved      = 0;
+    };
+
+
+    /**
+     * File opened through VFS
+     *
+     * View to file mapping for loose files and stored archive entries or decompressed buffer
+     * for compressed entries. Archive mapping is shared, so file outlives unmounting
+     */
+    class VfsFile {
+    public:
+        VfsFile() = default;
+        VfsFile(std::shared_ptr<const MappedFile> mapping, BytesView bytes);
+        explicit VfsFile(ftl::Vector<Byte> buffer);
+
+        VfsFile(VfsFile&&) = default;
+        VfsFile& operator=(VfsFile&&) = default;
+
+        VfsFile(const VfsFile&) = delete;
+        VfsFile& operator=(const VfsFile&) = delete;
+
+        auto bytes() const { return _bytes; }
+
+        auto view() const -> std::string_view {
+            return std::string_view(reinterpret_cast<const char*>(_bytes.data()), _bytes.size());
+        }
+
+        auto data () const { return _bytes.data(); }
+        auto size () const { return _bytes.size(); }
+        bool empty() const { return _bytes.empty(); }
+
+    private:
+        std::shared_ptr<const MappedFile> _mapping;
+        ftl::Vector<Byte>                 _buffer;
+        BytesView                         _bytes;
+    };
+
+
+    class PackArchive {
+    public:
+        /**
+         * Map archive and validate its directory
+         * @return nullopt if file can't be mapped or corrupted
+         */
+        static auto openOpt(const std::string_view& path) -> std::optional<PackArchive>;
+
+        /**
+         * Find entry by normalized path
+         * @return nullptr if archive has no such entry
+         */
+        auto find(const std::string_view& path) const -> const PackEntry*;
+
+        /**
+         * Read entry data, compressed entries are decompressed to new buffer
+         * @return nullopt if entry data is corrupted
+         */
+        auto read(const PackEntry& entry) const -> std::optional<VfsFile>;
+
+        auto name(const PackEntry& entry) const -> std::string_view {
+            return std::string_view(_names + entry.name_offset, entry.name_size);
+        }
+
+        auto begin() const { return _entries; }
+        auto end  () const { return _entries + _count; }
+        auto size () const { return _count; }
+
+    private:
+        PackArchive() = default;
+
+        std::shared_ptr<const MappedFile> _file;
+        const PackEntry*                  _entries = nullptr;
+        SizeT                             _count   = 0;
+        const char*                       _names   = nullptr;
+    };
+
+
+    struct PackSource {
+        ftl::String path;      // Path inside archive, relative to data directory
+        ftl::String real_path; // Path to file on disk
+    };
+
+    struct PackStats {
+        SizeT files_count   = 0;
+        SizeT original_size = 0;
+        SizeT packed_size   = 0;
+    };
+
+    /**
+     * Write archive. Entry is stored as is if compression doesn't save at least 1/16 of its size
+     */
+    auto writePackArchive(const ftl::String& output, const ftl::Vector<PackSource>& sources,
+                          PackCompression compression) -> PackStats;
+
+    auto packPathHash(const std::string_view& normalized_path) -> U64;
+
+    /**
+     * Collapse repeated slashes, "." and ".." components. Keeps leading slash of absolute path
+     */
+    auto normalizePath(const std::string_view& path) -> ftl::String;
+
+
+    /**
+     * Virtual file system over data directory
+     *
+     * Mounts are searched from the last one, so later mounts override earlier. On startup all
+     * archives (*.dpk) from data directory are mounted in name order and data directory itself
+     * is mounted over them, so loose files override packed ones.
+     * Accepts paths relative to data directory as well as absolute paths from fs::to_data_path().
+     * Absolute paths outside of data directory are read directly. Does not touch configs and logs,
+     * so configs are loaded through it too
+     */
+    class Vfs {
+    public:
+        void mount_dir    (const ftl::String& root);
+        bool mount_archive(const ftl::String& path); // Returns false if archive can't be opened
+
+        auto open  (const std::string_view& path) const -> std::optional<VfsFile>;
+        bool exists(const std::string_view& path) const;
+
+        /**
+         * Normalized path relative to data directory or nullopt if path is outside of it
+         */
+        auto virtual_path(const std::string_view& path) const -> std::optional<ftl::String>;
+
+        auto& data_root() const { return _data_root; }
+
+    private:
+        struct Mount {
+            ftl::String                dir;
+            std::optional<PackArchive> archive;
+        };
+
+        ftl::String                _data_root;
+        mutable std::shared_mutex  _mutex;
+        std::vector<Mount>         _mounts;
+
+    DE_MARK_AS_SINGLETON(Vfs);
+    };
+
+
+    inline Vfs& vfs() {
+        return Vfs::instance();
+    }
+
+} // namespace base
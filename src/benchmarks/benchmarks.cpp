@@ -11,6 +11,7 @@ std::size_t aabbs_count = 100337;
 #endif
 
 #include <array>
+#include <atomic>
 #include <vector>
 #include <random>
 #include <ctime>
@@ -20,6 +21,8 @@ std::size_t aabbs_count = 100337;
 #include <malloc.h>
 #include <iomanip>
 #include <thread>
+#include <algorithm>
+#include <cmath>
 
 
 using Float = float;
@@ -434,4 +437,1347 @@ static void BM_DE_culling(benchmark::State& state) {
 }
 BENCHMARK(BM_DE_culling);
 
+
+// IDs of AABBs added by the last fill function
+static std::vector<SizeT> registered_ids;
+
+static void clearStorage() {
+    grx::frustum_storage().clear();
+    registered_ids.clear();
+}
+
+static void registerAabb(const AabbT& aabb, bool is_static = false) {
+    registered_ids.push_back(grx::frustum_storage().getID(std::pair(
+            glm::vec4(aabb.first.x,  aabb.first.y,  aabb.first.z,  1.f),
+            glm::vec4(aabb.second.x, aabb.second.y, aabb.second.z, 1.f)), is_static));
+}
+
+
+// Culling output modes: per-object results scan vs compacted visible IDs
+// 100k objects, 5% of them are visible
+auto fillStorageWithVisibility(std::size_t count, double visible_part) {
+    auto frustum_arr = generateFrustum();
+    auto visible_count = static_cast<std::size_t>(count * visible_part);
+
+    AabbV visible, invisible;
+    while (visible.size() < visible_count || invisible.size() < count - visible_count) {
+        for (auto& aabb : generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count)) {
+            if (frustum_test(aabb, frustum_arr) == 0) {
+                if (visible.size() < visible_count)
+                    visible.push_back(aabb);
+            }
+            else if (invisible.size() < count - visible_count)
+                invisible.push_back(aabb);
+        }
+    }
+
+    auto all = std::vector<AabbT>(visible.begin(), visible.end());
+    all.insert(all.end(), invisible.begin(), invisible.end());
+    std::shuffle(all.begin(), all.end(), mt);
+
+    clearStorage();
+    for (auto& aabb : all)
+        registerAabb(aabb);
+
+    frst_st::FrustumStorage::FrustumT frustum;
+    for (int i = 0; i < 6; ++i)
+        frustum[i] = glm::vec4(frustum_arr[i].x, frustum_arr[i].y, frustum_arr[i].z, frustum_arr[i].w);
+
+    return frustum;
+}
+
+static void BM_culling_output_results(benchmark::State& state) {
+    auto frustum = fillStorageWithVisibility(100000, 0.05);
+    auto& storage = grx::frustum_storage();
+
+    for (auto _ : state) {
+        storage.calculateCulling(frustum);
+
+        SizeT sum = 0;
+        for (auto id : registered_ids)
+            if (storage.getResult(id) == 0)
+                sum += id;
+
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_culling_output_results)->UseRealTime();
+
+static void BM_culling_output_visible_ids(benchmark::State& state) {
+    auto frustum = fillStorageWithVisibility(100000, 0.05);
+    auto& storage = grx::frustum_storage();
+
+    for (auto _ : state) {
+        SizeT sum = 0;
+        for (auto id : storage.calculateVisible(frustum))
+            sum += id;
+
+        benchmark::DoNotOptimize(sum);
+    }
+}
+BENCHMARK(BM_culling_output_visible_ids)->UseRealTime();
+
+
+// Static scene: brute-force SIMD pass vs BVH, shows the crossover point
+static void fillStorageWorld(std::size_t count, bool is_static) {
+    clearStorage();
+
+    auto aabbs = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-1000, -1000, -1000), vec3(1000, 1000, 1000), count);
+    for (auto& aabb : aabbs)
+        registerAabb(aabb, is_static);
+}
+
+static auto benchmarkFrustum() {
+    auto frustum_arr = generateFrustum();
+    frst_st::FrustumStorage::FrustumT frustum;
+
+    for (int i = 0; i < 6; ++i)
+        frustum[i] = glm::vec4(frustum_arr[i].x, frustum_arr[i].y, frustum_arr[i].z, frustum_arr[i].w);
+
+    return frustum;
+}
+
+static void BM_culling_static_brute_force(benchmark::State& state) {
+    fillStorageWorld(static_cast<std::size_t>(state.range(0)), false);
+    auto frustum = benchmarkFrustum();
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(grx::frustum_storage().calculateVisible(frustum).size());
+}
+BENCHMARK(BM_culling_static_brute_force)->RangeMultiplier(4)->Range(256, 1 << 20)->UseRealTime();
+
+static void BM_culling_static_bvh(benchmark::State& state) {
+    fillStorageWorld(static_cast<std::size_t>(state.range(0)), true);
+    auto frustum = benchmarkFrustum();
+
+    // Build BVH before measurement
+    grx::frustum_storage().calculateVisible(frustum);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(grx::frustum_storage().calculateVisible(frustum).size());
+}
+BENCHMARK(BM_culling_static_bvh)->RangeMultiplier(4)->Range(256, 1 << 20)->UseRealTime();
+
+
+// Temporal coherence: camera path replay over 200k objects
+struct CameraKey {
+    Float x, y, z;
+    Float yaw, pitch;
+    int   frames; // Frames to reach the next key
+};
+
+// Walk forward, stop and look around, strafe, stand still
+static const CameraKey camera_path[] = {
+    {   0.f, 2.f,    0.f, 0.0f,  0.0f, 120 },
+    {   0.f, 2.f,  120.f, 0.0f,  0.0f,  60 },
+    {   0.f, 2.f,  120.f, 1.2f,  0.1f,  60 },
+    {   0.f, 2.f,  120.f, 1.2f,  0.1f,  90 },
+    {  80.f, 2.f,  120.f, 1.2f, -0.1f, 120 },
+    {  80.f, 2.f,   40.f, 3.0f,  0.0f,  60 },
+    {  80.f, 2.f,   40.f, 3.0f,  0.0f,  60 },
+    {   0.f, 2.f,    0.f, 0.0f,  0.0f,   0 },
+};
+
+static auto frustumFromCamera(const CameraKey& cam, Float fov = 1.f, Float aspect = 16.f / 9.f) {
+    auto fx = std::cos(cam.pitch) * std::sin(cam.yaw);
+    auto fy = std::sin(cam.pitch);
+    auto fz = std::cos(cam.pitch) * std::cos(cam.yaw);
+    auto rx = std::cos(cam.yaw), rz = -std::sin(cam.yaw);
+    auto ux = fy * rz, uy = fz * rx - fx * rz, uz = -fy * rx; // up = forward x right
+
+    auto th = std::tan(fov * 0.5f);
+    auto tw = th * aspect;
+
+    auto plane = [&](Float nx, Float ny, Float nz, Float offset) {
+        auto len = std::sqrt(nx * nx + ny * ny + nz * nz);
+        nx /= len; ny /= len; nz /= len;
+        return glm::vec4(nx, ny, nz, -(nx * cam.x + ny * cam.y + nz * cam.z) + offset);
+    };
+
+    frst_st::FrustumStorage::FrustumT frustum;
+    frustum[0] = plane(fx * tw + rx, fy * tw,      fz * tw + rz, 0.f);    // Left
+    frustum[1] = plane(fx * tw - rx, fy * tw,      fz * tw - rz, 0.f);    // Right
+    frustum[2] = plane(fx * th + ux, fy * th + uy, fz * th + uz, 0.f);    // Bottom
+    frustum[3] = plane(fx * th - ux, fy * th - uy, fz * th - uz, 0.f);    // Top
+    frustum[4] = plane( fx,  fy,  fz, -0.1f);                             // Near
+    frustum[5] = plane(-fx, -fy, -fz, 1000.f);                            // Far
+
+    return frustum;
+}
+
+static auto recordCameraPath() {
+    std::vector<frst_st::FrustumStorage::FrustumT> frames;
+
+    for (SizeT k = 0; k + 1 < std::size(camera_path); ++k) {
+        auto& a = camera_path[k];
+        auto& b = camera_path[k + 1];
+
+        for (int f = 0; f < a.frames; ++f) {
+            auto t = static_cast<Float>(f) / a.frames;
+            frames.push_back(frustumFromCamera(CameraKey{
+                a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t,
+                a.yaw + (b.yaw - a.yaw) * t, a.pitch + (b.pitch - a.pitch) * t, 0}));
+        }
+    }
+
+    return frames;
+}
+
+static void BM_culling_camera_replay(benchmark::State& state) {
+    constexpr std::size_t objects = 200000;
+    constexpr std::size_t moving  = 1000; // Objects moved every frame
+
+    clearStorage();
+    grx::frustum_storage().setTemporalCoherence(state.range(0) != 0);
+
+    auto aabbs = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-1000, -50, -1000), vec3(1000, 50, 1000), objects);
+    for (auto& aabb : aabbs)
+        registerAabb(aabb);
+
+    auto frames = recordCameraPath();
+    auto offset = std::uniform_real_distribution<Float>(-1.f, 1.f);
+    SizeT frame = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < moving; ++i) {
+            auto id   = registered_ids[(frame * moving + i * 197) % objects];
+            auto aabb = grx::frustum_storage().getAabb(id);
+            auto move = glm::vec4(offset(mt), 0.f, offset(mt), 0.f);
+            grx::frustum_storage().setAabb(id, std::pair(aabb.first + move, aabb.second + move));
+        }
+
+        grx::frustum_storage().calculateCulling(frames[frame % frames.size()]);
+        ++frame;
+    }
+
+    grx::frustum_storage().setTemporalCoherence(true);
+    state.counters["frames"] = static_cast<double>(frames.size());
+}
+BENCHMARK(BM_culling_camera_replay)->ArgName("coherent")->Arg(0)->Arg(1)->UseRealTime();
+
+// Streaming threads register and unregister AABBs while main thread culls
+static void BM_culling_streaming(benchmark::State& state) {
+    constexpr std::size_t objects = 200000;
+    constexpr std::size_t batch   = 256; // AABBs held by streaming thread at once
+
+    fillStorageWorld(objects, false);
+
+    auto frustum = benchmarkFrustum();
+    auto stop    = std::atomic<bool>(false);
+    auto changes = std::atomic<std::size_t>(0);
+    auto streams = std::vector<std::thread>();
+
+    for (int t = 0; t < state.range(0); ++t) {
+        streams.emplace_back([&] {
+            auto ids = std::vector<SizeT>();
+            auto box = std::pair(glm::vec4(-1.f, -1.f, -1.f, 1.f), glm::vec4(1.f, 1.f, 1.f, 1.f));
+
+            while (!stop.load(std::memory_order_relaxed)) {
+                for (std::size_t i = 0; i < batch; ++i)
+                    ids.push_back(grx::frustum_storage().getID(box));
+                for (auto id : ids)
+                    grx::frustum_storage().removeID(id);
+
+                changes.fetch_add(ids.size() * 2, std::memory_order_relaxed);
+                ids.clear();
+                std::this_thread::yield();
+            }
+        });
+    }
+
+    for (auto _ : state)
+        grx::frustum_storage().calculateCulling(frustum);
+
+    stop = true;
+    for (auto& thread : streams)
+        thread.join();
+
+    state.counters["changes"] = benchmark::Counter(static_cast<double>(changes.load()), benchmark::Counter::kIsRate);
+}
+BENCHMARK(BM_culling_streaming)->ArgName("threads")->Arg(0)->Arg(2)->Arg(4)->UseRealTime();
+
+// Multi-view culling (main camera + shadow cascades): one pass for all views vs pass per view
+// 1M objects, streams do not fit in cache
+static auto multiViewFrustums(std::size_t count) {
+    std::vector<frst_st::FrustumStorage::FrustumT> frustums;
+    for (std::size_t v = 0; v < count; ++v)
+        frustums.push_back(frustumFromCamera(CameraKey{0.f, 2.f, 0.f, 0.4f * v, 0.f, 0}));
+    return frustums;
+}
+
+static void BM_culling_multi_view(benchmark::State& state) {
+    fillStorageWorld(1 << 20, false);
+    auto frustums = multiViewFrustums(static_cast<std::size_t>(state.range(0)));
+
+    for (auto _ : state)
+        grx::frustum_storage().calculateCulling(frustums.data(), frustums.size());
+}
+BENCHMARK(BM_culling_multi_view)->ArgName("views")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+static void BM_culling_pass_per_view(benchmark::State& state) {
+    fillStorageWorld(1 << 20, false);
+    auto frustums = multiViewFrustums(static_cast<std::size_t>(state.range(0)));
+
+    grx::frustum_storage().setTemporalCoherence(false);
+    for (auto _ : state)
+        for (auto& frustum : frustums)
+            grx::frustum_storage().calculateCulling(frustum);
+    grx::frustum_storage().setTemporalCoherence(true);
+}
+BENCHMARK(BM_culling_pass_per_view)->ArgName("views")->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+
+// Software occlusion culling: city blocks as occluders, small objects in the streets and behind buildings
+#include <glm/gtc/matrix_transform.hpp>
+
+struct City {
+    std::vector<float> positions;
+    std::vector<U32>   indices;
+    glm::mat4          view_projection;
+};
+
+static auto frustumFromMatrix(const glm::mat4& m) {
+    auto row = [&](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+    frst_st::FrustumStorage::FrustumT frustum;
+    frustum[0] = row(3) + row(0); // Left
+    frustum[1] = row(3) - row(0); // Right
+    frustum[2] = row(3) + row(1); // Bottom
+    frustum[3] = row(3) - row(1); // Top
+    frustum[4] = row(3) + row(2); // Near
+    frustum[5] = row(3) - row(2); // Far
+
+    return frustum;
+}
+
+static auto buildCity(std::size_t objects) {
+    constexpr int   blocks = 16;
+    constexpr Float block  = 40.f, street = 20.f;
+
+    City city;
+    auto height = std::uniform_real_distribution<Float>(20.f, 60.f);
+
+    // Buildings as closed boxes, all in one occluder mesh
+    for (int bx = 0; bx < blocks; ++bx) {
+        for (int bz = 0; bz < blocks; ++bz) {
+            auto x0 = (bx - blocks / 2) * (block + street) + street * 0.5f, x1 = x0 + block;
+            auto z0 = (bz - blocks / 2) * (block + street) + street * 0.5f, z1 = z0 + block;
+            auto y1 = height(mt);
+            auto first = static_cast<U32>(city.positions.size() / 3);
+
+            for (int i = 0; i < 8; ++i) {
+                city.positions.push_back(i & 1 ? x1 : x0);
+                city.positions.push_back(i & 2 ? y1 : 0.f);
+                city.positions.push_back(i & 4 ? z1 : z0);
+            }
+
+            static constexpr U32 faces[] = {
+                0, 1, 3, 0, 3, 2,  4, 6, 7, 4, 7, 5,  0, 4, 5, 0, 5, 1,
+                2, 3, 7, 2, 7, 6,  0, 2, 6, 0, 6, 4,  1, 5, 7, 1, 7, 3
+            };
+            for (auto index : faces)
+                city.indices.push_back(first + index);
+        }
+    }
+
+    clearStorage();
+
+    auto extent = blocks / 2 * (block + street);
+    auto aabbs  = generateAABBs(vec3(0, 0, 0), vec3(4, 4, 4), vec3(-extent, 0, -extent), vec3(extent, 10, extent), objects);
+    for (auto& aabb : aabbs)
+        registerAabb(aabb);
+
+    // Street level camera looking along the street
+    auto proj = glm::perspective(1.f, 16.f / 9.f, 0.1f, 1000.f);
+    auto view = glm::lookAt(glm::vec3(0.f, 2.f, -extent), glm::vec3(30.f, 2.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+    city.view_projection = proj * view;
+
+    return city;
+}
+
+static void renderCity(frst_st::OcclusionBuffer& buffer, const City& city) {
+    buffer.begin(city.view_projection);
+    buffer.addOccluder(city.positions.data(), city.positions.size() / 3,
+                       city.indices.data(),   city.indices.size(), glm::mat4(1.f));
+    buffer.render();
+}
+
+static void BM_occlusion_render(benchmark::State& state) {
+    auto city   = buildCity(0);
+    auto buffer = frst_st::OcclusionBuffer(static_cast<U32>(state.range(0)), static_cast<U32>(state.range(0) * 9 / 16));
+
+    for (auto _ : state) {
+        renderCity(buffer, city);
+        benchmark::DoNotOptimize(buffer.depth().data());
+    }
+
+    state.counters["triangles"] = static_cast<double>(buffer.triangles_count());
+}
+BENCHMARK(BM_occlusion_render)->Arg(256)->Arg(512)->Arg(1024)->UseRealTime();
+
+static void BM_occlusion_culling(benchmark::State& state) {
+    constexpr std::size_t objects = 200000;
+
+    auto  city      = buildCity(objects);
+    auto  buffer    = frst_st::OcclusionBuffer(320, 180);
+    auto  frustum   = frustumFromMatrix(city.view_projection);
+    auto& storage   = grx::frustum_storage();
+    bool  occlusion = state.range(0) != 0;
+
+    // Static camera, measure full culling every iteration
+    storage.setTemporalCoherence(false);
+
+    for (auto _ : state) {
+        storage.calculateCulling(frustum);
+
+        if (occlusion) {
+            renderCity(buffer, city);
+            storage.calculateOcclusion(buffer);
+        }
+    }
+
+    std::size_t visible = 0;
+    for (auto id : registered_ids)
+        visible += storage.getResult(id) == 0;
+
+    storage.setTemporalCoherence(true);
+    state.counters["visible"] = static_cast<double>(visible);
+}
+BENCHMARK(BM_occlusion_culling)->ArgName("occlusion")->Arg(0)->Arg(1)->UseRealTime();
+
+
+#include "../base/jobs.hpp"
+
+auto unpackFrustum(FrustumCref frustum, std::size_t width) {
+    auto unpacked = std::vector<Float, AlignedAllocator<Float, 32>>(6 * 4 * width);
+
+    for (std::size_t i = 0; i < 6; ++i)
+        for (std::size_t j = 0; j < width; ++j) {
+            unpacked[(i * 4 + 0) * width + j] = frustum[i].x;
+            unpacked[(i * 4 + 1) * width + j] = frustum[i].y;
+            unpacked[(i * 4 + 2) * width + j] = frustum[i].z;
+            unpacked[(i * 4 + 3) * width + j] = frustum[i].w;
+        }
+
+    return unpacked;
+}
+
+// Per-frame dispatch cost: threads spawned every frame vs persistent job system
+static void BM_culling_thread_spawn(benchmark::State& state) {
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto res     = CullResultV(count);
+    auto aabbs   = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count);
+    auto frustum = unpackFrustum(generateFrustum(), 8);
+    auto nprocs  = std::max(std::thread::hardware_concurrency(), 1U);
+
+    auto count_per_thread = (count / nprocs) - (count / nprocs) % 8;
+
+    for (auto _ : state) {
+        std::vector<std::thread> threads;
+        for (std::size_t i = 0; i < nprocs; ++i)
+            threads.emplace_back(
+                    x86_64sv_avx_frustum_culling,
+                    res.data() + i * count_per_thread,
+                    reinterpret_cast<Float *>(aabbs.data()) + i * 8 * count_per_thread,
+                    frustum.data(), count_per_thread);
+
+        for (auto& t : threads)
+            t.join();
+
+        benchmark::DoNotOptimize(res.data());
+    }
+}
+BENCHMARK(BM_culling_thread_spawn)->RangeMultiplier(2)->Range(5000, 30000)->UseRealTime();
+
+static void BM_culling_job_system(benchmark::State& state) {
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto res     = CullResultV(count);
+    auto aabbs   = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count);
+    auto frustum = unpackFrustum(generateFrustum(), 8);
+    auto blocks  = count / 8;
+
+    // Start workers before measurement
+    base::job_system();
+
+    for (auto _ : state) {
+        base::job_system().parallel_for(blocks, 64, [&](SizeT start, SizeT end) {
+            x86_64sv_avx_frustum_culling(
+                    res.data() + start * 8,
+                    reinterpret_cast<Float *>(aabbs.data()) + start * 8 * 8,
+                    frustum.data(), (end - start) * 8);
+        });
+
+        benchmark::DoNotOptimize(res.data());
+    }
+}
+BENCHMARK(BM_culling_job_system)->RangeMultiplier(2)->Range(5000, 30000)->UseRealTime();
+
+
+#include "../graphics/algorithms/frustum_culling_simd.hpp"
+#include "../base/cpu_extension_checker.hpp"
+
+// AoS (NASM) vs SoA (intrinsics) kernels, single thread
+static void BM_aos_asm_culling(benchmark::State& state,
+                               void(*kernel)(int32_t*, float*, float*, std::size_t), std::size_t width)
+{
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto res     = CullResultV(count);
+    auto aabbs   = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count);
+    auto frustum = unpackFrustum(generateFrustum(), width);
+
+    for (auto _ : state) {
+        kernel(res.data(), reinterpret_cast<Float *>(aabbs.data()), frustum.data(), count);
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+BENCHMARK_CAPTURE(BM_aos_asm_culling, sse, x86_64sv_sse_frustum_culling, 4)->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_aos_asm_culling, avx, x86_64sv_avx_frustum_culling, 8)->Arg(1024)->Arg(65536)->Arg(1048576);
+
+static void BM_soa_culling(benchmark::State& state, frst_st::SoaKernelT kernel, bool supported) {
+    if (!supported) {
+        state.SkipWithError("Instruction set is not supported");
+        return;
+    }
+
+    auto count = static_cast<std::size_t>(state.range(0));
+    auto res   = CullResultV(count);
+    auto aabbs = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count);
+
+    std::array<std::vector<Float, AlignedAllocator<Float, 64>>, 6> streams;
+    for (auto& stream : streams)
+        stream.reserve(count);
+
+    for (auto& aabb : aabbs) {
+        streams[0].push_back(aabb.first.x);
+        streams[1].push_back(aabb.first.y);
+        streams[2].push_back(aabb.first.z);
+        streams[3].push_back(aabb.second.x);
+        streams[4].push_back(aabb.second.y);
+        streams[5].push_back(aabb.second.z);
+    }
+
+    auto view = frst_st::AabbStreams{
+        streams[0].data(), streams[1].data(), streams[2].data(),
+        streams[3].data(), streams[4].data(), streams[5].data()};
+
+    auto frustum = generateFrustum();
+
+    for (auto _ : state) {
+        kernel(res.data(), view, &frustum[0].x, 0, count);
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+static const auto& cpu = base::cpu_extensions_checker();
+
+BENCHMARK_CAPTURE(BM_soa_culling, scalar,   frst_st::scalar_soa_frustum_culling,   true)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_culling, sse2,     frst_st::sse2_soa_frustum_culling,     cpu.HW_SSE2)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_culling, avx2_fma, frst_st::avx2_fma_soa_frustum_culling, cpu.HW_AVX2 && cpu.HW_FMA3 && cpu.OS_AVX)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_culling, avx512,   frst_st::avx512_soa_frustum_culling,   cpu.HW_AVX512F && cpu.OS_AVX512)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+
+// Spheres and OBBs with the same centers and sizes as AABBs above
+using SoaStreamsV = std::vector<std::vector<Float, AlignedAllocator<Float, 64>>>;
+
+static auto generateShapeCenters(std::size_t count) {
+    auto aabbs = generateAABBs(vec3(0, 0, 0), vec3(10, 10, 10), vec3(-100, -100, -100), vec3(100, 100, 100), count);
+    auto size  = std::uniform_real_distribution<Float>(0.f, 5.f);
+
+    std::vector<std::pair<vec3, Float>> centers;
+    for (auto& aabb : aabbs)
+        centers.emplace_back(vec3(aabb.first.x, aabb.first.y, aabb.first.z), size(mt));
+
+    return centers;
+}
+
+static void BM_soa_sphere_culling(benchmark::State& state, frst_st::SoaSphereKernelT kernel, bool supported) {
+    if (!supported) {
+        state.SkipWithError("Instruction set is not supported");
+        return;
+    }
+
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto res     = CullResultV(count);
+    auto streams = SoaStreamsV(4);
+
+    for (auto& [center, radius] : generateShapeCenters(count)) {
+        streams[0].push_back(center.x);
+        streams[1].push_back(center.y);
+        streams[2].push_back(center.z);
+        streams[3].push_back(radius);
+    }
+
+    auto view    = frst_st::SphereStreams{streams[0].data(), streams[1].data(), streams[2].data(), streams[3].data()};
+    auto frustum = generateFrustum();
+
+    for (auto _ : state) {
+        kernel(res.data(), view, &frustum[0].x, 0, count);
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_CAPTURE(BM_soa_sphere_culling, scalar,   frst_st::scalar_soa_sphere_culling,   true)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_sphere_culling, sse2,     frst_st::sse2_soa_sphere_culling,     cpu.HW_SSE2)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_sphere_culling, avx2_fma, frst_st::avx2_fma_soa_sphere_culling, cpu.HW_AVX2 && cpu.HW_FMA3 && cpu.OS_AVX)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_sphere_culling, avx512,   frst_st::avx512_soa_sphere_culling,   cpu.HW_AVX512F && cpu.OS_AVX512)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+
+static void BM_soa_obb_culling(benchmark::State& state, frst_st::SoaObbKernelT kernel, bool supported) {
+    if (!supported) {
+        state.SkipWithError("Instruction set is not supported");
+        return;
+    }
+
+    auto count   = static_cast<std::size_t>(state.range(0));
+    auto res     = CullResultV(count);
+    auto streams = SoaStreamsV(12);
+    auto angle   = std::uniform_real_distribution<Float>(0.f, 6.28f);
+
+    // Boxes rotated around Y axis
+    for (auto& [center, size] : generateShapeCenters(count)) {
+        auto a = angle(mt);
+        Float values[12] = {
+            center.x, center.y, center.z,
+            std::cos(a) * size, 0.f, std::sin(a) * size,
+            0.f, size, 0.f,
+            -std::sin(a) * size, 0.f, std::cos(a) * size
+        };
+
+        for (int i = 0; i < 12; ++i)
+            streams[i].push_back(values[i]);
+    }
+
+    auto view = frst_st::ObbStreams{
+        streams[0].data(), streams[1].data(),  streams[2].data(),
+        streams[3].data(), streams[4].data(),  streams[5].data(),
+        streams[6].data(), streams[7].data(),  streams[8].data(),
+        streams[9].data(), streams[10].data(), streams[11].data()};
+
+    auto frustum = generateFrustum();
+
+    for (auto _ : state) {
+        kernel(res.data(), view, &frustum[0].x, 0, count);
+        benchmark::DoNotOptimize(res.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count);
+}
+
+BENCHMARK_CAPTURE(BM_soa_obb_culling, scalar,   frst_st::scalar_soa_obb_culling,   true)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_obb_culling, sse2,     frst_st::sse2_soa_obb_culling,     cpu.HW_SSE2)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_obb_culling, avx2_fma, frst_st::avx2_fma_soa_obb_culling, cpu.HW_AVX2 && cpu.HW_FMA3 && cpu.OS_AVX)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+BENCHMARK_CAPTURE(BM_soa_obb_culling, avx512,   frst_st::avx512_soa_obb_culling,   cpu.HW_AVX512F && cpu.OS_AVX512)
+        ->Arg(1024)->Arg(65536)->Arg(1048576);
+
+#include "../graphics/TextureDecoder.hpp"
+#include "../base/filesystem.hpp"
+
+// Decode stage of 500 texture loads: caller thread vs job system
+static void BM_texture_decode_500(benchmark::State& state) {
+    constexpr SizeT count = 500;
+
+    auto parallel = state.range(0) != 0;
+    auto paths    = std::array<std::string, 2>{
+        base::fs::to_data_path("gamedata/textures/dummy.tga").c_str(),
+        base::fs::to_data_path("gamedata/textures/dummy_normal_map.png").c_str()
+    };
+    auto images = std::vector<grx_txtr::DecodedImage>(count);
+
+    base::job_system();
+
+    for (auto _ : state) {
+        if (parallel) {
+            auto counter = base::JobCounter();
+            for (SizeT i = 0; i < count; ++i)
+                base::job_system().submit([&, i] { images[i] = grx_txtr::decode_image(paths[i % 2]); }, &counter);
+            base::job_system().wait(counter);
+        }
+        else {
+            for (SizeT i = 0; i < count; ++i)
+                images[i] = grx_txtr::decode_image(paths[i % 2]);
+        }
+
+        benchmark::DoNotOptimize(images.data());
+    }
+
+    if (!images.front().valid())
+        state.SkipWithError("Can't decode test textures");
+}
+BENCHMARK(BM_texture_decode_500)->ArgName("jobs")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+#include "../graphics/TextureCache.hpp"
+#include "../base/files.hpp"
+
+// Texture load: decode source vs map cooked texture with mip chain
+static void BM_texture_load_cooked(benchmark::State& state) {
+    auto cooked_path = std::string((base::fs::current_path() / "bench_texture.dtx").c_str());
+    auto source_path = std::string(base::fs::to_data_path("gamedata/textures/dummy_normal_map.png").c_str());
+    auto source      = grx_txtr::read_image_file(source_path);
+    auto image       = grx_txtr::decode_image(source.data(), source.size(), source_path);
+
+    if (!image.valid()) {
+        state.SkipWithError("Can't decode test texture");
+        return;
+    }
+
+    auto cooked = grx_txtr::cook_texture(image, grx_txtr::TextureFormat::BC1, grx_txtr::hash_source(source.data(), source.size()));
+    base::writeBytesToFile(ftl::String(cooked_path), reinterpret_cast<const Byte*>(cooked.data()), cooked.size());
+
+    for (auto _ : state) {
+        if (state.range(0)) {
+            auto texture = grx_txtr::CookedTexture::map(cooked_path);
+            benchmark::DoNotOptimize(texture.mip(0).data);
+        } else {
+            auto decoded = grx_txtr::decode_image(source_path);
+            benchmark::DoNotOptimize(decoded.pixels.data());
+        }
+    }
+
+    std::remove(cooked_path.c_str());
+}
+BENCHMARK(BM_texture_load_cooked)->ArgName("cooked")->Arg(0)->Arg(1)->UseRealTime();
+
+
+#include <xxhash.h>
+
+// File read: read to buffer with ifstream vs memory mapping. Contents are hashed in both cases
+static void BM_file_read(benchmark::State& state) {
+    auto path = ftl::String(base::fs::current_path() / "bench_file_read.bin");
+    auto size = static_cast<SizeT>(state.range(1));
+
+    {
+        auto bytes = ftl::Vector<Byte>(size);
+        for (SizeT i = 0; i < size; ++i)
+            bytes[i] = Byte(i * 31 + (i >> 12));
+        base::writeBytesToFile(path, bytes);
+    }
+
+    for (auto _ : state) {
+        if (state.range(0)) {
+            auto file = base::MappedFile(path.c_str(), base::MappedFile::Access::Sequential);
+            benchmark::DoNotOptimize(XXH64(file.data(), file.size(), 0));
+        } else {
+            auto bytes = base::readFileToBytes(path);
+            benchmark::DoNotOptimize(XXH64(bytes.data(), bytes.size(), 0));
+        }
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_file_read)->ArgNames({"mmap", "size"})->RangeMultiplier(16)->Ranges({{0, 1}, {1 << 20, 1 << 30}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+#include "../base/vfs.hpp"
+
+// Open 1000 small files: loose files vs packed archive
+static void BM_vfs_open_1000(benchmark::State& state) {
+    auto dir     = base::fs::current_path() / "bench_vfs";
+    auto archive = ftl::String(base::fs::current_path() / "bench_vfs.dpk");
+    auto sources = ftl::Vector<base::PackSource>();
+    auto paths   = std::vector<std::string>();
+    auto bytes   = ftl::Vector<Byte>(2048, Byte('a'));
+
+    for (int i = 0; i < 1000; ++i) {
+        auto path = dir / ftl::String(std::to_string(i) + ".txt");
+        base::writeBytesToFile(path, bytes);
+        sources.push_back(base::PackSource{*base::vfs().virtual_path(path.c_str()), path});
+        paths.emplace_back(path.c_str());
+    }
+
+    base::writePackArchive(archive, sources, base::PackCompression::Store);
+    auto pack = base::PackArchive::openOpt(archive.c_str());
+
+    for (auto _ : state) {
+        for (auto& source : sources) {
+            if (state.range(0)) {
+                auto file = pack->read(*pack->find(source.path.c_str()));
+                benchmark::DoNotOptimize(file->data());
+            } else {
+                auto file = base::MappedFile::openOpt(source.real_path.c_str());
+                benchmark::DoNotOptimize(file->data());
+            }
+        }
+    }
+
+    for (auto& path : paths)
+        std::remove(path.c_str());
+    std::remove(archive.c_str());
+}
+BENCHMARK(BM_vfs_open_1000)->ArgName("packed")->Arg(0)->Arg(1)->UseRealTime();
+
+
+#include "../base/async_io.hpp"
+#include <fcntl.h>
+#include <unistd.h>
+
+// 1024 reads of 64KB with fixed count of requests in flight
+static void BM_async_io_read_64k(benchmark::State& state) {
+    constexpr SizeT BLOCK  = 64 * 1024;
+    constexpr SizeT BLOCKS = 1024;
+
+    auto path = ftl::String(base::fs::current_path() / "bench_async_io.bin");
+    base::writeBytesToFile(path, ftl::Vector<Byte>(BLOCK * BLOCKS, Byte(1)));
+
+    auto backend = state.range(0) ? base::AsyncIo::Backend::IoUring : base::AsyncIo::Backend::ThreadPool;
+    auto depth   = static_cast<U32>(state.range(1));
+    auto io      = base::AsyncIo(backend, depth);
+    auto fd      = open(path.c_str(), O_RDONLY);
+    auto buffers = ftl::Vector<Byte>(BLOCK * depth);
+
+    if (io.backend() != backend)
+        state.SkipWithError("io_uring is not supported");
+
+    for (auto _ : state) {
+        auto next = std::atomic<SizeT>(0);
+
+        std::function<void(SizeT)> submit = [&](SizeT slot) {
+            auto block = next++;
+            if (block >= BLOCKS)
+                return;
+
+            io.read(fd, buffers.data() + slot * BLOCK, BLOCK, block * BLOCK, [&, slot](S64) { submit(slot); });
+            io.flush();
+        };
+
+        for (SizeT slot = 0; slot < depth; ++slot)
+            submit(slot);
+        io.wait_idle();
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * BLOCK * BLOCKS));
+
+    close(fd);
+    std::remove(path.c_str());
+}
+BENCHMARK(BM_async_io_read_64k)->ArgNames({"io_uring", "depth"})->RangeMultiplier(4)->Ranges({{0, 1}, {1, 64}})
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+
+#include "../base/logs.hpp"
+
+// Cost of Log() for producers, file is written by logger thread
+static void BM_log(benchmark::State& state) {
+    base::Logger::instance().setConsoleOutput(false);
+    auto i = 0;
+
+    for (auto _ : state)
+        base::Log("benchmark message {} from '{}'", i++, "producer");
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_log)->Threads(1)->Threads(8)->UseRealTime();
+
+// Same message with deferred formatting
+static void BM_log_deferred(benchmark::State& state) {
+    base::Logger::instance().setConsoleOutput(false);
+    auto i = 0;
+
+    for (auto _ : state)
+        DE_BLOG(Info, General, "benchmark message {} from '{}'", i++, "producer");
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_log_deferred)->Threads(1)->Threads(8)->UseRealTime();
+
+// Call below category threshold: one relaxed load and branch, arguments are not evaluated
+static void BM_log_disabled(benchmark::State& state) {
+    base::setLogThreshold(base::LogCategory::Io, base::LogLevel::Warning);
+    auto i = 0;
+
+    for (auto _ : state) {
+        DE_LOG(Info, Io, "benchmark message {} from '{}'", i++, "producer");
+        benchmark::DoNotOptimize(i);
+    }
+
+    base::setLogThreshold(base::LogCategory::Io, base::LogLevel::Trace);
+}
+BENCHMARK(BM_log_disabled);
+
+// Enabled leveled call, compare with BM_log
+static void BM_log_leveled(benchmark::State& state) {
+    base::Logger::instance().setConsoleOutput(false);
+    auto i = 0;
+
+    for (auto _ : state)
+        DE_LOG(Warning, Io, "benchmark message {} from '{}'", i++, "producer");
+
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_log_leveled)->Threads(1)->Threads(8)->UseRealTime();
+
+
+#include "../base/configs.hpp"
+
+// Heap allocations counter for allocations per operation reports
+static std::atomic<U64> heap_allocations{0};
+
+void* operator new(std::size_t size) {
+    heap_allocations.fetch_add(1, std::memory_order_relaxed);
+
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept              { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// 10 included files, 500 sections with 100 keys each, every 5th section has parent
+static auto write_bench_configs(std::vector<std::string>& paths) -> ftl::String {
+    auto dir   = base::fs::current_path() / "bench_cfg";
+    auto entry = std::string("g_root = 'gamedata'\n");
+
+    auto write = [&](const ftl::String& path, const std::string& text) {
+        base::writeBytesToFile(path, reinterpret_cast<const Byte*>(text.data()), text.size());
+        paths.emplace_back(path.c_str());
+    };
+
+    for (int part = 0; part < 10; ++part) {
+        auto text = std::string();
+
+        for (int sect = part * 50; sect < part * 50 + 50; ++sect) {
+            text += fmt::format("[section_{}]", sect);
+            if (sect % 5 == 4)
+                text += fmt::format(" : section_{}", sect - 1);
+            text += '\n';
+
+            for (int k = 0; k < 100; ++k) {
+                switch (k % 5) {
+                    case 0: text += fmt::format("key_{} = {}\n", k, sect * 100 + k); break;
+                    case 1: text += fmt::format("key_{} = {}.5 ; comment\n", k, k); break;
+                    case 2: text += fmt::format("key_{} = 'models/object_{}.dmdl'\n", k, sect); break;
+                    case 3: text += fmt::format("key_{} = {{ {}, {}, {} }}\n", k, k, k + 1, k + 2); break;
+                    case 4: text += fmt::format("key_{} = $g_root  '/sub_{}'\n", k, k); break;
+                }
+            }
+        }
+
+        write(dir / ftl::String(fmt::format("part_{}.cfg", part)), text);
+        entry += fmt::format("#include 'part_{}.cfg'\n", part);
+    }
+    write(dir / "entry.cfg", entry);
+
+    return dir / "entry.cfg";
+}
+
+static void BM_config_parse_50k(benchmark::State& state) {
+    auto  paths   = std::vector<std::string>();
+    auto& storage = base::cfg_detls::cfgStorage();
+    auto  entries = base::cfg_detls::StrVector{write_bench_configs(paths)};
+
+    auto allocations = heap_allocations.load(std::memory_order_relaxed);
+
+    for (auto _ : state)
+        storage.load(entries);
+
+    allocations = heap_allocations.load(std::memory_order_relaxed) - allocations;
+
+    state.counters["keys"]         = static_cast<double>(storage.snapshot()->valuesCount());
+    state.counters["memory_bytes"] = static_cast<double>(storage.snapshot()->memoryUsage());
+    state.counters["allocations"]  = static_cast<double>(allocations) / static_cast<double>(state.iterations());
+
+    // Restore engine configs
+    storage.load(base::cfg_detls::cfg_state().getEntries());
+
+    for (auto& path : paths)
+        std::remove(path.c_str());
+}
+BENCHMARK(BM_config_parse_50k)->Unit(benchmark::kMillisecond);
+
+// Reload one changed file of 10, others are replayed from parse results
+static void BM_config_reload_50k(benchmark::State& state) {
+    auto  paths   = std::vector<std::string>();
+    auto& storage = base::cfg_detls::cfgStorage();
+    auto  entry   = write_bench_configs(paths);
+    auto  changed = base::cfg_detls::StrVector{entry.parent_path() / "part_3.cfg"};
+
+    storage.load({entry});
+
+    for (auto _ : state)
+        storage.reload(changed);
+
+    storage.load(base::cfg_detls::cfg_state().getEntries());
+
+    for (auto& path : paths)
+        std::remove(path.c_str());
+}
+BENCHMARK(BM_config_reload_50k)->Unit(benchmark::kMillisecond);
+
+// Cold startup parses files and writes cache, warm startup loads snapshot from cache
+static void BM_config_startup_50k(benchmark::State& state) {
+    auto  paths   = std::vector<std::string>();
+    auto& storage = base::cfg_detls::cfgStorage();
+    auto  entries = base::cfg_detls::StrVector{write_bench_configs(paths)};
+    auto  cache   = entries[0].parent_path() / "configs.dcfg";
+
+    storage.load(entries, cache);
+
+    for (auto _ : state) {
+        if (!state.range(0)) {
+            state.PauseTiming();
+            std::remove(cache.c_str());
+            state.ResumeTiming();
+        }
+        storage.load(entries, cache);
+    }
+
+    state.counters["memory_bytes"] = static_cast<double>(storage.snapshot()->memoryUsage());
+
+    storage.load(base::cfg_detls::cfg_state().getEntries());
+
+    std::remove(cache.c_str());
+    for (auto& path : paths)
+        std::remove(path.c_str());
+}
+BENCHMARK(BM_config_startup_50k)->ArgName("warm")->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+
+// cfg::read parses value on each call, cfg::Key caches typed value
+template <typename T>
+static void config_read_bench(benchmark::State& state, const char* name) {
+    auto path = ftl::String(base::fs::current_path() / "bench_read.cfg");
+    auto text = std::string("[bench]\nvalue = 12.5\nposition = 1.5, 2.5, 3.5\n");
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(text.data()), text.size());
+
+    base::cfg::cfg(); // Don't let lazy initialization override test config
+    auto& storage = base::cfg_detls::cfgStorage();
+    storage.load({path});
+
+    if (state.range(0)) {
+        auto key = base::cfg::Key<T>(name, "bench");
+        for (auto _ : state)
+            benchmark::DoNotOptimize(*key);
+    }
+    else {
+        for (auto _ : state)
+            benchmark::DoNotOptimize(base::cfg::read<T>(name, "bench"));
+    }
+
+    storage.load(base::cfg_detls::cfg_state().getEntries());
+    std::remove(path.c_str());
+}
+
+static void BM_config_read_float(benchmark::State& state) {
+    config_read_bench<float>(state, "value");
+}
+BENCHMARK(BM_config_read_float)->ArgName("cached")->Arg(0)->Arg(1);
+
+static void BM_config_read_vector3(benchmark::State& state) {
+    config_read_bench<ftl::Vector3f>(state, "position");
+}
+BENCHMARK(BM_config_read_vector3)->ArgName("cached")->Arg(0)->Arg(1);
+
+
+#include "../base/aton.hpp"
+#include <charconv>
+
+// 100k whitespace separated floats: full precision and config-like short ones
+static auto aton_bench_text() -> const std::string& {
+    static auto text = [] {
+        auto rng    = std::mt19937(7);
+        auto values = std::uniform_real_distribution<Float32>(-1000.f, 1000.f);
+        auto result = std::string();
+
+        for (int i = 0; i < 100000; ++i)
+            result += fmt::format(i % 2 ? "{:.3f}{}" : "{}{}", values(rng), i % 8 == 7 ? '\n' : ' ');
+
+        return result;
+    }();
+
+    return text;
+}
+
+static void BM_aton_floats(benchmark::State& state) {
+    auto& text = aton_bench_text();
+    auto  out  = std::vector<Float32>(100000);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(base::aton_array(text, out.data(), out.size()));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_aton_floats);
+
+static void BM_strtof_floats(benchmark::State& state) {
+    auto& text = aton_bench_text();
+    auto  out  = std::vector<Float32>(100000);
+
+    for (auto _ : state) {
+        auto p   = text.c_str();
+        auto end = static_cast<char*>(nullptr);
+
+        for (auto& value : out) {
+            value = std::strtof(p, &end);
+            p     = end;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_strtof_floats);
+
+static void BM_from_chars_floats(benchmark::State& state) {
+    auto& text = aton_bench_text();
+    auto  out  = std::vector<Float32>(100000);
+
+    for (auto _ : state) {
+        auto p   = text.data();
+        auto end = text.data() + text.size();
+
+        for (auto& value : out) {
+            while (*p == ' ' || *p == '\n')
+                ++p;
+            p = std::from_chars(p, end, value).ptr;
+        }
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_from_chars_floats);
+
+
+#include "../base/ftl/string_scan.hpp"
+
+// ~4 MB of config-like lines with padded values
+static auto split_bench_text() -> const ftl::String& {
+    static auto text = [] {
+        auto rng    = std::mt19937(11);
+        auto result = std::string();
+
+        while (result.size() < (4 << 20)) {
+            auto pad = std::string(rng() % 24, rng() % 2 ? ' ' : '\t');
+            result += fmt::format("key_{} ={}value_{}{}\n", rng() % 10000, pad, rng(), pad);
+        }
+
+        return ftl::String(std::move(result));
+    }();
+
+    return text;
+}
+
+// Per-char loop of previous implementation
+static auto scalar_split_view(std::string_view data, std::initializer_list<char> l) {
+    auto vec   = ftl::Vector<std::string_view>();
+    auto start = SizeT(0);
+
+    for (SizeT i = 0; i < data.size(); ++i) {
+        bool cmp = false;
+        for (auto c : l) { if (data[i] == c) { cmp = true; break; } }
+        if (cmp) {
+            if (start != i)
+                vec.emplace_back(data.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    if (start != data.size())
+        vec.emplace_back(data.substr(start, data.size()));
+    return vec;
+}
+
+static void BM_split_view_scalar(benchmark::State& state) {
+    auto& text = split_bench_text();
+    auto  data = std::string_view(text.data(), text.size());
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(scalar_split_view(data, {'\n'}).size());
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_split_view_scalar);
+
+static void BM_split_view(benchmark::State& state) {
+    auto& text = split_bench_text();
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(text.splitView('\n').size());
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_split_view);
+
+static void BM_split_view_buffer(benchmark::State& state) {
+    auto& text  = split_bench_text();
+    auto  views = std::vector<std::string_view>(1 << 20);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(text.splitView('\n', views.data(), views.size()));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_split_view_buffer);
+
+static void BM_split_view_set_scalar(benchmark::State& state) {
+    auto& text = split_bench_text();
+    auto  data = std::string_view(text.data(), text.size());
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(scalar_split_view(data, {'=', '\n', ';'}).size());
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_split_view_set_scalar);
+
+static void BM_split_view_set(benchmark::State& state) {
+    auto& text = split_bench_text();
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(text.splitView({'=', '\n', ';'}).size());
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_split_view_set);
+
+static void BM_trim_scalar(benchmark::State& state) {
+    auto& text  = split_bench_text();
+    auto  lines = text.splitView({'='});
+
+    for (auto _ : state)
+        for (auto line : lines) {
+            auto first = ftl::str_scan::scalar::find_not_any(line.data(), line.data() + line.size(), " \t");
+            benchmark::DoNotOptimize(ftl::str_scan::scalar::rfind_not_any(first, line.data() + line.size(), " \t"));
+        }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_trim_scalar);
+
+static void BM_trim(benchmark::State& state) {
+    auto& text  = split_bench_text();
+    auto  lines = text.splitView({'='});
+
+    for (auto _ : state)
+        for (auto line : lines)
+            benchmark::DoNotOptimize(ftl::str_scan::trim(line));
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+BENCHMARK(BM_trim);
+
+static void find_str_bench(benchmark::State& state, decltype(&ftl::str_scan::find_str) find) {
+    auto& text = split_bench_text();
+    auto  end  = text.data() + text.size();
+
+    for (auto _ : state) {
+        auto count = SizeT(0);
+        for (auto p = find(text.data(), end, "value_42"); p != end; p = find(p + 1, end, "value_42"))
+            ++count;
+        benchmark::DoNotOptimize(count);
+    }
+
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+}
+
+static void BM_find_str_scalar(benchmark::State& state) {
+    find_str_bench(state, ftl::str_scan::scalar::find_str);
+}
+BENCHMARK(BM_find_str_scalar);
+
+static void BM_find_str(benchmark::State& state) {
+    find_str_bench(state, ftl::str_scan::find_str);
+}
+BENCHMARK(BM_find_str);
+
+
+#include <deque>
+#include <mutex>
+#include "../base/ftl/concurrent_ring.hpp"
+
+// Producer thread pushes, benchmark thread pops: items per second through the ring
+static void BM_ring_spsc(benchmark::State& state) {
+    auto ring  = ftl::SpscRing<U64>(1024);
+    auto batch = static_cast<SizeT>(state.range(0));
+    auto stop  = std::atomic<bool>(false);
+
+    auto producer = std::thread([&] {
+        U64 values[64] = {};
+        while (!stop.load(std::memory_order_relaxed))
+            if (batch == 1)
+                ring.try_push_back(U64(1));
+            else
+                ring.try_push_back(values, values + batch);
+    });
+
+    U64 values[64];
+    U64 popped = 0;
+
+    for (auto _ : state) {
+        auto n = batch == 1 ? SizeT(ring.try_pop_front(values[0])) : ring.try_pop_front(values, batch);
+        popped += n;
+        benchmark::DoNotOptimize(values);
+    }
+
+    stop = true;
+    producer.join();
+    state.SetItemsProcessed(static_cast<int64_t>(popped));
+}
+BENCHMARK(BM_ring_spsc)->ArgName("batch")->Arg(1)->Arg(16)->UseRealTime();
+
+static auto& bench_mpmc_ring() {
+    static auto ring = ftl::MpmcRing<U64>(1024);
+    return ring;
+}
+
+// Every thread pushes and pops, so ring is never empty while thread waits for its value
+static void BM_ring_mpmc(benchmark::State& state) {
+    auto& ring  = bench_mpmc_ring();
+    auto  batch = static_cast<SizeT>(state.range(0));
+    U64   values[64] = {};
+
+    for (auto _ : state) {
+        for (SizeT pushed = 0; pushed < batch;)
+            pushed += ring.try_push_back(values + pushed, values + batch);
+        for (SizeT popped = 0; popped < batch;)
+            popped += ring.try_pop_front(values + popped, batch - popped);
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_ring_mpmc)->ArgName("batch")->Arg(1)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+
+// Same traffic through mutex and std::deque, like job system's injected queue used to do
+static void BM_ring_mutex_deque(benchmark::State& state) {
+    static auto mutex = std::mutex();
+    static auto deque = std::deque<U64>();
+
+    auto batch = static_cast<SizeT>(state.range(0));
+    U64  values[64] = {};
+
+    for (auto _ : state) {
+        {
+            auto lock = std::lock_guard(mutex);
+            deque.insert(deque.end(), values, values + batch);
+        }
+        {
+            auto lock = std::lock_guard(mutex);
+            std::copy_n(deque.begin(), batch, values);
+            deque.erase(deque.begin(), deque.begin() + static_cast<PtrDiff>(batch));
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * batch));
+}
+BENCHMARK(BM_ring_mutex_deque)->ArgName("batch")->Arg(1)->Arg(16)->ThreadRange(1, 16)->UseRealTime();
+
+
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "LightManager.hpp"
 
 #include "ShaderManager.hpp"
+#include "allocators/Arena.hpp"
 
 dtls_light::LightManager::LightManager() {
     _directional_light.is_active() = false;
@@ -10,29 +11,6 @@ dtls_light::LightManager::LightManager() {
 
     for (auto& l : _spot_lights)
         l.is_active() = false;
-
-    // Generate light parameter names in shaders
-    for (int i = 0; i < FR_MAX_POINT_LIGHTS; ++i) {
-        _point_lights_names[i].color                 = ftl::String().sprintf("_point_lights[{}].base.color", i);
-        _point_lights_names[i].position              = ftl::String().sprintf("_point_lights[{}].position", i);
-        _point_lights_names[i].ambient_intensity     = ftl::String().sprintf("_point_lights[{}].base.ambient_intensity", i);
-        _point_lights_names[i].diffuse_intensity     = ftl::String().sprintf("_point_lights[{}].base.diffuse_intensity", i);
-        _point_lights_names[i].attenuation_constant  = ftl::String().sprintf("_point_lights[{}].attenuation.constant", i);
-        _point_lights_names[i].attenuation_linear    = ftl::String().sprintf("_point_lights[{}].attenuation.linear", i);
-        _point_lights_names[i].attenuation_quadratic = ftl::String().sprintf("_point_lights[{}].attenuation.quadratic", i);
-    }
-
-    for (int i = 0; i < FR_MAX_SPOT_LIGHTS; ++i) {
-        _spot_lights_names[i].color                 = ftl::String().sprintf("_spot_lights[{}].base.base.color", i);
-        _spot_lights_names[i].position              = ftl::String().sprintf("_spot_lights[{}].base.position", i);
-        _spot_lights_names[i].ambient_intensity     = ftl::String().sprintf("_spot_lights[{}].base.base.ambient_intensity", i);
-        _spot_lights_names[i].diffuse_intensity     = ftl::String().sprintf("_spot_lights[{}].base.base.diffuse_intensity", i);
-        _spot_lights_names[i].attenuation_constant  = ftl::String().sprintf("_spot_lights[{}].base.attenuation.constant", i);
-        _spot_lights_names[i].attenuation_linear    = ftl::String().sprintf("_spot_lights[{}].base.attenuation.linear", i);
-        _spot_lights_names[i].attenuation_quadratic = ftl::String().sprintf("_spot_lights[{}].base.attenuation.quadratic", i);
-        _spot_lights_names[i].direction             = ftl::String().sprintf("_spot_lights[{}].direction", i);
-        _spot_lights_names[i].cutoff                = ftl::String().sprintf("_spot_lights[{}].cutoff", i);
-    }
 }
 
 dtls_light::LightManager::~LightManager() = default;
@@ -110,26 +88,34 @@ auto dtls_light::LightManager::_genUniformIDs(grx::ShaderProgram& program) -> Ca
     u.dir_light_uniforms.ambient_intensity = program.uniformId(_dir_light_names.ambient_intensity);
     u.dir_light_uniforms.direction         = program.uniformId(_dir_light_names.direction);
 
+    // Light parameter names are needed only for lookup, so they are generated in thread arena
+    auto scope = base::ArenaScope();
+    auto name  = ftl::pmr::String(&scope.arena());
+
+    auto id = [&](const char* format, SizeT i) {
+        return program.uniformId(name.sprintf(format, i).c_str());
+    };
+
     for (SizeT i = 0; i < FR_MAX_POINT_LIGHTS; ++i) {
-        u.point_light_uniforms[i].color                 = program.uniformId(_point_lights_names[i].color.c_str());
-        u.point_light_uniforms[i].position              = program.uniformId(_point_lights_names[i].position.c_str());
-        u.point_light_uniforms[i].diffuse_intensity     = program.uniformId(_point_lights_names[i].diffuse_intensity.c_str());
-        u.point_light_uniforms[i].ambient_intensity     = program.uniformId(_point_lights_names[i].ambient_intensity.c_str());
-        u.point_light_uniforms[i].attenuation_constant  = program.uniformId(_point_lights_names[i].attenuation_constant.c_str());
-        u.point_light_uniforms[i].attenuation_linear    = program.uniformId(_point_lights_names[i].attenuation_linear.c_str());
-        u.point_light_uniforms[i].attenuation_quadratic = program.uniformId(_point_lights_names[i].attenuation_quadratic.c_str());
+        u.point_light_uniforms[i].color                 = id("_point_lights[{}].base.color", i);
+        u.point_light_uniforms[i].position              = id("_point_lights[{}].position", i);
+        u.point_light_uniforms[i].diffuse_intensity     = id("_point_lights[{}].base.diffuse_intensity", i);
+        u.point_light_uniforms[i].ambient_intensity     = id("_point_lights[{}].base.ambient_intensity", i);
+        u.point_light_uniforms[i].attenuation_constant  = id("_point_lights[{}].attenuation.constant", i);
+        u.point_light_uniforms[i].attenuation_linear    = id("_point_lights[{}].attenuation.linear", i);
+        u.point_light_uniforms[i].attenuation_quadratic = id("_point_lights[{}].attenuation.quadratic", i);
     }
 
     for (SizeT i = 0; i < FR_MAX_SPOT_LIGHTS; ++i) {
-        u.spot_light_uniforms[i].color                 = program.uniformId(_spot_lights_names[i].color.c_str());
-        u.spot_light_uniforms[i].position              = program.uniformId(_spot_lights_names[i].position.c_str());
-        u.spot_light_uniforms[i].diffuse_intensity     = program.uniformId(_spot_lights_names[i].diffuse_intensity.c_str());
-        u.spot_light_uniforms[i].ambient_intensity     = program.uniformId(_spot_lights_names[i].ambient_intensity.c_str());
-        u.spot_light_uniforms[i].attenuation_constant  = program.uniformId(_spot_lights_names[i].attenuation_constant.c_str());
-        u.spot_light_uniforms[i].attenuation_linear    = program.uniformId(_spot_lights_names[i].attenuation_linear.c_str());
-        u.spot_light_uniforms[i].attenuation_quadratic = program.uniformId(_spot_lights_names[i].attenuation_quadratic.c_str());
-        u.spot_light_uniforms[i].direction             = program.uniformId(_spot_lights_names[i].direction.c_str());
-        u.spot_light_uniforms[i].cutoff                = program.uniformId(_spot_lights_names[i].cutoff.c_str());
+        u.spot_light_uniforms[i].color                 = id("_spot_lights[{}].base.base.color", i);
+        u.spot_light_uniforms[i].position              = id("_spot_lights[{}].base.position", i);
+        u.spot_light_uniforms[i].diffuse_intensity     = id("_spot_lights[{}].base.base.diffuse_intensity", i);
+        u.spot_light_uniforms[i].ambient_intensity     = id("_spot_lights[{}].base.base.ambient_intensity", i);
+        u.spot_light_uniforms[i].attenuation_constant  = id("_spot_lights[{}].base.attenuation.constant", i);
+        u.spot_light_uniforms[i].attenuation_linear    = id("_spot_lights[{}].base.attenuation.linear", i);
+        u.spot_light_uniforms[i].attenuation_quadratic = id("_spot_lights[{}].base.attenuation.quadratic", i);
+        u.spot_light_uniforms[i].direction             = id("_spot_lights[{}].direction", i);
+        u.spot_light_uniforms[i].cutoff                = id("_spot_lights[{}].cutoff", i);
     }
 
     return u;
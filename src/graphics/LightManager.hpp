@@ -146,28 +146,6 @@ namespace dtls_light {
             const char* direction         = "_directional_light.direction";
         } _dir_light_names;
 
-        struct PointLightNames{
-            ftl::String color;
-            ftl::String position;
-            ftl::String ambient_intensity;
-            ftl::String diffuse_intensity;
-            ftl::String attenuation_constant;
-            ftl::String attenuation_linear;
-            ftl::String attenuation_quadratic;
-        };
-
-        struct SpotLightNames{
-            ftl::String color;
-            ftl::String position;
-            ftl::String ambient_intensity;
-            ftl::String diffuse_intensity;
-            ftl::String attenuation_constant;
-            ftl::String attenuation_linear;
-            ftl::String attenuation_quadratic;
-            ftl::String direction;
-            ftl::String cutoff;
-        };
-
         struct DirLightUniformIDs {
             int color;
             int ambient_intensity;
@@ -207,8 +185,6 @@ namespace dtls_light {
             int specular_intensity;
         };
 
-        std::array<PointLightNames, FR_MAX_POINT_LIGHTS> _point_lights_names;
-        std::array<SpotLightNames,  FR_MAX_SPOT_LIGHTS>  _spot_lights_names;
         ska::flat_hash_map<unsigned, CachedUniforms> _cached_program_uniforms;
 
     protected:
@@ -221,7 +197,7 @@ namespace dtls_light {
                 }
             }
 
-            base::Log("Attempt to create more then {} point light sources!", FR_MAX_POINT_LIGHTS);
+            DE_LOG(Warning, Graphics, "Attempt to create more then {} point light sources!", FR_MAX_POINT_LIGHTS);
             return FR_MAX_POINT_LIGHTS;
         }
 
@@ -234,7 +210,7 @@ namespace dtls_light {
                 }
             }
 
-            base::Log("Attempt to create more then {} spot light sources!", FR_MAX_SPOT_LIGHTS);
+            DE_LOG(Warning, Graphics, "Attempt to create more then {} spot light sources!", FR_MAX_SPOT_LIGHTS);
             return FR_MAX_SPOT_LIGHTS;
         }
 
@@ -4,16 +4,87 @@
 #include "ShaderManager.hpp"
 
 #include <iostream>
+#include <cstring>
 
 #include <GL/glew.h>
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
+#include <assimp/IOStream.hpp>
+#include <assimp/IOSystem.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/material.h>
 #include <glm/ext/matrix_transform.hpp>
 
 #include "filesystem.hpp"
 #include "configs.hpp"
+#include "vfs.hpp"
+
+namespace {
+    class VfsIOStream : public Assimp::IOStream {
+    public:
+        explicit VfsIOStream(base::VfsFile file): _file(std::move(file)) {}
+
+        size_t Read(void* buffer, size_t size, size_t count) override {
+            if (size == 0)
+                return 0;
+
+            auto read = std::min(count, (_file.size() - _pos) / size);
+            std::memcpy(buffer, _file.data() + _pos, read * size);
+            _pos += read * size;
+
+            return read;
+        }
+
+        size_t Write(const void*, size_t, size_t) override {
+            return 0;
+        }
+
+        aiReturn Seek(size_t offset, aiOrigin origin) override {
+            auto size = _file.size();
+            auto from = origin == aiOrigin_CUR ? _pos : SizeT(0);
+
+            if (offset > size - from)
+                return aiReturn_FAILURE;
+
+            _pos = origin == aiOrigin_END ? size - offset : from + offset;
+            return aiReturn_SUCCESS;
+        }
+
+        size_t Tell    () const override { return _pos; }
+        size_t FileSize() const override { return _file.size(); }
+        void   Flush   () override {}
+
+    private:
+        base::VfsFile _file;
+        SizeT         _pos = 0;
+    };
+
+    /**
+     * Assimp reads mesh and files it references (materials, buffers) through VFS
+     */
+    class VfsIOSystem : public Assimp::IOSystem {
+    public:
+        bool Exists(const char* path) const override {
+            return base::vfs().exists(path);
+        }
+
+        char getOsSeparator() const override {
+            return '/';
+        }
+
+        Assimp::IOStream* Open(const char* path, const char* mode) override {
+            if (std::strchr(mode, 'w') || std::strchr(mode, 'a'))
+                return nullptr;
+
+            auto file = base::vfs().open(path);
+            return file ? new VfsIOStream(std::move(*file)) : nullptr;
+        }
+
+        void Close(Assimp::IOStream* stream) override {
+            delete stream;
+        }
+    };
+}
 
 grx::Mesh::Mesh(const char* filepath) {
     auto realPath = base::fs::to_data_path(base::cfg::read<ftl::String>("models_dir") / std::string_view(filepath));
@@ -24,6 +95,7 @@ grx::Mesh::Mesh(const char* filepath) {
     glGenBuffers(_glBuffers.size(), _glBuffers.data());
 
     auto importer = Assimp::Importer();
+    importer.SetIOHandler(new VfsIOSystem()); // Importer takes ownership
 
     auto scene = importer.ReadFile(realPath.c_str(), aiProcess_Triangulate | aiProcess_GenSmoothNormals | aiProcess_CalcTangentSpace);
 
@@ -142,7 +214,7 @@ void grx::Mesh::initFromScene(const aiScene* scene, const char* filepath) {
             auto path = aiString();
             if (material->GetTexture(aiTextureType_NORMALS, 0, &path, NULL, NULL, NULL, NULL, NULL) == AI_SUCCESS) {
                 std::cout << "\t\tLoad normals " << path.C_Str() << std::endl;
-                textures_normals.emplace_back(path.data);
+                textures_normals.emplace_back(path.data, grx_txtr::Placeholder::NormalMap);
             } else
                 textures_normals.emplace_back();
         }
@@ -379,6 +451,32 @@ void grx::Mesh::render(const glm::mat4& view, const glm::mat4& projection, grx::
         mvps.emplace_back(projection * view * models.back());
     }
 
+    renderInstanced(models, mvps, sp);
+}
+
+void grx::Mesh::render(const glm::mat4& view, const glm::mat4& projection, grx::ShaderProgram& sp,
+                       const U32* instance_ids, unsigned count) {
+    if (count == 0)
+        return;
+
+    std::vector<glm::mat4> models; models.reserve(count);
+    std::vector<glm::mat4> mvps; mvps.reserve(count);
+
+    auto vp = projection * view;
+
+    for (unsigned i = 0; i < count; ++i) {
+        auto id = instance_ids[i];
+        models.emplace_back(glm::translate(glm::mat4(1), glm::vec3((id << 2)+4, 0.f, 0.f)));
+        mvps.emplace_back(vp * models.back());
+    }
+
+    renderInstanced(models, mvps, sp);
+}
+
+void grx::Mesh::renderInstanced(const std::vector<glm::mat4>& models, const std::vector<glm::mat4>& mvps,
+                                grx::ShaderProgram& sp) {
+    auto instancesNum = static_cast<unsigned>(models.size());
+
     sp.uniform("_textureSampler", 0);
     sp.uniform("_normal_map", 1);
 
@@ -6,6 +6,7 @@
 #include <glm/mat4x4.hpp>
 #include <assimp/vector3.h>
 #include <assimp/matrix4x4.h>
+#include "baseTypes.hpp"
 #include "ShaderManager.hpp"
 #include "TextureManager.hpp"
 
@@ -109,6 +110,14 @@ namespace grx {
             render(view_projection.first, view_projection.second, shader_program, instances);
         }
 
+        // Renders only instances from list (e.g. visible IDs from culling)
+        void render(const glm::mat4& view, const glm::mat4& projection, grx::ShaderProgram& shader_program,
+                    const U32* instance_ids, unsigned count);
+
+        void render(const VP_T& view_projection, grx::ShaderProgram& shader_program, const U32* instance_ids, unsigned count) {
+            render(view_projection.first, view_projection.second, shader_program, instance_ids, count);
+        }
+
         void addNormals(unsigned materialID, const grx::Texture& texture) {
             if (textures_normals.size() <= materialID)
                 textures_normals.resize(materialID + 1);
@@ -143,6 +152,8 @@ namespace grx {
     protected:
         void initFromScene(const aiScene* scene, const char* filepath);
         void initMesh(const aiMesh* mesh, UnpackedVertexVector& vertices, std::vector<unsigned>& indices);
+        void renderInstanced(const std::vector<glm::mat4>& models, const std::vector<glm::mat4>& mvps,
+                             grx::ShaderProgram& sp);
 
         std::vector<MeshEntry> mesh_entries;
         std::vector<grx::Texture>  textures;
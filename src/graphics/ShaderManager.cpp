@@ -1,12 +1,11 @@
 #include "ShaderManager.hpp"
 
-#include <fstream>
-
 #include <GL/glew.h>
 #include <GL/glfx.h>
 #include <iostream>
 
 #include "filesystem.hpp"
+#include "vfs.hpp"
 #include "configs.hpp"
 
 grx_sl::ShaderManager::ShaderManager() {
@@ -31,19 +30,16 @@ unsigned int grx_sl::ShaderManager::loadShader(const char* sp, grx::ShaderType s
 
     GLuint ID = glCreateShader(shType);
 
-    // Todo: assert if can't open!
-    std::ifstream shIfs(sp, std::ios::in | std::ios::ate);
-    auto shIfsEnd = shIfs.tellg();
-    shIfs.seekg(0, std::ios::beg);
-    auto shCodeSize = shIfsEnd - shIfs.tellg();
+    // Source is passed straight from the file view with explicit length
+    auto file = base::vfs().open(sp);
+    RASSERTF(file.has_value(), "Can't open shader file: \'{}\'", sp);
 
-    char* shCode = new char[shCodeSize + 1];
-    shCode[shCodeSize] = '\0';
-    shIfs.read(shCode, shCodeSize);
-    shIfs.close();
+    auto shCode     = file->view();
+    auto shCodePtr  = shCode.data();
+    auto shCodeSize = static_cast<GLint>(shCode.size());
 
     // Todo: compilation log
-    glShaderSource(ID, 1, &shCode, nullptr);
+    glShaderSource(ID, 1, &shCodePtr, &shCodeSize);
     glCompileShader(ID);
 
 
@@ -61,8 +57,6 @@ unsigned int grx_sl::ShaderManager::loadShader(const char* sp, grx::ShaderType s
         delete [] errorMsg;
     }
 
-    delete [] shCode;
-
     return ID;
 }
 
@@ -113,8 +107,13 @@ unsigned grx_sl::ShaderManager::loadEffect(const char* ep) {
     if (found != effects.end())
         return found->second;
 
+    auto file = base::vfs().open(realPath.c_str());
+    RASSERTF(file.has_value(), "Can't open effect file: \'{}\'", realPath);
+
+    // glfx expects null-terminated source
+    auto source   = std::string(file->view());
     auto effectId = glfxGenEffect();
-    auto rc = glfxParseEffectFromFile(effectId, realPath.c_str());
+    auto rc = glfxParseEffectFromMemory(effectId, source.c_str());
 
     // Todo: assert
     if (!rc)
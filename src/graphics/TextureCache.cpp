@@ -0,0 +1,526 @@
+#include "TextureCache.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include <xxhash.h>
+
+#include "files.hpp"
+#include "vfs.hpp"
+#include "logs.hpp"
+
+
+namespace {
+    using namespace grx_txtr;
+
+    constexpr SizeT MIP_ALIGNMENT = 16;
+
+    SizeT block_bytes(TextureFormat format) {
+        return format == TextureFormat::BC1 ? 8 : 16;
+    }
+
+    /**
+     * Gather 4x4 RGBA block, pixels outside of image are clamped to the edge
+     */
+    void fetchBlock(const DecodedImage& image, U32 bx, U32 by, U8 (&block)[16][4]) {
+        for (U32 y = 0; y < 4; ++y) {
+            for (U32 x = 0; x < 4; ++x) {
+                auto px  = std::min(bx * 4 + x, image.width  - 1);
+                auto py  = std::min(by * 4 + y, image.height - 1);
+                auto src = image.pixels.data() + (SizeT(py) * image.width + px) * 4;
+                std::memcpy(block[y * 4 + x], src, 4);
+            }
+        }
+    }
+
+    void storeBlock(DecodedImage& image, U32 bx, U32 by, const U8 (&block)[16][4]) {
+        for (U32 y = 0; y < 4 && by * 4 + y < image.height; ++y)
+            for (U32 x = 0; x < 4 && bx * 4 + x < image.width; ++x)
+                std::memcpy(image.pixels.data() + (SizeT(by * 4 + y) * image.width + bx * 4 + x) * 4, block[y * 4 + x], 4);
+    }
+
+    U16 pack565(const U8* c) {
+        auto r = (c[0] * 31 + 127) / 255;
+        auto g = (c[1] * 63 + 127) / 255;
+        auto b = (c[2] * 31 + 127) / 255;
+        return static_cast<U16>((r << 11) | (g << 5) | b);
+    }
+
+    void unpack565(U16 c, U8* out) {
+        auto r = (c >> 11) & 0x1F;
+        auto g = (c >> 5)  & 0x3F;
+        auto b =  c        & 0x1F;
+        out[0] = static_cast<U8>((r << 3) | (r >> 2));
+        out[1] = static_cast<U8>((g << 2) | (g >> 4));
+        out[2] = static_cast<U8>((b << 3) | (b >> 2));
+        out[3] = 255;
+    }
+
+    void bc1Palette(U16 c0, U16 c1, bool four_colors, U8 (&palette)[4][4]) {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+
+        for (int i = 0; i < 3; ++i) {
+            if (four_colors) {
+                palette[2][i] = static_cast<U8>((2 * palette[0][i] + palette[1][i]) / 3);
+                palette[3][i] = static_cast<U8>((palette[0][i] + 2 * palette[1][i]) / 3);
+            } else {
+                palette[2][i] = static_cast<U8>((palette[0][i] + palette[1][i]) / 2);
+                palette[3][i] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = four_colors ? 255 : 0;
+    }
+
+    /**
+     * Endpoints are extreme pixels along principal axis of block colors, 4-color mode only
+     */
+    void encodeBc1Block(const U8 (&block)[16][4], U8* out) {
+        float mean[3] = {0.f, 0.f, 0.f};
+        for (auto& px : block)
+            for (int i = 0; i < 3; ++i)
+                mean[i] += px[i] / 16.f;
+
+        float cov[6] = {0.f, 0.f, 0.f, 0.f, 0.f, 0.f};
+        for (auto& px : block) {
+            float d[3] = {px[0] - mean[0], px[1] - mean[1], px[2] - mean[2]};
+            cov[0] += d[0] * d[0]; cov[1] += d[0] * d[1]; cov[2] += d[0] * d[2];
+            cov[3] += d[1] * d[1]; cov[4] += d[1] * d[2]; cov[5] += d[2] * d[2];
+        }
+
+        // Power iteration
+        float axis[3] = {1.f, 1.f, 1.f};
+        for (int iter = 0; iter < 8; ++iter) {
+            float next[3] = {
+                cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2],
+                cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2],
+                cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2]
+            };
+            auto norm = std::max({std::abs(next[0]), std::abs(next[1]), std::abs(next[2])});
+            if (norm < 1e-6f)
+                break;
+            for (int i = 0; i < 3; ++i)
+                axis[i] = next[i] / norm;
+        }
+
+        auto min_px = 0U, max_px = 0U;
+        auto min_t  = std::numeric_limits<float>::max();
+        auto max_t  = std::numeric_limits<float>::lowest();
+
+        for (U32 p = 0; p < 16; ++p) {
+            auto t = block[p][0] * axis[0] + block[p][1] * axis[1] + block[p][2] * axis[2];
+            if (t < min_t) { min_t = t; min_px = p; }
+            if (t > max_t) { max_t = t; max_px = p; }
+        }
+
+        auto& max = block[max_px];
+        auto& min = block[min_px];
+
+        auto c0 = pack565(max);
+        auto c1 = pack565(min);
+        if (c0 < c1)
+            std::swap(c0, c1);
+
+        U32 indices = 0;
+
+        if (c0 != c1) {
+            U8 palette[4][4];
+            bc1Palette(c0, c1, true, palette);
+
+            for (U32 p = 0; p < 16; ++p) {
+                U32 best      = 0;
+                S32 best_dist = std::numeric_limits<S32>::max();
+
+                for (U32 i = 0; i < 4; ++i) {
+                    S32 dist = 0;
+                    for (int c = 0; c < 3; ++c) {
+                        auto d = S32(block[p][c]) - S32(palette[i][c]);
+                        dist += d * d;
+                    }
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best      = i;
+                    }
+                }
+                indices |= best << (p * 2);
+            }
+        }
+
+        std::memcpy(out,     &c0,      2);
+        std::memcpy(out + 2, &c1,      2);
+        std::memcpy(out + 4, &indices, 4);
+    }
+
+    void decodeBc1Block(const U8* in, bool force_four_colors, U8 (&block)[16][4]) {
+        U16 c0, c1;
+        U32 indices;
+        std::memcpy(&c0,      in,     2);
+        std::memcpy(&c1,      in + 2, 2);
+        std::memcpy(&indices, in + 4, 4);
+
+        U8 palette[4][4];
+        bc1Palette(c0, c1, force_four_colors || c0 > c1, palette);
+
+        for (U32 p = 0; p < 16; ++p)
+            std::memcpy(block[p], palette[(indices >> (p * 2)) & 3], 4);
+    }
+
+    void bc4Palette(U8 a0, U8 a1, U8 (&palette)[8]) {
+        palette[0] = a0;
+        palette[1] = a1;
+
+        if (a0 > a1) {
+            for (int i = 1; i < 7; ++i)
+                palette[i + 1] = static_cast<U8>(((7 - i) * a0 + i * a1) / 7);
+        } else {
+            for (int i = 1; i < 5; ++i)
+                palette[i + 1] = static_cast<U8>(((5 - i) * a0 + i * a1) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    /**
+     * Single channel block, used for BC3 alpha and BC5 channels. 8-value mode only
+     */
+    void encodeBc4Block(const U8 (&block)[16][4], int channel, U8* out) {
+        U8 a0 = 0, a1 = 255;
+
+        for (auto& px : block) {
+            a0 = std::max(a0, px[channel]);
+            a1 = std::min(a1, px[channel]);
+        }
+
+        U64 indices = 0;
+
+        if (a0 != a1) {
+            U8 palette[8];
+            bc4Palette(a0, a1, palette);
+
+            for (U32 p = 0; p < 16; ++p) {
+                U64 best      = 0;
+                S32 best_dist = std::numeric_limits<S32>::max();
+
+                for (U32 i = 0; i < 8; ++i) {
+                    auto dist = std::abs(S32(block[p][channel]) - S32(palette[i]));
+                    if (dist < best_dist) {
+                        best_dist = dist;
+                        best      = i;
+                    }
+                }
+                indices |= best << (p * 3);
+            }
+        }
+
+        out[0] = a0;
+        out[1] = a1;
+        for (int i = 0; i < 6; ++i)
+            out[2 + i] = static_cast<U8>(indices >> (i * 8));
+    }
+
+    void decodeBc4Block(const U8* in, int channel, U8 (&block)[16][4]) {
+        U8 palette[8];
+        bc4Palette(in[0], in[1], palette);
+
+        U64 indices = 0;
+        for (int i = 0; i < 6; ++i)
+            indices |= U64(in[2 + i]) << (i * 8);
+
+        for (U32 p = 0; p < 16; ++p)
+            block[p][channel] = palette[(indices >> (p * 3)) & 7];
+    }
+} // anonymous namespace
+
+
+auto grx_txtr::hash_source(const U8* data, SizeT size) -> U64 {
+    return XXH64(data, size, 0);
+}
+
+auto grx_txtr::build_mips(const DecodedImage& image) -> std::vector<DecodedImage> {
+    auto mips = std::vector<DecodedImage>();
+    mips.push_back(image);
+
+    while (mips.back().width > 1 || mips.back().height > 1) {
+        auto& src = mips.back();
+        auto  dst = DecodedImage();
+
+        dst.width  = std::max(src.width  / 2, 1U);
+        dst.height = std::max(src.height / 2, 1U);
+        dst.pixels.resize(SizeT(dst.width) * dst.height * 4);
+
+        for (U32 y = 0; y < dst.height; ++y) {
+            auto y0 = std::min(y * 2,     src.height - 1);
+            auto y1 = std::min(y * 2 + 1, src.height - 1);
+
+            for (U32 x = 0; x < dst.width; ++x) {
+                auto x0 = std::min(x * 2,     src.width - 1);
+                auto x1 = std::min(x * 2 + 1, src.width - 1);
+
+                for (SizeT c = 0; c < 4; ++c) {
+                    auto sum = src.pixels[(SizeT(y0) * src.width + x0) * 4 + c] +
+                               src.pixels[(SizeT(y0) * src.width + x1) * 4 + c] +
+                               src.pixels[(SizeT(y1) * src.width + x0) * 4 + c] +
+                               src.pixels[(SizeT(y1) * src.width + x1) * 4 + c];
+                    dst.pixels[(SizeT(y) * dst.width + x) * 4 + c] = static_cast<U8>((sum + 2) / 4);
+                }
+            }
+        }
+
+        mips.push_back(std::move(dst));
+    }
+
+    return mips;
+}
+
+auto grx_txtr::compressed_size(TextureFormat format, U32 width, U32 height) -> SizeT {
+    if (format == TextureFormat::RGBA8)
+        return SizeT(width) * height * 4;
+
+    return SizeT((width + 3) / 4) * ((height + 3) / 4) * block_bytes(format);
+}
+
+auto grx_txtr::compress_image(TextureFormat format, const DecodedImage& image) -> std::vector<U8> {
+    if (format == TextureFormat::RGBA8)
+        return image.pixels;
+
+    auto result   = std::vector<U8>(compressed_size(format, image.width, image.height));
+    auto blocks_x = (image.width  + 3) / 4;
+    auto blocks_y = (image.height + 3) / 4;
+    auto out      = result.data();
+
+    U8 block[16][4];
+
+    for (U32 by = 0; by < blocks_y; ++by) {
+        for (U32 bx = 0; bx < blocks_x; ++bx) {
+            fetchBlock(image, bx, by, block);
+
+            switch (format) {
+                case TextureFormat::BC1:
+                    encodeBc1Block(block, out);
+                    break;
+                case TextureFormat::BC3:
+                    encodeBc4Block(block, 3, out);
+                    encodeBc1Block(block, out + 8);
+                    break;
+                case TextureFormat::BC5:
+                    encodeBc4Block(block, 0, out);
+                    encodeBc4Block(block, 1, out + 8);
+                    break;
+                default:
+                    break;
+            }
+
+            out += block_bytes(format);
+        }
+    }
+
+    return result;
+}
+
+auto grx_txtr::decompress_image(TextureFormat format, const U8* data, U32 width, U32 height) -> DecodedImage {
+    auto image = DecodedImage();
+    image.width  = width;
+    image.height = height;
+
+    if (format == TextureFormat::RGBA8) {
+        image.pixels.assign(data, data + compressed_size(format, width, height));
+        return image;
+    }
+
+    image.pixels.resize(SizeT(width) * height * 4);
+
+    auto blocks_x = (width  + 3) / 4;
+    auto blocks_y = (height + 3) / 4;
+
+    U8 block[16][4];
+
+    for (U32 by = 0; by < blocks_y; ++by) {
+        for (U32 bx = 0; bx < blocks_x; ++bx) {
+            switch (format) {
+                case TextureFormat::BC1:
+                    decodeBc1Block(data, false, block);
+                    break;
+                case TextureFormat::BC3:
+                    decodeBc1Block(data + 8, true, block);
+                    decodeBc4Block(data, 3, block);
+                    break;
+                case TextureFormat::BC5:
+                    for (auto& px : block) {
+                        px[2] = 0;
+                        px[3] = 255;
+                    }
+                    decodeBc4Block(data,     0, block);
+                    decodeBc4Block(data + 8, 1, block);
+                    break;
+                default:
+                    break;
+            }
+
+            storeBlock(image, bx, by, block);
+            data += block_bytes(format);
+        }
+    }
+
+    return image;
+}
+
+auto grx_txtr::auto_format(const DecodedImage& image) -> TextureFormat {
+    for (SizeT i = 3; i < image.pixels.size(); i += 4)
+        if (image.pixels[i] != 255)
+            return TextureFormat::BC3;
+
+    return TextureFormat::BC1;
+}
+
+auto grx_txtr::cook_texture(const DecodedImage& image, TextureFormat format, U64 source_hash) -> std::vector<U8> {
+    auto mips   = build_mips(image);
+    auto header = CookedHeader();
+
+    header.format      = static_cast<U32>(format);
+    header.width       = image.width;
+    header.height      = image.height;
+    header.mips_count  = static_cast<U32>(mips.size());
+    header.source_hash = source_hash;
+
+    auto table  = std::vector<CookedMip>(mips.size());
+    auto offset = sizeof(CookedHeader) + sizeof(CookedMip) * table.size();
+
+    for (SizeT i = 0; i < mips.size(); ++i) {
+        offset = (offset + MIP_ALIGNMENT - 1) & ~(MIP_ALIGNMENT - 1);
+
+        table[i].width  = mips[i].width;
+        table[i].height = mips[i].height;
+        table[i].offset = offset;
+        table[i].size   = compressed_size(format, mips[i].width, mips[i].height);
+
+        offset += table[i].size;
+    }
+
+    auto result = std::vector<U8>(offset, 0);
+    std::memcpy(result.data(), &header, sizeof(header));
+    std::memcpy(result.data() + sizeof(header), table.data(), sizeof(CookedMip) * table.size());
+
+    for (SizeT i = 0; i < mips.size(); ++i) {
+        auto data = compress_image(format, mips[i]);
+        std::memcpy(result.data() + table[i].offset, data.data(), data.size());
+    }
+
+    return result;
+}
+
+auto grx_txtr::load_cooked(const std::string& source_path, const std::string& cache_path,
+                           std::optional<TextureFormat> format) -> CookedTexture {
+    auto file   = base::vfs().open(source_path);
+    auto source = file ? file->bytes() : base::BytesView();
+    auto data   = reinterpret_cast<const U8*>(source.data());
+    auto cooked = CookedTexture::map(cache_path);
+
+    // Texture cooked in other format is cooked again, e.g. image first loaded as diffuse then as normal map
+    auto sameFormat = !format || (cooked.valid() && cooked.format() == *format);
+
+    if (cooked.valid() && source.empty() && !sameFormat)
+        DE_LOG(Warning, Graphics, "Cooked texture '{}' has other format than requested, there is no source to cook it again",
+               cache_path);
+
+    if (cooked.valid() && (source.empty() || (sameFormat && cooked.source_hash() == hash_source(data, source.size()))))
+        return cooked;
+
+    if (source.empty()) {
+        DE_LOG(Error, Graphics, "Can't load texture '{}'. Can't read file", source_path);
+        return CookedTexture();
+    }
+
+    auto image = decode_image(data, source.size(), source_path);
+    if (!image.valid())
+        return CookedTexture();
+
+    auto bytes = cook_texture(image, format ? *format : auto_format(image), hash_source(data, source.size()));
+    base::writeBytesToFile(ftl::String(cache_path), reinterpret_cast<const Byte*>(bytes.data()), bytes.size());
+
+    return CookedTexture(std::move(bytes));
+}
+
+
+grx_txtr::CookedTexture::CookedTexture(std::vector<U8> bytes): _bytes(std::move(bytes)) {
+    _data = _bytes.data();
+    _size = _bytes.size();
+    validate();
+}
+
+grx_txtr::CookedTexture::~CookedTexture() {
+    reset();
+}
+
+grx_txtr::CookedTexture::CookedTexture(CookedTexture&& ct) noexcept {
+    *this = std::move(ct);
+}
+
+auto grx_txtr::CookedTexture::operator=(CookedTexture&& ct) noexcept -> CookedTexture& {
+    if (this != &ct) {
+        reset();
+
+        _bytes  = std::move(ct._bytes);
+        _data   = ct._data;
+        _size   = ct._size;
+        _file   = std::move(ct._file);
+        _header = ct._header;
+
+        ct._data   = nullptr;
+        ct._size   = 0;
+        ct._header = nullptr;
+    }
+    return *this;
+}
+
+void grx_txtr::CookedTexture::reset() {
+    _bytes.clear();
+    _file   = base::VfsFile();
+    _data   = nullptr;
+    _size   = 0;
+    _header = nullptr;
+}
+
+void grx_txtr::CookedTexture::validate() {
+    auto header = reinterpret_cast<const CookedHeader*>(_data);
+
+    auto valid = _size >= sizeof(CookedHeader) &&
+                 header->magic == CookedHeader::MAGIC && header->version == CookedHeader::VERSION &&
+                 header->format <= static_cast<U32>(TextureFormat::BC5) && header->mips_count > 0 &&
+                 _size >= sizeof(CookedHeader) + sizeof(CookedMip) * header->mips_count;
+
+    if (valid) {
+        auto table = reinterpret_cast<const CookedMip*>(_data + sizeof(CookedHeader));
+
+        for (U32 i = 0; i < header->mips_count && valid; ++i)
+            valid = table[i].offset + table[i].size <= _size &&
+                    table[i].size == compressed_size(static_cast<TextureFormat>(header->format),
+                                                     table[i].width, table[i].height);
+    }
+
+    if (valid)
+        _header = header;
+    else
+        reset();
+}
+
+auto grx_txtr::CookedTexture::map(const std::string& path) -> CookedTexture {
+    auto result = CookedTexture();
+    auto file   = base::vfs().open(path);
+
+    if (file) {
+        result._file = std::move(*file);
+        result._data = reinterpret_cast<const U8*>(result._file.data());
+        result._size = result._file.size();
+        result.validate();
+    }
+
+    return result;
+}
+
+auto grx_txtr::CookedTexture::mip(U32 level) const -> MipView {
+    auto table = reinterpret_cast<const CookedMip*>(_data + sizeof(CookedHeader));
+    auto& mip  = table[level];
+
+    return MipView{mip.width, mip.height, _data + mip.offset, static_cast<SizeT>(mip.size)};
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <string>
+#include <optional>
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "vfs.hpp"
+#include "TextureDecoder.hpp"
+
+namespace grx_txtr {
+
+    enum class TextureFormat : U32 {
+        RGBA8 = 0,
+        BC1,  // RGB, 4 bpp
+        BC3,  // RGBA, 8 bpp
+        BC5   // RG (normal maps with reconstructed Z), 8 bpp
+    };
+
+    /**
+     * Cooked texture container (.dtx)
+     *
+     * CookedHeader, CookedMip table and mip levels from the largest one. Everything is
+     * stored in native byte order and ready to be passed to glTexImage2D/glCompressedTexImage2D
+     */
+    struct CookedHeader {
+        static constexpr U32 MAGIC   = 0x58544544; // "DETX"
+        static constexpr U32 VERSION = 1;
+
+        U32 magic       = MAGIC;
+        U32 version     = VERSION;
+        U32 format      = 0;
+        U32 width       = 0;
+        U32 height      = 0;
+        U32 mips_count  = 0;
+        U64 source_hash = 0; // xxhash64 of source image file
+    };
+
+    struct CookedMip {
+        U32 width  = 0;
+        U32 height = 0;
+        U64 offset = 0; // From the start of container
+        U64 size   = 0;
+    };
+
+    struct MipView {
+        U32       width  = 0;
+        U32       height = 0;
+        const U8* data   = nullptr;
+        SizeT     size   = 0;
+    };
+
+
+    /**
+     * Read-only cooked texture. Owns either loaded bytes or file from VFS
+     */
+    class CookedTexture {
+    public:
+        CookedTexture() = default;
+        explicit CookedTexture(std::vector<U8> bytes);
+        ~CookedTexture();
+
+        CookedTexture(CookedTexture&& ct) noexcept;
+        CookedTexture& operator=(CookedTexture&& ct) noexcept;
+
+        CookedTexture(const CookedTexture&) = delete;
+        CookedTexture& operator=(const CookedTexture&) = delete;
+
+        /**
+         * Map cooked texture file, packed cooked textures are read from archives
+         * @return invalid texture if file not exists or corrupted
+         */
+        static auto map(const std::string& path) -> CookedTexture;
+
+        bool valid() const { return _header != nullptr; }
+
+        auto format     () const { return static_cast<TextureFormat>(_header->format); }
+        auto width      () const { return _header->width; }
+        auto height     () const { return _header->height; }
+        auto mips_count () const { return _header->mips_count; }
+        auto source_hash() const { return _header->source_hash; }
+
+        auto mip(U32 level) const -> MipView;
+
+        auto bytes_size() const { return _size; }
+
+    private:
+        void validate();
+        void reset();
+
+        std::vector<U8>     _bytes;
+        const U8*           _data   = nullptr;
+        SizeT               _size   = 0;
+        base::VfsFile       _file;
+        const CookedHeader* _header = nullptr;
+    };
+
+
+    auto hash_source(const U8* data, SizeT size) -> U64;
+
+    /**
+     * Build full mip chain with box filter, first level is the image itself
+     */
+    auto build_mips(const DecodedImage& image) -> std::vector<DecodedImage>;
+
+    auto compressed_size (TextureFormat format, U32 width, U32 height) -> SizeT;
+    auto compress_image  (TextureFormat format, const DecodedImage& image) -> std::vector<U8>;
+    auto decompress_image(TextureFormat format, const U8* data, U32 width, U32 height) -> DecodedImage;
+
+    /**
+     * Choose BC1 for opaque images and BC3 for images with alpha
+     */
+    auto auto_format(const DecodedImage& image) -> TextureFormat;
+
+    /**
+     * Cook decoded image to container
+     * @param image - RGBA8 image
+     * @param format - format of mip levels
+     * @param source_hash - hash of source file for cache invalidation
+     */
+    auto cook_texture(const DecodedImage& image, TextureFormat format, U64 source_hash) -> std::vector<U8>;
+
+    /**
+     * Map cooked texture from cache or cook it from source on the first run
+     *
+     * Cache is used if its source hash and format match the source file and requested format
+     * or if there is no source file.
+     * Does not touch GL and may be called from any thread
+     * @param source_path - full path to source image
+     * @param cache_path - full path to cooked texture
+     * @param format - required format, nullopt for auto_format() of new texture and any format of cached one
+     * @return invalid texture if neither cache nor source can be loaded
+     */
+    auto load_cooked(const std::string& source_path, const std::string& cache_path,
+                     std::optional<TextureFormat> format) -> CookedTexture;
+
+} // namespace grx_txtr
@@ -0,0 +1,102 @@
+#include "TextureDecoder.hpp"
+
+#include <fstream>
+#include <mutex>
+#include <cstring>
+
+#include <IL/il.h>
+
+#include "vfs.hpp"
+#include "logs.hpp"
+
+
+std::string ilGetErrorString() {
+    switch (ilGetError()) {
+        case IL_INVALID_ENUM:         return "Invalid enum";
+        case IL_OUT_OF_MEMORY:        return "Out of memory";
+        case IL_FORMAT_NOT_SUPPORTED: return "Format not supported";
+        case IL_INTERNAL_ERROR:       return "Internal error";
+        case IL_INVALID_VALUE:        return "Invalid value";
+        case IL_ILLEGAL_OPERATION:    return "Illegal operation";
+        case IL_ILLEGAL_FILE_VALUE:   return "Illegal file value";
+        case IL_INVALID_FILE_HEADER:  return "Invalid file header";
+        case IL_INVALID_PARAM:        return "Invalid param";
+        case IL_COULD_NOT_OPEN_FILE:  return "Could not open file";
+        case IL_INVALID_EXTENSION:    return "Invalid extension";
+        case IL_FILE_ALREADY_EXISTS:  return "File already exists";
+        case IL_OUT_FORMAT_SAME:      return "Out format same";
+        case IL_STACK_OVERFLOW:       return "Stack overflow";
+        case IL_STACK_UNDERFLOW:      return "Stack underflow";
+        case IL_INVALID_CONVERSION:   return "Invalid conversion";
+        case IL_BAD_DIMENSIONS:       return "Bad dimensions";
+        case IL_FILE_READ_ERROR:      return "File read/write error";
+        default:                      return "No error";
+    }
+}
+
+namespace {
+    std::mutex     il_mutex;
+    std::once_flag il_init_flag;
+
+    void ilInitOnce() {
+        std::call_once(il_init_flag, [] {
+            ilInit();
+            ilEnable(IL_ORIGIN_SET);
+            ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+        });
+    }
+}
+
+auto grx_txtr::decode_image(const U8* data, SizeT size, const std::string& path_hint) -> DecodedImage {
+    ilInitOnce();
+
+    auto image = DecodedImage();
+    auto lock  = std::lock_guard(il_mutex);
+
+    auto imgID = ilGenImage();
+    ilBindImage(imgID);
+
+    auto type = ilTypeFromExt(path_hint.c_str());
+    auto rc   = ilLoadL(type != IL_TYPE_UNKNOWN ? type : ilDetermineTypeL(data, static_cast<ILuint>(size)),
+                        data, static_cast<ILuint>(size));
+
+    if (!rc || !ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE)) {
+        DE_LOG(Error, Graphics, "Can't decode texture '{}'. IL error: {}", path_hint, ilGetErrorString());
+        ilDeleteImage(imgID);
+        return image;
+    }
+
+    image.width  = static_cast<U32>(ilGetInteger(IL_IMAGE_WIDTH));
+    image.height = static_cast<U32>(ilGetInteger(IL_IMAGE_HEIGHT));
+    image.pixels.resize(SizeT(image.width) * image.height * 4);
+    std::memcpy(image.pixels.data(), ilGetData(), image.pixels.size());
+
+    ilDeleteImage(imgID);
+    return image;
+}
+
+auto grx_txtr::read_image_file(const std::string& path) -> std::vector<U8> {
+    auto ifs = std::ifstream(path, std::ios_base::binary | std::ios_base::in);
+
+    if (!ifs.is_open())
+        return {};
+
+    ifs.seekg(0, std::ios_base::end);
+    auto bytes = std::vector<U8>(static_cast<SizeT>(ifs.tellg()));
+    ifs.seekg(0, std::ios_base::beg);
+    ifs.read(reinterpret_cast<char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+
+    return ifs ? bytes : std::vector<U8>();
+}
+
+auto grx_txtr::decode_image(const std::string& path) -> DecodedImage {
+    // File is read outside of DevIL lock, so threads wait only for decoding
+    auto file = base::vfs().open(path);
+
+    if (!file || file->empty()) {
+        DE_LOG(Error, Graphics, "Can't load texture '{}'. Can't read file", path);
+        return DecodedImage();
+    }
+
+    return decode_image(reinterpret_cast<const U8*>(file->data()), file->size(), path);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "baseTypes.hpp"
+
+namespace grx_txtr {
+
+    /**
+     * Image decoded to RGBA8, rows go from bottom to top as GL expects
+     */
+    struct DecodedImage {
+        std::vector<U8> pixels;
+        U32             width  = 0;
+        U32             height = 0;
+
+        bool  valid     () const { return !pixels.empty(); }
+        SizeT size_bytes() const { return pixels.size(); }
+    };
+
+    /**
+     * Read whole image file
+     * @return empty vector if file can't be read
+     */
+    auto read_image_file(const std::string& path) -> std::vector<U8>;
+
+    /**
+     * Decode stage of texture loading. Does not touch GL and may be called from any thread
+     *
+     * File is read through VFS without locks, DevIL keeps global state so only decoding itself is serialized
+     * @param path - full path to image file or path relative to data directory
+     * @return decoded image or invalid image if file can't be read or decoded
+     */
+    auto decode_image(const std::string& path) -> DecodedImage;
+
+    /**
+     * Decode image from memory
+     * @param data - encoded image
+     * @param size - size of encoded image
+     * @param path_hint - file name used to detect format (TGA has no signature)
+     */
+    auto decode_image(const U8* data, SizeT size, const std::string& path_hint) -> DecodedImage;
+
+} // namespace grx_txtr
@@ -1,119 +1,210 @@
 #include "TextureManager.hpp"
 
-#include <fstream>
-
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
-#include <IL/il.h>
-#include <cstring>
-#include <iostream>
 
 #include "configs.hpp"
 #include "logs.hpp"
 
 
-std::string ilGetErrorString() {
-    switch (ilGetError()) {
-        case IL_INVALID_ENUM:         return "Invalid enum";
-        case IL_OUT_OF_MEMORY:        return "Out of memory";
-        case IL_FORMAT_NOT_SUPPORTED: return "Format not supported";
-        case IL_INTERNAL_ERROR:       return "Internal error";
-        case IL_INVALID_VALUE:        return "Invalid value";
-        case IL_ILLEGAL_OPERATION:    return "Illegal operation";
-        case IL_ILLEGAL_FILE_VALUE:   return "Illegal file value";
-        case IL_INVALID_FILE_HEADER:  return "Invalid file header";
-        case IL_INVALID_PARAM:        return "Invalid param";
-        case IL_COULD_NOT_OPEN_FILE:  return "Could not open file";
-        case IL_INVALID_EXTENSION:    return "Invalid extension";
-        case IL_FILE_ALREADY_EXISTS:  return "File already exists";
-        case IL_OUT_FORMAT_SAME:      return "Out format same";
-        case IL_STACK_OVERFLOW:       return "Stack overflow";
-        case IL_STACK_UNDERFLOW:      return "Stack underflow";
-        case IL_INVALID_CONVERSION:   return "Invalid conversion";
-        case IL_BAD_DIMENSIONS:       return "Bad dimensions";
-        case IL_FILE_READ_ERROR:      return "File read/write error";
-        default:                      return "No error";
+namespace {
+    GLenum glCompressedFormat(grx_txtr::TextureFormat format) {
+        switch (format) {
+            case grx_txtr::TextureFormat::BC1: return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case grx_txtr::TextureFormat::BC3: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case grx_txtr::TextureFormat::BC5: return GL_COMPRESSED_RG_RGTC2;
+            default:                           return 0;
+        }
     }
 }
 
-unsigned grx_txtr::TextureManager::loadIL(const std::string& path) {
-    auto realPath = base::fs::to_data_path(base::cfg::read<ftl::String>("textures_dir") / path);
-
-    auto imgID = ilGenImage();
+unsigned grx_txtr::TextureManager::upload(const CookedTexture& texture) {
     GLuint texId = 0; glGenTextures(1, &texId);
 
-    ilBindImage(imgID);
-    ilEnable(IL_ORIGIN_SET);
-    ilOriginFunc(IL_ORIGIN_LOWER_LEFT);
+    glBindTexture(GL_TEXTURE_2D, texId);
 
-    auto rc = ilLoadImage(realPath.c_str());
+    // RGTC is core since GL 3.0, S3TC is decompressed on CPU if not supported
+    auto format     = texture.format();
+    auto compressed = format == TextureFormat::BC5 ||
+                      (format != TextureFormat::RGBA8 && GLEW_EXT_texture_compression_s3tc);
 
-    if (!rc) {
-        base::Log("Can't load texture '{}'. IL error: {}", realPath, ilGetErrorString());
-        ilDeleteImage(imgID);
-        glDeleteTextures(1, &texId);
-        return 0;
-    } else {
-        ilConvertImage(IL_RGBA, IL_UNSIGNED_BYTE);
+    for (U32 level = 0; level < texture.mips_count(); ++level) {
+        auto mip = texture.mip(level);
+
+        if (format == TextureFormat::RGBA8) {
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA, static_cast<GLsizei>(mip.width),
+                         static_cast<GLsizei>(mip.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, mip.data);
+        }
+        else if (compressed) {
+            glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), glCompressedFormat(format),
+                                   static_cast<GLsizei>(mip.width), static_cast<GLsizei>(mip.height), 0,
+                                   static_cast<GLsizei>(mip.size), mip.data);
+        }
+        else {
+            auto image = decompress_image(format, mip.data, mip.width, mip.height);
+            glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), GL_RGBA, static_cast<GLsizei>(mip.width),
+                         static_cast<GLsizei>(mip.height), 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.data());
+        }
+    }
 
-        glBindTexture(GL_TEXTURE_2D, texId);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<GLint>(texture.mips_count() - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, ilGetInteger(IL_IMAGE_WIDTH),
-                     ilGetInteger(IL_IMAGE_HEIGHT), 0, GL_RGBA, GL_UNSIGNED_BYTE,
-                     ilGetData());
-        glGenerateMipmap(GL_TEXTURE_2D);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    return texId;
+}
 
-        ilDeleteImage(imgID);\
-        return texId;
-    }
+auto grx_txtr::TextureManager::realPath(const std::string& path) -> std::string {
+    return base::fs::to_data_path(base::cfg::read<ftl::String>("textures_dir") / path).c_str();
 }
 
-unsigned grx_txtr::TextureManager::loadTexture(const std::string& path) {
-    return loadIL(path);
+// Image loaded with explicit format is cached separately from auto format one, so they don't recook each other
+auto grx_txtr::TextureManager::cachePath(const std::string& path, std::optional<TextureFormat> format) -> std::string {
+    auto suffix = format ? ftl::String().sprintf(".f{}.dtx", static_cast<U32>(*format)) : ftl::String(".dtx");
+    return (base::fs::to_data_path(base::cfg::read<ftl::String>("textures_cache_dir") / path) + suffix).c_str();
+}
+
+auto grx_txtr::TextureManager::loadSync(const std::string& path) -> unsigned {
+    auto texture = load_cooked(realPath(path), cachePath(path, std::nullopt), std::nullopt);
+    return texture.valid() ? upload(texture) : 0;
 }
 
 grx_txtr::TextureManager:: TextureManager() {
-    ilInit();
+    // Job system must outlive texture manager which waits for decode jobs on destruction
+    base::job_system();
 
-    _dummy_diffuse    = load("dummy.tga");
-    _dummy_normal_map = load("dummy_normal_map.png");
+    _dummy_diffuse    = loadSync("dummy.tga");
+    _dummy_normal_map = loadSync("dummy_normal_map.png");
 }
 
 grx_txtr::TextureManager::~TextureManager() {
-    for (auto& t : textures)
-        glDeleteTextures(1, &(t.second.id));
+    if (!_decode_jobs.done())
+        base::job_system().wait(_decode_jobs);
+
+    for (auto& t : _slots)
+        if (t.id)
+            glDeleteTextures(1, &t.id);
+
+    glDeleteTextures(1, &_dummy_diffuse);
+    glDeleteTextures(1, &_dummy_normal_map);
 }
 
-unsigned grx_txtr::TextureManager::load(const std::string& path) {
-    auto find = textures.find(path);
+auto grx_txtr::TextureManager::load(const std::string& path, Placeholder placeholder) -> SlotT {
+    auto find = textures.find(TextureKey{path, placeholder});
 
     if (find != textures.end()) {
-        find->second.count++;
-        return find->second.id;
+        _slots[find->second].count++;
+        return find->second;
+    }
+
+    auto slot = SlotT(0);
+    if (!_free_slots.empty()) {
+        slot = _free_slots.back();
+        _free_slots.pop_back();
+    } else {
+        slot = static_cast<SlotT>(_slots.size());
+        _slots.emplace_back();
     }
-    else {
-        auto id = loadTexture(path);
 
-        if (id)
-            textures[path].id = id;
+    auto& param = _slots[slot];
+    param.id          = 0;
+    param.placeholder = placeholder == Placeholder::NormalMap ? _dummy_normal_map : _dummy_diffuse;
+    param.count       = 1;
+    param.kind        = placeholder;
+    param.path        = path;
+
+    textures.emplace(TextureKey{path, placeholder}, slot);
+    ++_pending;
+
+    // Normal maps are not block compressed by default, shaders use all three components
+    auto format = placeholder == Placeholder::NormalMap ? std::optional(TextureFormat::RGBA8) : std::nullopt;
+
+    // Config is read here, decode job touches only files and DevIL
+    base::job_system().submit([this, slot, format, generation = param.generation,
+                               real_path = realPath(path), cache_path = cachePath(path, format)] {
+        auto texture = load_cooked(real_path, cache_path, format);
+        auto lock    = std::lock_guard(_decoded_mutex);
+        _decoded.push_back(Decoded{slot, generation, std::move(texture)});
+    }, &_decode_jobs);
+
+    return slot;
+}
+
+void grx_txtr::TextureManager::acquire(SlotT slot) {
+    _slots[slot].count++;
+}
+
+void grx_txtr::TextureManager::release(SlotT slot) {
+    auto& param = _slots[slot];
 
-        return id;
+    if (param.count > 1) {
+        param.count--;
+        return;
     }
+
+    if (param.id)
+        glDeleteTextures(1, &param.id);
+
+    textures.erase(TextureKey{param.path, param.kind});
+
+    param.id    = 0;
+    param.count = 0;
+    param.path.clear();
+    param.generation++;
+
+    _free_slots.push_back(slot);
 }
 
 void grx_txtr::TextureManager::destroy(const std::string& path) {
-    auto find = textures.find(path);
+    for (auto kind : {Placeholder::Diffuse, Placeholder::NormalMap}) {
+        auto find = textures.find(TextureKey{path, kind});
 
-    if (find != textures.end()) {
-        if (find->second.count > 1)
-            find->second.count--;
-        else {
-            glDeleteTextures(1, &find->second.id);
-            textures.erase(path);
+        if (find != textures.end())
+            release(find->second);
+    }
+}
+
+auto grx_txtr::TextureManager::update(SizeT budget) -> SizeT {
+    SizeT uploaded = 0;
+    SizeT spent    = 0;
+
+    while (uploaded == 0 || spent < budget) {
+        auto decoded = Decoded();
+        {
+            auto lock = std::lock_guard(_decoded_mutex);
+            if (_decoded.empty())
+                break;
+
+            decoded = std::move(_decoded.front());
+            _decoded.pop_front();
         }
+        --_pending;
+
+        // Texture was destroyed while decoding or can't be decoded, placeholder stays
+        auto& param = _slots[decoded.slot];
+        if (param.generation != decoded.generation || !decoded.texture.valid())
+            continue;
+
+        param.id = upload(decoded.texture);
+        spent   += decoded.texture.bytes_size();
+        uploaded++;
     }
+
+    return uploaded;
+}
+
+void grx_txtr::TextureManager::finish() {
+    base::job_system().wait(_decode_jobs);
+    update(std::numeric_limits<SizeT>::max());
+}
+
+unsigned grx_txtr::TextureManager::glID(SlotT slot) const {
+    auto& param = _slots[slot];
+    return param.id ? param.id : param.placeholder;
+}
+
+void grx_txtr::TextureManager::bind(SlotT slot) const {
+    glBindTexture(GL_TEXTURE_2D, glID(slot));
 }
 
 void grx_txtr::TextureManager::bindDummyDiffuse() {
@@ -125,5 +216,5 @@ void grx_txtr::TextureManager::bindDummyNormalMap() {
 }
 
 void grx::Texture::bind() {
-    glBindTexture(GL_TEXTURE_2D, glID);
-}
\ No newline at end of file
+    texture_manager().bind(_slot);
+}
@@ -1,32 +1,116 @@
 #pragma once
 
+#include <string>
 #include <string_view>
-#include <future>
+#include <limits>
+#include <mutex>
+#include <deque>
+#include <vector>
 #include <flat_hash_map.hpp>
 
 #include "defines.hpp"
+#include "jobs.hpp"
+#include "TextureCache.hpp"
 
 namespace grx_txtr {
 
+    enum class Placeholder : U8 {
+        Diffuse = 0, NormalMap
+    };
+
     struct TextureParam {
-        unsigned    id    = 0;
-        std::size_t count = 1;
+        unsigned    id          = 0; // GL texture, 0 while decoding or if loading failed
+        unsigned    placeholder = 0; // GL texture bound instead of not ready one
+        std::size_t count       = 1;
+        U32         generation  = 0; // Increased on slot reuse, drops decoded images of destroyed textures
+        Placeholder kind        = Placeholder::Diffuse;
+        std::string path;
+    };
+
+    /**
+     * Same image loaded as diffuse texture and as normal map is cooked to different formats,
+     * so it takes two slots
+     */
+    struct TextureKey {
+        std::string path;
+        Placeholder kind;
+
+        bool operator==(const TextureKey& key) const { return kind == key.kind && path == key.path; }
     };
 
+    struct TextureKeyHash {
+        std::size_t operator()(const TextureKey& key) const {
+            return std::hash<std::string>()(key.path) ^ static_cast<std::size_t>(key.kind);
+        }
+    };
+
+    /**
+     * Texture cache with asynchronous loading
+     *
+     * load() only looks up the texture, decoding runs on job system and decoded images
+     * are uploaded to GL by update() within per-frame budget. Until upload textures are
+     * resolved to placeholders. Everything except decoding must be called from GL thread
+     *
+     * Textures are decoded once and cooked to textures_cache_dir with mip chain and block
+     * compression, next runs map cooked textures and upload them without decoding
+     */
     class TextureManager {
     public:
-        unsigned load   (const std::string& path);
-        void     destroy(const std::string& path);
+        using SlotT = U32;
+
+        static constexpr SlotT INVALID_SLOT          = std::numeric_limits<SlotT>::max();
+        static constexpr SizeT DEFAULT_UPLOAD_BUDGET = 16 * 1024 * 1024; // Bytes per frame
+
+        SlotT load   (const std::string& path, Placeholder placeholder = Placeholder::Diffuse);
+        void  acquire(SlotT slot);
+        void  release(SlotT slot);
+        void  destroy(const std::string& path); // Releases both diffuse and normal map textures of path
+
+        /**
+         * Upload decoded textures to GL
+         * @param budget - max bytes to upload per call, at least one texture is uploaded anyway
+         * @return count of uploaded textures
+         */
+        SizeT update(SizeT budget = DEFAULT_UPLOAD_BUDGET);
+
+        /**
+         * Wait for all pending textures and upload them
+         */
+        void  finish();
+
+        unsigned glID (SlotT slot) const;
+        bool     ready(SlotT slot) const { return _slots[slot].id != 0; }
+        void     bind (SlotT slot) const;
+
+        auto& path(SlotT slot) const { return _slots[slot].path; }
+
+        SizeT pending_count() const { return _pending; }
 
         void bindDummyDiffuse();
         void bindDummyNormalMap();
 
     protected:
-        static unsigned loadIL      (const std::string& path);
-        static unsigned loadTexture (const std::string& path);
+        struct Decoded {
+            SlotT        slot       = INVALID_SLOT;
+            U32          generation = 0;
+            CookedTexture texture;
+        };
+
+        static unsigned upload(const CookedTexture& texture);
 
-        ska::flat_hash_map<std::string, TextureParam> textures;
+        auto loadSync (const std::string& path) -> unsigned;
+        auto realPath (const std::string& path) -> std::string;
+        auto cachePath(const std::string& path, std::optional<TextureFormat> format) -> std::string;
 
+        ska::flat_hash_map<TextureKey, SlotT, TextureKeyHash> textures;
+
+        std::vector<TextureParam> _slots;
+        std::vector<SlotT>        _free_slots;
+        SizeT                     _pending = 0;
+
+        base::JobCounter    _decode_jobs;
+        std::mutex          _decoded_mutex;
+        std::deque<Decoded> _decoded;
 
         unsigned _dummy_diffuse;
         unsigned _dummy_normal_map;
@@ -44,40 +128,46 @@ namespace grx {
 
     class Texture {
     public:
+        using SlotT = grx_txtr::TextureManager::SlotT;
+
         Texture() = default;
 
-        explicit Texture(const std::string& path): _name(path) {
-            glID = texture_manager().load(path);
+        explicit Texture(const std::string& path, grx_txtr::Placeholder placeholder = grx_txtr::Placeholder::Diffuse):
+            _slot(texture_manager().load(path, placeholder)) {}
+
+        Texture(const Texture& t): _slot(t._slot) {
+            if (_slot != grx_txtr::TextureManager::INVALID_SLOT)
+                texture_manager().acquire(_slot);
         }
 
-        Texture(Texture&& t) noexcept: _name(std::move(t._name)), glID(t.glID) {
-            t.glID = 0; // invalidate
+        Texture(Texture&& t) noexcept: _slot(t._slot) {
+            t._slot = grx_txtr::TextureManager::INVALID_SLOT; // invalidate
         }
 
         ~Texture() {
-            if (glID)
-                texture_manager().destroy(_name);
+            if (_slot != grx_txtr::TextureManager::INVALID_SLOT)
+                texture_manager().release(_slot);
         }
 
-        Texture& operator=(const Texture& t) noexcept {
-            glID = texture_manager().load(t._name);
+        Texture& operator=(const Texture& t) {
+            if (this != &t)
+                *this = Texture(t);
             return *this;
         }
 
         Texture& operator=(Texture&& t) noexcept {
-            _name = std::move(t._name);
-            glID  = t.glID;
-            t.glID = 0; // invalidate
+            std::swap(_slot, t._slot);
             return *this;
         }
 
         void bind();
 
-        DE_DEFINE_GET(_name, name);
-        bool valid() { return glID != 0; }
+        auto& name() const { return texture_manager().path(_slot); }
+
+        bool valid() const { return _slot != grx_txtr::TextureManager::INVALID_SLOT; }
+        bool ready() const { return valid() && texture_manager().ready(_slot); }
 
     private:
-        std::string _name;
-        unsigned    glID = 0;
+        SlotT _slot = grx_txtr::TextureManager::INVALID_SLOT;
     };
-} // namespace grx
\ No newline at end of file
+} // namespace grx
@@ -10,6 +10,9 @@
 #include "GraphicsContext.hpp"
 #include "InputContext.hpp"
 #include "Camera.hpp"
+#include "TextureManager.hpp"
+#include "async_io.hpp"
+#include "configs.hpp"
 
 // map glfw window pointer to grx window pointer :/
 static ska::flat_hash_map<GLFWwindow*, grx::Window*> windowMapping;
@@ -93,6 +96,15 @@ bool grx::Window::isShouldClose() {
 void grx::Window::swapBuffers() {
     glfwSwapBuffers(glfwWindow);
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    // Upload textures decoded since last frame
+    texture_manager().update();
+
+    // Submit file requests batched during the frame
+    base::async_io().flush();
+
+    // Call config change callbacks after hot reload
+    base::cfg::dispatchChanges();
 }
 
 int grx::Window::getKey(int key) {
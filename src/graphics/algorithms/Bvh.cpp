@@ -0,0 +1,331 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <xmmintrin.h>
+
+#include "Bvh.hpp"
+
+namespace {
+    // Depth of binary tree after which SAH is replaced with median split
+    constexpr U32 MAX_SAH_DEPTH = 48;
+
+    inline float half_area(const float* min, const float* max) {
+        auto dx = max[0] - min[0];
+        auto dy = max[1] - min[1];
+        auto dz = max[2] - min[2];
+        return dx * dy + dy * dz + dz * dx;
+    }
+
+    inline void reset_bounds(float* min, float* max) {
+        for (int i = 0; i < 3; ++i) {
+            min[i] =  std::numeric_limits<float>::max();
+            max[i] = -std::numeric_limits<float>::max();
+        }
+    }
+
+    inline void grow_bounds(float* min, float* max, const float* pmin, const float* pmax) {
+        for (int i = 0; i < 3; ++i) {
+            min[i] = std::min(min[i], pmin[i]);
+            max[i] = std::max(max[i], pmax[i]);
+        }
+    }
+
+    inline float centroid(const frst_st::BvhPrimitive& p, int axis) {
+        return (p.min[axis] + p.max[axis]) * 0.5f;
+    }
+}
+
+
+void frst_st::Bvh4::clear() {
+    nodes.clear();
+    primitives.clear();
+    ids.clear();
+}
+
+void frst_st::Bvh4::build(std::vector<BvhPrimitive> prims) {
+    clear();
+
+    if (prims.empty())
+        return;
+
+    primitives = std::move(prims);
+
+    std::vector<BinaryNode> tree;
+    tree.reserve(2 * primitives.size() / LEAF_SIZE + 1);
+
+    auto root = buildBinary(tree, 0, static_cast<U32>(primitives.size()), 0);
+
+    nodes.reserve(tree.size() / 2 + 1);
+    collapse(tree, root);
+
+    ids.resize(primitives.size());
+    for (SizeT i = 0; i < primitives.size(); ++i)
+        ids[i] = primitives[i].id;
+}
+
+S32 frst_st::Bvh4::buildBinary(std::vector<BinaryNode>& tree, U32 first, U32 count, U32 depth) {
+    auto index = static_cast<S32>(tree.size());
+    tree.emplace_back();
+
+    BinaryNode node;
+    node.first = first;
+    node.count = count;
+    node.left  = -1;
+    node.right = -1;
+
+    float cmin[3], cmax[3];
+    reset_bounds(node.min, node.max);
+    reset_bounds(cmin, cmax);
+
+    auto begin = primitives.begin() + first;
+    auto end   = begin + count;
+
+    for (auto p = begin; p != end; ++p) {
+        float c[3] = { centroid(*p, 0), centroid(*p, 1), centroid(*p, 2) };
+        grow_bounds(node.min, node.max, p->min, p->max);
+        grow_bounds(cmin, cmax, c, c);
+    }
+
+    if (count <= LEAF_SIZE) {
+        tree[index] = node;
+        return index;
+    }
+
+    int axis = 0;
+    for (int i = 1; i < 3; ++i)
+        if (cmax[i] - cmin[i] > cmax[axis] - cmin[axis])
+            axis = i;
+
+    auto extent = cmax[axis] - cmin[axis];
+    auto mid    = end;
+
+    if (extent > 0.f && depth < MAX_SAH_DEPTH) {
+        // Binned SAH
+        auto scale   = static_cast<float>(BINS) / extent;
+        auto bin_for = [&](const BvhPrimitive& p) {
+            return std::min(static_cast<SizeT>((centroid(p, axis) - cmin[axis]) * scale), BINS - 1);
+        };
+
+        float bin_min[BINS][3], bin_max[BINS][3];
+        U32   bin_count[BINS] = {};
+
+        for (SizeT b = 0; b < BINS; ++b)
+            reset_bounds(bin_min[b], bin_max[b]);
+
+        for (auto p = begin; p != end; ++p) {
+            auto b = bin_for(*p);
+            grow_bounds(bin_min[b], bin_max[b], p->min, p->max);
+            ++bin_count[b];
+        }
+
+        // Sweep from the right: cost of right part for split after bin b
+        float right_cost[BINS];
+        float rmin[3], rmax[3];
+        U32   rcount = 0;
+        reset_bounds(rmin, rmax);
+
+        for (SizeT b = BINS - 1; b > 0; --b) {
+            grow_bounds(rmin, rmax, bin_min[b], bin_max[b]);
+            rcount += bin_count[b];
+            right_cost[b - 1] = rcount ? half_area(rmin, rmax) * rcount : 0.f;
+        }
+
+        // Sweep from the left and pick the best split
+        float lmin[3], lmax[3];
+        U32   lcount    = 0;
+        auto  best_cost = std::numeric_limits<float>::max();
+        SizeT best_bin  = BINS;
+        reset_bounds(lmin, lmax);
+
+        for (SizeT b = 0; b < BINS - 1; ++b) {
+            grow_bounds(lmin, lmax, bin_min[b], bin_max[b]);
+            lcount += bin_count[b];
+
+            if (lcount == 0 || lcount == count)
+                continue;
+
+            auto cost = half_area(lmin, lmax) * lcount + right_cost[b];
+            if (cost < best_cost) {
+                best_cost = cost;
+                best_bin  = b;
+            }
+        }
+
+        if (best_bin != BINS)
+            mid = std::partition(begin, end, [&](const BvhPrimitive& p) { return bin_for(p) <= best_bin; });
+    }
+
+    // Median split if SAH failed
+    if (mid == begin || mid == end) {
+        mid = begin + count / 2;
+        std::nth_element(begin, mid, end, [axis](const BvhPrimitive& a, const BvhPrimitive& b) {
+            return centroid(a, axis) < centroid(b, axis);
+        });
+    }
+
+    auto left_count = static_cast<U32>(mid - begin);
+
+    node.left  = buildBinary(tree, first, left_count, depth + 1);
+    node.right = buildBinary(tree, first + left_count, count - left_count, depth + 1);
+
+    tree[index] = node;
+    return index;
+}
+
+S32 frst_st::Bvh4::collapse(const std::vector<BinaryNode>& tree, S32 binary_index) {
+    S32 children[4];
+    int children_count = 0;
+
+    auto& bnode = tree[binary_index];
+    if (bnode.left < 0)
+        children[children_count++] = binary_index;
+    else {
+        children[children_count++] = bnode.left;
+        children[children_count++] = bnode.right;
+    }
+
+    // Open internal child with the largest surface area until node is full
+    while (children_count < 4) {
+        int   best      = -1;
+        float best_area = -1.f;
+
+        for (int i = 0; i < children_count; ++i) {
+            auto& c = tree[children[i]];
+            if (c.left >= 0 && half_area(c.min, c.max) > best_area) {
+                best      = i;
+                best_area = half_area(c.min, c.max);
+            }
+        }
+
+        if (best < 0)
+            break;
+
+        auto opened = tree[children[best]];
+        children[best]             = opened.left;
+        children[children_count++] = opened.right;
+    }
+
+    auto index = static_cast<S32>(nodes.size());
+    nodes.emplace_back();
+
+    for (int lane = 0; lane < 4; ++lane) {
+        if (lane < children_count) {
+            auto& c     = tree[children[lane]];
+            auto  child = c.left < 0 ? -1 : collapse(tree, children[lane]);
+
+            auto& node = nodes[index];
+            node.min_x[lane] = c.min[0];
+            node.min_y[lane] = c.min[1];
+            node.min_z[lane] = c.min[2];
+            node.max_x[lane] = c.max[0];
+            node.max_y[lane] = c.max[1];
+            node.max_z[lane] = c.max[2];
+            node.child[lane] = child;
+            node.first[lane] = c.first;
+            node.count[lane] = c.count;
+        }
+        else {
+            auto& node = nodes[index];
+            node.min_x[lane] = node.min_y[lane] = node.min_z[lane] = 0.f;
+            node.max_x[lane] = node.max_y[lane] = node.max_z[lane] = 0.f;
+            node.child[lane] = -1;
+            node.first[lane] = 0;
+            node.count[lane] = 0;
+        }
+    }
+
+    return index;
+}
+
+
+SizeT frst_st::Bvh4::cull(const float* frustum, U32* visible) const {
+    if (nodes.empty())
+        return 0;
+
+    __m128 a[6], b[6], c[6], d[6];
+    bool   sx[6], sy[6], sz[6];
+
+    for (int p = 0; p < 6; ++p) {
+        a[p]  = _mm_set1_ps(frustum[p * 4 + 0]);
+        b[p]  = _mm_set1_ps(frustum[p * 4 + 1]);
+        c[p]  = _mm_set1_ps(frustum[p * 4 + 2]);
+        d[p]  = _mm_set1_ps(frustum[p * 4 + 3]);
+        sx[p] = frustum[p * 4 + 0] >= 0.f;
+        sy[p] = frustum[p * 4 + 1] >= 0.f;
+        sz[p] = frustum[p * 4 + 2] >= 0.f;
+    }
+
+    auto zero = _mm_setzero_ps();
+
+    std::vector<S32> stack;
+    stack.reserve(64);
+    stack.push_back(0);
+
+    SizeT count = 0;
+
+    while (!stack.empty()) {
+        auto& node = nodes[stack.back()];
+        stack.pop_back();
+
+        auto outside = _mm_setzero_ps();
+        auto inside  = _mm_cmpeq_ps(zero, zero);
+
+        for (int p = 0; p < 6; ++p) {
+            // Positive vertex decides if box is outside of plane, negative - if it is fully inside
+            auto px = _mm_load_ps(sx[p] ? node.max_x : node.min_x);
+            auto py = _mm_load_ps(sy[p] ? node.max_y : node.min_y);
+            auto pz = _mm_load_ps(sz[p] ? node.max_z : node.min_z);
+            auto nx = _mm_load_ps(sx[p] ? node.min_x : node.max_x);
+            auto ny = _mm_load_ps(sy[p] ? node.min_y : node.max_y);
+            auto nz = _mm_load_ps(sz[p] ? node.min_z : node.max_z);
+
+            auto dp = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(px, a[p]), _mm_mul_ps(py, b[p])),
+                                            _mm_mul_ps(pz, c[p])), d[p]);
+            auto dn = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, a[p]), _mm_mul_ps(ny, b[p])),
+                                            _mm_mul_ps(nz, c[p])), d[p]);
+
+            outside = _mm_or_ps (outside, _mm_cmple_ps(dp, zero));
+            inside  = _mm_and_ps(inside,  _mm_cmpgt_ps(dn, zero));
+        }
+
+        auto outside_mask = _mm_movemask_ps(outside);
+        auto inside_mask  = _mm_movemask_ps(inside);
+
+        for (int lane = 0; lane < 4; ++lane) {
+            if (node.count[lane] == 0 || (outside_mask & (1 << lane)))
+                continue;
+
+            auto first = node.first[lane];
+            auto size  = node.count[lane];
+
+            if (inside_mask & (1 << lane)) {
+                // Whole subtree is inside
+                std::memcpy(visible + count, ids.data() + first, size * sizeof(U32));
+                count += size;
+            }
+            else if (node.child[lane] >= 0) {
+                stack.push_back(node.child[lane]);
+            }
+            else {
+                // Leaf on the border, test primitives
+                for (auto i = first; i < first + size; ++i) {
+                    auto& prim   = primitives[i];
+                    int   culled = 0;
+
+                    for (int p = 0; p < 6; ++p) {
+                        auto plane = frustum + p * 4;
+                        auto x = sx[p] ? prim.max[0] : prim.min[0];
+                        auto y = sy[p] ? prim.max[1] : prim.min[1];
+                        auto z = sz[p] ? prim.max[2] : prim.min[2];
+                        culled |= (x * plane[0] + y * plane[1] + z * plane[2] + plane[3]) <= 0.f;
+                    }
+
+                    visible[count] = prim.id;
+                    count += culled ^ 1;
+                }
+            }
+        }
+    }
+
+    return count;
+}
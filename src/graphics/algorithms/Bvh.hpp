@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "baseTypes.hpp"
+#include "allocators/AlignedAllocator.hpp"
+
+namespace frst_st {
+    struct BvhPrimitive {
+        float min[3];
+        float max[3];
+        U32   id;
+    };
+
+    /**
+     * Bounding volume hierarchy with 4-wide nodes for static AABBs
+     *
+     * Built with binned SAH, then binary tree is collapsed into 4-wide nodes stored as SoA,
+     * so one node is tested against a plane with a few SSE instructions.
+     * Primitives of any subtree are contiguous, so subtree which is fully inside of frustum
+     * is accepted with one copy of its IDs.
+     */
+    class Bvh4 {
+    public:
+        static constexpr SizeT LEAF_SIZE = 4;
+        static constexpr SizeT BINS      = 16;
+
+        void build(std::vector<BvhPrimitive> primitives);
+        void clear();
+
+        /**
+         * Writes IDs of primitives intersecting frustum (frustum[6][4], planes as Ax + By + Cz + D)
+         * @param visible - output, must have size() space
+         * @return count of written IDs
+         */
+        SizeT cull(const float* frustum, U32* visible) const;
+
+        SizeT size       () const { return ids.size(); }
+        SizeT nodes_count() const { return nodes.size(); }
+        bool  empty      () const { return ids.empty(); }
+
+    private:
+        struct alignas(64) Node {
+            float min_x[4], min_y[4], min_z[4];
+            float max_x[4], max_y[4], max_z[4];
+            S32   child[4]; // Index of child node, -1 for leaf
+            U32   first[4]; // Primitives of child subtree: [first, first + count)
+            U32   count[4]; // 0 for empty slot
+        };
+
+        struct BinaryNode {
+            float min[3];
+            float max[3];
+            U32   first, count;
+            S32   left, right; // -1 for leaf
+        };
+
+        S32 buildBinary(std::vector<BinaryNode>& tree, U32 first, U32 count, U32 depth);
+        S32 collapse   (const std::vector<BinaryNode>& tree, S32 binary_index);
+
+    private:
+        std::vector<Node, AlignedAllocator<Node, 64>> nodes;
+        std::vector<BvhPrimitive>                     primitives; // In leaf order
+        std::vector<U32>                              ids;        // In leaf order
+    };
+
+} // namespace frst_st
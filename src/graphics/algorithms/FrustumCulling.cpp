@@ -1,128 +1,903 @@
-#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include "FrustumCulling.hpp"
 
 #include "cpu_extension_checker.hpp"
-#include "frustum_culling_asm.hpp"
 #include "assert.hpp"
+#include "jobs.hpp"
 
 frst_st::FrustumStorage::FrustumStorage() {
-    aabbs     .reserve(65536);
-    results   .reserve(65536);
-    free_aabbs.reserve(65536);
+    for (auto stream : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z})
+        stream->reserve(65536);
+    results .reserve(65536);
+    dense_of.reserve(65536);
+    slot_of .reserve(65536);
+
+    owner = std::this_thread::get_id();
+
+    auto& cpu = base::cpu_extensions_checker();
+
+    if (cpu.HW_AVX512F && cpu.OS_AVX512) {
+        kernel          = avx512_soa_frustum_culling;
+        compact_kernel  = avx512_soa_frustum_culling_compact;
+        coherent_kernel = avx512_soa_frustum_culling_coherent;
+        multi_kernel    = avx512_soa_frustum_culling_multi;
+        sphere_kernel   = avx512_soa_sphere_culling;
+        obb_kernel      = avx512_soa_obb_culling;
+        simd_width      = 16;
+    }
+    else if (cpu.HW_AVX2 && cpu.HW_FMA3 && cpu.OS_AVX) {
+        kernel          = avx2_fma_soa_frustum_culling;
+        compact_kernel  = avx2_fma_soa_frustum_culling_compact;
+        coherent_kernel = avx2_fma_soa_frustum_culling_coherent;
+        multi_kernel    = avx2_fma_soa_frustum_culling_multi;
+        sphere_kernel   = avx2_fma_soa_sphere_culling;
+        obb_kernel      = avx2_fma_soa_obb_culling;
+        simd_width      = 8;
+    }
+    else if (cpu.HW_SSE2) {
+        kernel          = sse2_soa_frustum_culling;
+        compact_kernel  = sse2_soa_frustum_culling_compact;
+        coherent_kernel = nullptr;
+        multi_kernel    = sse2_soa_frustum_culling_multi;
+        sphere_kernel   = sse2_soa_sphere_culling;
+        obb_kernel      = sse2_soa_obb_culling;
+        simd_width      = 4;
+    }
+    else {
+        kernel          = scalar_soa_frustum_culling;
+        compact_kernel  = scalar_soa_frustum_culling_compact;
+        coherent_kernel = scalar_soa_frustum_culling_coherent;
+        multi_kernel    = scalar_soa_frustum_culling_multi;
+        sphere_kernel   = scalar_soa_sphere_culling;
+        obb_kernel      = scalar_soa_obb_culling;
+        simd_width      = 1;
+    }
+}
+
+frst_st::FrustumStorage::~FrustumStorage() {
+    auto op = pending.exchange(nullptr, std::memory_order_acquire);
+    while (op) {
+        auto next = op->next;
+        delete op;
+        op = next;
+    }
 }
 
-frst_st::FrustumStorage::~FrustumStorage() = default;
+template <typename ShapeT>
+SizeT frst_st::FrustumStorage::registerID(SizeT type_bits, const ShapeT& shape, ShapeT PendingOp::* field) {
+    auto handle = pool(type_bits).allocate();
+    RASSERTF(handle.index <= INDEX_MASK, "Too many primitives ({})", handle.index);
 
-SizeT frst_st::FrustumStorage::getID(const AabbT& aabb) {
-    if (free_aabbs.empty()) {
-        aabbs.emplace_back(aabb);
-        results.emplace_back(0);
-        return aabbs.size() - 1;
+    auto id = handle.pack() | type_bits;
+
+    if (std::this_thread::get_id() == owner) {
+        applyPending();
+        add(id, shape);
     } else {
-        auto id = free_aabbs.front();
-        free_aabbs.pop_back();
-        aabbs.at(id) = aabb;
-        return id;
+        auto op = new PendingOp();
+        op->id     = id;
+        op->*field = shape;
+        push(op);
     }
+
+    return id;
+}
+
+SizeT frst_st::FrustumStorage::getID(const AabbT& aabb, bool is_static) {
+    return registerID(is_static ? STATIC_ID_BIT : 0, aabb, &PendingOp::aabb);
 }
 
 SizeT frst_st::FrustumStorage::getID() {
-    if (free_aabbs.empty()) {
-        aabbs.emplace_back();
-        results.emplace_back(0);
-        return aabbs.size() - 1;
+    return getID(AabbT(glm::vec4(0.f), glm::vec4(0.f)));
+}
+
+SizeT frst_st::FrustumStorage::getSphereID(const SphereT& sphere) {
+    return registerID(SPHERE_ID_BIT, sphere, &PendingOp::sphere);
+}
+
+SizeT frst_st::FrustumStorage::getObbID(const ObbT& obb) {
+    return registerID(OBB_ID_BIT, obb, &PendingOp::obb);
+}
+
+void frst_st::FrustumStorage::removeID(SizeT id) {
+    auto& slots  = pool(id);
+    auto  handle = toHandle(id);
+
+    auto retired = slots.retire(handle);
+    ASSERTF(retired, "Remove of stale ID ({:#x})", id);
+
+    if (!retired)
+        return;
+
+    // Removal is queued before slot is recycled, so it is applied before reuse of the slot
+    if (std::this_thread::get_id() == owner) {
+        applyPending();
+        remove(id);
     } else {
-        auto id = free_aabbs.front();
-        free_aabbs.pop_back();
-        return id;
+        auto op = new PendingOp();
+        op->id     = id;
+        op->remove = true;
+        push(op);
     }
+
+    slots.recycle(handle.index);
 }
 
-void frst_st::FrustumStorage::removeID(SizeT id) {
-    ASSERTF(id < aabbs.size(), "ID >= aabbs size ({}, {})", id, aabbs.size());
-    free_aabbs.push_back(id);
+bool frst_st::FrustumStorage::isValid(SizeT id) const {
+    return pool(id).valid(toHandle(id));
+}
+
+auto frst_st::FrustumStorage::pool(SizeT id) -> base::HandlePool& {
+    return const_cast<base::HandlePool&>(static_cast<const FrustumStorage*>(this)->pool(id));
+}
+
+auto frst_st::FrustumStorage::pool(SizeT id) const -> const base::HandlePool& {
+    if (isSphere(id))
+        return sphere_handles;
+    if (isObb(id))
+        return obb_handles;
+    return isStatic(id) ? static_handles : handles;
+}
+
+void frst_st::FrustumStorage::push(PendingOp* op) {
+    auto head = pending.load(std::memory_order_relaxed);
+    do {
+        op->next = head;
+    } while (!pending.compare_exchange_weak(head, op, std::memory_order_release, std::memory_order_relaxed));
+}
+
+void frst_st::FrustumStorage::applyPending() {
+    auto op = pending.exchange(nullptr, std::memory_order_acquire);
+    if (!op)
+        return;
+
+    // Stack holds the latest operation on top, reverse it to apply in order
+    PendingOp* ordered = nullptr;
+    while (op) {
+        auto next = op->next;
+        op->next  = ordered;
+        ordered   = op;
+        op        = next;
+    }
+
+    while (ordered) {
+        auto id = ordered->id;
+
+        if (ordered->remove)
+            remove(id);
+        else if (isSphere(id))
+            add(id, ordered->sphere);
+        else if (isObb(id))
+            add(id, ordered->obb);
+        else
+            add(id, ordered->aabb);
+
+        auto next = ordered->next;
+        delete ordered;
+        ordered = next;
+    }
+}
+
+void frst_st::FrustumStorage::add(SizeT id, const AabbT& aabb) {
+    auto slot = toHandle(id).index;
+
+    if (isStatic(id)) {
+        if (slot >= static_aabbs.size()) {
+            static_aabbs  .resize(slot + 1);
+            static_alive  .resize(slot + 1, 0);
+            static_results.resize(slot + 1, 0);
+        }
+
+        static_alive[slot] = 1;
+        writeAabb(id, aabb);
+        return;
+    }
+
+    if (slot >= dense_of.size())
+        dense_of.resize(slot + 1, NO_SLOT);
+
+    for (auto stream : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z})
+        stream->emplace_back(0.f);
+    results      .emplace_back(0);
+    alive        .emplace_back(1);
+    cached_planes.emplace_back(0);
+    dirty        .emplace_back(0);
+    slot_of      .emplace_back(slot);
+
+    dense_of[slot] = static_cast<U32>(results.size() - 1);
+    writeAabb(id, aabb);
+}
+
+void frst_st::FrustumStorage::add(SizeT id, const SphereT& sphere) {
+    auto slot = toHandle(id).index;
+
+    if (slot >= sphere_results.size()) {
+        for (auto stream : {&sphere_x, &sphere_y, &sphere_z, &sphere_r})
+            stream->resize(slot + 1, 0.f);
+        sphere_alive  .resize(slot + 1, 0);
+        sphere_results.resize(slot + 1, 0);
+    }
+
+    sphere_alive  [slot] = 1;
+    sphere_results[slot] = 0;
+    writeSphere(id, sphere);
+}
+
+void frst_st::FrustumStorage::add(SizeT id, const ObbT& box) {
+    auto slot = toHandle(id).index;
+
+    if (slot >= obb_results.size()) {
+        for (auto& stream : obb)
+            stream.resize(slot + 1, 0.f);
+        obb_alive  .resize(slot + 1, 0);
+        obb_results.resize(slot + 1, 0);
+    }
+
+    obb_alive  [slot] = 1;
+    obb_results[slot] = 0;
+    writeObb(id, box);
+}
+
+void frst_st::FrustumStorage::remove(SizeT id) {
+    auto slot = toHandle(id).index;
+
+    if (isSphere(id) || isObb(id)) {
+        auto& alive_slots = isSphere(id) ? sphere_alive : obb_alive;
+        ASSERTF(slot < alive_slots.size(), "Remove of not added ID ({:#x})", id);
+        alive_slots[slot] = 0;
+        return;
+    }
+
+    if (isStatic(id)) {
+        ASSERTF(slot < static_results.size(), "Static ID >= static aabbs size ({}, {})", slot, static_results.size());
+        static_alive[slot] = 0;
+        bvh_dirty = true;
+        return;
+    }
+
+    ASSERTF(slot < dense_of.size() && dense_of[slot] != NO_SLOT, "Remove of not added ID ({:#x})", id);
+
+    // Slot stays in streams as hole until compaction
+    auto i = dense_of[slot];
+    alive[i]       = 0;
+    slot_of[i]     = NO_SLOT;
+    dense_of[slot] = NO_SLOT;
+    ++holes;
+}
+
+void frst_st::FrustumStorage::compact() {
+    if (holes == 0 || holes * COMPACT_RATIO < results.size())
+        return;
+
+    // Stable, so neighbours in streams stay neighbours
+    SizeT count = 0;
+    dirty_ids.clear();
+
+    for (SizeT i = 0; i < results.size(); ++i) {
+        if (!alive[i])
+            continue;
+
+        if (count != i) {
+            min_x[count] = min_x[i];
+            min_y[count] = min_y[i];
+            min_z[count] = min_z[i];
+            max_x[count] = max_x[i];
+            max_y[count] = max_y[i];
+            max_z[count] = max_z[i];
+
+            results      [count] = results[i];
+            cached_planes[count] = cached_planes[i];
+            dirty        [count] = dirty[i];
+            slot_of      [count] = slot_of[i];
+            alive        [count] = 1;
+
+            dense_of[slot_of[count]] = static_cast<U32>(count);
+
+            // AABBs added after the last multi-view culling are visible
+            if (count < view_masks.size())
+                view_masks[count] = i < view_masks.size() ? view_masks[i] : ~U32(0);
+        }
+
+        if (dirty[count])
+            dirty_ids.push_back(static_cast<U32>(count));
+
+        ++count;
+    }
+
+    for (auto stream : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z})
+        stream->resize(count);
+    results      .resize(count);
+    alive        .resize(count);
+    cached_planes.resize(count);
+    dirty        .resize(count);
+    slot_of      .resize(count);
+    view_masks   .resize(std::min(view_masks.size(), count));
+
+    holes           = 0;
+    occlusion_valid = false;
+}
+
+SizeT frst_st::FrustumStorage::dense(SizeT id) const {
+    auto slot = toHandle(id).index;
+    return slot < dense_of.size() ? dense_of[slot] : NO_SLOT;
+}
+
+auto frst_st::FrustumStorage::getAabb(SizeT id) const -> AabbT {
+    ASSERTF(isValid(id), "Stale ID ({:#x})", id);
+    ASSERTF(isAabb(id), "ID is not AABB ({:#x})", id);
+
+    if (isStatic(id)) {
+        auto slot = toHandle(id).index;
+        ASSERTF(slot < static_aabbs.size(), "AABB is not added yet, call applyPending() ({:#x})", id);
+        return static_aabbs[slot];
+    }
+
+    auto i = dense(id);
+    ASSERTF(i != NO_SLOT, "AABB is not added yet, call applyPending() ({:#x})", id);
+    return AabbT(glm::vec4(min_x[i], min_y[i], min_z[i], 1.f),
+                 glm::vec4(max_x[i], max_y[i], max_z[i], 1.f));
+}
+
+void frst_st::FrustumStorage::setAabb(SizeT id, const AabbT& aabb) {
+    ASSERTF(isValid(id), "Stale ID ({:#x})", id);
+    ASSERTF(isAabb(id), "ID is not AABB ({:#x})", id);
+
+    // AABB may be added by other thread
+    if (pending.load(std::memory_order_relaxed))
+        applyPending();
+
+    writeAabb(id, aabb);
+}
+
+void frst_st::FrustumStorage::writeAabb(SizeT id, const AabbT& aabb) {
+    // Kernels test only positive vertex, so min must be <= max
+    auto min = glm::vec4(std::min(aabb.first.x, aabb.second.x),
+                         std::min(aabb.first.y, aabb.second.y),
+                         std::min(aabb.first.z, aabb.second.z), 1.f);
+    auto max = glm::vec4(std::max(aabb.first.x, aabb.second.x),
+                         std::max(aabb.first.y, aabb.second.y),
+                         std::max(aabb.first.z, aabb.second.z), 1.f);
+
+    if (isStatic(id)) {
+        auto slot = toHandle(id).index;
+        ASSERT(slot < static_aabbs.size());
+        static_aabbs[slot] = AabbT(min, max);
+        bvh_dirty = true;
+        return;
+    }
+
+    auto i = dense(id);
+    ASSERT(i != NO_SLOT);
+    markDirty(i);
+    min_x[i] = min.x;
+    min_y[i] = min.y;
+    min_z[i] = min.z;
+    max_x[i] = max.x;
+    max_y[i] = max.y;
+    max_z[i] = max.z;
+}
+
+auto frst_st::FrustumStorage::getSphere(SizeT id) const -> SphereT {
+    ASSERTF(isValid(id) && isSphere(id), "Stale ID or ID is not sphere ({:#x})", id);
+
+    auto slot = toHandle(id).index;
+    ASSERTF(slot < sphere_results.size(), "Sphere is not added yet, call applyPending() ({:#x})", id);
+    return SphereT(sphere_x[slot], sphere_y[slot], sphere_z[slot], sphere_r[slot]);
+}
+
+void frst_st::FrustumStorage::setSphere(SizeT id, const SphereT& sphere) {
+    ASSERTF(isValid(id) && isSphere(id), "Stale ID or ID is not sphere ({:#x})", id);
+
+    if (pending.load(std::memory_order_relaxed))
+        applyPending();
+
+    writeSphere(id, sphere);
+}
+
+void frst_st::FrustumStorage::writeSphere(SizeT id, const SphereT& sphere) {
+    auto slot = toHandle(id).index;
+    ASSERT(slot < sphere_results.size());
+
+    sphere_x[slot] = sphere.x;
+    sphere_y[slot] = sphere.y;
+    sphere_z[slot] = sphere.z;
+    sphere_r[slot] = std::fabs(sphere.w);
 }
 
+auto frst_st::FrustumStorage::getObb(SizeT id) const -> ObbT {
+    ASSERTF(isValid(id) && isObb(id), "Stale ID or ID is not OBB ({:#x})", id);
 
-void frst_st::FrustumStorage::frustum_test_mt(
-        void(*func)(int32_t*, float*, float*, std::size_t),
-        int32_t *results, float *aabbs, float *frustum, std::size_t count, std::size_t nprocs)
-{
-    std::vector<std::thread> threads;
-    for (SizeT i = 0; i < nprocs; ++i)
-        threads.emplace_back(
-                std::thread(
-                        func,
-                        results + i * count,
-                        aabbs + i * 8 * count, frustum, count));
+    auto slot = toHandle(id).index;
+    ASSERTF(slot < obb_results.size(), "OBB is not added yet, call applyPending() ({:#x})", id);
 
-    for (auto& t : threads)
-        t.join();
+    auto box = ObbT();
+    box.center = glm::vec4(obb[0][slot], obb[1][slot], obb[2][slot], 1.f);
+    for (int k = 0; k < 3; ++k)
+        box.axes[k] = glm::vec4(obb[3 + k * 3][slot], obb[4 + k * 3][slot], obb[5 + k * 3][slot], 0.f);
+
+    return box;
 }
 
+void frst_st::FrustumStorage::setObb(SizeT id, const ObbT& box) {
+    ASSERTF(isValid(id) && isObb(id), "Stale ID or ID is not OBB ({:#x})", id);
+
+    if (pending.load(std::memory_order_relaxed))
+        applyPending();
+
+    writeObb(id, box);
+}
+
+void frst_st::FrustumStorage::writeObb(SizeT id, const ObbT& box) {
+    auto slot = toHandle(id).index;
+    ASSERT(slot < obb_results.size());
+
+    obb[0][slot] = box.center.x;
+    obb[1][slot] = box.center.y;
+    obb[2][slot] = box.center.z;
+
+    for (int k = 0; k < 3; ++k) {
+        obb[3 + k * 3][slot] = box.axes[k].x;
+        obb[4 + k * 3][slot] = box.axes[k].y;
+        obb[5 + k * 3][slot] = box.axes[k].z;
+    }
+}
+
+U32 frst_st::FrustumStorage::getViewMask(SizeT id) const {
+    ASSERTF(isValid(id), "Stale ID ({:#x})", id);
+
+    if (!isAabb(id)) {
+        auto  slot  = toHandle(id).index;
+        auto& masks = isSphere(id) ? sphere_view_masks : obb_view_masks;
+        return slot < masks.size() ? masks[slot] : ~U32(0);
+    }
+
+    if (isStatic(id)) {
+        auto slot = toHandle(id).index;
+        return slot < static_view_masks.size() ? static_view_masks[slot] : ~U32(0);
+    }
+
+    auto i = dense(id);
+    return i < view_masks.size() ? view_masks[i] : ~U32(0);
+}
+
+int32_t frst_st::FrustumStorage::getResult(SizeT id) const {
+    ASSERTF(isValid(id), "Stale ID ({:#x})", id);
+
+    // Not culled yet AABBs are visible
+    if (!isAabb(id)) {
+        auto  slot   = toHandle(id).index;
+        auto& culled = isSphere(id) ? sphere_results  : obb_results;
+        auto& hidden = isSphere(id) ? sphere_occluded : obb_occluded;
+        if (slot >= culled.size())
+            return 0;
+
+        return culled[slot] | (occlusion_valid && slot < hidden.size() ? hidden[slot] : 0);
+    }
+
+    if (isStatic(id)) {
+        auto slot = toHandle(id).index;
+        if (slot >= static_results.size())
+            return 0;
+
+        return static_results[slot] | (occlusion_valid && slot < static_occluded.size() ? static_occluded[slot] : 0);
+    }
+
+    auto i = dense(id);
+    if (i == NO_SLOT)
+        return 0;
+
+    return results[i] | (occlusion_valid && i < occluded.size() ? occluded[i] : 0);
+}
+
+void frst_st::FrustumStorage::clear() {
+    applyPending();
+
+    for (auto stream : {&min_x, &min_y, &min_z, &max_x, &max_y, &max_z})
+        stream->clear();
+    results.clear();
+    alive.clear();
+    visible_count = 0;
+
+    handles.reset();
+    dense_of.clear();
+    slot_of.clear();
+    holes = 0;
+
+    cached_planes.clear();
+    dirty.clear();
+    dirty_ids.clear();
+    has_last_planes = false;
+
+    view_masks.clear();
+    static_view_masks.clear();
+
+    static_handles.reset();
+    static_aabbs.clear();
+    static_alive.clear();
+    static_results.clear();
+    bvh.clear();
+    bvh_dirty            = false;
+    static_results_valid = false;
+
+    sphere_handles.reset();
+    for (auto stream : {&sphere_x, &sphere_y, &sphere_z, &sphere_r})
+        stream->clear();
+    sphere_alive.clear();
+    sphere_results.clear();
+    sphere_view_masks.clear();
+
+    obb_handles.reset();
+    for (auto& stream : obb)
+        stream.clear();
+    obb_alive.clear();
+    obb_results.clear();
+    obb_view_masks.clear();
+
+    occluded.clear();
+    static_occluded.clear();
+    sphere_occluded.clear();
+    obb_occluded.clear();
+    occlusion_valid = false;
+}
+
+void frst_st::FrustumStorage::markDirty(SizeT id) {
+    if (!dirty[id]) {
+        dirty[id] = 1;
+        dirty_ids.push_back(static_cast<U32>(id));
+    }
+}
+
+void frst_st::FrustumStorage::rebuildBvh() {
+    std::vector<BvhPrimitive> primitives;
+    primitives.reserve(static_aabbs.size());
+
+    for (SizeT i = 0; i < static_aabbs.size(); ++i) {
+        if (!static_alive[i])
+            continue;
+
+        auto& aabb = static_aabbs[i];
+        primitives.push_back(BvhPrimitive{
+            { aabb.first.x,  aabb.first.y,  aabb.first.z  },
+            { aabb.second.x, aabb.second.y, aabb.second.z },
+            static_cast<U32>(i)
+        });
+    }
+
+    bvh.build(std::move(primitives));
+    static_visible.resize(bvh.size());
+    bvh_dirty            = false;
+    static_results_valid = false;
+}
+
+
+namespace {
+    void unpack_planes(const frst_st::FrustumStorage::FrustumT& frustum, float (&planes)[6][4]) {
+        for (int i = 0; i < 6; ++i) {
+            planes[i][0] = frustum[i].x;
+            planes[i][1] = frustum[i].y;
+            planes[i][2] = frustum[i].z;
+            planes[i][3] = frustum[i].w;
+        }
+    }
+}
+
+template <typename Function>
+void frst_st::FrustumStorage::dispatchBlocks(SizeT count, Function&& func) {
+    if (count <= ST_THRESHOLD) {
+        func(SizeT(0), count);
+        return;
+    }
+
+    // Chunks are multiple of SIMD width, only the last one has tail
+    auto blocks = (count + simd_width - 1) / simd_width;
+    auto grain  = std::max(ST_THRESHOLD / simd_width, SizeT(1));
+
+    base::job_system().parallel_for(blocks, grain, [&](SizeT start, SizeT end) {
+        func(start * simd_width, std::min(end * simd_width, count));
+    });
+}
+
+void frst_st::FrustumStorage::cullDynamic(const float* planes, U32 changed_planes) {
+    auto aabbs = streams();
+    auto count = results.size();
+
+    if (temporal_coherence && changed_planes == 0) {
+        // Frustum is the same, only dirty AABBs can change result
+        for (auto id : dirty_ids)
+            scalar_soa_frustum_culling_coherent(
+                    results.data(), cached_planes.data(), dirty.data(), aabbs, planes, 0, id, id + 1);
+    }
+    else if (temporal_coherence && coherent_kernel && changed_planes != ALL_PLANES) {
+        // Cached plane is tested per lane, so it pays off only if some planes may be skipped.
+        // Stale cached planes after full pass make it slower, but never wrong
+        dispatchBlocks(count, [&](SizeT start, SizeT end) {
+            coherent_kernel(results.data(), cached_planes.data(), dirty.data(), aabbs, planes, changed_planes, start, end);
+        });
+    }
+    else {
+        dispatchBlocks(count, [&](SizeT start, SizeT end) {
+            kernel(results.data(), aabbs, planes, start, end);
+        });
+    }
+
+    for (auto id : dirty_ids)
+        dirty[id] = 0;
+    dirty_ids.clear();
+}
+
+auto frst_st::FrustumStorage::cullDynamicCompact(const float* planes) -> SizeT {
+    auto aabbs = streams();
+    auto count = results.size();
+
+    // Kernels write positions in streams, they are replaced with slot indices
+    auto to_slots = [this](U32* ids, SizeT ids_count) {
+        for (SizeT i = 0; i < ids_count; ++i)
+            ids[i] = slot_of[ids[i]];
+    };
+
+    if (count <= ST_THRESHOLD) {
+        auto visible = compact_kernel(visible_ids.data(), aabbs, alive.data(), planes, 0, count);
+        to_slots(visible_ids.data(), visible);
+        return visible;
+    }
+
+    // Each chunk packs its IDs at the beginning of own range of visible_ids,
+    // then ranges are moved together in order
+    auto& js     = base::job_system();
+    auto  blocks = (count + simd_width - 1) / simd_width;
+    auto  grain  = std::max(ST_THRESHOLD / simd_width, SizeT(1));
+    auto  chunks = std::min((blocks + grain - 1) / grain, js.concurrency() * 4);
+    auto  chunk  = ((blocks + chunks - 1) / chunks) * simd_width;
+
+    chunks = (count + chunk - 1) / chunk;
+    chunk_counts.resize(chunks);
+
+    js.parallel_for(chunks, 1, [&](SizeT first, SizeT last) {
+        for (SizeT c = first; c < last; ++c) {
+            auto start = c * chunk;
+            auto end   = std::min(start + chunk, count);
+
+            chunk_counts[c] = compact_kernel(visible_ids.data() + start, aabbs, alive.data(), planes, start, end);
+            to_slots(visible_ids.data() + start, chunk_counts[c]);
+        }
+    });
+
+    SizeT visible = chunk_counts[0];
+    for (SizeT c = 1; c < chunks; ++c) {
+        std::memmove(visible_ids.data() + visible, visible_ids.data() + c * chunk, chunk_counts[c] * sizeof(U32));
+        visible += chunk_counts[c];
+    }
+
+    return visible;
+}
+
+void frst_st::FrustumStorage::cullShapes(const float* planes, int32_t* sphere_culled, int32_t* obb_culled) {
+    auto spheres = sphere_streams();
+    auto boxes   = obb_streams();
+
+    dispatchBlocks(sphere_results.size(), [&](SizeT start, SizeT end) {
+        sphere_kernel(sphere_culled, spheres, planes, start, end);
+    });
+
+    dispatchBlocks(obb_results.size(), [&](SizeT start, SizeT end) {
+        obb_kernel(obb_culled, boxes, planes, start, end);
+    });
+}
+
+auto frst_st::FrustumStorage::appendVisibleShapes(SizeT visible) -> SizeT {
+    // Branchless append like in compact kernels
+    for (SizeT i = 0; i < sphere_results.size(); ++i) {
+        visible_ids[visible] = static_cast<U32>(i | SPHERE_ID_BIT);
+        visible += sphere_alive[i] & (sphere_results[i] ^ 1);
+    }
+
+    for (SizeT i = 0; i < obb_results.size(); ++i) {
+        visible_ids[visible] = static_cast<U32>(i | OBB_ID_BIT);
+        visible += obb_alive[i] & (obb_results[i] ^ 1);
+    }
+
+    return visible;
+}
 
 void frst_st::FrustumStorage::calculateCulling(const FrustumT& frustum) {
-    SizeT nprocs = std::thread::hardware_concurrency();
-    SizeT st_threshold = 512;
-
-    // AVX
-    if (base::cpu_extensions_checker().HW_AVX)
-    {
-        float frustum_8x_unpacked[6][4][8] __attribute__((aligned(32)));
-
-        for (auto i = 0; i < 6; ++i)
-            for (int j = 0; j < 8; ++j) {
-                frustum_8x_unpacked[i][0][j] = frustum[i].x;
-                frustum_8x_unpacked[i][1][j] = frustum[i].y;
-                frustum_8x_unpacked[i][2][j] = frustum[i].z;
-                frustum_8x_unpacked[i][3][j] = frustum[i].w;
-            }
-
-        auto count_per_thread = aabbs.size() / nprocs;
-
-        if (aabbs.size() > st_threshold && count_per_thread > 8) {
-            count_per_thread = count_per_thread - (count_per_thread % 8); // must be multiple of 8
-            auto remainder_pos = count_per_thread * nprocs;
-
-            frustum_test_mt(x86_64sv_avx_frustum_culling,
-                            results.data(),
-                            reinterpret_cast<float *>(aabbs.data()),
-                            &frustum_8x_unpacked[0][0][0],
-                            count_per_thread, nprocs);
-
-            frustum_test(remainder_pos, frustum);
-        } else
-            frustum_test(0, frustum);
-
-    }
-    // SSE2
-    else if (base::cpu_extensions_checker().HW_SSE2)
-    {
-        float frustum_4x_unpacked[6][4][4] __attribute__((aligned(32)));
-
-        for (auto i = 0; i < 6; ++i)
-            for (int j = 0; j < 4; ++j) {
-                frustum_4x_unpacked[i][0][j] = frustum[i].x;
-                frustum_4x_unpacked[i][1][j] = frustum[i].y;
-                frustum_4x_unpacked[i][2][j] = frustum[i].z;
-                frustum_4x_unpacked[i][3][j] = frustum[i].w;
-            }
-
-        auto count_per_thread = aabbs.size() / nprocs;
-
-        if (aabbs.size() > st_threshold && count_per_thread > 4) {
-            count_per_thread = count_per_thread - (count_per_thread % 4); // must be multiple of 4
-            auto remainder_pos = count_per_thread * nprocs;
-
-            frustum_test_mt(x86_64sv_sse_frustum_culling,
-                            results.data(),
-                            reinterpret_cast<float *>(aabbs.data()),
-                            &frustum_4x_unpacked[0][0][0],
-                            count_per_thread, nprocs);
-
-            frustum_test(remainder_pos, frustum);
-        } else
-            frustum_test(0, frustum);
-    }
-    else frustum_test(0, frustum);
-}
\ No newline at end of file
+    applyPending();
+    compact();
+
+    float planes[6][4];
+    unpack_planes(frustum, planes);
+
+    U32 changed_planes = 0;
+    for (int i = 0; i < 6; ++i)
+        if (!has_last_planes || std::memcmp(planes[i], last_planes[i], sizeof(planes[i])) != 0)
+            changed_planes |= 1U << i;
+
+    std::memcpy(last_planes, planes, sizeof(planes));
+    has_last_planes = true;
+    occlusion_valid = false;
+
+    if (bvh_dirty)
+        rebuildBvh();
+
+    cullShapes(&planes[0][0], sphere_results.data(), obb_results.data());
+
+    // Static results are still valid if neither frustum nor BVH is changed
+    if (bvh.empty() || (temporal_coherence && changed_planes == 0 && static_results_valid)) {
+        cullDynamic(&planes[0][0], changed_planes);
+        return;
+    }
+
+    // BVH is traversed in parallel with large linear pass
+    SizeT static_count = 0;
+
+    if (results.size() <= ST_THRESHOLD) {
+        static_count = bvh.cull(&planes[0][0], static_visible.data());
+        cullDynamic(&planes[0][0], changed_planes);
+    } else {
+        auto& js      = base::job_system();
+        auto  counter = base::JobCounter();
+
+        js.submit([&] { static_count = bvh.cull(&planes[0][0], static_visible.data()); }, &counter);
+        cullDynamic(&planes[0][0], changed_planes);
+        js.wait(counter);
+    }
+
+    std::fill(static_results.begin(), static_results.end(), 1);
+    for (SizeT i = 0; i < static_count; ++i)
+        static_results[static_visible[i]] = 0;
+
+    static_results_valid = true;
+}
+
+void frst_st::FrustumStorage::calculateCulling(const FrustumT* frustums, SizeT views_count) {
+    RASSERTF(views_count <= MAX_VIEWS, "Too many views ({} > {})", views_count, MAX_VIEWS);
+
+    applyPending();
+    compact();
+
+    float planes[MAX_VIEWS][6][4];
+    for (SizeT v = 0; v < views_count; ++v)
+        unpack_planes(frustums[v], planes[v]);
+
+    if (bvh_dirty)
+        rebuildBvh();
+
+    view_masks.resize(results.size());
+    static_view_masks.assign(static_aabbs.size(), 0);
+
+    // Spheres and OBBs are culled view by view
+    sphere_view_masks.assign(sphere_results.size(), 0);
+    obb_view_masks   .assign(obb_results.size(), 0);
+    sphere_scratch   .resize(sphere_results.size());
+    obb_scratch      .resize(obb_results.size());
+
+    for (SizeT v = 0; v < views_count; ++v) {
+        cullShapes(&planes[v][0][0], sphere_scratch.data(), obb_scratch.data());
+
+        for (SizeT i = 0; i < sphere_scratch.size(); ++i)
+            sphere_view_masks[i] |= static_cast<U32>(sphere_scratch[i] ^ 1) << v;
+        for (SizeT i = 0; i < obb_scratch.size(); ++i)
+            obb_view_masks[i] |= static_cast<U32>(obb_scratch[i] ^ 1) << v;
+    }
+
+    // BVH is small and hierarchical, it is traversed once per view
+    auto cull_static = [&] {
+        for (SizeT v = 0; v < views_count; ++v) {
+            auto count = bvh.cull(&planes[v][0][0], static_visible.data());
+            for (SizeT i = 0; i < count; ++i)
+                static_view_masks[static_visible[i]] |= 1U << v;
+        }
+    };
+
+    auto cull_dynamic = [&] {
+        auto aabbs = streams();
+        dispatchBlocks(results.size(), [&](SizeT start, SizeT end) {
+            multi_kernel(view_masks.data(), aabbs, &planes[0][0][0], views_count, start, end);
+        });
+    };
+
+    if (bvh.empty()) {
+        cull_dynamic();
+    }
+    else if (results.size() <= ST_THRESHOLD) {
+        cull_static();
+        cull_dynamic();
+    }
+    else {
+        auto& js      = base::job_system();
+        auto  counter = base::JobCounter();
+
+        js.submit(cull_static, &counter);
+        cull_dynamic();
+        js.wait(counter);
+    }
+}
+
+void frst_st::FrustumStorage::calculateOcclusion(const OcclusionBuffer& buffer) {
+    auto aabbs = streams();
+
+    occluded.resize(results.size());
+    dispatchBlocks(results.size(), [&](SizeT start, SizeT end) {
+        buffer.cull(occluded.data(), results.data(), aabbs, start, end);
+    });
+
+    static_occluded.resize(static_results.size());
+    base::job_system().parallel_for(static_results.size(), ST_THRESHOLD, [&](SizeT start, SizeT end) {
+        for (SizeT i = start; i < end; ++i) {
+            auto& aabb   = static_aabbs[i];
+            float min[3] = { aabb.first.x,  aabb.first.y,  aabb.first.z };
+            float max[3] = { aabb.second.x, aabb.second.y, aabb.second.z };
+
+            static_occluded[i] = !static_results[i] && static_alive[i] && buffer.isOccluded(min, max);
+        }
+    });
+
+    // Spheres and OBBs are tested by their bounding boxes
+    sphere_occluded.resize(sphere_results.size());
+    for (SizeT i = 0; i < sphere_results.size(); ++i) {
+        auto  r      = sphere_r[i];
+        float min[3] = { sphere_x[i] - r, sphere_y[i] - r, sphere_z[i] - r };
+        float max[3] = { sphere_x[i] + r, sphere_y[i] + r, sphere_z[i] + r };
+
+        sphere_occluded[i] = !sphere_results[i] && sphere_alive[i] && buffer.isOccluded(min, max);
+    }
+
+    obb_occluded.resize(obb_results.size());
+    for (SizeT i = 0; i < obb_results.size(); ++i) {
+        float min[3], max[3];
+        for (int k = 0; k < 3; ++k) {
+            auto extent = std::fabs(obb[3 + k][i]) + std::fabs(obb[6 + k][i]) + std::fabs(obb[9 + k][i]);
+            min[k] = obb[k][i] - extent;
+            max[k] = obb[k][i] + extent;
+        }
+
+        obb_occluded[i] = !obb_results[i] && obb_alive[i] && buffer.isOccluded(min, max);
+    }
+
+    occlusion_valid = true;
+}
+
+auto frst_st::FrustumStorage::calculateVisible(const FrustumT& frustum) -> VisibleSet {
+    applyPending();
+    compact();
+
+    float planes[6][4];
+    unpack_planes(frustum, planes);
+
+    if (bvh_dirty)
+        rebuildBvh();
+
+    auto capacity = results.size() + bvh.size() + sphere_results.size() + obb_results.size();
+    if (visible_ids.size() < capacity)
+        visible_ids.resize(capacity);
+
+    cullShapes(&planes[0][0], sphere_results.data(), obb_results.data());
+
+    if (bvh.empty()) {
+        visible_count = cullDynamicCompact(&planes[0][0]);
+        visible_count = appendVisibleShapes(visible_count);
+        return visible();
+    }
+
+    SizeT static_count = 0;
+
+    if (results.size() <= ST_THRESHOLD) {
+        static_count  = bvh.cull(&planes[0][0], static_visible.data());
+        visible_count = cullDynamicCompact(&planes[0][0]);
+    } else {
+        auto& js      = base::job_system();
+        auto  counter = base::JobCounter();
+
+        js.submit([&] { static_count = bvh.cull(&planes[0][0], static_visible.data()); }, &counter);
+        visible_count = cullDynamicCompact(&planes[0][0]);
+        js.wait(counter);
+    }
+
+    for (SizeT i = 0; i < static_count; ++i)
+        visible_ids[visible_count + i] = static_visible[i] | static_cast<U32>(STATIC_ID_BIT);
+    visible_count += static_count;
+    visible_count  = appendVisibleShapes(visible_count);
+
+    return visible();
+}
@@ -2,56 +2,281 @@
 
 #include <vector>
 #include <queue>
+#include <atomic>
+#include <thread>
 
 #include <glm/vec4.hpp>
 
 #include "baseTypes.hpp"
 #include "allocators/AlignedAllocator.hpp"
-#include "ftl/ring.hpp"
+#include "handles.hpp"
 #include "defines.hpp"
+#include "frustum_culling_simd.hpp"
+#include "Bvh.hpp"
+#include "OcclusionCulling.hpp"
 #include "../Camera.hpp"
 
 namespace frst_st {
+    /**
+     * Dense list of visible IDs, valid until the next calculateVisible() call
+     * IDs are slot indices (low half of ID without generation) with type bits:
+     * STATIC_ID_BIT for static AABBs, SPHERE_ID_BIT for spheres and OBB_ID_BIT for OBBs
+     */
+    struct VisibleSet {
+        const U32* ids;
+        SizeT      count;
+
+        const U32* begin() const { return ids; }
+        const U32* end  () const { return ids + count; }
+        SizeT      size () const { return count; }
+        bool       empty() const { return count == 0; }
+    };
+
+    /**
+     * AABB storage for frustum culling
+     *
+     * AABBs are stored as structure of arrays: six streams (minX..maxZ) aligned to 64 bytes,
+     * so kernels load 4/8/16 boxes with one instruction and no shuffles.
+     * Kernel (AVX-512, AVX2 + FMA, SSE2 or scalar) is selected at runtime
+     *
+     * Static AABBs live in separate BVH which is rebuilt on the next culling after any change.
+     * Their IDs are marked with STATIC_ID_BIT
+     *
+     * Bounding spheres and OBBs live in own typed pools (SoA too) and are culled by the same calculate* calls,
+     * their IDs are marked with SPHERE_ID_BIT and OBB_ID_BIT. Pools are indexed by slot, removed slots are
+     * skipped until reused. Multi-view culling tests them view by view
+     *
+     * ID is generational handle (see base::Handle), stale ID is detected. Dynamic AABBs are kept dense:
+     * removed ones leave holes which are compacted on culling when there are enough of them,
+     * so kernels do not scan dead slots. Handle refers to slot, slot refers to position in streams
+     *
+     * getID() and removeID() may be called from any thread, even while culling runs. Handles are allocated
+     * with lock-free free list, changes from threads other than owner (which created storage) are queued
+     * and applied on the next culling or setAabb(). Other methods must be called from owner thread
+     *
+     * calculateCulling() uses temporal coherence: plane which rejected AABB last frame is tested first,
+     * unchanged AABBs are tested only against planes which were changed since the last call,
+     * and if frustum is not changed only dirty AABBs are tested
+     *
+     * calculateOcclusion() additionally culls visible AABBs hidden by occluders in software depth buffer
+     */
     class FrustumStorage {
     public:
         using AabbT     = std::pair<glm::vec4, glm::vec4>;
-        using AabbVecT  = std::vector<AabbT, AlignedAllocator<float, 32>>;
-        using AabbRingT = ftl::Ring<SizeT>;
-        using ResultsT  = std::vector<int32_t, AlignedAllocator<float, 32>>;
+        using StreamT   = std::vector<float, AlignedAllocator<float, 64>>;
+        using ResultsT  = std::vector<int32_t, AlignedAllocator<int32_t, 64>>;
+        using IdsT      = std::vector<U32,     AlignedAllocator<U32,     64>>;
         using FrustumT  = grx::Camera::FrustumT;
 
+        // xyz - center, w - radius
+        using SphereT   = glm::vec4;
+
+        // Center and axes in world space scaled by half size of box along them
+        struct ObbT {
+            glm::vec4 center;
+            glm::vec4 axes[3];
+        };
+
+        static constexpr SizeT STATIC_ID_BIT = SizeT(1) << 31;
+        static constexpr SizeT SPHERE_ID_BIT = SizeT(1) << 30;
+        static constexpr SizeT OBB_ID_BIT    = SizeT(1) << 29;
+        static constexpr SizeT INDEX_MASK    = OBB_ID_BIT - 1;
+        static constexpr SizeT MAX_VIEWS     = 32;
+
+        static bool isStatic(SizeT id) { return (id & STATIC_ID_BIT) != 0; }
+        static bool isSphere(SizeT id) { return (id & SPHERE_ID_BIT) != 0; }
+        static bool isObb   (SizeT id) { return (id & OBB_ID_BIT) != 0; }
+        static bool isAabb  (SizeT id) { return (id & (SPHERE_ID_BIT | OBB_ID_BIT)) == 0; }
+
     public:
-        SizeT getID    (const AabbT& aabb);
+        SizeT getID    (const AabbT& aabb, bool is_static = false);
         SizeT getID    ();
+        SizeT getSphereID(const SphereT& sphere);
+        SizeT getObbID   (const ObbT& obb);
         void  removeID (SizeT id);
+        bool  isValid  (SizeT id) const;
 
-        AabbT&  getAabb  (SizeT id) { ASSERT(id < aabbs  .size()); return aabbs  [id]; }
-        int32_t getResult(SizeT id) { ASSERT(id < results.size()); return results[id]; }
+        AabbT   getAabb  (SizeT id) const;
+        void    setAabb  (SizeT id, const AabbT& aabb);
+        SphereT getSphere(SizeT id) const;
+        void    setSphere(SizeT id, const SphereT& sphere);
+        ObbT    getObb   (SizeT id) const;
+        void    setObb   (SizeT id, const ObbT& obb);
+        int32_t getResult(SizeT id) const;
 
-        void clear() { results.clear(); aabbs.clear(); free_aabbs.clear(); }
+        // Count of dynamic slots in streams including holes, and count of static slots
+        SizeT size       () const { return results.size(); }
+        SizeT static_size() const { return static_results.size(); }
+        SizeT sphere_size() const { return sphere_results.size(); }
+        SizeT obb_size   () const { return obb_results.size(); }
 
+        void clear();
+
+        // Apply getID() / removeID() calls made from other threads
+        void applyPending();
+
+        // Writes culling result for each AABB, see getResult()
         void calculateCulling(const FrustumT& frustum);
 
+        void setTemporalCoherence(bool value) { temporal_coherence = value; }
+
+        /**
+         * Culls AABBs against several views (main camera, shadow cascades, reflections) in one pass,
+         * each block of AABBs is loaded once for all views. Writes mask per AABB, see getViewMask().
+         * Does not change results of single view calculateCulling()
+         */
+        void calculateCulling(const FrustumT* frustums, SizeT views_count);
+
+        // Bit v is set if AABB is visible in view v of the last multi-view culling. Not culled yet AABBs are visible
+        U32 getViewMask(SizeT id) const;
+
+        /**
+         * Marks AABBs which are hidden by occluders as culled in getResult() until the next calculateCulling()
+         * Must be called after calculateCulling(), buffer must be rendered with the same camera
+         */
+        void calculateOcclusion(const OcclusionBuffer& buffer);
+
+        // Writes dense list of visible IDs (dynamic AABBs, static AABBs, spheres, OBBs), removed IDs are skipped
+        auto calculateVisible(const FrustumT& frustum) -> VisibleSet;
+
+        auto visible() const -> VisibleSet { return VisibleSet{visible_ids.data(), visible_count}; }
+
+        auto streams() const -> AabbStreams {
+            return AabbStreams{min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data()};
+        }
+
+        auto sphere_streams() const -> SphereStreams {
+            return SphereStreams{sphere_x.data(), sphere_y.data(), sphere_z.data(), sphere_r.data()};
+        }
+
+        auto obb_streams() const -> ObbStreams {
+            return ObbStreams{obb[0].data(), obb[1].data(), obb[2].data(),
+                              obb[3].data(), obb[4].data(),  obb[5].data(),
+                              obb[6].data(), obb[7].data(),  obb[8].data(),
+                              obb[9].data(), obb[10].data(), obb[11].data()};
+        }
+
     private:
-        static void frustum_test_mt(void(*func)(int32_t*, float*, float*, std::size_t),
-                int32_t *results, float *aabbs, float *frustum, std::size_t count, std::size_t nprocs);
-
-        void frustum_test(SizeT start, const FrustumT& planes) {
-            for (SizeT i = start; i < aabbs.size(); ++i) {
-                int32_t pass = 0;
-                for (auto &plane : planes)
-                    pass |= (std::max(aabbs[i].first.x * plane.x, aabbs[i].second.x * plane.x) +
-                             std::max(aabbs[i].first.y * plane.y, aabbs[i].second.y * plane.y) +
-                             std::max(aabbs[i].first.z * plane.z, aabbs[i].second.z * plane.z) + plane.w) <= 0;
-                results[i] = pass;
-            }
+        // Below this count culling is done on caller thread
+        static constexpr SizeT ST_THRESHOLD = 512;
+        static constexpr U32   ALL_PLANES   = 0x3F;
+        static constexpr U32   NO_SLOT      = 0xFFFFFFFF;
+
+        // Dynamic AABBs are compacted when count of holes is more than size / COMPACT_RATIO
+        static constexpr SizeT COMPACT_RATIO = 8;
+
+        // Shape is taken from field which matches type of ID
+        struct PendingOp {
+            SizeT      id     = 0;
+            AabbT      aabb   = {};
+            SphereT    sphere = {};
+            ObbT       obb    = {};
+            bool       remove = false;
+            PendingOp* next   = nullptr;
+        };
+
+        template <typename ShapeT>
+        SizeT registerID(SizeT type_bits, const ShapeT& shape, ShapeT PendingOp::* field);
+
+        void  add    (SizeT id, const AabbT& aabb);
+        void  add    (SizeT id, const SphereT& sphere);
+        void  add    (SizeT id, const ObbT& obb);
+        void  remove (SizeT id);
+        void  push   (PendingOp* op);
+        void  writeAabb  (SizeT id, const AabbT& aabb);
+        void  writeSphere(SizeT id, const SphereT& sphere);
+        void  writeObb   (SizeT id, const ObbT& obb);
+        void  compact();
+        SizeT dense  (SizeT id) const; // Position in streams or NO_SLOT if not added yet
+
+        auto pool(SizeT id)       -> base::HandlePool&;
+        auto pool(SizeT id) const -> const base::HandlePool&;
+
+        static auto toHandle(SizeT id) -> base::Handle {
+            return base::Handle{static_cast<U32>(id & INDEX_MASK), static_cast<U32>(id >> 32)};
         }
 
+        void cullDynamic       (const float* planes, U32 changed_planes);
+        auto cullDynamicCompact(const float* planes) -> SizeT;
+        void cullShapes        (const float* planes, int32_t* sphere_culled, int32_t* obb_culled);
+        auto appendVisibleShapes(SizeT visible) -> SizeT;
+        void rebuildBvh        ();
+        void markDirty         (SizeT id);
+
+        template <typename Function>
+        void dispatchBlocks(SizeT count, Function&& func);
+
     private:
-        AabbVecT  aabbs;
-        AabbRingT free_aabbs;
+        StreamT min_x, min_y, min_z;
+        StreamT max_x, max_y, max_z;
+
+        ResultsT  alive;
         ResultsT  results;
 
+        // Slot index -> position in streams and back
+        base::HandlePool handles;
+        std::vector<U32> dense_of;
+        std::vector<U32> slot_of;
+        SizeT            holes = 0;
+
+        std::atomic<PendingOp*> pending = nullptr;
+        std::thread::id         owner;
+
+        // Multi-view culling
+        IdsT             view_masks;
+        std::vector<U32> static_view_masks;
+        std::vector<U32> sphere_view_masks;
+        std::vector<U32> obb_view_masks;
+        ResultsT         sphere_scratch;
+        ResultsT         obb_scratch;
+
+        // Temporal coherence
+        ResultsT         cached_planes;
+        ResultsT         dirty;
+        std::vector<U32> dirty_ids;
+        float            last_planes[6][4]  = {};
+        bool             has_last_planes    = false;
+        bool             temporal_coherence = true;
+
+        IdsT               visible_ids;
+        SizeT              visible_count = 0;
+        std::vector<SizeT> chunk_counts;
+
+        std::vector<AabbT> static_aabbs;
+        base::HandlePool   static_handles;
+        ResultsT           static_alive;
+        ResultsT           static_results;
+        IdsT               static_visible;
+        Bvh4               bvh;
+        bool               bvh_dirty            = false;
+        bool               static_results_valid = false;
+
+        // Spheres and OBBs, indexed by slot
+        StreamT          sphere_x, sphere_y, sphere_z, sphere_r;
+        base::HandlePool sphere_handles;
+        ResultsT         sphere_alive;
+        ResultsT         sphere_results;
+
+        StreamT          obb[12]; // Center xyz, then axes u, v, w
+        base::HandlePool obb_handles;
+        ResultsT         obb_alive;
+        ResultsT         obb_results;
+
+        // Occlusion culling, separate from results to not break temporal coherence
+        ResultsT occluded;
+        ResultsT static_occluded;
+        ResultsT sphere_occluded;
+        ResultsT obb_occluded;
+        bool     occlusion_valid = false;
+
+        SoaKernelT         kernel;
+        SoaCompactKernelT  compact_kernel;
+        SoaCoherentKernelT coherent_kernel;
+        SoaMultiKernelT    multi_kernel;
+        SoaSphereKernelT   sphere_kernel;
+        SoaObbKernelT      obb_kernel;
+        SizeT              simd_width;
+
     DE_MARK_AS_SINGLETON(FrustumStorage);
     };
 
@@ -59,7 +284,7 @@ namespace frst_st {
 
 
 namespace grx {
-    auto& frustum_storage() {
+    inline auto& frustum_storage() {
         return frst_st::FrustumStorage::instance();
     }
 
@@ -69,17 +294,38 @@ namespace grx {
             id = frustum_storage().getID();
         }
 
-        CullingDataProvider(const glm::vec4& min, const glm::vec4& max) {
-            id = frustum_storage().getID(std::pair(min, max));
+        // Static AABBs are culled with BVH, they should be changed rarely
+        CullingDataProvider(const glm::vec4& min, const glm::vec4& max, bool is_static = false) {
+            id = frustum_storage().getID(std::pair(min, max), is_static);
+        }
+
+        explicit CullingDataProvider(const frst_st::FrustumStorage::SphereT& sphere) {
+            id = frustum_storage().getSphereID(sphere);
+        }
+
+        explicit CullingDataProvider(const frst_st::FrustumStorage::ObbT& obb) {
+            id = frustum_storage().getObbID(obb);
         }
 
         ~CullingDataProvider() {
             frustum_storage().removeID(id);
         }
 
-        auto& aabb  ()       { return frustum_storage().getAabb(id); }
-        auto& aabb  () const { return frustum_storage().getAabb(id); }
-        auto  result()       { return frustum_storage().getResult(id); }
+        auto aabb  () const { return frustum_storage().getAabb(id); }
+        auto result() const { return frustum_storage().getResult(id); }
+        auto viewMask() const { return frustum_storage().getViewMask(id); }
+
+        void setAabb(const glm::vec4& min, const glm::vec4& max) {
+            frustum_storage().setAabb(id, std::pair(min, max));
+        }
+
+        void setSphere(const frst_st::FrustumStorage::SphereT& sphere) {
+            frustum_storage().setSphere(id, sphere);
+        }
+
+        void setObb(const frst_st::FrustumStorage::ObbT& obb) {
+            frustum_storage().setObb(id, obb);
+        }
 
     private:
         SizeT id;
@@ -0,0 +1,434 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <emmintrin.h>
+
+#include "OcclusionCulling.hpp"
+
+#include "assert.hpp"
+#include "jobs.hpp"
+
+namespace {
+    constexpr float FAR_DEPTH = 1.f;
+
+    // Triangles with smaller area in pixels cover no pixel centers
+    constexpr float MIN_AREA = 1e-6f;
+
+    inline float near_distance(float z, float w) {
+        return z + w; // OpenGL near plane: z >= -w
+    }
+}
+
+
+frst_st::OcclusionBuffer::OcclusionBuffer(U32 width, U32 height) {
+    resize(width, height);
+}
+
+void frst_st::OcclusionBuffer::resize(U32 width, U32 height) {
+    ASSERTF(width > 0 && height > 0, "Invalid occlusion buffer size ({}, {})", width, height);
+
+    _tiles_width  = (width  + TILE_WIDTH  - 1) / TILE_WIDTH;
+    _tiles_height = (height + TILE_HEIGHT - 1) / TILE_HEIGHT;
+    _width        = _tiles_width  * TILE_WIDTH;
+    _height       = _tiles_height * TILE_HEIGHT;
+
+    _depth.assign(static_cast<SizeT>(_width) * _height, FAR_DEPTH);
+    _hiz  .assign(static_cast<SizeT>(_tiles_width) * _tiles_height, FAR_DEPTH);
+}
+
+void frst_st::OcclusionBuffer::begin(const glm::mat4& view_projection) {
+    _view_projection = view_projection;
+    _triangles.clear();
+
+    std::fill(_depth.begin(), _depth.end(), FAR_DEPTH);
+    std::fill(_hiz.begin(),   _hiz.end(),   FAR_DEPTH);
+}
+
+void frst_st::OcclusionBuffer::addOccluder(const float* positions, SizeT vertices_count,
+                                           const U32*   indices,   SizeT indices_count, const glm::mat4& model)
+{
+    ASSERTF(indices_count % 3 == 0, "Occluder indices count is not a multiple of 3 ({})", indices_count);
+
+    auto m = _view_projection * model;
+
+    _clip_vertices.resize(vertices_count);
+    for (SizeT i = 0; i < vertices_count; ++i) {
+        auto x = positions[i * 3 + 0];
+        auto y = positions[i * 3 + 1];
+        auto z = positions[i * 3 + 2];
+
+        _clip_vertices[i] = ClipVertex{
+            m[0][0] * x + m[1][0] * y + m[2][0] * z + m[3][0],
+            m[0][1] * x + m[1][1] * y + m[2][1] * z + m[3][1],
+            m[0][2] * x + m[1][2] * y + m[2][2] * z + m[3][2],
+            m[0][3] * x + m[1][3] * y + m[2][3] * z + m[3][3]
+        };
+    }
+
+    for (SizeT i = 0; i < indices_count; i += 3) {
+        ASSERT(indices[i] < vertices_count && indices[i + 1] < vertices_count && indices[i + 2] < vertices_count);
+        addTriangle(_clip_vertices[indices[i]], _clip_vertices[indices[i + 1]], _clip_vertices[indices[i + 2]]);
+    }
+}
+
+void frst_st::OcclusionBuffer::addTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2) {
+    const ClipVertex* in[3] = { &v0, &v1, &v2 };
+    float             dist[3];
+    int               inside = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        dist[i] = near_distance(in[i]->z, in[i]->w);
+        inside += dist[i] >= 0.f;
+    }
+
+    if (inside == 3) {
+        setup(v0, v1, v2);
+        return;
+    }
+
+    if (inside == 0)
+        return;
+
+    // Clip by near plane, result has 3 or 4 vertices
+    ClipVertex out[4];
+    int        count = 0;
+
+    for (int i = 0; i < 3; ++i) {
+        auto  j = (i + 1) % 3;
+        auto& a = *in[i];
+        auto& b = *in[j];
+
+        if (dist[i] >= 0.f)
+            out[count++] = a;
+
+        if ((dist[i] >= 0.f) != (dist[j] >= 0.f)) {
+            auto t = dist[i] / (dist[i] - dist[j]);
+            out[count++] = ClipVertex{
+                a.x + (b.x - a.x) * t,
+                a.y + (b.y - a.y) * t,
+                a.z + (b.z - a.z) * t,
+                a.w + (b.w - a.w) * t
+            };
+        }
+    }
+
+    setup(out[0], out[1], out[2]);
+    if (count == 4)
+        setup(out[0], out[2], out[3]);
+}
+
+void frst_st::OcclusionBuffer::setup(const ClipVertex& c0, const ClipVertex& c1, const ClipVertex& c2) {
+    struct ScreenVertex { float x, y, z; };
+
+    auto to_screen = [this](const ClipVertex& c) {
+        auto inv_w = 1.f / c.w;
+        return ScreenVertex{
+            (c.x * inv_w * 0.5f + 0.5f) * static_cast<float>(_width),
+            (c.y * inv_w * 0.5f + 0.5f) * static_cast<float>(_height),
+            c.z * inv_w
+        };
+    };
+
+    auto v0 = to_screen(c0);
+    auto v1 = to_screen(c1);
+    auto v2 = to_screen(c2);
+
+    // Occluder behind far plane hides nothing
+    if (v0.z > FAR_DEPTH && v1.z > FAR_DEPTH && v2.z > FAR_DEPTH)
+        return;
+
+    auto area = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+    if (std::fabs(area) < MIN_AREA)
+        return;
+
+    // Make winding counter-clockwise
+    if (area < 0.f) {
+        std::swap(v1, v2);
+        area = -area;
+    }
+
+    auto width  = static_cast<float>(_width);
+    auto height = static_cast<float>(_height);
+    auto min_x  = std::min({v0.x, v1.x, v2.x});
+    auto min_y  = std::min({v0.y, v1.y, v2.y});
+    auto max_x  = std::max({v0.x, v1.x, v2.x});
+    auto max_y  = std::max({v0.y, v1.y, v2.y});
+
+    if (max_x < 0.f || max_y < 0.f || min_x >= width || min_y >= height)
+        return;
+
+    Triangle tri;
+    tri.min_x = static_cast<S32>(std::max(min_x, 0.f));
+    tri.min_y = static_cast<S32>(std::max(min_y, 0.f));
+    tri.max_x = static_cast<S32>(std::min(max_x, width  - 1.f));
+    tri.max_y = static_cast<S32>(std::min(max_y, height - 1.f));
+
+    /*
+     * Pixel is written if its center is inside or on the edge. Triangles sharing an edge get exactly
+     * negated edge functions (constant is computed from the same vertex), so no pixel between them is lost
+     */
+    const ScreenVertex* v[3] = { &v0, &v1, &v2 };
+    for (int i = 0; i < 3; ++i) {
+        auto& a = *v[i];
+        auto& b = *v[(i + 1) % 3];
+        auto& o = (a.x < b.x || (a.x == b.x && a.y < b.y)) ? a : b;
+
+        tri.edge_a[i] = a.y - b.y;
+        tri.edge_b[i] = b.x - a.x;
+        tri.edge_c[i] = -(tri.edge_a[i] * o.x + tri.edge_b[i] * o.y);
+    }
+
+    // Depth is linear in screen space, take the farthest value inside of pixel
+    tri.dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+    tri.dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+    tri.z0   = v0.z - tri.dzdx * v0.x - tri.dzdy * v0.y + 0.5f * (std::fabs(tri.dzdx) + std::fabs(tri.dzdy));
+
+    _triangles.push_back(tri);
+}
+
+void frst_st::OcclusionBuffer::rasterize(const Triangle& tri, S32 min_y, S32 max_y) {
+    auto a0 = _mm_set1_ps(tri.edge_a[0]);
+    auto a1 = _mm_set1_ps(tri.edge_a[1]);
+    auto a2 = _mm_set1_ps(tri.edge_a[2]);
+    auto dz = _mm_set1_ps(tri.dzdx);
+
+    auto zero   = _mm_setzero_ps();
+    auto lanes  = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+    auto step   = _mm_set1_ps(4.f);
+    auto start  = tri.min_x & ~3; // Rows are 16-byte aligned, width is multiple of TILE_WIDTH
+
+    for (auto y = std::max(min_y, tri.min_y); y <= std::min(max_y, tri.max_y); ++y) {
+        auto py  = static_cast<float>(y) + 0.5f;
+        auto e0  = _mm_set1_ps(tri.edge_b[0] * py + tri.edge_c[0]);
+        auto e1  = _mm_set1_ps(tri.edge_b[1] * py + tri.edge_c[1]);
+        auto e2  = _mm_set1_ps(tri.edge_b[2] * py + tri.edge_c[2]);
+        auto zr  = _mm_set1_ps(tri.dzdy * py + tri.z0);
+        auto row = _depth.data() + static_cast<SizeT>(y) * _width;
+        auto px  = _mm_add_ps(_mm_set1_ps(static_cast<float>(start)), lanes);
+
+        for (auto x = start; x <= tri.max_x; x += 4, px = _mm_add_ps(px, step)) {
+            auto inside = _mm_and_ps(_mm_and_ps(
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a0, px), e0), zero),
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a1, px), e1), zero)),
+                    _mm_cmpge_ps(_mm_add_ps(_mm_mul_ps(a2, px), e2), zero));
+
+            if (_mm_movemask_ps(inside) == 0)
+                continue;
+
+            auto z     = _mm_add_ps(_mm_mul_ps(dz, px), zr);
+            auto depth = _mm_load_ps(row + x);
+            auto mixed = _mm_or_ps(_mm_and_ps(inside, _mm_min_ps(depth, z)), _mm_andnot_ps(inside, depth));
+
+            _mm_store_ps(row + x, mixed);
+        }
+    }
+}
+
+void frst_st::OcclusionBuffer::renderBand(U32 tile_row_start, U32 tile_row_end) {
+    auto min_y = static_cast<S32>(tile_row_start * TILE_HEIGHT);
+    auto max_y = static_cast<S32>(tile_row_end   * TILE_HEIGHT) - 1;
+
+    for (auto& tri : _triangles)
+        if (tri.max_y >= min_y && tri.min_y <= max_y)
+            rasterize(tri, min_y, max_y);
+
+    // Hierarchical buffer holds the farthest depth of tile
+    for (auto ty = tile_row_start; ty < tile_row_end; ++ty) {
+        for (U32 tx = 0; tx < _tiles_width; ++tx) {
+            auto row   = _depth.data() + static_cast<SizeT>(ty * TILE_HEIGHT) * _width + tx * TILE_WIDTH;
+            auto depth = _mm_max_ps(_mm_load_ps(row), _mm_load_ps(row + 4));
+
+            for (U32 y = 1; y < TILE_HEIGHT; ++y) {
+                row  += _width;
+                depth = _mm_max_ps(depth, _mm_max_ps(_mm_load_ps(row), _mm_load_ps(row + 4)));
+            }
+
+            depth = _mm_max_ps(depth, _mm_shuffle_ps(depth, depth, _MM_SHUFFLE(1, 0, 3, 2)));
+            depth = _mm_max_ps(depth, _mm_shuffle_ps(depth, depth, _MM_SHUFFLE(2, 3, 0, 1)));
+
+            _hiz[ty * _tiles_width + tx] = _mm_cvtss_f32(depth);
+        }
+    }
+}
+
+void frst_st::OcclusionBuffer::render() {
+    base::job_system().parallel_for(_tiles_height, 1, [this](SizeT start, SizeT end) {
+        renderBand(static_cast<U32>(start), static_cast<U32>(end));
+    });
+}
+
+
+namespace {
+    // View-projection matrix as broadcasted elements: m[column][row]
+    struct MatrixSse {
+        __m128 m[4][4];
+
+        explicit MatrixSse(const glm::mat4& matrix) {
+            for (int c = 0; c < 4; ++c)
+                for (int r = 0; r < 4; ++r)
+                    m[c][r] = _mm_set1_ps(matrix[c][r]);
+        }
+    };
+
+    // Screen rectangles and nearest depths of 4 AABBs
+    struct ScreenBounds {
+        alignas(16) float min_x[4];
+        alignas(16) float min_y[4];
+        alignas(16) float max_x[4];
+        alignas(16) float max_y[4];
+        alignas(16) float min_z[4];
+    };
+
+    /**
+     * Project 4 AABBs to screen
+     * Corners are min + any of extents along axes, so clip coordinates are built from 4 products per row
+     * @return mask of lanes where AABB crosses near plane
+     */
+    inline int project_aabbs(const MatrixSse& mat, __m128 min_x, __m128 min_y, __m128 min_z,
+                             __m128 max_x, __m128 max_y, __m128 max_z, float width, float height,
+                             ScreenBounds& out)
+    {
+        auto ex = _mm_sub_ps(max_x, min_x);
+        auto ey = _mm_sub_ps(max_y, min_y);
+        auto ez = _mm_sub_ps(max_z, min_z);
+
+        __m128 corners[4][8];
+
+        for (int r = 0; r < 4; ++r) {
+            auto& m    = mat.m;
+            auto  base = _mm_add_ps(_mm_add_ps(_mm_mul_ps(m[0][r], min_x), _mm_mul_ps(m[1][r], min_y)),
+                                    _mm_add_ps(_mm_mul_ps(m[2][r], min_z), m[3][r]));
+            auto dx = _mm_mul_ps(m[0][r], ex);
+            auto dy = _mm_mul_ps(m[1][r], ey);
+            auto dz = _mm_mul_ps(m[2][r], ez);
+
+            auto c = corners[r];
+            c[0] = base;
+            c[1] = _mm_add_ps(base, dx);
+            c[2] = _mm_add_ps(base, dy);
+            c[3] = _mm_add_ps(c[1],  dy);
+            for (int i = 0; i < 4; ++i)
+                c[i + 4] = _mm_add_ps(c[i], dz);
+        }
+
+        auto zero         = _mm_setzero_ps();
+        auto one          = _mm_set1_ps(1.f);
+        auto crosses_near = _mm_setzero_ps();
+        auto big          = _mm_set1_ps(std::numeric_limits<float>::max());
+        auto nx_min = big, ny_min = big, nz_min = big;
+        auto nx_max = _mm_sub_ps(zero, big), ny_max = nx_max;
+
+        for (int i = 0; i < 8; ++i) {
+            crosses_near = _mm_or_ps(crosses_near, _mm_cmple_ps(_mm_add_ps(corners[2][i], corners[3][i]), zero));
+
+            auto rw = _mm_div_ps(one, corners[3][i]);
+            auto nx = _mm_mul_ps(corners[0][i], rw);
+            auto ny = _mm_mul_ps(corners[1][i], rw);
+            auto nz = _mm_mul_ps(corners[2][i], rw);
+
+            nx_min = _mm_min_ps(nx_min, nx);
+            nx_max = _mm_max_ps(nx_max, nx);
+            ny_min = _mm_min_ps(ny_min, ny);
+            ny_max = _mm_max_ps(ny_max, ny);
+            nz_min = _mm_min_ps(nz_min, nz);
+        }
+
+        auto w    = _mm_set1_ps(width  * 0.5f);
+        auto h    = _mm_set1_ps(height * 0.5f);
+
+        // (ndc * 0.5 + 0.5) * size
+        _mm_store_ps(out.min_x, _mm_mul_ps(_mm_add_ps(nx_min, one), w));
+        _mm_store_ps(out.max_x, _mm_mul_ps(_mm_add_ps(nx_max, one), w));
+        _mm_store_ps(out.min_y, _mm_mul_ps(_mm_add_ps(ny_min, one), h));
+        _mm_store_ps(out.max_y, _mm_mul_ps(_mm_add_ps(ny_max, one), h));
+        _mm_store_ps(out.min_z, nz_min);
+
+        return _mm_movemask_ps(crosses_near);
+    }
+}
+
+bool frst_st::OcclusionBuffer::isRectOccluded(float min_x, float min_y, float max_x, float max_y, float min_z) const {
+    auto width  = static_cast<float>(_width);
+    auto height = static_cast<float>(_height);
+
+    // Outside of screen is a job of frustum culling
+    if (!(max_x >= 0.f && max_y >= 0.f && min_x < width && min_y < height))
+        return false;
+
+    auto x0 = static_cast<S32>(std::max(min_x, 0.f));
+    auto y0 = static_cast<S32>(std::max(min_y, 0.f));
+    auto x1 = static_cast<S32>(std::min(max_x, width  - 1.f));
+    auto y1 = static_cast<S32>(std::min(max_y, height - 1.f));
+
+    constexpr auto tw = static_cast<S32>(TILE_WIDTH);
+    constexpr auto th = static_cast<S32>(TILE_HEIGHT);
+
+    for (auto ty = y0 / th; ty <= y1 / th; ++ty) {
+        for (auto tx = x0 / tw; tx <= x1 / tw; ++tx) {
+            if (min_z > _hiz[ty * _tiles_width + tx])
+                continue;
+
+            // Tile is partially covered, test pixels of rectangle
+            auto py0 = std::max(y0, ty * th), py1 = std::min(y1, ty * th + th - 1);
+            auto px0 = std::max(x0, tx * tw), px1 = std::min(x1, tx * tw + tw - 1);
+
+            for (auto y = py0; y <= py1; ++y) {
+                auto row = _depth.data() + static_cast<SizeT>(y) * _width;
+                for (auto x = px0; x <= px1; ++x)
+                    if (min_z <= row[x])
+                        return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool frst_st::OcclusionBuffer::isOccluded(const float* min, const float* max) const {
+    ScreenBounds bounds;
+
+    auto crosses_near = project_aabbs(MatrixSse(_view_projection),
+            _mm_set1_ps(min[0]), _mm_set1_ps(min[1]), _mm_set1_ps(min[2]),
+            _mm_set1_ps(max[0]), _mm_set1_ps(max[1]), _mm_set1_ps(max[2]),
+            static_cast<float>(_width), static_cast<float>(_height), bounds);
+
+    return !crosses_near && isRectOccluded(bounds.min_x[0], bounds.min_y[0], bounds.max_x[0], bounds.max_y[0],
+                                           bounds.min_z[0]);
+}
+
+void frst_st::OcclusionBuffer::cull(int32_t* occluded, const int32_t* culled, const AabbStreams& aabbs,
+                                    SizeT start, SizeT end) const
+{
+    auto mat    = MatrixSse(_view_projection);
+    auto width  = static_cast<float>(_width);
+    auto height = static_cast<float>(_height);
+
+    ScreenBounds bounds;
+
+    SizeT i = start;
+    for (; i + 4 <= end; i += 4) {
+        auto skip = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(culled + i)), _mm_setzero_si128()))) ^ 0xF;
+
+        if (skip == 0xF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(occluded + i), _mm_setzero_si128());
+            continue;
+        }
+
+        auto crosses_near = project_aabbs(mat,
+                _mm_loadu_ps(aabbs.min_x + i), _mm_loadu_ps(aabbs.min_y + i), _mm_loadu_ps(aabbs.min_z + i),
+                _mm_loadu_ps(aabbs.max_x + i), _mm_loadu_ps(aabbs.max_y + i), _mm_loadu_ps(aabbs.max_z + i),
+                width, height, bounds);
+
+        for (int lane = 0; lane < 4; ++lane)
+            occluded[i + lane] = !((skip | crosses_near) & (1 << lane)) &&
+                    isRectOccluded(bounds.min_x[lane], bounds.min_y[lane], bounds.max_x[lane], bounds.max_y[lane],
+                                   bounds.min_z[lane]);
+    }
+
+    for (; i < end; ++i) {
+        float min[3] = { aabbs.min_x[i], aabbs.min_y[i], aabbs.min_z[i] };
+        float max[3] = { aabbs.max_x[i], aabbs.max_y[i], aabbs.max_z[i] };
+        occluded[i] = !culled[i] && isOccluded(min, max);
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <vector>
+
+#include <glm/mat4x4.hpp>
+
+#include "baseTypes.hpp"
+#include "allocators/AlignedAllocator.hpp"
+#include "frustum_culling_simd.hpp"
+
+namespace frst_st {
+    /**
+     * Low resolution software depth buffer for occlusion culling
+     *
+     * Few large occluder meshes are transformed, clipped by near plane and rasterized on CPU
+     * (4 pixels per SSE instruction) on job system threads, each thread owns a band of tile rows.
+     * After rasterization the farthest depth of each TILE_WIDTH x TILE_HEIGHT tile is stored
+     * in hierarchical buffer, so most AABBs are accepted or rejected with a few tile reads.
+     *
+     * Depth is NDC z in [-1, 1] (OpenGL convention), empty buffer is at far plane
+     *
+     * Usage per frame: begin(view_projection), addOccluder() for each occluder, render(), then isOccluded() / cull()
+     */
+    class OcclusionBuffer {
+    public:
+        static constexpr U32 TILE_WIDTH  = 8;
+        static constexpr U32 TILE_HEIGHT = 4;
+
+        using DepthT = std::vector<float, AlignedAllocator<float, 64>>;
+
+    public:
+        explicit OcclusionBuffer(U32 width = 320, U32 height = 192);
+
+        // Size is rounded up to tile size
+        void resize(U32 width, U32 height);
+
+        // Clears buffer and occluders
+        void begin(const glm::mat4& view_projection);
+
+        /**
+         * Add occluder mesh
+         * @param positions - xyz of each vertex
+         * @param indices - triangle list, winding is not important
+         * @param model - model matrix of occluder
+         */
+        void addOccluder(const float* positions, SizeT vertices_count,
+                         const U32*   indices,   SizeT indices_count, const glm::mat4& model);
+
+        // Rasterize added occluders and build hierarchical buffer
+        void render();
+
+        // True if AABB is fully behind occluders. AABB crossing near plane is never occluded
+        bool isOccluded(const float* min, const float* max) const;
+
+        /**
+         * Write 1 to occluded[i] for AABBs in [start, end) which are occluded, 0 otherwise.
+         * AABBs with culled[i] != 0 are skipped (0 is written)
+         */
+        void cull(int32_t* occluded, const int32_t* culled, const AabbStreams& aabbs, SizeT start, SizeT end) const;
+
+        U32   width          () const { return _width; }
+        U32   height         () const { return _height; }
+        SizeT triangles_count() const { return _triangles.size(); }
+
+        const DepthT& depth() const { return _depth; }
+
+    private:
+        struct ClipVertex {
+            float x, y, z, w;
+        };
+
+        // Screen space triangle prepared for rasterization
+        struct Triangle {
+            float edge_a[3], edge_b[3], edge_c[3]; // a * x + b * y + c >= 0 if pixel center is inside of edge
+            float z0, dzdx, dzdy;                  // Farthest depth in pixel: z0 + dzdx * x + dzdy * y
+            S32   min_x, min_y, max_x, max_y;      // Bounding box in pixels, inclusive
+        };
+
+        void addTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+        void setup      (const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2);
+        void rasterize  (const Triangle& tri, S32 min_y, S32 max_y);
+        void renderBand (U32 tile_row_start, U32 tile_row_end);
+
+        bool isRectOccluded(float min_x, float min_y, float max_x, float max_y, float min_z) const;
+
+    private:
+        U32 _width        = 0;
+        U32 _height       = 0;
+        U32 _tiles_width  = 0;
+        U32 _tiles_height = 0;
+
+        glm::mat4 _view_projection = glm::mat4(1.f);
+
+        DepthT                  _depth;
+        DepthT                  _hiz;
+        std::vector<Triangle>   _triangles;
+        std::vector<ClipVertex> _clip_vertices;
+    };
+
+} // namespace frst_st
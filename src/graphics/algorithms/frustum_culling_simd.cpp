@@ -0,0 +1,983 @@
+#include <cmath>
+#include <immintrin.h>
+
+#include "frustum_culling_simd.hpp"
+
+namespace {
+    /**
+     * Streams of the vertex which lies farthest along plane normal (positive vertex)
+     * AABB is outside of plane if its positive vertex is outside
+     */
+    struct PlaneStreams {
+        const float* x;
+        const float* y;
+        const float* z;
+    };
+
+    inline PlaneStreams positive_vertex(const frst_st::AabbStreams& s, const float* plane) {
+        return PlaneStreams{
+            plane[0] >= 0.f ? s.max_x : s.min_x,
+            plane[1] >= 0.f ? s.max_y : s.min_y,
+            plane[2] >= 0.f ? s.max_z : s.min_z
+        };
+    }
+
+    /**
+     * Left-packing table for 8 lanes: for each mask, indices of set bits go first
+     */
+    struct LeftPackTable {
+        alignas(32) U32 indices[256][8];
+    };
+
+    constexpr LeftPackTable make_left_pack_table() {
+        auto table = LeftPackTable{};
+
+        for (U32 mask = 0; mask < 256; ++mask) {
+            U32 k = 0;
+            for (U32 bit = 0; bit < 8; ++bit)
+                if (mask & (1U << bit))
+                    table.indices[mask][k++] = bit;
+        }
+
+        return table;
+    }
+
+    constexpr auto left_pack_table = make_left_pack_table();
+
+    inline bool plane_rejects(const frst_st::AabbStreams& s, const float* plane, SizeT i) {
+        auto x = plane[0] >= 0.f ? s.max_x[i] : s.min_x[i];
+        auto y = plane[1] >= 0.f ? s.max_y[i] : s.min_y[i];
+        auto z = plane[2] >= 0.f ? s.max_z[i] : s.min_z[i];
+        return (x * plane[0] + y * plane[1] + z * plane[2] + plane[3]) <= 0.f;
+    }
+
+    /**
+     * Negative parts of plane normals for multi-view kernels
+     * Positive vertex is max - (max - min) for negative components, so distance to it is
+     * dot(n, max) - dot(min(n, 0), max - min). Blocks keep max and extent in registers, no per-plane blends
+     */
+    inline void negative_components(const float* frustums, SizeT views_count, float (&negative)[32 * 6][3]) {
+        for (SizeT p = 0; p < views_count * 6; ++p)
+            for (int k = 0; k < 3; ++k)
+                negative[p][k] = frustums[p * 4 + k] < 0.f ? frustums[p * 4 + k] : 0.f;
+    }
+
+    // Sphere is outside of not normalized plane if distance to center is less than -radius * |normal|
+    inline void plane_lengths(const float* frustum, float (&lengths)[6]) {
+        for (int p = 0; p < 6; ++p)
+            lengths[p] = std::sqrt(frustum[p * 4 + 0] * frustum[p * 4 + 0] +
+                                   frustum[p * 4 + 1] * frustum[p * 4 + 1] +
+                                   frustum[p * 4 + 2] * frustum[p * 4 + 2]);
+    }
+
+    // Dot products of vectors from SoA streams with plane normal for OBB kernels
+    __attribute__((target("sse2")))
+    inline __m128 sse2_dot(const float* x, const float* y, const float* z, __m128 a, __m128 b, __m128 c) {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(x), a), _mm_mul_ps(_mm_loadu_ps(y), b)),
+                          _mm_mul_ps(_mm_loadu_ps(z), c));
+    }
+
+    __attribute__((target("avx2,fma")))
+    inline __m256 avx2_fma_dot(const float* x, const float* y, const float* z, __m256 a, __m256 b, __m256 c) {
+        return _mm256_fmadd_ps(_mm256_loadu_ps(z), c,
+               _mm256_fmadd_ps(_mm256_loadu_ps(y), b,
+               _mm256_mul_ps  (_mm256_loadu_ps(x), a)));
+    }
+
+    // AVX-512 kernel keeps vectors in registers
+    __attribute__((target("avx512f")))
+    inline __m512 avx512_dot(const __m512* v, __m512 a, __m512 b, __m512 c) {
+        return _mm512_fmadd_ps(v[2], c, _mm512_fmadd_ps(v[1], b, _mm512_mul_ps(v[0], a)));
+    }
+
+    constexpr U32 ALL_PLANES = 0x3F;
+}
+
+
+void frst_st::scalar_soa_frustum_culling(
+        int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    for (int p = 0; p < 6; ++p)
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+
+    for (SizeT i = start; i < end; ++i) {
+        int32_t culled = 0;
+        for (int p = 0; p < 6; ++p) {
+            auto plane = frustum + p * 4;
+            culled |= (v[p].x[i] * plane[0] + v[p].y[i] * plane[1] + v[p].z[i] * plane[2] + plane[3]) <= 0.f;
+        }
+        results[i] = culled;
+    }
+}
+
+SizeT frst_st::scalar_soa_frustum_culling_compact(
+        U32* visible, const AabbStreams& aabbs, const int32_t* alive, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    for (int p = 0; p < 6; ++p)
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+
+    SizeT count = 0;
+    for (SizeT i = start; i < end; ++i) {
+        int32_t culled = alive[i] == 0;
+        for (int p = 0; p < 6; ++p) {
+            auto plane = frustum + p * 4;
+            culled |= (v[p].x[i] * plane[0] + v[p].y[i] * plane[1] + v[p].z[i] * plane[2] + plane[3]) <= 0.f;
+        }
+
+        // Branchless append
+        visible[count] = static_cast<U32>(i);
+        count += culled ^ 1;
+    }
+
+    return count;
+}
+
+void frst_st::scalar_soa_frustum_culling_coherent(
+        int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+        const AabbStreams& aabbs, const float* frustum, U32 changed_planes, SizeT start, SizeT end)
+{
+    for (SizeT i = start; i < end; ++i) {
+        auto cached = cached_planes[i];
+
+        if (plane_rejects(aabbs, frustum + cached * 4, i)) {
+            results[i] = 1;
+            continue;
+        }
+
+        // Previously culled AABB was rejected by cached plane only, others are unknown
+        auto planes = (dirty[i] || results[i]) ? ALL_PLANES : changed_planes;
+        int32_t culled = 0;
+
+        for (int p = 0; p < 6; ++p) {
+            if ((planes & (1U << p)) && p != cached && plane_rejects(aabbs, frustum + p * 4, i)) {
+                culled = 1;
+                cached_planes[i] = p;
+                break;
+            }
+        }
+
+        results[i] = culled;
+    }
+}
+
+void frst_st::scalar_soa_frustum_culling_multi(
+        U32* masks, const AabbStreams& aabbs, const float* frustums, SizeT views_count, SizeT start, SizeT end)
+{
+    float negative[32 * 6][3];
+    negative_components(frustums, views_count, negative);
+
+    for (SizeT i = start; i < end; ++i) {
+        float max[3] = { aabbs.max_x[i], aabbs.max_y[i], aabbs.max_z[i] };
+        float ext[3] = { max[0] - aabbs.min_x[i], max[1] - aabbs.min_y[i], max[2] - aabbs.min_z[i] };
+        U32   mask   = 0;
+
+        for (SizeT view = 0; view < views_count; ++view) {
+            int32_t culled = 0;
+            for (SizeT p = view * 6; p < view * 6 + 6; ++p) {
+                auto plane = frustums + p * 4;
+                auto dist  = max[0] * plane[0] + max[1] * plane[1] + max[2] * plane[2] + plane[3] -
+                             (ext[0] * negative[p][0] + ext[1] * negative[p][1] + ext[2] * negative[p][2]);
+                culled |= dist <= 0.f;
+            }
+            mask |= static_cast<U32>(culled ^ 1) << view;
+        }
+
+        masks[i] = mask;
+    }
+}
+
+void frst_st::scalar_soa_sphere_culling(
+        int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end)
+{
+    float lengths[6];
+    plane_lengths(frustum, lengths);
+
+    for (SizeT i = start; i < end; ++i) {
+        int32_t culled = 0;
+        for (int p = 0; p < 6; ++p) {
+            auto plane = frustum + p * 4;
+            culled |= (spheres.x[i] * plane[0] + spheres.y[i] * plane[1] + spheres.z[i] * plane[2] + plane[3] +
+                       spheres.radius[i] * lengths[p]) <= 0.f;
+        }
+        results[i] = culled;
+    }
+}
+
+void frst_st::scalar_soa_obb_culling(
+        int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end)
+{
+    for (SizeT i = start; i < end; ++i) {
+        int32_t culled = 0;
+        for (int p = 0; p < 6; ++p) {
+            auto a = frustum[p * 4 + 0];
+            auto b = frustum[p * 4 + 1];
+            auto c = frustum[p * 4 + 2];
+
+            // Projection of box on plane normal
+            auto extent = std::fabs(obbs.ux[i] * a + obbs.uy[i] * b + obbs.uz[i] * c) +
+                          std::fabs(obbs.vx[i] * a + obbs.vy[i] * b + obbs.vz[i] * c) +
+                          std::fabs(obbs.wx[i] * a + obbs.wy[i] * b + obbs.wz[i] * c);
+
+            culled |= (obbs.x[i] * a + obbs.y[i] * b + obbs.z[i] * c + frustum[p * 4 + 3] + extent) <= 0.f;
+        }
+        results[i] = culled;
+    }
+}
+
+
+__attribute__((target("sse2")))
+void frst_st::sse2_soa_frustum_culling(
+        int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m128 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero = _mm_setzero_ps();
+    auto one  = _mm_set1_epi32(1);
+
+    SizeT i = start;
+    for (; i + 4 <= end; i += 4) {
+        auto culled = _mm_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm_add_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(v[p].x + i), a[p]),
+                                          _mm_mul_ps(_mm_loadu_ps(v[p].y + i), b[p])),
+                               _mm_mul_ps(_mm_loadu_ps(v[p].z + i), c[p])),
+                    d[p]);
+            culled = _mm_or_ps(culled, _mm_cmple_ps(dist, zero));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), _mm_and_si128(_mm_castps_si128(culled), one));
+    }
+
+    scalar_soa_frustum_culling(results, aabbs, frustum, i, end);
+}
+
+
+__attribute__((target("sse2")))
+SizeT frst_st::sse2_soa_frustum_culling_compact(
+        U32* visible, const AabbStreams& aabbs, const int32_t* alive, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m128 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero  = _mm_setzero_ps();
+    auto zeroi = _mm_setzero_si128();
+
+    SizeT count = 0;
+    SizeT i     = start;
+    for (; i + 4 <= end; i += 4) {
+        auto dead   = _mm_cmpeq_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(alive + i)), zeroi);
+        auto culled = _mm_castsi128_ps(dead);
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm_add_ps(
+                    _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(v[p].x + i), a[p]),
+                                          _mm_mul_ps(_mm_loadu_ps(v[p].y + i), b[p])),
+                               _mm_mul_ps(_mm_loadu_ps(v[p].z + i), c[p])),
+                    d[p]);
+            culled = _mm_or_ps(culled, _mm_cmple_ps(dist, zero));
+        }
+
+        // No byte shuffles in SSE2, pack with branchless scalar stores
+        auto mask = ~_mm_movemask_ps(culled);
+        for (U32 lane = 0; lane < 4; ++lane) {
+            visible[count] = static_cast<U32>(i + lane);
+            count += (mask >> lane) & 1;
+        }
+    }
+
+    return count + scalar_soa_frustum_culling_compact(visible + count, aabbs, alive, frustum, i, end);
+}
+
+
+__attribute__((target("sse2")))
+void frst_st::sse2_soa_frustum_culling_multi(
+        U32* masks, const AabbStreams& aabbs, const float* frustums, SizeT views_count, SizeT start, SizeT end)
+{
+    float negative[32 * 6][3];
+    negative_components(frustums, views_count, negative);
+
+    auto zero = _mm_setzero_ps();
+
+    SizeT i = start;
+    for (; i + 4 <= end; i += 4) {
+        // Block is loaded once and stays in registers for all views
+        auto max_x = _mm_loadu_ps(aabbs.max_x + i);
+        auto max_y = _mm_loadu_ps(aabbs.max_y + i);
+        auto max_z = _mm_loadu_ps(aabbs.max_z + i);
+        auto ext_x = _mm_sub_ps(max_x, _mm_loadu_ps(aabbs.min_x + i));
+        auto ext_y = _mm_sub_ps(max_y, _mm_loadu_ps(aabbs.min_y + i));
+        auto ext_z = _mm_sub_ps(max_z, _mm_loadu_ps(aabbs.min_z + i));
+        auto mask  = _mm_setzero_si128();
+
+        for (SizeT view = 0; view < views_count; ++view) {
+            auto culled = _mm_setzero_ps();
+
+            for (SizeT p = view * 6; p < view * 6 + 6; ++p) {
+                auto plane = frustums + p * 4;
+                auto dist  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(max_x, _mm_set1_ps(plane[0])),
+                                                   _mm_mul_ps(max_y, _mm_set1_ps(plane[1]))),
+                                        _mm_add_ps(_mm_mul_ps(max_z, _mm_set1_ps(plane[2])), _mm_set1_ps(plane[3])));
+                auto back  = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ext_x, _mm_set1_ps(negative[p][0])),
+                                                   _mm_mul_ps(ext_y, _mm_set1_ps(negative[p][1]))),
+                                        _mm_mul_ps(ext_z, _mm_set1_ps(negative[p][2])));
+                culled = _mm_or_ps(culled, _mm_cmple_ps(_mm_sub_ps(dist, back), zero));
+            }
+
+            auto bit = _mm_set1_epi32(static_cast<int>(1U << view));
+            mask = _mm_or_si128(mask, _mm_andnot_si128(_mm_castps_si128(culled), bit));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(masks + i), mask);
+    }
+
+    scalar_soa_frustum_culling_multi(masks, aabbs, frustums, views_count, i, end);
+}
+
+
+__attribute__((target("sse2")))
+void frst_st::sse2_soa_sphere_culling(
+        int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end)
+{
+    float lengths[6];
+    plane_lengths(frustum, lengths);
+
+    auto zero = _mm_setzero_ps();
+    auto one  = _mm_set1_epi32(1);
+
+    SizeT i = start;
+    for (; i + 4 <= end; i += 4) {
+        auto x = _mm_loadu_ps(spheres.x + i);
+        auto y = _mm_loadu_ps(spheres.y + i);
+        auto z = _mm_loadu_ps(spheres.z + i);
+        auto r = _mm_loadu_ps(spheres.radius + i);
+        auto culled = _mm_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm_add_ps(
+                    _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(frustum[p * 4 + 0])), _mm_mul_ps(y, _mm_set1_ps(frustum[p * 4 + 1]))),
+                    _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(frustum[p * 4 + 2])),
+                               _mm_add_ps(_mm_mul_ps(r, _mm_set1_ps(lengths[p])), _mm_set1_ps(frustum[p * 4 + 3]))));
+            culled = _mm_or_ps(culled, _mm_cmple_ps(dist, zero));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), _mm_and_si128(_mm_castps_si128(culled), one));
+    }
+
+    scalar_soa_sphere_culling(results, spheres, frustum, i, end);
+}
+
+
+__attribute__((target("sse2")))
+void frst_st::sse2_soa_obb_culling(
+        int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end)
+{
+    auto zero = _mm_setzero_ps();
+    auto one  = _mm_set1_epi32(1);
+    auto sign = _mm_set1_ps(-0.f);
+
+    SizeT i = start;
+    for (; i + 4 <= end; i += 4) {
+        auto culled = _mm_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto a = _mm_set1_ps(frustum[p * 4 + 0]);
+            auto b = _mm_set1_ps(frustum[p * 4 + 1]);
+            auto c = _mm_set1_ps(frustum[p * 4 + 2]);
+
+            auto u = sse2_dot(obbs.ux + i, obbs.uy + i, obbs.uz + i, a, b, c);
+            auto v = sse2_dot(obbs.vx + i, obbs.vy + i, obbs.vz + i, a, b, c);
+            auto w = sse2_dot(obbs.wx + i, obbs.wy + i, obbs.wz + i, a, b, c);
+
+            // Projection of box on plane normal
+            auto extent = _mm_add_ps(_mm_add_ps(_mm_andnot_ps(sign, u), _mm_andnot_ps(sign, v)), _mm_andnot_ps(sign, w));
+            auto center = sse2_dot(obbs.x + i, obbs.y + i, obbs.z + i, a, b, c);
+            auto dist   = _mm_add_ps(_mm_add_ps(center, _mm_set1_ps(frustum[p * 4 + 3])), extent);
+
+            culled = _mm_or_ps(culled, _mm_cmple_ps(dist, zero));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(results + i), _mm_and_si128(_mm_castps_si128(culled), one));
+    }
+
+    scalar_soa_obb_culling(results, obbs, frustum, i, end);
+}
+
+
+__attribute__((target("avx2,fma")))
+void frst_st::avx2_fma_soa_frustum_culling(
+        int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m256 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm256_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm256_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm256_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm256_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero = _mm256_setzero_ps();
+
+    SizeT i = start;
+    for (; i + 8 <= end; i += 8) {
+        auto culled = _mm256_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm256_fmadd_ps(_mm256_loadu_ps(v[p].z + i), c[p],
+                        _mm256_fmadd_ps(_mm256_loadu_ps(v[p].y + i), b[p],
+                        _mm256_fmadd_ps(_mm256_loadu_ps(v[p].x + i), a[p], d[p])));
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, zero, _CMP_LE_OQ));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i),
+                            _mm256_srli_epi32(_mm256_castps_si256(culled), 31));
+    }
+
+    scalar_soa_frustum_culling(results, aabbs, frustum, i, end);
+}
+
+
+__attribute__((target("avx2,fma,popcnt")))
+SizeT frst_st::avx2_fma_soa_frustum_culling_compact(
+        U32* visible, const AabbStreams& aabbs, const int32_t* alive, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m256 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm256_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm256_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm256_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm256_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero  = _mm256_setzero_ps();
+    auto zeroi = _mm256_setzero_si256();
+    auto lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    SizeT count = 0;
+    SizeT i     = start;
+    for (; i + 8 <= end; i += 8) {
+        auto dead   = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(alive + i)), zeroi);
+        auto culled = _mm256_castsi256_ps(dead);
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm256_fmadd_ps(_mm256_loadu_ps(v[p].z + i), c[p],
+                        _mm256_fmadd_ps(_mm256_loadu_ps(v[p].y + i), b[p],
+                        _mm256_fmadd_ps(_mm256_loadu_ps(v[p].x + i), a[p], d[p])));
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, zero, _CMP_LE_OQ));
+        }
+
+        // Left-pack IDs of visible lanes. Full 8 lanes are stored, but count <= i - start,
+        // so the store never crosses visible + (end - start)
+        auto mask   = static_cast<U32>(~_mm256_movemask_ps(culled)) & 0xFF;
+        auto perm   = _mm256_load_si256(reinterpret_cast<const __m256i*>(left_pack_table.indices[mask]));
+        auto ids    = _mm256_add_epi32(lanes, _mm256_set1_epi32(static_cast<int>(i)));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(visible + count), _mm256_permutevar8x32_epi32(ids, perm));
+        count += static_cast<SizeT>(__builtin_popcount(mask));
+    }
+
+    return count + scalar_soa_frustum_culling_compact(visible + count, aabbs, alive, frustum, i, end);
+}
+
+
+__attribute__((target("avx2,fma")))
+void frst_st::avx2_fma_soa_frustum_culling_coherent(
+        int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+        const AabbStreams& aabbs, const float* frustum, U32 changed_planes, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m256 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm256_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm256_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm256_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm256_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    // Plane components as tables for per-lane lookup of cached plane
+    float ta[8] = {}, tb[8] = {}, tc[8] = {}, td[8] = {};
+    for (int p = 0; p < 6; ++p) {
+        ta[p] = frustum[p * 4 + 0];
+        tb[p] = frustum[p * 4 + 1];
+        tc[p] = frustum[p * 4 + 2];
+        td[p] = frustum[p * 4 + 3];
+    }
+
+    auto pa    = _mm256_loadu_ps(ta);
+    auto pb    = _mm256_loadu_ps(tb);
+    auto pc    = _mm256_loadu_ps(tc);
+    auto pd    = _mm256_loadu_ps(td);
+    auto zero  = _mm256_setzero_ps();
+    auto zeroi = _mm256_setzero_si256();
+
+    SizeT i = start;
+    for (; i + 8 <= end; i += 8) {
+        auto cached = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cached_planes + i));
+
+        auto ca = _mm256_permutevar8x32_ps(pa, cached);
+        auto cb = _mm256_permutevar8x32_ps(pb, cached);
+        auto cc = _mm256_permutevar8x32_ps(pc, cached);
+        auto cd = _mm256_permutevar8x32_ps(pd, cached);
+
+        // Positive vertex of cached plane, blendv takes min for negative components
+        auto x = _mm256_blendv_ps(_mm256_loadu_ps(aabbs.max_x + i), _mm256_loadu_ps(aabbs.min_x + i), ca);
+        auto y = _mm256_blendv_ps(_mm256_loadu_ps(aabbs.max_y + i), _mm256_loadu_ps(aabbs.min_y + i), cb);
+        auto z = _mm256_blendv_ps(_mm256_loadu_ps(aabbs.max_z + i), _mm256_loadu_ps(aabbs.min_z + i), cc);
+
+        auto dist   = _mm256_fmadd_ps(z, cc, _mm256_fmadd_ps(y, cb, _mm256_fmadd_ps(x, ca, cd)));
+        auto culled = _mm256_cmp_ps(dist, zero, _CMP_LE_OQ);
+
+        if (_mm256_movemask_ps(culled) != 0xFF) {
+            auto prev  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(results + i));
+            auto dirt  = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dirty + i));
+            auto full  = _mm256_or_ps(
+                    _mm256_castsi256_ps(_mm256_xor_si256(_mm256_cmpeq_epi32(dirt, zeroi), _mm256_set1_epi32(-1))),
+                    _mm256_andnot_ps(culled, _mm256_castsi256_ps(
+                            _mm256_xor_si256(_mm256_cmpeq_epi32(prev, zeroi), _mm256_set1_epi32(-1)))));
+
+            auto planes = _mm256_movemask_ps(full) ? ALL_PLANES : changed_planes;
+
+            for (int p = 0; p < 6; ++p) {
+                if (!(planes & (1U << p)))
+                    continue;
+
+                auto dp  = _mm256_fmadd_ps(_mm256_loadu_ps(v[p].z + i), c[p],
+                           _mm256_fmadd_ps(_mm256_loadu_ps(v[p].y + i), b[p],
+                           _mm256_fmadd_ps(_mm256_loadu_ps(v[p].x + i), a[p], d[p])));
+                auto rej = _mm256_cmp_ps(dp, zero, _CMP_LE_OQ);
+
+                // Remember the first rejecting plane
+                cached = _mm256_blendv_epi8(cached, _mm256_set1_epi32(p),
+                                            _mm256_castps_si256(_mm256_andnot_ps(culled, rej)));
+                culled = _mm256_or_ps(culled, rej);
+            }
+
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(cached_planes + i), cached);
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i),
+                            _mm256_srli_epi32(_mm256_castps_si256(culled), 31));
+    }
+
+    scalar_soa_frustum_culling_coherent(results, cached_planes, dirty, aabbs, frustum, changed_planes, i, end);
+}
+
+
+__attribute__((target("avx2,fma")))
+void frst_st::avx2_fma_soa_frustum_culling_multi(
+        U32* masks, const AabbStreams& aabbs, const float* frustums, SizeT views_count, SizeT start, SizeT end)
+{
+    float negative[32 * 6][3];
+    negative_components(frustums, views_count, negative);
+
+    auto zero = _mm256_setzero_ps();
+
+    SizeT i = start;
+    for (; i + 8 <= end; i += 8) {
+        // Block is loaded once and stays in registers for all views
+        auto max_x = _mm256_loadu_ps(aabbs.max_x + i);
+        auto max_y = _mm256_loadu_ps(aabbs.max_y + i);
+        auto max_z = _mm256_loadu_ps(aabbs.max_z + i);
+        auto ext_x = _mm256_sub_ps(max_x, _mm256_loadu_ps(aabbs.min_x + i));
+        auto ext_y = _mm256_sub_ps(max_y, _mm256_loadu_ps(aabbs.min_y + i));
+        auto ext_z = _mm256_sub_ps(max_z, _mm256_loadu_ps(aabbs.min_z + i));
+        auto mask  = _mm256_setzero_si256();
+
+        for (SizeT view = 0; view < views_count; ++view) {
+            auto culled = _mm256_setzero_ps();
+
+            for (SizeT p = view * 6; p < view * 6 + 6; ++p) {
+                auto plane = frustums + p * 4;
+                auto dist  = _mm256_fmadd_ps(max_z, _mm256_broadcast_ss(plane + 2),
+                             _mm256_fmadd_ps(max_y, _mm256_broadcast_ss(plane + 1),
+                             _mm256_fmadd_ps(max_x, _mm256_broadcast_ss(plane + 0), _mm256_broadcast_ss(plane + 3))));
+                dist = _mm256_fnmadd_ps(ext_x, _mm256_broadcast_ss(&negative[p][0]), dist);
+                dist = _mm256_fnmadd_ps(ext_y, _mm256_broadcast_ss(&negative[p][1]), dist);
+                dist = _mm256_fnmadd_ps(ext_z, _mm256_broadcast_ss(&negative[p][2]), dist);
+                culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, zero, _CMP_LE_OQ));
+            }
+
+            auto bit = _mm256_set1_epi32(static_cast<int>(1U << view));
+            mask = _mm256_or_si256(mask, _mm256_andnot_si256(_mm256_castps_si256(culled), bit));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(masks + i), mask);
+    }
+
+    scalar_soa_frustum_culling_multi(masks, aabbs, frustums, views_count, i, end);
+}
+
+
+__attribute__((target("avx2,fma")))
+void frst_st::avx2_fma_soa_sphere_culling(
+        int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end)
+{
+    float lengths[6];
+    plane_lengths(frustum, lengths);
+
+    auto zero = _mm256_setzero_ps();
+
+    SizeT i = start;
+    for (; i + 8 <= end; i += 8) {
+        auto x = _mm256_loadu_ps(spheres.x + i);
+        auto y = _mm256_loadu_ps(spheres.y + i);
+        auto z = _mm256_loadu_ps(spheres.z + i);
+        auto r = _mm256_loadu_ps(spheres.radius + i);
+        auto culled = _mm256_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm256_fmadd_ps(z, _mm256_broadcast_ss(frustum + p * 4 + 2),
+                        _mm256_fmadd_ps(y, _mm256_broadcast_ss(frustum + p * 4 + 1),
+                        _mm256_fmadd_ps(x, _mm256_broadcast_ss(frustum + p * 4 + 0),
+                        _mm256_fmadd_ps(r, _mm256_broadcast_ss(lengths + p), _mm256_broadcast_ss(frustum + p * 4 + 3)))));
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, zero, _CMP_LE_OQ));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i),
+                            _mm256_srli_epi32(_mm256_castps_si256(culled), 31));
+    }
+
+    scalar_soa_sphere_culling(results, spheres, frustum, i, end);
+}
+
+
+__attribute__((target("avx2,fma")))
+void frst_st::avx2_fma_soa_obb_culling(
+        int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end)
+{
+    auto zero = _mm256_setzero_ps();
+    auto sign = _mm256_set1_ps(-0.f);
+
+    SizeT i = start;
+    for (; i + 8 <= end; i += 8) {
+        auto culled = _mm256_setzero_ps();
+
+        for (int p = 0; p < 6; ++p) {
+            auto a = _mm256_broadcast_ss(frustum + p * 4 + 0);
+            auto b = _mm256_broadcast_ss(frustum + p * 4 + 1);
+            auto c = _mm256_broadcast_ss(frustum + p * 4 + 2);
+
+            auto u = avx2_fma_dot(obbs.ux + i, obbs.uy + i, obbs.uz + i, a, b, c);
+            auto v = avx2_fma_dot(obbs.vx + i, obbs.vy + i, obbs.vz + i, a, b, c);
+            auto w = avx2_fma_dot(obbs.wx + i, obbs.wy + i, obbs.wz + i, a, b, c);
+
+            // Projection of box on plane normal
+            auto extent = _mm256_add_ps(_mm256_add_ps(_mm256_andnot_ps(sign, u), _mm256_andnot_ps(sign, v)),
+                                        _mm256_andnot_ps(sign, w));
+            auto dist   = _mm256_fmadd_ps(_mm256_loadu_ps(obbs.z + i), c,
+                          _mm256_fmadd_ps(_mm256_loadu_ps(obbs.y + i), b,
+                          _mm256_fmadd_ps(_mm256_loadu_ps(obbs.x + i), a,
+                          _mm256_add_ps(_mm256_broadcast_ss(frustum + p * 4 + 3), extent))));
+
+            culled = _mm256_or_ps(culled, _mm256_cmp_ps(dist, zero, _CMP_LE_OQ));
+        }
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(results + i),
+                            _mm256_srli_epi32(_mm256_castps_si256(culled), 31));
+    }
+
+    scalar_soa_obb_culling(results, obbs, frustum, i, end);
+}
+
+
+__attribute__((target("avx512f")))
+void frst_st::avx512_soa_frustum_culling(
+        int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m512 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm512_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm512_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm512_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm512_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero = _mm512_setzero_ps();
+    auto one  = _mm512_set1_epi32(1);
+
+    // Tail is handled with masked loads and stores
+    for (SizeT i = start; i < end; i += 16) {
+        auto lanes  = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+        auto culled = __mmask16(0);
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].z + i), c[p],
+                        _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].y + i), b[p],
+                        _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].x + i), a[p], d[p])));
+            culled |= _mm512_mask_cmp_ps_mask(lanes, dist, zero, _CMP_LE_OQ);
+        }
+
+        _mm512_mask_storeu_epi32(results + i, lanes, _mm512_maskz_mov_epi32(culled, one));
+    }
+}
+
+
+__attribute__((target("avx512f,popcnt")))
+SizeT frst_st::avx512_soa_frustum_culling_compact(
+        U32* visible, const AabbStreams& aabbs, const int32_t* alive, const float* frustum, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m512 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm512_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm512_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm512_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm512_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    auto zero  = _mm512_setzero_ps();
+    auto lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+
+    SizeT count = 0;
+    for (SizeT i = start; i < end; i += 16) {
+        auto tail = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+        auto live = _mm512_mask_test_epi32_mask(tail, _mm512_maskz_loadu_epi32(tail, alive + i),
+                                                _mm512_set1_epi32(-1));
+        auto culled = __mmask16(0);
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(live, v[p].z + i), c[p],
+                        _mm512_fmadd_ps(_mm512_maskz_loadu_ps(live, v[p].y + i), b[p],
+                        _mm512_fmadd_ps(_mm512_maskz_loadu_ps(live, v[p].x + i), a[p], d[p])));
+            culled |= _mm512_mask_cmp_ps_mask(live, dist, zero, _CMP_LE_OQ);
+        }
+
+        auto mask = static_cast<__mmask16>(live & ~culled);
+        auto ids  = _mm512_add_epi32(lanes, _mm512_set1_epi32(static_cast<int>(i)));
+
+        _mm512_mask_compressstoreu_epi32(visible + count, mask, ids);
+        count += static_cast<SizeT>(__builtin_popcount(mask));
+    }
+
+    return count;
+}
+
+
+__attribute__((target("avx512f")))
+void frst_st::avx512_soa_frustum_culling_coherent(
+        int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+        const AabbStreams& aabbs, const float* frustum, U32 changed_planes, SizeT start, SizeT end)
+{
+    PlaneStreams v[6];
+    __m512 a[6], b[6], c[6], d[6];
+
+    for (int p = 0; p < 6; ++p) {
+        v[p] = positive_vertex(aabbs, frustum + p * 4);
+        a[p] = _mm512_set1_ps(frustum[p * 4 + 0]);
+        b[p] = _mm512_set1_ps(frustum[p * 4 + 1]);
+        c[p] = _mm512_set1_ps(frustum[p * 4 + 2]);
+        d[p] = _mm512_set1_ps(frustum[p * 4 + 3]);
+    }
+
+    // Plane components as tables for per-lane lookup of cached plane
+    float ta[16] = {}, tb[16] = {}, tc[16] = {}, td[16] = {};
+    for (int p = 0; p < 6; ++p) {
+        ta[p] = frustum[p * 4 + 0];
+        tb[p] = frustum[p * 4 + 1];
+        tc[p] = frustum[p * 4 + 2];
+        td[p] = frustum[p * 4 + 3];
+    }
+
+    auto pa   = _mm512_loadu_ps(ta);
+    auto pb   = _mm512_loadu_ps(tb);
+    auto pc   = _mm512_loadu_ps(tc);
+    auto pd   = _mm512_loadu_ps(td);
+    auto zero = _mm512_setzero_ps();
+    auto one  = _mm512_set1_epi32(1);
+
+    for (SizeT i = start; i < end; i += 16) {
+        auto lanes  = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+        auto cached = _mm512_maskz_loadu_epi32(lanes, cached_planes + i);
+
+        auto ca = _mm512_permutexvar_ps(cached, pa);
+        auto cb = _mm512_permutexvar_ps(cached, pb);
+        auto cc = _mm512_permutexvar_ps(cached, pc);
+        auto cd = _mm512_permutexvar_ps(cached, pd);
+
+        // Positive vertex of cached plane
+        auto x = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(ca, zero, _CMP_GE_OQ),
+                _mm512_maskz_loadu_ps(lanes, aabbs.min_x + i), _mm512_maskz_loadu_ps(lanes, aabbs.max_x + i));
+        auto y = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(cb, zero, _CMP_GE_OQ),
+                _mm512_maskz_loadu_ps(lanes, aabbs.min_y + i), _mm512_maskz_loadu_ps(lanes, aabbs.max_y + i));
+        auto z = _mm512_mask_blend_ps(_mm512_cmp_ps_mask(cc, zero, _CMP_GE_OQ),
+                _mm512_maskz_loadu_ps(lanes, aabbs.min_z + i), _mm512_maskz_loadu_ps(lanes, aabbs.max_z + i));
+
+        auto dist   = _mm512_fmadd_ps(z, cc, _mm512_fmadd_ps(y, cb, _mm512_fmadd_ps(x, ca, cd)));
+        auto culled = _mm512_mask_cmp_ps_mask(lanes, dist, zero, _CMP_LE_OQ);
+
+        if (culled != lanes) {
+            auto prev = _mm512_mask_test_epi32_mask(lanes, _mm512_maskz_loadu_epi32(lanes, results + i), one);
+            auto dirt = _mm512_mask_test_epi32_mask(lanes, _mm512_maskz_loadu_epi32(lanes, dirty + i), _mm512_set1_epi32(-1));
+            auto full = static_cast<__mmask16>(dirt | (prev & ~culled));
+
+            auto planes = full ? ALL_PLANES : changed_planes;
+
+            for (int p = 0; p < 6; ++p) {
+                if (!(planes & (1U << p)))
+                    continue;
+
+                auto dp  = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].z + i), c[p],
+                           _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].y + i), b[p],
+                           _mm512_fmadd_ps(_mm512_maskz_loadu_ps(lanes, v[p].x + i), a[p], d[p])));
+                auto rej = _mm512_mask_cmp_ps_mask(lanes, dp, zero, _CMP_LE_OQ);
+
+                // Remember the first rejecting plane
+                cached = _mm512_mask_mov_epi32(cached, static_cast<__mmask16>(rej & ~culled), _mm512_set1_epi32(p));
+                culled |= rej;
+            }
+
+            _mm512_mask_storeu_epi32(cached_planes + i, lanes, cached);
+        }
+
+        _mm512_mask_storeu_epi32(results + i, lanes, _mm512_maskz_mov_epi32(culled, one));
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void frst_st::avx512_soa_frustum_culling_multi(
+        U32* masks, const AabbStreams& aabbs, const float* frustums, SizeT views_count, SizeT start, SizeT end)
+{
+    float negative[32 * 6][3];
+    negative_components(frustums, views_count, negative);
+
+    auto zero = _mm512_setzero_ps();
+
+    // Tail is handled with masked loads and stores
+    for (SizeT i = start; i < end; i += 16) {
+        auto lanes = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+
+        // Block is loaded once and stays in registers for all views
+        auto max_x = _mm512_maskz_loadu_ps(lanes, aabbs.max_x + i);
+        auto max_y = _mm512_maskz_loadu_ps(lanes, aabbs.max_y + i);
+        auto max_z = _mm512_maskz_loadu_ps(lanes, aabbs.max_z + i);
+        auto ext_x = _mm512_sub_ps(max_x, _mm512_maskz_loadu_ps(lanes, aabbs.min_x + i));
+        auto ext_y = _mm512_sub_ps(max_y, _mm512_maskz_loadu_ps(lanes, aabbs.min_y + i));
+        auto ext_z = _mm512_sub_ps(max_z, _mm512_maskz_loadu_ps(lanes, aabbs.min_z + i));
+        auto mask  = _mm512_setzero_si512();
+
+        for (SizeT view = 0; view < views_count; ++view) {
+            auto culled = __mmask16(0);
+
+            for (SizeT p = view * 6; p < view * 6 + 6; ++p) {
+                auto plane = frustums + p * 4;
+                auto dist  = _mm512_fmadd_ps(max_z, _mm512_set1_ps(plane[2]),
+                             _mm512_fmadd_ps(max_y, _mm512_set1_ps(plane[1]),
+                             _mm512_fmadd_ps(max_x, _mm512_set1_ps(plane[0]), _mm512_set1_ps(plane[3]))));
+                dist = _mm512_fnmadd_ps(ext_x, _mm512_set1_ps(negative[p][0]), dist);
+                dist = _mm512_fnmadd_ps(ext_y, _mm512_set1_ps(negative[p][1]), dist);
+                dist = _mm512_fnmadd_ps(ext_z, _mm512_set1_ps(negative[p][2]), dist);
+                culled |= _mm512_cmp_ps_mask(dist, zero, _CMP_LE_OQ);
+            }
+
+            mask = _mm512_mask_or_epi32(mask, static_cast<__mmask16>(~culled), mask,
+                                        _mm512_set1_epi32(static_cast<int>(1U << view)));
+        }
+
+        _mm512_mask_storeu_epi32(masks + i, lanes, mask);
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void frst_st::avx512_soa_sphere_culling(
+        int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end)
+{
+    float lengths[6];
+    plane_lengths(frustum, lengths);
+
+    auto zero = _mm512_setzero_ps();
+    auto one  = _mm512_set1_epi32(1);
+
+    // Tail is handled with masked loads and stores
+    for (SizeT i = start; i < end; i += 16) {
+        auto lanes = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+        auto x = _mm512_maskz_loadu_ps(lanes, spheres.x + i);
+        auto y = _mm512_maskz_loadu_ps(lanes, spheres.y + i);
+        auto z = _mm512_maskz_loadu_ps(lanes, spheres.z + i);
+        auto r = _mm512_maskz_loadu_ps(lanes, spheres.radius + i);
+        auto culled = __mmask16(0);
+
+        for (int p = 0; p < 6; ++p) {
+            auto dist = _mm512_fmadd_ps(z, _mm512_set1_ps(frustum[p * 4 + 2]),
+                        _mm512_fmadd_ps(y, _mm512_set1_ps(frustum[p * 4 + 1]),
+                        _mm512_fmadd_ps(x, _mm512_set1_ps(frustum[p * 4 + 0]),
+                        _mm512_fmadd_ps(r, _mm512_set1_ps(lengths[p]), _mm512_set1_ps(frustum[p * 4 + 3])))));
+            culled |= _mm512_mask_cmp_ps_mask(lanes, dist, zero, _CMP_LE_OQ);
+        }
+
+        _mm512_mask_storeu_epi32(results + i, lanes, _mm512_maskz_mov_epi32(culled, one));
+    }
+}
+
+
+__attribute__((target("avx512f")))
+void frst_st::avx512_soa_obb_culling(
+        int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end)
+{
+    auto zero = _mm512_setzero_ps();
+    auto one  = _mm512_set1_epi32(1);
+
+    for (SizeT i = start; i < end; i += 16) {
+        auto lanes  = end - i >= 16 ? __mmask16(0xFFFF) : __mmask16((1U << (end - i)) - 1);
+        auto culled = __mmask16(0);
+
+        // 32 registers are enough to keep whole block loaded for all planes
+        const float* streams[12] = { obbs.x,  obbs.y,  obbs.z,
+                                     obbs.ux, obbs.uy, obbs.uz,
+                                     obbs.vx, obbs.vy, obbs.vz,
+                                     obbs.wx, obbs.wy, obbs.wz };
+        __m512 box[12];
+        for (int k = 0; k < 12; ++k)
+            box[k] = _mm512_maskz_loadu_ps(lanes, streams[k] + i);
+
+        for (int p = 0; p < 6; ++p) {
+            auto a = _mm512_set1_ps(frustum[p * 4 + 0]);
+            auto b = _mm512_set1_ps(frustum[p * 4 + 1]);
+            auto c = _mm512_set1_ps(frustum[p * 4 + 2]);
+
+            // Projection of box on plane normal
+            auto extent = _mm512_add_ps(_mm512_add_ps(_mm512_abs_ps(avx512_dot(box + 3, a, b, c)),
+                                                      _mm512_abs_ps(avx512_dot(box + 6, a, b, c))),
+                                        _mm512_abs_ps(avx512_dot(box + 9, a, b, c)));
+            auto dist   = _mm512_add_ps(avx512_dot(box, a, b, c), _mm512_add_ps(_mm512_set1_ps(frustum[p * 4 + 3]), extent));
+
+            culled |= _mm512_mask_cmp_ps_mask(lanes, dist, zero, _CMP_LE_OQ);
+        }
+
+        _mm512_mask_storeu_epi32(results + i, lanes, _mm512_maskz_mov_epi32(culled, one));
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <cstdint>
+#include "baseTypes.hpp"
+
+namespace frst_st {
+    /**
+     * Structure-of-arrays view of AABB storage
+     * Each stream holds one coordinate of all AABBs, min must be <= max
+     */
+    struct AabbStreams {
+        const float* min_x;
+        const float* min_y;
+        const float* min_z;
+        const float* max_x;
+        const float* max_y;
+        const float* max_z;
+    };
+
+    /**
+     * Structure-of-arrays view of bounding spheres, radius must be >= 0
+     */
+    struct SphereStreams {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* radius;
+    };
+
+    /**
+     * Structure-of-arrays view of oriented bounding boxes
+     * u, v, w are box axes in world space scaled by half size of box along them
+     */
+    struct ObbStreams {
+        const float* x;
+        const float* y;
+        const float* z;
+        const float* ux; const float* uy; const float* uz;
+        const float* vx; const float* vy; const float* vz;
+        const float* wx; const float* wy; const float* wz;
+    };
+
+    /**
+     * SoA culling kernel
+     * Tests AABBs in [start, end) against 6 planes (frustum[6][4] as Ax + By + Cz + D),
+     * writes 1 to results[i] if AABB is culled, 0 otherwise
+     */
+    using SoaKernelT = void(*)(int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end);
+
+    void scalar_soa_frustum_culling  (int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end);
+    void sse2_soa_frustum_culling    (int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end);
+    void avx2_fma_soa_frustum_culling(int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end);
+    void avx512_soa_frustum_culling  (int32_t* results, const AabbStreams& aabbs, const float* frustum, SizeT start, SizeT end);
+
+    /**
+     * SoA culling kernel with compacted output
+     * Writes IDs of alive (alive[i] != 0) and not culled AABBs in [start, end) to visible, returns count of them.
+     * May write garbage up to visible + (end - start), but never beyond it
+     */
+    using SoaCompactKernelT = SizeT(*)(U32* visible, const AabbStreams& aabbs, const int32_t* alive,
+                                       const float* frustum, SizeT start, SizeT end);
+
+    SizeT scalar_soa_frustum_culling_compact  (U32* visible, const AabbStreams& aabbs, const int32_t* alive,
+                                               const float* frustum, SizeT start, SizeT end);
+    SizeT sse2_soa_frustum_culling_compact    (U32* visible, const AabbStreams& aabbs, const int32_t* alive,
+                                               const float* frustum, SizeT start, SizeT end);
+    SizeT avx2_fma_soa_frustum_culling_compact(U32* visible, const AabbStreams& aabbs, const int32_t* alive,
+                                               const float* frustum, SizeT start, SizeT end);
+    SizeT avx512_soa_frustum_culling_compact  (U32* visible, const AabbStreams& aabbs, const int32_t* alive,
+                                               const float* frustum, SizeT start, SizeT end);
+
+    /**
+     * SoA culling kernel with temporal coherence
+     * cached_planes[i] holds index of plane which rejected AABB last time, it is tested first.
+     * Previously visible AABBs which are not dirty are tested only against changed planes
+     * (bit per plane in changed_planes). Writes results like SoaKernelT and updates cached_planes.
+     */
+    using SoaCoherentKernelT = void(*)(int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+                                       const AabbStreams& aabbs, const float* frustum, U32 changed_planes,
+                                       SizeT start, SizeT end);
+
+    void scalar_soa_frustum_culling_coherent  (int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+                                               const AabbStreams& aabbs, const float* frustum, U32 changed_planes,
+                                               SizeT start, SizeT end);
+    void avx2_fma_soa_frustum_culling_coherent(int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+                                               const AabbStreams& aabbs, const float* frustum, U32 changed_planes,
+                                               SizeT start, SizeT end);
+    void avx512_soa_frustum_culling_coherent  (int32_t* results, int32_t* cached_planes, const int32_t* dirty,
+                                               const AabbStreams& aabbs, const float* frustum, U32 changed_planes,
+                                               SizeT start, SizeT end);
+
+    /**
+     * SoA culling kernel for several views
+     * Tests AABBs in [start, end) against views_count frustums (frustums[views_count][6][4]), AABB block
+     * is loaded once for all views. Writes visibility mask to masks[i]: bit v is set if AABB is visible in view v.
+     * views_count must be <= 32
+     */
+    using SoaMultiKernelT = void(*)(U32* masks, const AabbStreams& aabbs, const float* frustums, SizeT views_count,
+                                    SizeT start, SizeT end);
+
+    void scalar_soa_frustum_culling_multi  (U32* masks, const AabbStreams& aabbs, const float* frustums,
+                                            SizeT views_count, SizeT start, SizeT end);
+    void sse2_soa_frustum_culling_multi    (U32* masks, const AabbStreams& aabbs, const float* frustums,
+                                            SizeT views_count, SizeT start, SizeT end);
+    void avx2_fma_soa_frustum_culling_multi(U32* masks, const AabbStreams& aabbs, const float* frustums,
+                                            SizeT views_count, SizeT start, SizeT end);
+    void avx512_soa_frustum_culling_multi  (U32* masks, const AabbStreams& aabbs, const float* frustums,
+                                            SizeT views_count, SizeT start, SizeT end);
+
+    /**
+     * SoA culling kernels for spheres and OBBs, results are the same as for SoaKernelT
+     * Planes may be not normalized
+     */
+    using SoaSphereKernelT = void(*)(int32_t* results, const SphereStreams& spheres, const float* frustum,
+                                     SizeT start, SizeT end);
+    using SoaObbKernelT    = void(*)(int32_t* results, const ObbStreams& obbs, const float* frustum,
+                                     SizeT start, SizeT end);
+
+    void scalar_soa_sphere_culling  (int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end);
+    void sse2_soa_sphere_culling    (int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end);
+    void avx2_fma_soa_sphere_culling(int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end);
+    void avx512_soa_sphere_culling  (int32_t* results, const SphereStreams& spheres, const float* frustum, SizeT start, SizeT end);
+
+    void scalar_soa_obb_culling  (int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end);
+    void sse2_soa_obb_culling    (int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end);
+    void avx2_fma_soa_obb_culling(int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end);
+    void avx512_soa_obb_culling  (int32_t* results, const ObbStreams& obbs, const float* frustum, SizeT start, SizeT end);
+
+} // namespace frst_st
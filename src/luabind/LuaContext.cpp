@@ -1,5 +1,7 @@
 #include "LuaContext.hpp"
 
+#include <algorithm>
+
 extern "C" {
     #include <luajit-2.1/lua.h>
     #include <luajit-2.1/lauxlib.h>
@@ -7,6 +9,31 @@ extern "C" {
     #include <luajit-2.1/luajit.h>
 }
 
+#include "assert.hpp"
+#include "logs.hpp"
+#include "vfs.hpp"
+
+namespace {
+    // package.loaders entry, reads modules through VFS. Upvalue is package path
+    int vfsLoader(lua_State* L) {
+        auto module = std::string(luaL_checkstring(L, 1));
+        std::replace(module.begin(), module.end(), '.', '/');
+
+        auto path = std::string(lua_tostring(L, lua_upvalueindex(1))) + "/" + module + ".lua";
+        auto file = base::vfs().open(path);
+
+        if (!file) {
+            lua_pushfstring(L, "\n\tno file '%s' in vfs", path.c_str());
+            return 1;
+        }
+
+        if (luaL_loadbuffer(L, file->view().data(), file->size(), ("@" + path).c_str()) != 0)
+            return lua_error(L);
+
+        return 1;
+    }
+}
+
 namespace lua {
 
 Context::Context(const Context::StrV &path)
@@ -23,7 +50,15 @@ Context::~Context()
 
 void Context::doFile(const Context::StrV &name)
 {
-    luaL_dofile(L, (_packagePath + "/" + name.data()).data());
+    auto path = _packagePath + "/" + name.data();
+    auto file = base::vfs().open(path);
+    RASSERTF(file.has_value(), "Can't open lua file: \'{}\'", path);
+
+    if (luaL_loadbuffer(L, file->view().data(), file->size(), ("@" + path).c_str()) != 0 ||
+        lua_pcall(L, 0, LUA_MULTRET, 0) != 0) {
+        DE_LOG(Error, Lua, "Lua error: {}", lua_tostring(L, -1));
+        lua_pop(L, 1);
+    }
 }
 
 void Context::addPackagePath(const Context::StrV &path)
@@ -38,6 +73,17 @@ void Context::addPackagePath(const Context::StrV &path)
 
     lua_pushstring(L, s.c_str());
     lua_setfield(L, -3, "path");
+    lua_pop(L, 1);
+
+    // Search modules in VFS right after package.preload
+    lua_getfield(L, -1, "loaders");
+    for (auto i = static_cast<int>(lua_objlen(L, -1)); i >= 2; --i) {
+        lua_rawgeti(L, -1, i);
+        lua_rawseti(L, -2, i + 1);
+    }
+    lua_pushstring(L, _packagePath.c_str());
+    lua_pushcclosure(L, vfsLoader, 1);
+    lua_rawseti(L, -2, 2);
     lua_pop(L, 2);
 }
 
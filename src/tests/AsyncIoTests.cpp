@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstdio>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../base/async_io.hpp"
+#include "../base/filesystem.hpp"
+
+namespace {
+    using Backend = base::AsyncIo::Backend;
+
+    void test_read_write(Backend backend) {
+        auto io   = base::AsyncIo(backend, 4);
+        auto path = base::fs::current_path() / "async_io_test.bin";
+        auto fd   = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        ASSERT_NE(fd, -1);
+
+        constexpr SizeT BLOCK  = 4096;
+        constexpr SizeT BLOCKS = 64; // More than queue depth and batch size
+
+        auto data = ftl::Vector<Byte>(BLOCK * BLOCKS);
+        for (SizeT i = 0; i < data.size(); ++i)
+            data[i] = Byte(i * 7 + i / BLOCK);
+
+        auto written = std::atomic<SizeT>(0);
+        for (SizeT i = 0; i < BLOCKS; ++i)
+            io.write(fd, data.data() + i * BLOCK, BLOCK, i * BLOCK, [&](S64 rc) {
+                if (rc == S64(BLOCK))
+                    ++written;
+            });
+        io.wait_idle();
+        ASSERT_EQ(written.load(), BLOCKS);
+
+        auto read = ftl::Vector<Byte>(data.size());
+        auto futures = std::vector<std::future<S64>>();
+        for (SizeT i = 0; i < BLOCKS; ++i)
+            futures.push_back(io.read(fd, read.data() + i * BLOCK, BLOCK, i * BLOCK));
+        io.flush();
+
+        for (auto& future : futures)
+            ASSERT_EQ(future.get(), S64(BLOCK));
+        ASSERT_TRUE(read == data);
+
+        // Requests submitted from callbacks
+        auto chained = std::atomic<int>(0);
+        io.read(fd, read.data(), BLOCK, 0, [&](S64) {
+            ++chained;
+            io.read(fd, read.data(), BLOCK, BLOCK, [&](S64) { ++chained; });
+            io.flush();
+        });
+        io.wait_idle();
+        ASSERT_EQ(chained.load(), 2);
+
+        auto bad = io.read(-1, read.data(), BLOCK, 0);
+        io.flush();
+        ASSERT_EQ(bad.get(), -EBADF);
+
+        auto file = ftl::Vector<Byte>();
+        io.read_file(path, [&](ftl::Vector<Byte> bytes) { file = std::move(bytes); });
+        io.wait_idle();
+        ASSERT_TRUE(file == data);
+
+        close(fd);
+        std::remove(path.c_str());
+    }
+}
+
+TEST(AsyncIo, IoUring) {
+    auto io = base::AsyncIo(Backend::IoUring);
+    if (io.backend() != Backend::IoUring)
+        GTEST_SKIP() << "io_uring is not supported";
+
+    test_read_write(Backend::IoUring);
+}
+
+TEST(AsyncIo, ThreadPool) {
+    test_read_write(Backend::ThreadPool);
+}
@@ -1,7 +1,19 @@
 #include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+#include <thread>
+
 #include "../base/configs.hpp"
+#include "../base/files.hpp"
 #include "../base/ftl/array.hpp"
 
+namespace {
+    void write_cfg(const ftl::String& path, const std::string& text) {
+        base::writeBytesToFile(path, reinterpret_cast<const Byte*>(text.data()), text.size());
+    }
+}
+
 #define TEST_SECTION(SECT_NAME) \
 ASSERT_EQ      (cfg::read<U32>     ("one", SECT_NAME),      100); \
 ASSERT_EQ      (cfg::read<S32>     ("two", SECT_NAME),      -101); \
@@ -84,5 +96,205 @@ TEST(ConfigTests, TestSection) {
     // Yeah
     auto inttrplvector = cfg::read<ftl::Vector<ftl::Vector<ftl::Vector<S32>>>>("inttrplvector", "test_section_multi1");
     ASSERT_EQ(inttrplvector.to_string(), "{ { { 1, 2 }, { 3, 2 } }, { { 1, 4, 6 }, { 4, 5, 6, 7 } }, { { 1 } } }");
+
+    // Inheritance
+    ASSERT_EQ(cfg::read<S32>("a", "test_section_derived"), 1);
+    ASSERT_EQ(cfg::read<S32>("b", "test_section_derived"), 2);
+    ASSERT_EQ(cfg::read<S32>("c", "test_section_derived"), 3);
+    ASSERT_EQ(cfg::read<S32>("c", "test_section_base2"),   2);
+    ASSERT_EQ(cfg::read<ftl::Vector2u32>("intvec2", "test_section_derived"), ftl::Vector2u32(10, 20));
+    ASSERT_EQ(cfg::read_ive<S32>("d", "test_section_derived", 4), 4);
+    ASSERT_EQ(cfg::read_ie<S32>("a", "no_such_section", 5), 5);
 }
 
+TEST(ConfigTests, CachedKeys) {
+    namespace cfg = base::cfg;
+
+    auto flt   = cfg::Key<Float32>("four", "test_section_single1");
+    auto vec   = cfg::Key<ftl::Vector3f32>("fltvec3", "test_section_multi1");
+    auto tuple = cfg::Key<S32, float, bool, ftl::String, ftl::Vector2f64>("tuple", "test_section_multi1");
+    auto def   = cfg::Key<S32>("a", "test_section_derived", -1);
+
+    ASSERT_FLOAT_EQ(*flt, 103.3f);
+    ASSERT_EQ(*vec, ftl::Vector3f32(1.1, 2.2, 3.3));
+    ASSERT_EQ(std::get<3>(*tuple), "sample text");
+    ASSERT_EQ(*def, 1);
+    ASSERT_EQ((cfg::read_ie<S32, S32>("intvec2", "test_section_multi1", std::tuple(0, 0))), std::tuple(10, 20));
+
+    // Reload invalidates cached values
+    auto& storage = base::cfg_detls::cfgStorage();
+    auto  entries = base::cfg_detls::cfg_state().getEntries();
+
+    storage.load({});
+    ASSERT_EQ(*def, -1);
+
+    storage.load(entries);
+    ASSERT_EQ(*def, 1);
+    ASSERT_FLOAT_EQ(*flt, 103.3f);
+}
+
+TEST(ConfigTests, Reload) {
+    namespace cfg = base::cfg;
+
+    auto& storage   = base::cfg_detls::cfgStorage();
+    auto  entries   = base::cfg_detls::cfg_state().getEntries();
+    auto  dir       = base::fs::current_path() / "cfg_reload_test";
+    auto  entry_cfg = dir / "entry.cfg";
+    auto  base_cfg  = entry_cfg.parent_path() / "base.cfg"; // Path as in include directive
+
+    write_cfg(base_cfg,  "speed = 10\n[player]\nhp = 100\n");
+    write_cfg(entry_cfg, "#include 'base.cfg'\n[enemy]\nspeed = $speed\ndamage = 5\n");
+    storage.load({entry_cfg});
+
+    auto speed   = cfg::Key<S32>("speed", "enemy");
+    auto calls   = std::string();
+    auto watcher = [&](auto name, auto section) { calls += std::string(section) + ':' + std::string(name) + ' '; };
+    auto subs    = {cfg::subscribe("speed", "enemy", watcher),
+                    cfg::subscribe("hp", "player", watcher),
+                    cfg::subscribe("damage", "enemy", watcher)};
+
+    ASSERT_EQ(*speed, 10);
+
+    // Entry dereferences changed value, so it's parsed again
+    auto old = base::cfg_detls::cfgSnapshot();
+    write_cfg(base_cfg, "speed = 20\n[player]\nhp = 100\n");
+    cfg::reload({base_cfg});
+
+    ASSERT_EQ(*speed, 20);
+    ASSERT_EQ(old->getValue("enemy", "speed"), "10");
+    ASSERT_NE(base::cfg_detls::cfgSnapshot()->files()[0], old->files()[0]);
+    ASSERT_TRUE(calls.empty());
+
+    cfg::dispatchChanges();
+    ASSERT_EQ(calls, "enemy:speed ");
+
+    // Unchanged included file is reused
+    calls.clear();
+    old = base::cfg_detls::cfgSnapshot();
+    write_cfg(entry_cfg, "#include 'base.cfg'\n[enemy]\nspeed = $speed\ndamage = 7\n");
+    cfg::reload({entry_cfg});
+    cfg::dispatchChanges();
+
+    ASSERT_EQ(calls, "enemy:damage ");
+    ASSERT_EQ(base::cfg_detls::cfgSnapshot()->files()[1], old->files()[1]);
+    ASSERT_EQ(cfg::read<S32>("damage", "enemy"), 7);
+
+    // Watcher reloads files changed on disk
+    calls.clear();
+    storage.startWatching();
+    write_cfg(base_cfg, "speed = 30\n[player]\nhp = 50\n");
+
+    for (int i = 0; i < 300 && *speed != 30; ++i)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+    storage.stopWatching();
+    cfg::dispatchChanges();
+
+    ASSERT_EQ(*speed, 30);
+    ASSERT_EQ(calls.size(), std::string("enemy:speed player:hp ").size());
+    ASSERT_NE(calls.find("enemy:speed "), std::string::npos);
+    ASSERT_NE(calls.find("player:hp "), std::string::npos);
+
+    for (auto id : subs)
+        cfg::unsubscribe(id);
+
+    std::remove(entry_cfg.c_str());
+    std::remove(base_cfg.c_str());
+    std::remove(dir.c_str());
+
+    storage.load(entries);
+}
+
+TEST(ConfigTests, ReloadError) {
+    namespace cfg = base::cfg;
+
+    auto& storage   = base::cfg_detls::cfgStorage();
+    auto  entries   = base::cfg_detls::cfg_state().getEntries();
+    auto  dir       = base::fs::current_path() / "cfg_reload_error_test";
+    auto  entry_cfg = dir / "entry.cfg";
+
+    write_cfg(entry_cfg, "[enemy]\nspeed = 10\n");
+    storage.load({entry_cfg});
+
+    auto speed = cfg::Key<S32>("speed", "enemy");
+    auto old   = base::cfg_detls::cfgSnapshot();
+    ASSERT_EQ(*speed, 10);
+
+    // Malformed file is not applied, previous values are kept
+    write_cfg(entry_cfg, "[enemy\nspeed = 20\n");
+    cfg::reload({entry_cfg});
+
+    ASSERT_EQ(base::cfg_detls::cfgSnapshot(), old);
+    ASSERT_EQ(*speed, 10);
+    ASSERT_EQ(cfg::read<S32>("speed", "enemy"), 10);
+
+    // Dereference of missing value
+    write_cfg(entry_cfg, "[enemy]\nspeed = $missing\n");
+    cfg::reload({entry_cfg});
+
+    ASSERT_EQ(base::cfg_detls::cfgSnapshot(), old);
+    ASSERT_EQ(*speed, 10);
+
+    // Fixed file is reloaded
+    write_cfg(entry_cfg, "[enemy]\nspeed = 30\n");
+    cfg::reload({entry_cfg});
+
+    ASSERT_EQ(*speed, 30);
+
+    std::remove(entry_cfg.c_str());
+    std::remove(dir.c_str());
+
+    storage.load(entries);
+}
+
+TEST(ConfigTests, Cache) {
+    namespace cfg = base::cfg;
+
+    auto& storage   = base::cfg_detls::cfgStorage();
+    auto  entries   = base::cfg_detls::cfg_state().getEntries();
+    auto  dir       = base::fs::current_path() / "cfg_cache_test";
+    auto  entry_cfg = dir / "entry.cfg";
+    auto  base_cfg  = entry_cfg.parent_path() / "base.cfg";
+    auto  cache     = dir / "configs.dcfg";
+
+    auto is_cached = [] { return base::cfg_detls::cfgSnapshot()->files().empty(); };
+
+    write_cfg(base_cfg,  "root = 'data'\n[base]\nspeed = 10\n");
+    write_cfg(entry_cfg, "#include 'base.cfg'\n[enemy] : base\npath = $root '/enemy'\n");
+
+    storage.load({entry_cfg}, cache);
+    ASSERT_FALSE(is_cached());
+
+    storage.load({entry_cfg}, cache);
+    ASSERT_TRUE(is_cached());
+    ASSERT_EQ(cfg::read<S32>("speed", "enemy"), 10);
+    ASSERT_EQ(cfg::read<ftl::String>("path", "enemy"), "data/enemy");
+    ASSERT_EQ(cfg::read<ftl::String>("root"), "data");
+
+    // Same content with new mtime
+    write_cfg(base_cfg, "root = 'data'\n[base]\nspeed = 10\n");
+    storage.load({entry_cfg}, cache);
+    ASSERT_TRUE(is_cached());
+
+    write_cfg(base_cfg, "root = 'data'\n[base]\nspeed = 200\n");
+    storage.load({entry_cfg}, cache);
+    ASSERT_FALSE(is_cached());
+    ASSERT_EQ(cfg::read<S32>("speed", "enemy"), 200);
+
+    // Cache of other entries
+    storage.load({base_cfg}, cache);
+    ASSERT_FALSE(is_cached());
+    ASSERT_FALSE(cfg::read_ie<bool>("path", "enemy", false));
+
+    write_cfg(cache, "DCFG corrupted cache");
+    storage.load({entry_cfg}, cache);
+    ASSERT_FALSE(is_cached());
+    ASSERT_EQ(cfg::read<S32>("speed", "enemy"), 200);
+
+    std::remove(entry_cfg.c_str());
+    std::remove(base_cfg.c_str());
+    std::remove(cache.c_str());
+    std::remove(dir.c_str());
+
+    storage.load(entries);
+}
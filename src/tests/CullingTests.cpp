@@ -0,0 +1,622 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../base/cpu_extension_checker.hpp"
+#include "../graphics/algorithms/frustum_culling_simd.hpp"
+#include "../graphics/algorithms/Bvh.hpp"
+#include "../graphics/algorithms/OcclusionCulling.hpp"
+
+namespace {
+    /*
+     * All values lie on 1/16 grid and plane normals are integer with integer length,
+     * so every dot product is exact and kernels with and without FMA must agree bit to bit
+     */
+    constexpr float GRID = 1.f / 16.f;
+
+    const float normals[][3] = {
+        {1, 0, 0}, {0, 1, 0}, {0, 0, 1}, {1, 2, 2}, {2, 3, 6}, {0, 3, 4}, {1, 4, 8}, {2, 6, 9}
+    };
+
+    struct KernelDesc {
+        const char* name;
+        bool        supported;
+    };
+
+    const auto& cpu = base::cpu_extensions_checker();
+
+    const bool has_sse2     = cpu.HW_SSE2;
+    const bool has_avx2_fma = cpu.HW_AVX2 && cpu.HW_FMA3 && cpu.OS_AVX;
+    const bool has_avx512   = cpu.HW_AVX512F && cpu.OS_AVX512;
+
+    float grid_value(std::mt19937& gen, int min, int max) {
+        return static_cast<float>(std::uniform_int_distribution<int>(min, max)(gen)) * GRID;
+    }
+
+    void random_frustum(std::mt19937& gen, float* frustum) {
+        auto pick = std::uniform_int_distribution<int>(0, std::size(normals) - 1);
+        auto sign = std::uniform_int_distribution<int>(0, 1);
+
+        for (int p = 0; p < 6; ++p) {
+            auto& n = normals[pick(gen)];
+            for (int k = 0; k < 3; ++k)
+                frustum[p * 4 + k] = sign(gen) ? n[k] : -n[k];
+
+            // Origin is inside, planes cross the scene, so many boxes lie on the border
+            frustum[p * 4 + 3] = grid_value(gen, 0, 16 * 160);
+        }
+    }
+
+    struct AabbScene {
+        std::vector<float> min_x, min_y, min_z, max_x, max_y, max_z;
+
+        explicit AabbScene(std::mt19937& gen, SizeT count) {
+            auto size = std::uniform_int_distribution<int>(0, 5);
+
+            for (auto* s : { &min_x, &min_y, &min_z, &max_x, &max_y, &max_z })
+                s->resize(count);
+
+            for (SizeT i = 0; i < count; ++i) {
+                // Zero size and large boxes are both common
+                auto extent = static_cast<float>(1 << size(gen)) * (size(gen) == 0 ? 0.f : 1.f);
+                for (auto [min, max] : { std::pair{&min_x, &max_x}, {&min_y, &max_y}, {&min_z, &max_z} }) {
+                    (*min)[i] = grid_value(gen, -16 * 64, 16 * 64);
+                    (*max)[i] = (*min)[i] + extent;
+                }
+            }
+        }
+
+        frst_st::AabbStreams streams() const {
+            return frst_st::AabbStreams{
+                min_x.data(), min_y.data(), min_z.data(), max_x.data(), max_y.data(), max_z.data()
+            };
+        }
+    };
+
+    // Random [start, end) inside of [0, count), both ends are often unaligned
+    std::pair<SizeT, SizeT> random_range(std::mt19937& gen, SizeT count) {
+        auto a = std::uniform_int_distribution<SizeT>(0, count)(gen);
+        auto b = std::uniform_int_distribution<SizeT>(0, count)(gen);
+        return a < b ? std::pair{a, b} : std::pair{b, a};
+    }
+}
+
+
+TEST(Culling, SoaKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"sse2",     has_sse2},     frst_st::sse2_soa_frustum_culling},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_frustum_culling},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_frustum_culling},
+    };
+
+    auto gen = std::mt19937(42);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        auto count = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto scene = AabbScene(gen, count);
+        auto aabbs = scene.streams();
+
+        float frustum[6 * 4];
+        random_frustum(gen, frustum);
+
+        auto [start, end] = iteration % 2 ? random_range(gen, count) : std::pair<SizeT, SizeT>{0, count};
+
+        // Values out of range must stay untouched
+        auto expected = std::vector<int32_t>(count, -1);
+        frst_st::scalar_soa_frustum_culling(expected.data(), aabbs, frustum, start, end);
+
+        for (auto& kernel : kernels) {
+            if (!kernel.supported)
+                continue;
+
+            auto results = std::vector<int32_t>(count, -1);
+            kernel.fn(results.data(), aabbs, frustum, start, end);
+
+            ASSERT_EQ(results, expected) << kernel.name << ": count " << count << ", range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+TEST(Culling, SoaCompactKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaCompactKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"sse2",     has_sse2},     frst_st::sse2_soa_frustum_culling_compact},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_frustum_culling_compact},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_frustum_culling_compact},
+    };
+
+    auto gen  = std::mt19937(43);
+    auto coin = std::uniform_int_distribution<int>(0, 3);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        auto count = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto scene = AabbScene(gen, count);
+        auto aabbs = scene.streams();
+
+        auto alive = std::vector<int32_t>(count);
+        for (auto& a : alive)
+            a = coin(gen) != 0;
+
+        float frustum[6 * 4];
+        random_frustum(gen, frustum);
+
+        auto [start, end] = iteration % 2 ? random_range(gen, count) : std::pair<SizeT, SizeT>{0, count};
+
+        // Compact kernels may write garbage up to visible + (end - start), but not beyond
+        auto expected       = std::vector<U32>(end - start);
+        auto expected_count = frst_st::scalar_soa_frustum_culling_compact(
+                expected.data(), aabbs, alive.data(), frustum, start, end);
+        expected.resize(expected_count);
+
+        for (auto& kernel : kernels) {
+            if (!kernel.supported)
+                continue;
+
+            auto visible       = std::vector<U32>(end - start);
+            auto visible_count = kernel.fn(visible.data(), aabbs, alive.data(), frustum, start, end);
+            visible.resize(visible_count);
+
+            ASSERT_EQ(visible, expected) << kernel.name << ": count " << count << ", range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+TEST(Culling, SoaCoherentKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaCoherentKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"scalar",   true},         frst_st::scalar_soa_frustum_culling_coherent},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_frustum_culling_coherent},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_frustum_culling_coherent},
+    };
+
+    auto gen  = std::mt19937(44);
+    auto coin = std::uniform_int_distribution<int>(0, 7);
+
+    for (int iteration = 0; iteration < 50; ++iteration) {
+        auto count = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto scene = AabbScene(gen, count);
+        auto aabbs = scene.streams();
+
+        float frustum[6 * 4];
+        random_frustum(gen, frustum);
+
+        // Every kernel keeps its own state between frames, first frame has everything dirty
+        struct State {
+            std::vector<int32_t> results;
+            std::vector<int32_t> cached_planes;
+        };
+
+        auto initial        = State{std::vector<int32_t>(count, 1), std::vector<int32_t>(count, 0)};
+        auto states         = std::vector<State>(std::size(kernels), initial);
+        auto dirty          = std::vector<int32_t>(count, 1);
+        U32  changed_planes = 0x3F;
+
+        for (int frame = 0; frame < 8; ++frame) {
+            auto expected = std::vector<int32_t>(count);
+            frst_st::scalar_soa_frustum_culling(expected.data(), aabbs, frustum, 0, count);
+
+            for (SizeT k = 0; k < std::size(kernels); ++k) {
+                if (!kernels[k].supported)
+                    continue;
+
+                auto& state = states[k];
+                kernels[k].fn(state.results.data(), state.cached_planes.data(), dirty.data(),
+                              aabbs, frustum, changed_planes, 0, count);
+
+                ASSERT_EQ(state.results, expected) << kernels[k].name << ": count " << count << ", frame " << frame;
+            }
+
+            // Next frame: move a few planes and a few boxes
+            changed_planes = 0;
+            for (int p = 0; p < 6; ++p) {
+                if (coin(gen) == 0) {
+                    frustum[p * 4 + 3] = grid_value(gen, 0, 16 * 160);
+                    changed_planes |= 1U << p;
+                }
+            }
+
+            for (SizeT i = 0; i < count; ++i) {
+                dirty[i] = coin(gen) == 0;
+                if (dirty[i]) {
+                    auto shift = grid_value(gen, -16 * 8, 16 * 8);
+                    scene.min_x[i] += shift;
+                    scene.max_x[i] += shift;
+                }
+            }
+        }
+    }
+}
+
+TEST(Culling, SoaMultiKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaMultiKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"scalar",   true},         frst_st::scalar_soa_frustum_culling_multi},
+        {{"sse2",     has_sse2},     frst_st::sse2_soa_frustum_culling_multi},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_frustum_culling_multi},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_frustum_culling_multi},
+    };
+
+    auto gen = std::mt19937(45);
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        auto count = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto scene = AabbScene(gen, count);
+        auto aabbs = scene.streams();
+        auto views = iteration < 4 ? SizeT(32) : std::uniform_int_distribution<SizeT>(1, 32)(gen);
+
+        auto frustums = std::vector<float>(views * 6 * 4);
+        for (SizeT v = 0; v < views; ++v)
+            random_frustum(gen, frustums.data() + v * 6 * 4);
+
+        auto [start, end] = iteration % 2 ? random_range(gen, count) : std::pair<SizeT, SizeT>{0, count};
+
+        // Each view is culled separately, bit is set if view sees the box
+        auto expected = std::vector<U32>(count, 0xDEADBEEF);
+        auto results  = std::vector<int32_t>(count);
+
+        for (SizeT i = start; i < end; ++i)
+            expected[i] = 0;
+
+        for (SizeT v = 0; v < views; ++v) {
+            frst_st::scalar_soa_frustum_culling(results.data(), aabbs, frustums.data() + v * 6 * 4, start, end);
+            for (SizeT i = start; i < end; ++i)
+                expected[i] |= static_cast<U32>(results[i] == 0) << v;
+        }
+
+        for (auto& kernel : kernels) {
+            if (!kernel.supported)
+                continue;
+
+            auto masks = std::vector<U32>(count, 0xDEADBEEF);
+            kernel.fn(masks.data(), aabbs, frustums.data(), views, start, end);
+
+            ASSERT_EQ(masks, expected) << kernel.name << ": count " << count << ", views " << views
+                                       << ", range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+TEST(Culling, SoaSphereKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaSphereKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"sse2",     has_sse2},     frst_st::sse2_soa_sphere_culling},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_sphere_culling},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_sphere_culling},
+    };
+
+    auto gen = std::mt19937(46);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        auto count   = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto streams = std::vector<std::vector<float>>(4, std::vector<float>(count));
+
+        for (SizeT i = 0; i < count; ++i) {
+            for (int k = 0; k < 3; ++k)
+                streams[k][i] = grid_value(gen, -16 * 64, 16 * 64);
+            streams[3][i] = grid_value(gen, 0, 16 * 16);
+        }
+
+        auto spheres = frst_st::SphereStreams{streams[0].data(), streams[1].data(), streams[2].data(), streams[3].data()};
+
+        float frustum[6 * 4];
+        random_frustum(gen, frustum);
+
+        auto [start, end] = iteration % 2 ? random_range(gen, count) : std::pair<SizeT, SizeT>{0, count};
+
+        auto expected = std::vector<int32_t>(count, -1);
+        frst_st::scalar_soa_sphere_culling(expected.data(), spheres, frustum, start, end);
+
+        for (auto& kernel : kernels) {
+            if (!kernel.supported)
+                continue;
+
+            auto results = std::vector<int32_t>(count, -1);
+            kernel.fn(results.data(), spheres, frustum, start, end);
+
+            ASSERT_EQ(results, expected) << kernel.name << ": count " << count << ", range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+TEST(Culling, SoaObbKernels) {
+    struct Kernel : KernelDesc { frst_st::SoaObbKernelT fn; };
+
+    const Kernel kernels[] = {
+        {{"sse2",     has_sse2},     frst_st::sse2_soa_obb_culling},
+        {{"avx2_fma", has_avx2_fma}, frst_st::avx2_fma_soa_obb_culling},
+        {{"avx512",   has_avx512},   frst_st::avx512_soa_obb_culling},
+    };
+
+    auto gen = std::mt19937(47);
+
+    for (int iteration = 0; iteration < 200; ++iteration) {
+        auto count   = std::uniform_int_distribution<SizeT>(0, 300)(gen);
+        auto streams = std::vector<std::vector<float>>(12, std::vector<float>(count));
+
+        // Center and three scaled axes, axes are not required to be orthogonal by kernels
+        for (SizeT i = 0; i < count; ++i) {
+            for (int k = 0; k < 3; ++k)
+                streams[k][i] = grid_value(gen, -16 * 64, 16 * 64);
+            for (int k = 3; k < 12; ++k)
+                streams[k][i] = grid_value(gen, -16 * 8, 16 * 8);
+        }
+
+        auto s    = [&streams](int k) { return streams[k].data(); };
+        auto obbs = frst_st::ObbStreams{s(0), s(1), s(2), s(3), s(4), s(5), s(6), s(7), s(8), s(9), s(10), s(11)};
+
+        float frustum[6 * 4];
+        random_frustum(gen, frustum);
+
+        auto [start, end] = iteration % 2 ? random_range(gen, count) : std::pair<SizeT, SizeT>{0, count};
+
+        auto expected = std::vector<int32_t>(count, -1);
+        frst_st::scalar_soa_obb_culling(expected.data(), obbs, frustum, start, end);
+
+        for (auto& kernel : kernels) {
+            if (!kernel.supported)
+                continue;
+
+            auto results = std::vector<int32_t>(count, -1);
+            kernel.fn(results.data(), obbs, frustum, start, end);
+
+            ASSERT_EQ(results, expected) << kernel.name << ": count " << count << ", range [" << start << ", " << end << ")";
+        }
+    }
+}
+
+namespace {
+    // Sorted IDs of primitives which are not culled by any plane
+    std::vector<U32> brute_force_cull(const std::vector<frst_st::BvhPrimitive>& primitives, const float* frustum) {
+        auto visible = std::vector<U32>();
+
+        for (auto& prim : primitives) {
+            bool culled = false;
+            for (int p = 0; p < 6; ++p) {
+                auto plane = frustum + p * 4;
+                auto x = plane[0] >= 0.f ? prim.max[0] : prim.min[0];
+                auto y = plane[1] >= 0.f ? prim.max[1] : prim.min[1];
+                auto z = plane[2] >= 0.f ? prim.max[2] : prim.min[2];
+                culled |= (x * plane[0] + y * plane[1] + z * plane[2] + plane[3]) <= 0.f;
+            }
+
+            if (!culled)
+                visible.push_back(prim.id);
+        }
+
+        std::sort(visible.begin(), visible.end());
+        return visible;
+    }
+
+    std::vector<U32> bvh_cull(const frst_st::Bvh4& bvh, const float* frustum) {
+        auto visible = std::vector<U32>(bvh.size());
+        visible.resize(bvh.cull(frustum, visible.data()));
+        std::sort(visible.begin(), visible.end());
+        return visible;
+    }
+
+    frst_st::BvhPrimitive to_primitive(const AabbScene& scene, SizeT i) {
+        return frst_st::BvhPrimitive{
+            {scene.min_x[i], scene.min_y[i], scene.min_z[i]},
+            {scene.max_x[i], scene.max_y[i], scene.max_z[i]},
+            static_cast<U32>(i)
+        };
+    }
+}
+
+TEST(Culling, BvhRandomScenes) {
+    auto gen    = std::mt19937(48);
+    auto bvh    = frst_st::Bvh4();
+    auto remove = std::uniform_int_distribution<int>(0, 2);
+
+    for (int iteration = 0; iteration < 100; ++iteration) {
+        auto count      = std::uniform_int_distribution<SizeT>(0, 2000)(gen);
+        auto scene      = AabbScene(gen, count);
+        auto primitives = std::vector<frst_st::BvhPrimitive>();
+
+        for (SizeT i = 0; i < count; ++i)
+            primitives.push_back(to_primitive(scene, i));
+
+        bvh.build(primitives);
+        ASSERT_EQ(bvh.size(), count);
+
+        for (int frame = 0; frame < 4; ++frame) {
+            float frustum[6 * 4];
+            random_frustum(gen, frustum);
+            ASSERT_EQ(bvh_cull(bvh, frustum), brute_force_cull(primitives, frustum)) << "count " << count;
+        }
+
+        // Same BVH is rebuilt after a third of primitives is removed
+        primitives.erase(std::remove_if(primitives.begin(), primitives.end(), [&](auto&) { return remove(gen) == 0; }),
+                         primitives.end());
+
+        bvh.build(primitives);
+        ASSERT_EQ(bvh.size(), primitives.size());
+
+        for (int frame = 0; frame < 4; ++frame) {
+            float frustum[6 * 4];
+            random_frustum(gen, frustum);
+            ASSERT_EQ(bvh_cull(bvh, frustum), brute_force_cull(primitives, frustum)) << "count " << primitives.size();
+        }
+    }
+}
+
+TEST(Culling, BvhDegenerateScenes) {
+    auto gen = std::mt19937(49);
+
+    auto box = [](U32 id, float x, float y, float z, float size) {
+        return frst_st::BvhPrimitive{{x, y, z}, {x + size, y + size, z + size}, id};
+    };
+
+    auto scenes = std::vector<std::vector<frst_st::BvhPrimitive>>(4);
+
+    for (U32 i = 0; i < 1000; ++i) {
+        // Identical boxes, SAH has no extent and falls back to median split
+        scenes[0].push_back(box(i, 1.f, 2.f, 3.f, 4.f));
+
+        // Identical zero size boxes
+        scenes[1].push_back(box(i, -5.f, 0.f, 5.f, 0.f));
+
+        // Zero size boxes on a line
+        scenes[2].push_back(box(i, static_cast<float>(i % 97) - 48.f, 0.f, 0.f, 0.f));
+
+        // Flat boxes in a plane mixed with huge ones
+        auto flat = box(i, grid_value(gen, -16 * 64, 16 * 64), 0.f, grid_value(gen, -16 * 64, 16 * 64), 1.f);
+        flat.max[1] = flat.min[1];
+        scenes[3].push_back(i % 50 ? flat : box(i, -64.f, -64.f, -64.f, 128.f));
+    }
+
+    auto bvh = frst_st::Bvh4();
+
+    float frustum[6 * 4];
+
+    // Empty and single primitive
+    random_frustum(gen, frustum);
+    bvh.build({});
+    ASSERT_TRUE(bvh.empty());
+    ASSERT_EQ(bvh.cull(frustum, nullptr), 0);
+
+    auto single = std::vector<frst_st::BvhPrimitive>{box(7, 0.f, 0.f, 0.f, 1.f)};
+    bvh.build(single);
+    ASSERT_EQ(bvh_cull(bvh, frustum), brute_force_cull(single, frustum));
+
+    for (SizeT s = 0; s < scenes.size(); ++s) {
+        bvh.build(scenes[s]);
+        ASSERT_EQ(bvh.size(), scenes[s].size());
+
+        for (int frame = 0; frame < 20; ++frame) {
+            random_frustum(gen, frustum);
+            ASSERT_EQ(bvh_cull(bvh, frustum), brute_force_cull(scenes[s], frustum)) << "scene " << s;
+        }
+    }
+}
+
+namespace {
+    // Camera in origin looking along -Z
+    glm::mat4 occlusion_view_projection(const frst_st::OcclusionBuffer& buffer) {
+        auto aspect = static_cast<float>(buffer.width()) / static_cast<float>(buffer.height());
+        auto proj   = glm::perspective(1.f, aspect, 0.1f, 1000.f);
+        auto view   = glm::lookAt(glm::vec3(0.f, 0.f, 0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+        return proj * view;
+    }
+
+    // Quad as two triangles from 4 corners in order
+    void add_quad(frst_st::OcclusionBuffer& buffer, const std::array<float, 12>& corners) {
+        static constexpr U32 indices[] = { 0, 1, 2, 0, 2, 3 };
+        buffer.addOccluder(corners.data(), 4, indices, std::size(indices), glm::mat4(1.f));
+    }
+
+    bool occluded(const frst_st::OcclusionBuffer& buffer, std::array<float, 3> min, std::array<float, 3> max) {
+        return buffer.isOccluded(min.data(), max.data());
+    }
+}
+
+TEST(Culling, OcclusionBufferWall) {
+    auto buffer = frst_st::OcclusionBuffer(320, 192);
+
+    // Nothing is occluded by empty buffer
+    buffer.begin(occlusion_view_projection(buffer));
+    buffer.render();
+    ASSERT_FALSE(occluded(buffer, {-1.f, -1.f, -15.f}, {1.f, 1.f, -14.f}));
+
+    // Wall 10x10 at distance 10 covers central part of screen
+    buffer.begin(occlusion_view_projection(buffer));
+    add_quad(buffer, {-5.f, -5.f, -10.f,  5.f, -5.f, -10.f,  5.f, 5.f, -10.f,  -5.f, 5.f, -10.f});
+    buffer.render();
+    ASSERT_EQ(buffer.triangles_count(), 2);
+
+    // Fully hidden behind the wall
+    ASSERT_TRUE(occluded(buffer, {-1.f, -1.f, -15.f}, {1.f, 1.f, -14.f}));
+    ASSERT_TRUE(occluded(buffer, {-4.f, -4.f, -50.f}, {4.f, 4.f, -11.f}));
+
+    // In front of the wall and intersecting it
+    ASSERT_FALSE(occluded(buffer, {-1.f, -1.f, -6.f}, {1.f, 1.f, -5.f}));
+    ASSERT_FALSE(occluded(buffer, {-1.f, -1.f, -15.f}, {1.f, 1.f, -9.f}));
+
+    // Behind the wall, but sticks out of its right and top edges
+    ASSERT_FALSE(occluded(buffer, {3.f, -1.f, -15.f}, {9.f, 1.f, -14.f}));
+    ASSERT_FALSE(occluded(buffer, {-1.f, 3.f, -15.f}, {1.f, 9.f, -14.f}));
+
+    // Crossing near plane is never occluded, even if the far part is hidden
+    ASSERT_FALSE(occluded(buffer, {-1.f, -1.f, -15.f}, {1.f, 1.f, 1.f}));
+    ASSERT_FALSE(occluded(buffer, {-1.f, -1.f, -15.f}, {1.f, 1.f, -0.05f}));
+    ASSERT_FALSE(occluded(buffer, {-0.01f, -0.01f, -15.f}, {0.01f, 0.01f, 0.f}));
+}
+
+TEST(Culling, OcclusionBufferNearClipping) {
+    auto buffer = frst_st::OcclusionBuffer(320, 192);
+
+    // Floor under camera from behind it to far away, rasterized after clipping by near plane
+    buffer.begin(occlusion_view_projection(buffer));
+    add_quad(buffer, {-50.f, -1.f, 10.f,  50.f, -1.f, 10.f,  50.f, -1.f, -100.f,  -50.f, -1.f, -100.f});
+    buffer.render();
+    ASSERT_GT(buffer.triangles_count(), 2);
+
+    // Under the floor
+    ASSERT_TRUE(occluded(buffer, {-2.f, -4.f, -20.f}, {2.f, -3.f, -10.f}));
+
+    // Above the floor and partially above it
+    ASSERT_FALSE(occluded(buffer, {-2.f, 0.f, -20.f}, {2.f, 1.f, -10.f}));
+    ASSERT_FALSE(occluded(buffer, {-2.f, -4.f, -20.f}, {2.f, 0.f, -10.f}));
+
+    // Under the floor, but crossing near plane
+    ASSERT_FALSE(occluded(buffer, {-2.f, -4.f, -20.f}, {2.f, -3.f, 0.5f}));
+    ASSERT_FALSE(occluded(buffer, {-2.f, -4.f, -20.f}, {2.f, -3.f, -0.09f}));
+}
+
+TEST(Culling, OcclusionBufferCull) {
+    auto buffer = frst_st::OcclusionBuffer(320, 192);
+
+    buffer.begin(occlusion_view_projection(buffer));
+    add_quad(buffer, {-5.f, -5.f, -10.f,  5.f, -5.f, -10.f,  5.f, 5.f, -10.f,  -5.f, 5.f, -10.f});
+    add_quad(buffer, {-50.f, -1.f, 10.f,  50.f, -1.f, 10.f,  50.f, -1.f, -100.f,  -50.f, -1.f, -100.f});
+    buffer.render();
+
+    // Batch version must agree with single AABB test, boxes near camera often cross near plane
+    auto gen   = std::mt19937(50);
+    auto coin  = std::uniform_int_distribution<int>(0, 3);
+    auto count = SizeT(1003);
+    auto scene = AabbScene(gen, count);
+
+    for (SizeT i = 0; i < count; ++i) {
+        scene.min_z[i] = -std::abs(scene.min_z[i]) - 1.f;
+        scene.max_z[i] = scene.min_z[i] + (coin(gen) ? 1.f : 64.f);
+    }
+
+    auto culled = std::vector<int32_t>(count);
+    for (auto& c : culled)
+        c = coin(gen) == 0;
+
+    // Start is unaligned, so both 4-wide blocks and tail are used
+    auto  aabbs          = scene.streams();
+    auto  expected       = std::vector<int32_t>(count, -1);
+    SizeT start          = 1;
+    SizeT end            = count;
+    SizeT occluded_count = 0;
+
+    for (SizeT i = start; i < end; ++i) {
+        float min[3] = { scene.min_x[i], scene.min_y[i], scene.min_z[i] };
+        float max[3] = { scene.max_x[i], scene.max_y[i], scene.max_z[i] };
+        expected[i] = !culled[i] && buffer.isOccluded(min, max);
+        occluded_count += expected[i];
+    }
+
+    auto results = std::vector<int32_t>(count, -1);
+    buffer.cull(results.data(), culled.data(), aabbs, start, end);
+
+    ASSERT_EQ(results, expected);
+    ASSERT_GT(occluded_count, 0);
+    ASSERT_LT(occluded_count, end - start);
+}
@@ -109,3 +109,35 @@ TEST(FileTests, Serialize_Deserialize) {
 
     ASSERT_TRUE(a.serialize().to_string() == b.serialize().to_string());
 }
+
+TEST(FileTests, MappedFile) {
+    ftl::String path = base::fs::current_path() / "test_mapped.txt";
+    ftl::String empty_path = base::fs::current_path() / "test_mapped_empty.txt";
+
+    auto text = std::string("key = value\nsecond line");
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(text.data()), text.size());
+    base::writeBytesToFile(empty_path, ftl::Vector<Byte>());
+
+    {
+        auto file = base::MappedFile(path.c_str(), base::MappedFile::Access::Sequential);
+
+        ASSERT_EQ(file.size(), text.size());
+        ASSERT_EQ(file.view(), text);
+        ASSERT_EQ(file.view(12), "second line");
+        ASSERT_EQ(file.view(0, 3), "key");
+        ASSERT_TRUE(file.view(100).empty());
+        ASSERT_EQ(file.bytes(6, 5).size(), 5);
+        ASSERT_EQ(char(file.bytes(6)[0]), 'v');
+
+        auto moved = std::move(file);
+        ASSERT_TRUE(file.empty());
+        ASSERT_EQ(moved.view(), text);
+    }
+
+    auto empty = base::MappedFile::openOpt(empty_path.c_str());
+    ASSERT_TRUE(empty.has_value());
+    ASSERT_TRUE(empty->empty());
+    ASSERT_TRUE(empty->view().empty());
+
+    ASSERT_FALSE(base::MappedFile::openOpt("/nonexistent/test_mapped.txt").has_value());
+}
@@ -0,0 +1,134 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "../base/handles.hpp"
+
+TEST(HandlePool, AllocateRelease) {
+    auto pool = base::HandlePool();
+
+    auto a = pool.allocate();
+    auto b = pool.allocate();
+
+    ASSERT_NE(a.index, b.index);
+    ASSERT_TRUE(pool.valid(a));
+    ASSERT_TRUE(pool.valid(b));
+
+    ASSERT_TRUE (pool.release(a));
+    ASSERT_FALSE(pool.valid(a));
+    ASSERT_FALSE(pool.release(a));
+
+    // Slot is reused with new generation, old handle stays stale
+    auto c = pool.allocate();
+    ASSERT_EQ(c.index, a.index);
+    ASSERT_NE(c.generation, a.generation);
+    ASSERT_TRUE (pool.valid(c));
+    ASSERT_FALSE(pool.valid(a));
+    ASSERT_EQ(pool.slots_count(), 2);
+}
+
+TEST(HandlePool, Pack) {
+    auto h = base::Handle{123, 456};
+    ASSERT_EQ(base::Handle::unpack(h.pack()), h);
+    ASSERT_EQ(h.pack() & 0xFFFFFFFF, 123);
+}
+
+TEST(HandlePool, Segments) {
+    auto pool    = base::HandlePool();
+    auto handles = std::vector<base::Handle>();
+
+    for (U32 i = 0; i < 100000; ++i) {
+        handles.push_back(pool.allocate());
+        ASSERT_EQ(handles.back().index, i);
+    }
+
+    for (auto& h : handles)
+        ASSERT_TRUE(pool.release(h));
+
+    for (auto& h : handles)
+        ASSERT_FALSE(pool.valid(h));
+
+    ASSERT_EQ(pool.slots_count(), 100000);
+}
+
+TEST(HandlePool, Reset) {
+    auto pool = base::HandlePool();
+    auto a    = pool.allocate();
+
+    pool.reset();
+
+    ASSERT_FALSE(pool.valid(a));
+    ASSERT_EQ(pool.slots_count(), 0);
+
+    auto b = pool.allocate();
+    ASSERT_EQ(b.index, a.index);
+    ASSERT_TRUE(pool.valid(b));
+}
+
+TEST(HandlePool, ConcurrentProducers) {
+    constexpr U32 threads_count = 8;
+    constexpr U32 held          = 64;   // Handles held by each thread at once
+    constexpr U32 iterations    = 20000;
+
+    auto pool   = base::HandlePool();
+    auto owners = std::vector<std::atomic<U32>>(threads_count * (held + 1));
+    auto errors = std::atomic<U32>(0);
+
+    auto producer = [&](U32 thread) {
+        auto own = std::vector<base::Handle>();
+        own.reserve(held);
+
+        for (U32 i = 0; i < iterations; ++i) {
+            // Interleave threads even on single core
+            if (i % 256 == 0)
+                std::this_thread::yield();
+
+            if (own.size() < held && (i % 3 != 2 || own.empty())) {
+                auto h = pool.allocate();
+
+                // Nobody else may own this slot
+                if (h.index >= owners.size() || owners[h.index].exchange(thread + 1) != 0)
+                    ++errors;
+
+                own.push_back(h);
+            }
+            else {
+                auto h = own[i % own.size()];
+                own[i % own.size()] = own.back();
+                own.pop_back();
+
+                if (h.index < owners.size() && owners[h.index].exchange(0) != thread + 1)
+                    ++errors;
+
+                if (!pool.release(h) || pool.release(h) || pool.valid(h))
+                    ++errors;
+            }
+        }
+
+        for (auto& h : own) {
+            owners[h.index].store(0);
+            if (!pool.release(h))
+                ++errors;
+        }
+    };
+
+    auto threads = std::vector<std::thread>();
+    for (U32 t = 0; t < threads_count; ++t)
+        threads.emplace_back(producer, t);
+    for (auto& t : threads)
+        t.join();
+
+    ASSERT_EQ(errors.load(), 0);
+
+    // Freed slots are reused, pool grows only by handles held at once and released ones not recycled yet
+    ASSERT_LE(pool.slots_count(), threads_count * (held + 1));
+
+    auto unique = std::vector<bool>(pool.slots_count(), false);
+    for (U32 i = 0; i < pool.slots_count(); ++i) {
+        auto h = pool.allocate();
+        ASSERT_LT(h.index, unique.size());
+        ASSERT_FALSE(unique[h.index]);
+        unique[h.index] = true;
+    }
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include "../base/jobs.hpp"
+#include "../base/ftl/vector.hpp"
+
+TEST(JobSystem, SubmitWait) {
+    auto counter = base::JobCounter();
+    auto sum     = std::atomic<U64>(0);
+
+    for (U64 i = 1; i <= 1000; ++i)
+        base::job_system().submit([&sum, i] { sum += i; }, &counter);
+
+    base::job_system().wait(counter);
+
+    ASSERT_TRUE(counter.done());
+    ASSERT_EQ(sum.load(), 500500);
+}
+
+TEST(JobSystem, ParallelFor) {
+    auto data = ftl::Vector<U32>(100003, 0);
+
+    base::job_system().parallel_for(data.size(), 64, [&data](SizeT start, SizeT end) {
+        for (SizeT i = start; i < end; ++i)
+            data[i] += static_cast<U32>(i);
+    });
+
+    for (SizeT i = 0; i < data.size(); ++i)
+        ASSERT_EQ(data[i], i);
+}
+
+TEST(JobSystem, NestedForkJoin) {
+    auto sums = ftl::Vector<U64>(64, 0);
+
+    base::job_system().parallel_for(sums.size(), 1, [&sums](SizeT start, SizeT end) {
+        for (SizeT i = start; i < end; ++i) {
+            auto partial = std::atomic<U64>(0);
+
+            base::job_system().parallel_for(1000, 10, [&partial](SizeT s, SizeT e) {
+                U64 local = 0;
+                for (SizeT j = s; j < e; ++j)
+                    local += j;
+                partial += local;
+            });
+
+            sums[i] = partial.load();
+        }
+    });
+
+    for (auto s : sums)
+        ASSERT_EQ(s, 499500);
+}
+
+TEST(JobSystem, InjectedOverflow) {
+    auto counter = base::JobCounter();
+    auto sum     = std::atomic<U64>(0);
+
+    // More jobs than injected ring holds: overflow is executed by submitting thread
+    for (U64 i = 1; i <= 100000; ++i)
+        base::job_system().submit([&sum, i] { sum += i; }, &counter);
+
+    base::job_system().wait(counter);
+
+    ASSERT_EQ(sum.load(), 5000050000);
+}
@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "../base/filesystem.hpp"
+#include "../base/logs.hpp"
+
+TEST(Logs, MpscRingOrder) {
+    constexpr U64 PRODUCERS = 4;
+    constexpr U64 COUNT     = 100000;
+
+    auto ring    = base::logs_dtls::MpscRing<U64>(1024);
+    auto threads = std::vector<std::thread>();
+
+    for (U64 p = 0; p < PRODUCERS; ++p) {
+        threads.emplace_back([&ring, p] {
+            for (U64 i = 0; i < COUNT; ++i)
+                while (!ring.try_push([&](U64& value) { value = (p << 32) | i; }))
+                    std::this_thread::yield();
+        });
+    }
+
+    auto next = std::vector<U64>(PRODUCERS, 0);
+    for (U64 received = 0; received < PRODUCERS * COUNT;) {
+        auto popped = ring.try_pop([&](U64& value) {
+            auto producer = value >> 32;
+            ASSERT_LT(producer, PRODUCERS);
+            ASSERT_EQ(value & 0xffffffff, next[producer]);
+            ++next[producer];
+        });
+
+        if (popped)
+            ++received;
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    for (auto count : next)
+        ASSERT_EQ(count, COUNT);
+    ASSERT_FALSE(ring.try_pop([](U64&) {}));
+}
+
+TEST(Logs, FlushAndJournal) {
+    auto& logger = base::Logger::instance();
+    logger.setConsoleOutput(false).setAttachedToJournal(true).setJournalMaxSize(4);
+
+    for (int i = 0; i < 10; ++i)
+        base::Log("journal test {}", i);
+    base::Log("{}", std::string(1000, 'x'));
+    logger.flush();
+
+    auto journal = logger.getJournal();
+    ASSERT_EQ(journal.size(), 4);
+    ASSERT_EQ(journal[0].text(), "journal test 7");
+    ASSERT_EQ(journal[2].text(), "journal test 9");
+    ASSERT_EQ(journal[3].text(), std::string(1000, 'x'));
+
+    // [hh:mm:ss:xxx]:
+    auto time = journal[0].time();
+    ASSERT_EQ(time.size(), 16);
+    ASSERT_EQ(time.front(), '[');
+    ASSERT_EQ(time.substr(13), "]: ");
+
+    // Shrinking keeps the newest entries
+    logger.setJournalMaxSize(2);
+    journal = logger.getJournal();
+    ASSERT_EQ(journal.size(), 2);
+    ASSERT_EQ(journal[0].text(), "journal test 9");
+    ASSERT_EQ(journal[1].text(), std::string(1000, 'x'));
+
+    logger.setConsoleOutput(true).setAttachedToJournal(false).setJournalMaxSize(100);
+}
+
+namespace {
+    template <typename... ArgsT>
+    std::string encode_args(const ArgsT&... args) {
+        auto buffer = std::string((base::blog::arg_size(args) + ... + SizeT(0)), '\0');
+        [[maybe_unused]] auto out = reinterpret_cast<Byte*>(buffer.data());
+        ((out = base::blog::encode_arg(out, args)), ...);
+        return buffer;
+    }
+}
+
+TEST(Logs, DeferredFormat) {
+    using base::blog::ArgType;
+
+    auto id = base::blog::register_format("{} {} {} {} {} {:.2f}", __FILE__, __LINE__,
+            {ArgType::Int32, ArgType::UInt64, ArgType::Char, ArgType::Bool, ArgType::String, ArgType::Float64});
+    auto& format = base::blog::format_info(id);
+    ASSERT_EQ(format.types.size(), 6);
+
+    auto args = encode_args(-5, U64(1) << 40, 'c', true, ftl::String("str"), 2.25);
+    auto text = base::blog::format_message(format, reinterpret_cast<const Byte*>(args.data()), args.size());
+    ASSERT_TRUE(text.has_value());
+    ASSERT_EQ(*text, "-5 1099511627776 c true str 2.25");
+
+    // Truncated arguments
+    ASSERT_FALSE(base::blog::format_message(format, reinterpret_cast<const Byte*>(args.data()), args.size() - 1));
+}
+
+TEST(Logs, DeferredJournal) {
+    auto& logger = base::Logger::instance();
+    logger.setConsoleOutput(false).setAttachedToJournal(true);
+
+    for (int i = 0; i < 3; ++i)
+        DE_BLOG(Info, General, "deferred {} {} '{}'", i, 0.5f, "text");
+    DE_BLOG(Info, General, "no arguments");
+    logger.flush();
+
+    auto journal = logger.getJournal();
+    ASSERT_GE(journal.size(), 4);
+    ASSERT_EQ(journal[journal.size() - 2].text(), "deferred 2 0.5 'text'");
+    ASSERT_EQ(journal.back().text(), "no arguments");
+
+    logger.setConsoleOutput(true).setAttachedToJournal(false);
+}
+
+TEST(Logs, BinaryLogRoundTrip) {
+    using base::blog::ArgType;
+
+    auto id   = base::blog::register_format("value = {}, name = {}", __FILE__, __LINE__, {ArgType::UInt16, ArgType::String});
+    auto log  = std::string();
+    auto args = encode_args(U16(512), std::string_view("decay"));
+
+    base::blog::write_header(log);
+    base::blog::write_text_chunk(log, 1000000000, base::LogLevel::Info, base::LogCategory::General, "start");
+    base::blog::write_format_chunk(log, id, base::blog::format_info(id));
+    base::blog::write_message_chunk(log, 2000000000, base::LogLevel::Error, base::LogCategory::Io,
+                                    id, reinterpret_cast<const Byte*>(args.data()), args.size());
+
+    auto path = ftl::String(base::fs::current_path() / "test.blog");
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(log.data()), log.size());
+
+    auto texts = std::vector<std::string>();
+    auto times = std::vector<S64>();
+    auto read  = [&](std::chrono::system_clock::time_point time, base::LogLevel level, base::LogCategory category,
+                     std::string_view text) {
+        times.push_back(std::chrono::duration_cast<std::chrono::seconds>(time.time_since_epoch()).count());
+        texts.emplace_back();
+        base::appendLogPrefix(texts.back(), level, category);
+        texts.back().append(text);
+    };
+
+    ASSERT_TRUE(base::blog::read_log(path.c_str(), read));
+    ASSERT_EQ(texts, (std::vector<std::string>{"start", "ERROR [io] value = 512, name = decay"}));
+    ASSERT_EQ(times, (std::vector<S64>{1, 2}));
+
+    // Cut in the middle of message
+    texts.clear();
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(log.data()), log.size() - 3);
+    ASSERT_FALSE(base::blog::read_log(path.c_str(), read));
+    ASSERT_EQ(texts.size(), 1);
+
+    std::remove(path.c_str());
+}
+
+TEST(Logs, LevelsAndCategories) {
+    auto& logger = base::Logger::instance();
+    logger.setConsoleOutput(false).setAttachedToJournal(true);
+
+    base::setLogThreshold(base::LogCategory::Io, base::LogLevel::Warning);
+
+    auto evaluated = 0;
+    auto arg       = [&] { return ++evaluated; };
+
+    DE_LOG(Info, Io, "skipped {}", arg());
+    DE_BLOG(Debug, Io, "skipped {}", arg());
+    DE_LOG(Warning, Io, "can't read '{}'", "file");
+    DE_LOG(Error, Graphics, "shader {}", arg());
+    DE_BLOG(Error, Lua, "script error {}", 1);
+    logger.flush();
+
+    ASSERT_EQ(evaluated, 1);
+
+    auto journal = logger.getJournal();
+    ASSERT_GE(journal.size(), 3);
+    ASSERT_EQ(journal[journal.size() - 3].text(), "WARNING [io] can't read 'file'");
+    ASSERT_EQ(journal[journal.size() - 2].text(), "ERROR [graphics] shader 1");
+    ASSERT_EQ(journal.back().text(), "ERROR [lua] script error 1");
+
+    ASSERT_EQ(base::logLevelFromName("warning"), base::LogLevel::Warning);
+    ASSERT_FALSE(base::logLevelFromName("verbose").has_value());
+
+    base::setLogThreshold(base::LogCategory::Io, base::LogLevel::Trace);
+    logger.setConsoleOutput(true).setAttachedToJournal(false);
+}
@@ -1,6 +1,10 @@
 #include <gtest/gtest.h>
 
+#include <deque>
+#include <thread>
+
 #include "../base/ftl/ring.hpp"
+#include "../base/ftl/concurrent_ring.hpp"
 
 TEST(RingTests, Reduce) {
     // Reduce with string return type
@@ -228,4 +232,184 @@ TEST(RingTests, BasicTests) {
     deque.resize(100, 228);
     ring .resize(100, 228);
     ASSERT_EQ(1, std::equal(deque.cbegin(), deque.cend(), ring.cbegin()));
-}
\ No newline at end of file
+}
+
+TEST(RingTests, SpscBasic) {
+    auto ring = ftl::SpscRing<std::string>(4);
+    auto str  = std::string();
+
+    ASSERT_TRUE(ring.empty());
+    ASSERT_FALSE(ring.try_pop_front(str));
+
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(ring.try_emplace_back(std::to_string(i)));
+    ASSERT_FALSE(ring.try_push_back("full"));
+    ASSERT_EQ(ring.size(), 4);
+
+    ASSERT_EQ(*ring.front(), "0");
+    ring.pop_front();
+    ASSERT_TRUE(ring.try_pop_front(str));
+    ASSERT_EQ(str, "1");
+
+    // Batch wraps around the end of storage
+    auto in = std::vector<std::string>{"a", "b", "c"};
+    ASSERT_EQ(ring.try_push_back(in.begin(), in.end()), 2);
+
+    auto out = std::vector<std::string>();
+    ASSERT_EQ(ring.try_pop_front(std::back_inserter(out), 10), 4);
+    ASSERT_EQ(out, (std::vector<std::string>{"2", "3", "a", "b"}));
+    ASSERT_TRUE(ring.empty());
+
+    // Consumer iterates published values and releases them
+    for (auto& str : {"x", "y", "z"})
+        ring.push_back(str);
+
+    auto joined = std::string();
+    for (auto& str : ring)
+        joined += str;
+    ASSERT_EQ(joined, "xyz");
+    ASSERT_EQ(ring.end() - ring.begin(), 3);
+    ASSERT_EQ(ring.cbegin()[1], "y");
+    ASSERT_TRUE(std::is_sorted(ring.begin(), ring.end()));
+
+    ring.pop_front(2);
+    ASSERT_EQ(*ring.front(), "z");
+    ASSERT_EQ(ring.size(), 1);
+
+    // Not popped values are destroyed with ring
+    ring.push_back(std::string(100, 'x'));
+}
+
+TEST(RingTests, MpmcBasic) {
+    auto ring = ftl::MpmcRing<std::string>(4);
+    auto str  = std::string();
+
+    ASSERT_FALSE(ring.try_pop_front(str));
+
+    for (int i = 0; i < 4; ++i)
+        ASSERT_TRUE(ring.try_emplace_back(std::to_string(i)));
+    ASSERT_FALSE(ring.try_push_back("full"));
+
+    ASSERT_TRUE(ring.try_pop_front(str));
+    ASSERT_EQ(str, "0");
+
+    auto in = std::vector<std::string>{"a", "b"};
+    ASSERT_EQ(ring.try_push_back(in.begin(), in.end()), 1);
+
+    auto out = std::vector<std::string>();
+    ASSERT_EQ(ring.try_pop_front(std::back_inserter(out), 3), 3);
+    ASSERT_EQ(out, (std::vector<std::string>{"1", "2", "3"}));
+    ASSERT_EQ(ring.size(), 1);
+
+    ring.push_back(std::string(100, 'x'));
+}
+
+TEST(RingTests, SpscStress) {
+    constexpr U64 count = 1000000;
+    auto ring = ftl::SpscRing<U64>(1024);
+
+    auto producer = std::thread([&] {
+        U64 batch[7];
+        for (U64 i = 0; i < count;) {
+            // Mix single and batch pushes
+            if (i % 3) {
+                ring.push_back(i++);
+                continue;
+            }
+
+            auto n = std::min<U64>(7, count - i);
+            for (U64 j = 0; j < n; ++j)
+                batch[j] = i + j;
+            i += ring.try_push_back(batch, batch + n);
+        }
+    });
+
+    U64 expected = 0;
+    U64 batch[13];
+
+    while (expected < count) {
+        auto n = ring.try_pop_front(batch, 13);
+        for (SizeT j = 0; j < n; ++j)
+            ASSERT_EQ(batch[j], expected++);
+
+        if (auto value = ring.front()) {
+            ASSERT_EQ(*value, expected++);
+            ring.pop_front();
+        }
+
+        auto seen = SizeT(0);
+        for (auto value : ring) {
+            ASSERT_EQ(value, expected++);
+            ++seen;
+        }
+        ring.pop_front(seen);
+    }
+
+    producer.join();
+    ASSERT_TRUE(ring.empty());
+}
+
+TEST(RingTests, MpmcStress) {
+    constexpr U64 per_producer = 200000;
+
+    for (SizeT threads : {1, 2, 4, 8}) {
+        auto ring     = ftl::MpmcRing<U64>(256);
+        auto sum      = std::atomic<U64>(0);
+        auto popped   = std::atomic<U64>(0);
+        auto workers  = std::vector<std::thread>();
+        auto total    = per_producer * threads;
+
+        for (SizeT t = 0; t < threads; ++t) {
+            // Producer t pushes t*per_producer + [1, per_producer], values of each producer come in order
+            workers.emplace_back([&ring, t] {
+                U64 batch[5];
+                for (U64 i = 1; i <= per_producer;) {
+                    if (i % 2) {
+                        ring.push_back(t * per_producer + i++);
+                        continue;
+                    }
+
+                    auto n = std::min<U64>(5, per_producer - i + 1);
+                    for (U64 j = 0; j < n; ++j)
+                        batch[j] = t * per_producer + i + j;
+                    i += ring.try_push_back(batch, batch + n);
+                }
+            });
+
+            workers.emplace_back([&] {
+                auto last = std::vector<U64>(threads, 0);
+                U64  batch[9];
+
+                auto check = [&](U64 value) {
+                    auto producer = (value - 1) / per_producer;
+                    EXPECT_LT(last[producer], value);
+                    last[producer] = value;
+                    sum += value;
+                };
+
+                while (popped.load() < total) {
+                    auto n = ring.try_pop_front(batch, 9);
+                    for (SizeT j = 0; j < n; ++j)
+                        check(batch[j]);
+
+                    auto value = U64(0);
+                    if (ring.try_pop_front(value)) {
+                        check(value);
+                        ++n;
+                    }
+
+                    popped += n;
+                    if (!n)
+                        std::this_thread::yield();
+                }
+            });
+        }
+
+        for (auto& w : workers)
+            w.join();
+
+        ASSERT_EQ(popped.load(), total);
+        ASSERT_EQ(sum.load(), total * (total + 1) / 2);
+        ASSERT_TRUE(ring.empty());
+    }
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+#include "../base/files.hpp"
+#include "../base/filesystem.hpp"
+#include "../graphics/TextureCache.hpp"
+
+namespace {
+    using grx_txtr::TextureFormat;
+
+    // Diagonal color ramp with vertical alpha ramp. Colors of each block lie on a line,
+    // so block compression error on it is small
+    grx_txtr::DecodedImage gradient(U32 width, U32 height) {
+        auto image = grx_txtr::DecodedImage();
+        image.width  = width;
+        image.height = height;
+        image.pixels.resize(SizeT(width) * height * 4);
+
+        for (U32 y = 0; y < height; ++y) {
+            for (U32 x = 0; x < width; ++x) {
+                auto px = image.pixels.data() + (SizeT(y) * width + x) * 4;
+                auto t = (x + y) * 255 / (width + height);
+                px[0] = static_cast<U8>(t);
+                px[1] = static_cast<U8>(255 - t);
+                px[2] = static_cast<U8>(t / 2);
+                px[3] = static_cast<U8>(255 - y * 255 / height);
+            }
+        }
+
+        return image;
+    }
+
+    int max_error(const grx_txtr::DecodedImage& a, const grx_txtr::DecodedImage& b, SizeT channels) {
+        int error = 0;
+        for (SizeT i = 0; i < a.pixels.size(); i += 4)
+            for (SizeT c = 0; c < channels; ++c)
+                error = std::max(error, std::abs(int(a.pixels[i + c]) - int(b.pixels[i + c])));
+        return error;
+    }
+}
+
+TEST(TextureCache, MipChain) {
+    auto mips = grx_txtr::build_mips(gradient(64, 16));
+
+    ASSERT_EQ(mips.size(), 7);
+    ASSERT_EQ(mips[1].width,  32);
+    ASSERT_EQ(mips[1].height, 8);
+    ASSERT_EQ(mips[5].width,  2);
+    ASSERT_EQ(mips[5].height, 1);
+    ASSERT_EQ(mips[6].width,  1);
+    ASSERT_EQ(mips[6].height, 1);
+
+    for (auto& mip : mips)
+        ASSERT_EQ(mip.size_bytes(), SizeT(mip.width) * mip.height * 4);
+}
+
+TEST(TextureCache, RoundTrip) {
+    auto image = gradient(40, 24); // Not multiple of block size on the last blocks
+
+    struct {
+        TextureFormat format;
+        SizeT         channels;
+        int           max_error; // On the first level
+    } cases[] = {
+        {TextureFormat::RGBA8, 4, 0},
+        {TextureFormat::BC1,   3, 6},
+        {TextureFormat::BC3,   4, 6},
+        {TextureFormat::BC5,   2, 3}
+    };
+
+    for (auto& c : cases) {
+        auto bytes  = grx_txtr::cook_texture(image, c.format, 0xDEADBEEF);
+        auto cooked = grx_txtr::CookedTexture(bytes);
+
+        ASSERT_TRUE(cooked.valid());
+        ASSERT_EQ(cooked.format(),      c.format);
+        ASSERT_EQ(cooked.width(),       image.width);
+        ASSERT_EQ(cooked.height(),      image.height);
+        ASSERT_EQ(cooked.mips_count(),  6);
+        ASSERT_EQ(cooked.source_hash(), 0xDEADBEEF);
+
+        auto mips = grx_txtr::build_mips(image);
+        for (U32 level = 0; level < cooked.mips_count(); ++level) {
+            auto mip = cooked.mip(level);
+            ASSERT_EQ(mip.width,  mips[level].width);
+            ASSERT_EQ(mip.height, mips[level].height);
+            ASSERT_EQ(mip.size,   grx_txtr::compressed_size(c.format, mip.width, mip.height));
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(mip.data) % 16, 0);
+
+            // Ramp inside of block is twice steeper on each next level
+            auto decoded = grx_txtr::decompress_image(c.format, mip.data, mip.width, mip.height);
+            ASSERT_LE(max_error(decoded, mips[level], c.channels), c.max_error << level) << "level " << level;
+        }
+    }
+}
+
+TEST(TextureCache, AutoFormat) {
+    auto image = gradient(8, 8);
+    ASSERT_EQ(grx_txtr::auto_format(image), TextureFormat::BC3);
+
+    for (SizeT i = 3; i < image.pixels.size(); i += 4)
+        image.pixels[i] = 255;
+    ASSERT_EQ(grx_txtr::auto_format(image), TextureFormat::BC1);
+}
+
+TEST(TextureCache, MapFile) {
+    auto bytes = grx_txtr::cook_texture(gradient(16, 16), TextureFormat::BC1, 42);
+    auto path  = base::fs::current_path() / "test.dtx";
+
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(bytes.data()), bytes.size());
+
+    {
+        auto cooked = grx_txtr::CookedTexture::map(path.c_str());
+        ASSERT_TRUE(cooked.valid());
+        ASSERT_EQ(cooked.source_hash(), 42);
+        ASSERT_EQ(cooked.bytes_size(), bytes.size());
+
+        auto in_memory = grx_txtr::CookedTexture(bytes);
+        auto mip       = cooked.mip(0);
+        auto expected  = in_memory.mip(0);
+        ASSERT_EQ(mip.size, expected.size);
+        ASSERT_EQ(std::memcmp(mip.data, expected.data, mip.size), 0);
+    }
+
+    // Truncated container is rejected
+    base::writeBytesToFile(path, reinterpret_cast<const Byte*>(bytes.data()), bytes.size() / 2);
+    ASSERT_FALSE(grx_txtr::CookedTexture::map(path.c_str()).valid());
+
+    std::remove(path.c_str());
+    ASSERT_FALSE(grx_txtr::CookedTexture::map(path.c_str()).valid());
+}
+
+TEST(TextureCache, FirstRunCook) {
+    auto source = std::string((base::fs::current_path().parent_path() / "gamedata/textures/dummy.tga").c_str());
+    auto cache  = std::string((base::fs::current_path() / "test_cache.dtx").c_str());
+
+    std::remove(cache.c_str());
+
+    auto cooked = grx_txtr::load_cooked(source, cache, TextureFormat::BC1);
+    ASSERT_TRUE(cooked.valid());
+    ASSERT_EQ(cooked.format(), TextureFormat::BC1);
+
+    // Second load maps file written on the first one
+    auto mapped = grx_txtr::CookedTexture::map(cache);
+    ASSERT_TRUE(mapped.valid());
+    ASSERT_EQ(mapped.source_hash(), cooked.source_hash());
+
+    auto cached = grx_txtr::load_cooked(source, cache, TextureFormat::BC1);
+    ASSERT_TRUE(cached.valid());
+    ASSERT_EQ(cached.format(), TextureFormat::BC1);
+
+    auto any = grx_txtr::load_cooked(source, cache, std::nullopt);
+    ASSERT_EQ(any.format(), TextureFormat::BC1);
+
+    // Other format is cooked again
+    auto recooked = grx_txtr::load_cooked(source, cache, TextureFormat::RGBA8);
+    ASSERT_TRUE(recooked.valid());
+    ASSERT_EQ(recooked.format(), TextureFormat::RGBA8);
+    ASSERT_EQ(grx_txtr::CookedTexture::map(cache).format(), TextureFormat::RGBA8);
+
+    std::remove(cache.c_str());
+}
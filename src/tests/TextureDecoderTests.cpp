@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "../base/filesystem.hpp"
+#include "../base/jobs.hpp"
+#include "../graphics/TextureDecoder.hpp"
+
+namespace {
+    std::string texture_path(const char* name) {
+        return std::string((base::fs::current_path().parent_path() / "gamedata/textures/").c_str()) + name;
+    }
+}
+
+TEST(TextureDecoder, DecodeToRgba) {
+    for (auto name : {"dummy.tga", "dummy_normal_map.png"}) {
+        auto image = grx_txtr::decode_image(texture_path(name));
+
+        ASSERT_TRUE(image.valid());
+        ASSERT_GT(image.width,  0);
+        ASSERT_GT(image.height, 0);
+        ASSERT_EQ(image.size_bytes(), SizeT(image.width) * image.height * 4);
+    }
+}
+
+TEST(TextureDecoder, InvalidInput) {
+    ASSERT_FALSE(grx_txtr::decode_image(texture_path("not_exists.png")).valid());
+
+    auto garbage = std::vector<U8>(64, 0xAB);
+    ASSERT_FALSE(grx_txtr::decode_image(garbage.data(), garbage.size(), "garbage.png").valid());
+}
+
+TEST(TextureDecoder, ParallelDecodeMatchesSerial) {
+    auto path     = texture_path("dummy_normal_map.png");
+    auto expected = grx_txtr::decode_image(path);
+    ASSERT_TRUE(expected.valid());
+
+    auto images  = std::vector<grx_txtr::DecodedImage>(64);
+    auto counter = base::JobCounter();
+
+    for (SizeT i = 0; i < images.size(); ++i)
+        base::job_system().submit([&, i] { images[i] = grx_txtr::decode_image(path); }, &counter);
+    base::job_system().wait(counter);
+
+    for (auto& image : images) {
+        ASSERT_EQ(image.width,  expected.width);
+        ASSERT_EQ(image.height, expected.height);
+        ASSERT_EQ(image.pixels, expected.pixels);
+    }
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <map>
+
+#include <GL/glew.h>
+
+#include "../base/configs.hpp"
+#include "../base/filesystem.hpp"
+#include "../graphics/TextureManager.hpp"
+
+/*
+ * Tests run without GL context: GL entry points used by TextureManager are replaced
+ * with fakes which remember internal format of level 0 of each texture
+ */
+namespace {
+    GLuint                  next_texture  = 1;
+    GLuint                  bound_texture = 0;
+    std::map<GLuint, GLint> texture_formats;
+
+    void GLAPIENTRY fakeCompressedTexImage2D(GLenum, GLint level, GLenum internalformat, GLsizei, GLsizei, GLint,
+                                             GLsizei, const void*) {
+        if (level == 0)
+            texture_formats[bound_texture] = static_cast<GLint>(internalformat);
+    }
+}
+
+PFNGLCOMPRESSEDTEXIMAGE2DPROC __glewCompressedTexImage2D         = fakeCompressedTexImage2D;
+GLboolean                     __GLEW_EXT_texture_compression_s3tc = GL_TRUE;
+
+void GLAPIENTRY glGenTextures(GLsizei n, GLuint* textures) {
+    for (GLsizei i = 0; i < n; ++i)
+        textures[i] = next_texture++;
+}
+
+void GLAPIENTRY glDeleteTextures(GLsizei n, const GLuint* textures) {
+    for (GLsizei i = 0; i < n; ++i)
+        texture_formats.erase(textures[i]);
+}
+
+void GLAPIENTRY glBindTexture(GLenum, GLuint texture) {
+    bound_texture = texture;
+}
+
+void GLAPIENTRY glTexImage2D(GLenum, GLint level, GLint internalformat, GLsizei, GLsizei, GLint, GLenum, GLenum,
+                             const void*) {
+    if (level == 0)
+        texture_formats[bound_texture] = internalformat;
+}
+
+void GLAPIENTRY glTexParameteri(GLenum, GLenum, GLint) {}
+
+
+TEST(TextureManager, DiffuseAndNormalMapOfOnePath) {
+    // Other tests may leave their own config files loaded, textures_dir is in fs.cfg
+    auto& storage = base::cfg_detls::cfgStorage();
+    auto  entries = base::cfg_detls::cfg_state().getEntries();
+    storage.load({base::fs::current_path().parent_path() / "fs.cfg"});
+
+    auto& manager = grx::texture_manager();
+
+    auto diffuse = manager.load("dummy.tga");
+    auto normal  = manager.load("dummy.tga", grx_txtr::Placeholder::NormalMap);
+
+    // Same path with other placeholder takes its own slot, same placeholder shares slot
+    ASSERT_NE(diffuse, normal);
+    ASSERT_EQ(manager.load("dummy.tga"), diffuse);
+    ASSERT_EQ(manager.load("dummy.tga", grx_txtr::Placeholder::NormalMap), normal);
+
+    manager.finish();
+    ASSERT_TRUE(manager.ready(diffuse));
+    ASSERT_TRUE(manager.ready(normal));
+
+    // Diffuse texture is block compressed, normal map is uploaded as RGBA8
+    auto diffuse_format = texture_formats.at(manager.glID(diffuse));
+    ASSERT_TRUE(diffuse_format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || diffuse_format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+    ASSERT_EQ(texture_formats.at(manager.glID(normal)), GL_RGBA);
+
+    // Each path and placeholder is loaded twice above, destroy releases one reference of each kind
+    auto diffuse_id = manager.glID(diffuse);
+    auto normal_id  = manager.glID(normal);
+
+    manager.release(diffuse);
+    manager.release(normal);
+    manager.destroy("dummy.tga");
+
+    ASSERT_FALSE(manager.ready(diffuse));
+    ASSERT_FALSE(manager.ready(normal));
+    ASSERT_EQ(texture_formats.count(diffuse_id), 0);
+    ASSERT_EQ(texture_formats.count(normal_id),  0);
+
+    storage.load(entries);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "../base/compression.hpp"
+#include "../base/filesystem.hpp"
+#include "../base/vfs.hpp"
+
+namespace {
+    ftl::Vector<Byte> test_bytes(SizeT size, bool repetitive) {
+        auto bytes = ftl::Vector<Byte>(size);
+        auto state = U32(12345);
+
+        for (SizeT i = 0; i < size; ++i) {
+            state = state * 1103515245 + 12345;
+            bytes[i] = repetitive ? Byte("decay engine "[(i / 7) % 13]) : Byte(state >> 16);
+        }
+
+        return bytes;
+    }
+
+    void write_text(const ftl::String& path, const std::string& text) {
+        base::writeBytesToFile(path, reinterpret_cast<const Byte*>(text.data()), text.size());
+    }
+}
+
+TEST(Vfs, Lz4RoundTrip) {
+    for (auto size : {0, 1, 5, 12, 13, 100, 4096, 70000, 300000}) {
+        for (auto repetitive : {false, true}) {
+            auto src    = test_bytes(static_cast<SizeT>(size), repetitive);
+            auto packed = base::lz4::compress(src.data(), src.size());
+            auto dst    = ftl::Vector<Byte>(src.size());
+
+            ASSERT_LE(packed.size(), base::lz4::compress_bound(src.size()));
+            ASSERT_TRUE(base::lz4::decompress(packed.data(), packed.size(), dst.data(), dst.size()));
+            ASSERT_TRUE(src == dst) << "size " << size;
+
+            if (repetitive && size >= 4096)
+                ASSERT_LT(packed.size(), src.size() / 4);
+        }
+    }
+}
+
+TEST(Vfs, Lz4Corrupted) {
+    auto src    = test_bytes(10000, true);
+    auto packed = base::lz4::compress(src.data(), src.size());
+    auto dst    = ftl::Vector<Byte>(src.size());
+
+    ASSERT_FALSE(base::lz4::decompress(packed.data(), packed.size() / 2, dst.data(), dst.size()));
+    ASSERT_FALSE(base::lz4::decompress(packed.data(), packed.size(), dst.data(), dst.size() - 1));
+}
+
+TEST(Vfs, NormalizePath) {
+    ASSERT_EQ(base::normalizePath("gamedata//textures/./dummy.tga"), "gamedata/textures/dummy.tga");
+    ASSERT_EQ(base::normalizePath("/a/b/../c/"), "/a/c");
+    ASSERT_EQ(base::normalizePath("/../a"), "/a");
+    ASSERT_EQ(base::normalizePath("../a/./b"), "../a/b");
+    ASSERT_EQ(base::normalizePath("/"), "/");
+    ASSERT_EQ(base::normalizePath(""), "");
+}
+
+TEST(Vfs, ArchiveOverlay) {
+    auto& vfs     = base::vfs();
+    auto  src_dir = base::fs::current_path() / "vfs_src";
+    auto  dir     = base::fs::current_path() / "vfs_test";
+    auto  archive = base::fs::current_path() / "vfs_test.dpk";
+    auto  vdir    = *vfs.virtual_path(dir.c_str());
+
+    auto compressible = test_bytes(50000, true);
+    base::writeBytesToFile(src_dir / "packed.bin", compressible);
+    write_text(src_dir / "stored.txt", "stored");
+    write_text(src_dir / "override.txt", "archive");
+
+    auto sources = ftl::Vector<base::PackSource>();
+    sources.push_back(base::PackSource{vdir / "packed.bin",   src_dir / "packed.bin"});
+    sources.push_back(base::PackSource{vdir / "stored.txt",   src_dir / "stored.txt"});
+    sources.push_back(base::PackSource{vdir / "override.txt", src_dir / "override.txt"});
+
+    auto stats = base::writePackArchive(archive, sources, base::PackCompression::LZ4);
+    ASSERT_EQ(stats.files_count, 3);
+    ASSERT_LT(stats.packed_size, stats.original_size);
+
+    auto pack = base::PackArchive::openOpt(archive.c_str());
+    ASSERT_TRUE(pack.has_value());
+    ASSERT_EQ(pack->size(), 3);
+    ASSERT_NE(pack->find((vdir / "stored.txt").c_str()), nullptr);
+    ASSERT_EQ(pack->find((vdir / "missing.txt").c_str()), nullptr);
+
+    ASSERT_TRUE(vfs.mount_archive(archive));
+    // Loose files are searched after the archive only if mounted over it
+    vfs.mount_dir(vfs.data_root());
+    write_text(dir / "override.txt", "loose");
+
+    auto packed = vfs.open((vdir / "packed.bin").c_str());
+    ASSERT_TRUE(packed.has_value());
+    ASSERT_EQ(packed->size(), compressible.size());
+    ASSERT_EQ(std::memcmp(packed->data(), compressible.data(), compressible.size()), 0);
+
+    // Absolute paths from to_data_path resolve to the same entries
+    auto stored = vfs.open((dir / "stored.txt").c_str());
+    ASSERT_TRUE(stored.has_value());
+    ASSERT_EQ(stored->view(), "stored");
+
+    auto overridden = vfs.open((vdir / "override.txt").c_str());
+    ASSERT_TRUE(overridden.has_value());
+    ASSERT_EQ(overridden->view(), "loose");
+
+    ASSERT_TRUE(vfs.exists((vdir / "stored.txt").c_str()));
+    ASSERT_FALSE(vfs.exists((vdir / "missing.txt").c_str()));
+    ASSERT_FALSE(vfs.open((vdir / "missing.txt").c_str()).has_value());
+
+    std::remove((src_dir / "packed.bin").c_str());
+    std::remove((src_dir / "stored.txt").c_str());
+    std::remove((src_dir / "override.txt").c_str());
+    std::remove((dir / "override.txt").c_str());
+    std::remove(archive.c_str());
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <random>
+#include <cstring>
 #include <functional>
 #include "../base/baseTypes.hpp"
 #include "../base/allocators/ObjectPool.hpp"
@@ -56,4 +57,93 @@ TEST(ObjectPool, Validation) {
     ASSERT_EQ(*g, DummyConstructorClass(7, 0, -1));
     ASSERT_EQ(*h, DummyConstructorClass(0, 2, 444));
     ASSERT_EQ(*i, DummyConstructorClass(11, 22, 44));
-}
\ No newline at end of file
+}
+
+#include "../base/allocators/Arena.hpp"
+#include "../base/ftl/vector.hpp"
+
+TEST(Arena, AllocationAndRewind) {
+    auto arena = base::Arena(256);
+
+    auto a = arena.allocate(10, 1);
+    auto b = arena.allocate(16, 16);
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(b) % 16, 0);
+    ASSERT_GE(static_cast<Byte*>(b), static_cast<Byte*>(a) + 10);
+
+    auto marker = arena.mark();
+    auto used   = arena.usedBytes();
+
+    // Bigger than block
+    auto c = arena.allocate(1000, 8);
+    std::memset(c, 0xAB, 1000);
+    ASSERT_GT(arena.usedBytes(), used + 999);
+
+    arena.rewind(marker);
+    ASSERT_EQ(arena.usedBytes(), used);
+
+    // Blocks are reused after rewind
+    auto blocks   = arena.blocksCount();
+    auto reserved = arena.reservedBytes();
+    for (int i = 0; i < 10; ++i) {
+        auto p = arena.allocate(100, 8);
+        ASSERT_NE(p, nullptr);
+        ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 8, 0);
+    }
+
+    ASSERT_EQ(arena.blocksCount(), blocks);
+    ASSERT_EQ(arena.reservedBytes(), reserved);
+
+    arena.reset();
+    ASSERT_EQ(arena.usedBytes(), 0U);
+    ASSERT_EQ(arena.allocate(10, 1), a);
+    ASSERT_EQ(arena.allocations(), 14U);
+}
+
+TEST(Arena, Scope) {
+    auto& arena = base::thread_arena();
+    auto  used  = arena.usedBytes();
+
+    {
+        auto scope = base::ArenaScope();
+        auto str   = ftl::pmr::String("uniform_name_longer_than_small_buffer", &scope.arena());
+        ASSERT_GT(arena.usedBytes(), used);
+
+        {
+            auto inner = base::ArenaScope();
+            auto vec   = ftl::pmr::Vector<int>(&inner.arena());
+            vec.resize(100, 7);
+            ASSERT_EQ(vec.get_allocator().resource(), &arena);
+        }
+
+        ASSERT_EQ(str, "uniform_name_longer_than_small_buffer");
+    }
+
+    ASSERT_EQ(arena.usedBytes(), used);
+}
+
+TEST(Arena, PmrString) {
+    auto arena = base::Arena();
+    auto str   = ftl::pmr::String("key_1, key_2, long_key_name_for_heap_storage", &arena);
+
+    auto parts = str.split(',');
+    ASSERT_EQ(parts.size(), 3U);
+    ASSERT_EQ(parts.get_allocator().resource(), &arena);
+    ASSERT_EQ(parts[2].get_allocator().resource(), &arena);
+    ASSERT_EQ(parts[2], " long_key_name_for_heap_storage");
+
+    auto views = str.splitView(", ");
+    ASSERT_EQ(views.get_allocator().resource(), &arena);
+    ASSERT_EQ(views[1], "key_2");
+
+    auto name = ftl::pmr::String(&arena);
+    for (int i = 0; i < 16; ++i)
+        name.sprintf("_point_lights[{}].attenuation.quadratic", i);
+
+    ASSERT_EQ(name, "_point_lights[15].attenuation.quadratic");
+    ASSERT_EQ(name.substr(0, 13).get_allocator().resource(), &arena);
+    ASSERT_EQ(fmt::format("{}", name.substr(0, 13)), "_point_lights");
+
+    // Deallocation is no-op, so all memory is in arena
+    ASSERT_GT(arena.allocations(), 5);
+    ASSERT_EQ(arena.blocksCount(), 1U);
+}
@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+#include "../base/aton.hpp"
+
+namespace {
+    template <typename T>
+    auto bits(T value) {
+        std::conditional_t<sizeof(T) == 8, U64, U32> result;
+        std::memcpy(&result, &value, sizeof(T));
+        return result;
+    }
+
+    void expect_exact(const std::string& str) {
+        ASSERT_EQ(bits(base::aton<Float64>(str)), bits(std::strtod(str.c_str(), nullptr))) << str;
+        ASSERT_EQ(bits(base::aton<Float32>(str)), bits(std::strtof(str.c_str(), nullptr))) << str;
+    }
+}
+
+TEST(Aton, Integers) {
+    ASSERT_EQ(base::aton<S32>("  -12345"), -12345);
+    ASSERT_EQ(base::aton<S32>("+42"), 42);
+    ASSERT_EQ(base::aton<U32>("4294967295"), 4294967295U);
+    ASSERT_EQ(base::aton<S64>("-9223372036854775807"), -9223372036854775807LL);
+    ASSERT_EQ(base::aton<U64>("18446744073709551615"), 18446744073709551615ULL);
+    ASSERT_EQ(base::aton<U64>("1234567890123456789"), 1234567890123456789ULL);
+    ASSERT_EQ(base::aton<S16>("123abc"), 123);
+    ASSERT_EQ(base::aton<U8>("\t7"), 7);
+    ASSERT_EQ(base::aton<S32>("12345678 9"), 12345678);
+    ASSERT_EQ(base::aton<S32>(std::string_view("123456789", 4)), 1234);
+    ASSERT_EQ(base::aton<S32>("-"), 0);
+}
+
+TEST(Aton, Floats) {
+    ASSERT_FLOAT_EQ(base::aton<Float32>("103.3"), 103.3f);
+    ASSERT_FLOAT_EQ(base::aton<Float32>("10.55E1"), 105.5f);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>("-10.66E1"), -106.6);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>("1077E-1"), 107.7);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>(".5"), 0.5);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>("5."), 5.0);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>("2e"), 2.0);
+    ASSERT_DOUBLE_EQ(base::aton<Float64>(std::string_view("1.2345", 3)), 1.2);
+    ASSERT_EQ(base::aton<Float64>("abc"), 0.0);
+    ASSERT_TRUE(std::signbit(base::aton<Float64>("-0.0")));
+    ASSERT_TRUE(std::isinf(base::aton<Float64>("1e400")));
+    ASSERT_TRUE(std::isinf(base::aton<Float32>("-1e39")));
+}
+
+TEST(Aton, FloatsExactness) {
+    auto cases = {
+        "0.1", "0.2", "0.3", "1.7976931348623157e308", "1.7976931348623158e308", "2.2250738585072011e-308",
+        "2.2250738585072014e-308", "4.9406564584124654e-324", "2.4703282292062327e-324",
+        "2.4703282292062328e-324", "9007199254740993", "9007199254740992.5", "123456789012345678901234567890",
+        "0.10000000000000000555111512312578270211815834045410156251",
+        "0.1000000000000000055511151231257827021181583404541015625",
+        "7.038531e-26", "3.4028235e38", "3.4028236e38", "1.17549435e-38", "1.4e-45", "7e-46", "1.00000017881393432617187499",
+        "1.000000178813934326171875", "16777217", "33554435", "1e23", "8.589973e9", "4503599627370497.5",
+        "0.000000000000000000000000000000000000000000001", "1e-400", "00000000000000000000000001.5",
+        "3.14159265358979323846264338327950288419716939937510"
+    };
+
+    for (auto str : cases)
+        expect_exact(str);
+}
+
+TEST(Aton, FloatsRandomExactness) {
+    auto gen  = std::mt19937_64(42);
+    auto buf  = std::array<char, 64>();
+
+    for (int i = 0; i < 100000; ++i) {
+        auto value = Float64();
+        auto raw   = gen();
+        std::memcpy(&value, &raw, sizeof(value));
+
+        if (!std::isfinite(value))
+            continue;
+
+        // Shortest, exact and truncated representations
+        for (auto precision : {17, 9, 6, 25}) {
+            std::snprintf(buf.data(), buf.size(), "%.*g", precision, value);
+            expect_exact(buf.data());
+        }
+
+        // Decimal mantissa with random exponent
+        std::snprintf(buf.data(), buf.size(), "%llue%d",
+                      static_cast<unsigned long long>(gen() >> (gen() % 64)), static_cast<int>(gen() % 700) - 350);
+        expect_exact(buf.data());
+    }
+}
+
+TEST(Aton, Array) {
+    auto values = std::array<Float32, 8>();
+    auto ints   = std::array<S32, 8>();
+
+    ASSERT_EQ(base::aton_array("1 2.5\n-3e2\t 4\r\n", values.data(), values.size()), 4);
+    ASSERT_EQ(values[1], 2.5f);
+    ASSERT_EQ(values[2], -300.f);
+    ASSERT_EQ(values[3], 4.f);
+
+    ASSERT_EQ(base::aton_array("1 2 3 4 5", values.data(), 3), 3);
+    ASSERT_EQ(base::aton_array("1 2 x 4", values.data(), values.size()), 2);
+    ASSERT_EQ(base::aton_array("1 2.5 3", ints.data(), ints.size()), 1);
+    ASSERT_EQ(base::aton_array("  ", ints.data(), ints.size()), 0);
+    ASSERT_EQ(base::aton_array("-10 20 -", ints.data(), ints.size()), 2);
+    ASSERT_EQ(ints[0], -10);
+}
@@ -1,4 +1,7 @@
+#include <random>
+
 #include "../base/ftl/string.hpp"
+#include "../base/ftl/string_scan.hpp"
 #include "../base/ftl/vector.hpp"
 
 #include "gtest/gtest.h"
@@ -519,4 +522,78 @@ TEST(StringTests, Split) {
     ASSERT_TRUE(Str(" \n abc \n\n").splitView({' ', '\n'}) == Vec{"abc"});
 
     ASSERT_TRUE(Str(" \nabc \n xyz\nkek 228\n").splitView({' ', '\n'}).to_string() == "{ abc, xyz, kek, 228 }");
-}
\ No newline at end of file
+}
+TEST(StringTests, SplitToBuffer) {
+    using Str = ftl::String;
+
+    std::string_view buf[3];
+
+    auto words = Str("  abc   xyz kek 228 ");
+    ASSERT_EQ(words.splitView(' ', buf, 3), 3);
+    ASSERT_EQ(buf[0], "abc");
+    ASSERT_EQ(buf[1], "xyz");
+    ASSERT_EQ(buf[2], "kek 228 ");
+
+    auto pipes = Str("abc||xyz");
+    ASSERT_EQ(pipes.splitView("||", buf, 3), 2);
+    ASSERT_EQ(buf[1], "xyz");
+
+    auto commas = Str("a,,b");
+    ASSERT_EQ(commas.splitView({','}, buf, 3, true), 3);
+    ASSERT_EQ(buf[1], "");
+    ASSERT_EQ(Str("abc").splitView(' ', buf, 0), 0);
+    ASSERT_EQ(Str("   ").splitView(' ', buf, 3), 0);
+
+    auto lines = Str(" \nabc \n xyz\nkek 228\n");
+    auto views = lines.splitView<8>({' ', '\n'});
+    ASSERT_EQ(views.size(), 4);
+    ASSERT_EQ(*views.begin(), "abc");
+    ASSERT_EQ(views[3], "228");
+
+    auto letters = Str("a b c");
+    ASSERT_EQ(letters.splitView<2>(' ')[1], "b c");
+    ASSERT_TRUE(Str("").splitView<2>("||").empty());
+}
+
+// Vectorized scans and splits must be the same as scalar on every offset and block tail
+TEST(StringTests, ScanKernels) {
+    namespace scan = ftl::str_scan;
+
+    auto gen  = std::mt19937(42);
+    auto text = std::string(300, ' ');
+
+    for (int round = 0; round < 20; ++round) {
+        for (auto& c : text)
+            c = " \tab;/|\n"[gen() % (round % 2 ? 9 : 4)];
+
+        for (SizeT first = 0; first < 40; ++first) {
+            for (SizeT last = first; last <= text.size(); last += 1 + last / 8) {
+                auto p   = text.data() + first;
+                auto end = text.data() + last;
+
+                ASSERT_EQ(scan::find_char(p, end, ';'), scan::scalar::find_char(p, end, ';'));
+                ASSERT_EQ(scan::find_any(p, end, ";/|"), scan::scalar::find_any(p, end, ";/|"));
+                ASSERT_EQ(scan::find_not_any(p, end, " \t"), scan::scalar::find_not_any(p, end, " \t"));
+                ASSERT_EQ(scan::rfind_not_any(p, end, " \t"), scan::scalar::rfind_not_any(p, end, " \t"));
+                ASSERT_EQ(scan::find_str(p, end, "ab;"), scan::scalar::find_str(p, end, "ab;"));
+                ASSERT_EQ(scan::find_str(p, end, "a b"), scan::scalar::find_str(p, end, "a b"));
+
+                auto str  = ftl::String(std::string_view(p, end - p));
+                auto wstr = ftl::String32(std::u32string(p, end));
+                auto view = str.splitView({' ', '\t', '|'}, true);
+                auto wide = wstr.splitView({U' ', U'\t', U'|'}, true);
+
+                ASSERT_EQ(view.size(), wide.size());
+                for (SizeT i = 0; i < view.size(); ++i)
+                    ASSERT_EQ(view[i].size(), wide[i].size());
+
+                ASSERT_EQ(str.splitView("a ").size(), wstr.splitView(U"a ").size());
+                ASSERT_EQ(str.split(';').size(), wstr.split(U';').size());
+            }
+        }
+    }
+
+    ASSERT_EQ(scan::trim("  \t abc d \t"), "abc d");
+    ASSERT_EQ(scan::trim("   "), "");
+    ASSERT_EQ(scan::trim(std::string(40, ' ') + "x" + std::string(40, '\t')), "x");
+}
@@ -0,0 +1,60 @@
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include <fmt/format.h>
+
+#include "binary_log.hpp"
+
+/**
+ * Binary log decoder
+ *
+ * Usage: LogDecoder <log.blog> [<output.log>]
+ * Formats binary log written with log_binary = true to text log, prints to stdout if output is not set
+ */
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: LogDecoder <log.blog> [<output.log>]" << std::endl;
+        return 1;
+    }
+
+    auto file = std::ofstream();
+    if (argc == 3) {
+        file.open(argv[2], std::ios::binary);
+        if (!file) {
+            std::cerr << "Can't open '" << argv[2] << "'" << std::endl;
+            return 1;
+        }
+    }
+
+    auto& out   = argc == 3 ? static_cast<std::ostream&>(file) : std::cout;
+    auto  count = SizeT(0);
+
+    auto line = std::string();
+
+    auto ok = base::blog::read_log(argv[1], [&](std::chrono::system_clock::time_point time, base::LogLevel level,
+                                                base::LogCategory category, std::string_view text) {
+        auto seconds = std::chrono::system_clock::to_time_t(time);
+        auto ms      = std::chrono::duration_cast<std::chrono::milliseconds>(time.time_since_epoch()).count() % 1000;
+        auto tm      = std::tm();
+        localtime_r(&seconds, &tm);
+
+        line = fmt::format("[{:02}:{:02}:{:02}:{:03}]: ", tm.tm_hour, tm.tm_min, tm.tm_sec, ms);
+        base::appendLogPrefix(line, level, category);
+        line.append(text);
+        line += '\n';
+
+        out << line;
+        ++count;
+    });
+
+    if (!ok) {
+        std::cerr << "'" << argv[1] << "' is not a binary log or it is corrupted, decoded " << count
+                  << " messages" << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,95 @@
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "vfs.hpp"
+
+/**
+ * Gamedata packer
+ *
+ * Usage: GamedataPacker [--store] <output.dpk> <data_dir> [<subdir>...]
+ * Packs subdirectories of data directory (gamedata by default) recursively. Archive paths are
+ * relative to data directory, so archive placed to data directory overrides nothing but loose
+ * files that are removed from it
+ */
+
+namespace {
+    int usage() {
+        std::cerr << "Usage: GamedataPacker [--store] <output.dpk> <data_dir> [<subdir>...]" << std::endl;
+        return 1;
+    }
+
+    void collect(const std::string& root, const std::string& relative, ftl::Vector<base::PackSource>& sources) {
+        auto full = root + "/" + relative;
+        auto dir  = opendir(full.c_str());
+
+        if (!dir) {
+            std::cerr << "Can't open directory '" << full << "'" << std::endl;
+            return;
+        }
+
+        while (auto ent = readdir(dir)) {
+            auto name = std::string_view(ent->d_name);
+            if (name == "." || name == "..")
+                continue;
+
+            auto path = relative + "/" + std::string(name);
+            auto real = root + "/" + path;
+
+            struct stat st = {};
+            if (stat(real.c_str(), &st) != 0)
+                continue;
+
+            if (S_ISDIR(st.st_mode))
+                collect(root, path, sources);
+            else if (S_ISREG(st.st_mode))
+                sources.push_back(base::PackSource{ftl::String(path), ftl::String(real)});
+        }
+
+        closedir(dir);
+    }
+}
+
+int main(int argc, char** argv) {
+    auto compression = base::PackCompression::LZ4;
+    auto args        = std::vector<std::string>();
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+
+        if (arg == "--store")
+            compression = base::PackCompression::Store;
+        else
+            args.emplace_back(arg);
+    }
+
+    if (args.size() < 2)
+        return usage();
+
+    auto& output = args[0];
+    auto  root   = std::string(base::normalizePath(args[1]).c_str());
+    auto  dirs   = std::vector<std::string>(args.begin() + 2, args.end());
+
+    if (dirs.empty())
+        dirs.emplace_back("gamedata");
+
+    auto sources = ftl::Vector<base::PackSource>();
+    for (auto& dir : dirs)
+        collect(root, base::normalizePath(dir).c_str(), sources);
+
+    if (sources.empty()) {
+        std::cerr << "Nothing to pack" << std::endl;
+        return 1;
+    }
+
+    auto stats = base::writePackArchive(ftl::String(output), sources, compression);
+
+    std::cout << output << ": " << stats.files_count << " files, " << stats.original_size << " -> "
+              << stats.packed_size << " bytes" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,82 @@
+#include <iostream>
+#include <string_view>
+#include <vector>
+
+#include "files.hpp"
+#include "TextureCache.hpp"
+
+/**
+ * Offline texture cooker
+ *
+ * Usage: TextureCooker [--format auto|rgba8|bc1|bc3|bc5] <source> [<output>]
+ * Output defaults to <source>.dtx. Engine looks for cooked textures in textures_cache_dir
+ * with the same relative path as in textures_dir
+ */
+
+namespace {
+    using grx_txtr::TextureFormat;
+
+    std::optional<std::optional<TextureFormat>> parse_format(std::string_view name) {
+        if (name == "auto")  return std::optional<TextureFormat>();
+        if (name == "rgba8") return std::optional(TextureFormat::RGBA8);
+        if (name == "bc1")   return std::optional(TextureFormat::BC1);
+        if (name == "bc3")   return std::optional(TextureFormat::BC3);
+        if (name == "bc5")   return std::optional(TextureFormat::BC5);
+        return std::nullopt;
+    }
+
+    int usage() {
+        std::cerr << "Usage: TextureCooker [--format auto|rgba8|bc1|bc3|bc5] <source> [<output>]" << std::endl;
+        return 1;
+    }
+}
+
+int main(int argc, char** argv) {
+    auto format = std::optional<TextureFormat>();
+    auto paths  = std::vector<std::string>();
+
+    for (int i = 1; i < argc; ++i) {
+        auto arg = std::string_view(argv[i]);
+
+        if (arg == "--format" || arg == "-f") {
+            if (++i == argc)
+                return usage();
+
+            auto parsed = parse_format(argv[i]);
+            if (!parsed)
+                return usage();
+
+            format = *parsed;
+        }
+        else
+            paths.emplace_back(arg);
+    }
+
+    if (paths.empty() || paths.size() > 2)
+        return usage();
+
+    auto& source = paths[0];
+    auto  output = paths.size() == 2 ? paths[1] : source + ".dtx";
+
+    auto bytes = grx_txtr::read_image_file(source);
+    if (bytes.empty()) {
+        std::cerr << "Can't read '" << source << "'" << std::endl;
+        return 1;
+    }
+
+    auto image = grx_txtr::decode_image(bytes.data(), bytes.size(), source);
+    if (!image.valid()) {
+        std::cerr << "Can't decode '" << source << "'" << std::endl;
+        return 1;
+    }
+
+    auto cooked_format = format ? *format : grx_txtr::auto_format(image);
+    auto cooked        = grx_txtr::cook_texture(image, cooked_format, grx_txtr::hash_source(bytes.data(), bytes.size()));
+
+    base::writeBytesToFile(ftl::String(output), reinterpret_cast<const Byte*>(cooked.data()), cooked.size());
+
+    std::cout << source << " -> " << output << " (" << image.width << "x" << image.height << ", "
+              << cooked.size() << " bytes)" << std::endl;
+
+    return 0;
+}